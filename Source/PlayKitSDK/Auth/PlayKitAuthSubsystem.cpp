@@ -3,10 +3,16 @@
 
 #include "PlayKitAuthSubsystem.h"
 
-#include "HttpModule.h"
+#include "PlayKitCredentials.h"
+#include "Net/PlayKitTransport.h"
 #include "Interfaces/IHttpResponse.h"
 #include "Serialization/BufferArchive.h"
 
+// Key of the encrypted player token file
+static constexpr uint8 PlayerTokenKey[32] = {
+	'P','L','a','Y','k','I','t','S','D','k','F','o','R','u','N','r',
+	'E','a','L','e','N','g','I','n','E','2','0','2','5','U','E','5'
+};
 
 void UPlayKitAuthSubsystem::BeginDestroy()
 {
@@ -53,7 +59,7 @@ void UPlayKitAuthSubsystem::RequestCode(const FString _Address, ELoginType _Logi
 
 	///////////////// Set header /////////////////
 
-	subsystem->RequestCodeHttpRequest = FHttpModule::Get().CreateRequest();
+	subsystem->RequestCodeHttpRequest = FPlayKitTransport::Get().CreateRequest(url);
 
 
 	subsystem->RequestCodeHttpRequest->SetURL(url);
@@ -184,7 +190,7 @@ void UPlayKitAuthSubsystem::VerifyCode(const FString _Code, FOnVerifyCodeComplet
 	const FString url = subsystem->BaseURL / "/api/auth/verify-code";
 
 	///////////////// Set header /////////////////
-	subsystem->VerifyCodeHttpRequest = FHttpModule::Get().CreateRequest();
+	subsystem->VerifyCodeHttpRequest = FPlayKitTransport::Get().CreateRequest(url);
 
 	subsystem->VerifyCodeHttpRequest->SetURL(url);
 	subsystem->VerifyCodeHttpRequest->SetVerb("POST");
@@ -313,7 +319,7 @@ void UPlayKitAuthSubsystem::GetPlayerToken(const FString& _GlobalToken, FOnVerif
 	const FString url = subsystem->BaseURL / "/api/external/exchange-jwt";
 
 	///////////////// Set header /////////////////
-	subsystem->GetPlayerTokenHttpRequest = FHttpModule::Get().CreateRequest();
+	subsystem->GetPlayerTokenHttpRequest = FPlayKitTransport::Get().CreateRequest(url);
 
 	subsystem->GetPlayerTokenHttpRequest->SetURL(url);
 	subsystem->GetPlayerTokenHttpRequest->SetVerb("POST");
@@ -364,8 +370,9 @@ void UPlayKitAuthSubsystem::GetPlayerToken(const FString& _GlobalToken, FOnVerif
 			playerTokenInfo.UserId		= newJsonObject->GetStringField(TEXT("userId"));
 			playerTokenInfo.PlayerToken	= newJsonObject->GetStringField(TEXT("playerToken"));
 			playerTokenInfo.ExpiresAt	= newJsonObject->GetStringField(TEXT("expiresAt"));
-			// Save token
+			// Save token; it is refreshed with the same JWT before it expires
 			WeakThis->SaveToken(playerTokenInfo);
+			FPlayKitCredentials::SetRefreshJwt(_GlobalToken);
 
 			(void)_OnVerifyCodeCompleted.ExecuteIfBound(EVerifyCodeStatus::GetPlayerToken);
 		});
@@ -425,18 +432,31 @@ void UPlayKitAuthSubsystem::ClearVerifyCooldownTimer()
 //-----------------------------------------------
 void UPlayKitAuthSubsystem::SaveToken(FPlayerTokenInfo _PlayerTokenInfo) const
 {
+	// Served from memory right away; the file is written on a worker thread
+	FPlayKitCredentials::SetSavedToken(_PlayerTokenInfo);
+}
+
+//------------------------------------------------
+// Purpose: Get token
+//------------------------------------------------
+bool UPlayKitAuthSubsystem::GetToken(FPlayerTokenInfo& _OutPlayerTokenInfo, int32 _HoursEarly)
+{
+	// Decrypted once at startup, not per call
+	return FPlayKitCredentials::GetSavedToken(_OutPlayerTokenInfo, _HoursEarly);
+}
+
+//-----------------------------------------------
+// Purpose: Encrypt token and write it to file
+//-----------------------------------------------
+bool UPlayKitAuthSubsystem::SaveTokenToFile(const FPlayerTokenInfo& _PlayerTokenInfo, const FString& _FilePath)
+{
+	FPlayerTokenInfo playerTokenInfo = _PlayerTokenInfo;
 	FBufferArchive toBinary;
-	toBinary << _PlayerTokenInfo;
+	toBinary << playerTokenInfo;
 
 	TArray<uint8> encryptedData;
 	encryptedData.Append(toBinary.GetData(), toBinary.Num());
 
-
-	constexpr uint8 key[32] = {
-		'P','L','a','Y','k','I','t','S','D','k','F','o','R','u','N','r',
-		'E','a','L','e','N','g','I','n','E','2','0','2','5','U','E','5'
-	};
-
 	// Pad to multiple of 16 (PKCS7)
 	int32 padding = 16 - (encryptedData.Num() % 16);
 	if (padding != 0 && padding != 16)
@@ -446,64 +466,25 @@ void UPlayKitAuthSubsystem::SaveToken(FPlayerTokenInfo _PlayerTokenInfo) const
 	}
 
 
-	FAES::EncryptData(encryptedData.GetData(), encryptedData.Num(), key, 32);
+	FAES::EncryptData(encryptedData.GetData(), encryptedData.Num(), PlayerTokenKey, 32);
 
-	FFileHelper::SaveArrayToFile(encryptedData, *PlayerTokenSaveFilePath);
+	const bool bIsSaved = FFileHelper::SaveArrayToFile(encryptedData, *_FilePath);
 
 	// Clean up memory
 	toBinary.FlushCache();
 	toBinary.Empty();
+
+	return bIsSaved;
 }
 
 //------------------------------------------------
-// Purpose: Get token
+// Purpose: Read token from file and check expiry
 //------------------------------------------------
-bool UPlayKitAuthSubsystem::GetToken(FPlayerTokenInfo& _OutPlayerTokenInfo, int32 _HoursEarly)
+bool UPlayKitAuthSubsystem::LoadTokenFromFile(const FString& _FilePath, FPlayerTokenInfo& _OutPlayerTokenInfo, int32 _HoursEarly)
 {
-	UPlayKitAuthSubsystem* subsystem = Get();
-	if (!subsystem)
-		return false;
-
-
-	// If file doesn't exist, return false
-	if(!IFileManager::Get().FileExists(*(subsystem->PlayerTokenSaveFilePath)))
-		return false;
-	// Read file
-	TArray<uint8> binaryData;
-	bool bIsLoaded =
-		FFileHelper::LoadFileToArray(binaryData, *(subsystem->PlayerTokenSaveFilePath));
-
-	// File cannot be read
-	if (!bIsLoaded)
-		return false;
-
-
-
-	constexpr uint8 key[32] = {
-		'P','L','a','Y','k','I','t','S','D','k','F','o','R','u','N','r',
-		'E','a','L','e','N','g','I','n','E','2','0','2','5','U','E','5'
-	};
-	if (binaryData.Num() > 0)
-	{
-		uint8 padding = binaryData.Last();
-		if (padding > 0 && padding <= 16 && padding <= binaryData.Num())
-		{
-			binaryData.RemoveAt(binaryData.Num() - padding, padding, EAllowShrinking::No);
-		}
-	}
-
-
-	FAES::DecryptData(binaryData.GetData(), binaryData.Num(), key, 32);
-
-
-
-	FMemoryReader fromBinary(binaryData, true);
-	fromBinary.Seek(0);
 	FPlayerTokenInfo playerTokenInfo;
-	fromBinary << playerTokenInfo;
-
-	fromBinary.FlushCache();
-	fromBinary.Close();
+	if (!ReadTokenFile(_FilePath, playerTokenInfo))
+		return false;
 
 	// Check if expired
 	FString expiresAt = playerTokenInfo.ExpiresAt;
@@ -531,3 +512,38 @@ bool UPlayKitAuthSubsystem::GetToken(FPlayerTokenInfo& _OutPlayerTokenInfo, int3
 	_OutPlayerTokenInfo = playerTokenInfo;
 	return true;
 }
+
+//------------------------------------------------
+// Purpose: Read and decrypt the token file
+//------------------------------------------------
+bool UPlayKitAuthSubsystem::ReadTokenFile(const FString& _FilePath, FPlayerTokenInfo& _OutPlayerTokenInfo)
+{
+	// Read file; a missing file fails here as well
+	TArray<uint8> binaryData;
+	bool bIsLoaded =
+		FFileHelper::LoadFileToArray(binaryData, *_FilePath, FILEREAD_Silent);
+
+	// File cannot be read, or is not whole AES blocks
+	if (!bIsLoaded || binaryData.Num() == 0 || binaryData.Num() % 16 != 0)
+		return false;
+
+	// Padding is stripped implicitly: the reader stops at the end of the serialized struct.
+	// It must not be stripped before decryption, that would leave a partial block.
+	FAES::DecryptData(binaryData.GetData(), binaryData.Num(), PlayerTokenKey, 32);
+
+
+	FMemoryReader fromBinary(binaryData, true);
+	fromBinary.Seek(0);
+	FPlayerTokenInfo playerTokenInfo;
+	fromBinary << playerTokenInfo;
+
+	const bool bIsCorrupt = fromBinary.IsError();
+	fromBinary.FlushCache();
+	fromBinary.Close();
+
+	if (bIsCorrupt)
+		return false;
+
+	_OutPlayerTokenInfo = playerTokenInfo;
+	return true;
+}
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "PlayKitCredentials.h"
 #include "PlayKitAuthSubsystem.generated.h"
 
 
@@ -154,6 +155,13 @@ public:
 		meta=(DisplayName="Get Player Token Info"))
 	static bool GetToken(FPlayerTokenInfo& _OutPlayerTokenInfo, int32 _HoursEarly = 6);
 
+	// Encrypted token file access behind SaveToken and GetToken; usable without a game instance
+	static bool SaveTokenToFile(const FPlayerTokenInfo& _PlayerTokenInfo, const FString& _FilePath);
+	static bool LoadTokenFromFile(const FString& _FilePath, FPlayerTokenInfo& _OutPlayerTokenInfo, int32 _HoursEarly = 6);
+
+	// Decrypt the token file without checking its expiry
+	static bool ReadTokenFile(const FString& _FilePath, FPlayerTokenInfo& _OutPlayerTokenInfo);
+
 public:
 	//////////////// Login  ////////////////
 
@@ -187,7 +195,7 @@ public:
 	FString BaseURL = FString("https://api.playkit.ai");
 
 	//////////////// Client  ////////////////
-	const FString PlayerTokenSaveFilePath = FPaths::ProjectSavedDir() / TEXT("PlayKit/PlayerToken.dat");
+	const FString PlayerTokenSaveFilePath = FPlayKitCredentials::GetSavedTokenPath();
 	FUserClientInfo UserClientInfo;
 
 };
@@ -0,0 +1,363 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitCredentials.h"
+#include "PlayKitAuthSubsystem.h"
+#include "PlayKitSettings.h"
+#include "Net/PlayKitTransport.h"
+#include "Net/PlayKitJsonWriter.h"
+#include "Net/PlayKitGameThreadQueue.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Async/Async.h"
+#include "Containers/Ticker.h"
+#include <atomic>
+
+namespace PlayKitCredentials
+{
+	/** Published state; never modified once readers can see it */
+	struct FSnapshot
+	{
+		FString DeveloperToken;
+		FString PlayerToken;
+
+		FPlayerTokenInfo SavedToken;
+
+		/** Parsed SavedToken.ExpiresAt; MinValue without a usable saved token */
+		FDateTime SavedTokenExpiry = FDateTime::MinValue();
+
+		/** The token file has been read, or a token saved since */
+		bool bSavedTokenLoaded = false;
+	};
+
+	std::atomic<const FSnapshot*> Current { nullptr };
+
+	// Writers only. Replaced snapshots stay alive until shutdown since a reader may still be
+	// using one; tokens change a handful of times per session.
+	FCriticalSection WriteLock;
+	TArray<TUniquePtr<FSnapshot>> Snapshots;
+
+	TFuture<void> SavedTokenLoad;
+	TFuture<void> SavedTokenWrite;
+
+	// Refresh, game thread only
+	bool bRunning = false;
+	FString RefreshJwt;
+	FPlayKitCredentials::FRefresher Refresher;
+	FTSTicker::FDelegateHandle RefreshHandle;
+	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> RefreshRequest;
+	bool bRefreshing = false;
+
+	constexpr float FirstRetrySeconds = 30.0f;
+	constexpr float MaxRetrySeconds = 15.0f * 60.0f;
+	float RetryDelay = FirstRetrySeconds;
+
+	const FSnapshot& Get()
+	{
+		static const FSnapshot Empty;
+		const FSnapshot* Snapshot = Current.load(std::memory_order_acquire);
+		return Snapshot ? *Snapshot : Empty;
+	}
+
+	/** Publish a copy of the current snapshot changed by Modify */
+	void Publish(TFunctionRef<void(FSnapshot&)> Modify)
+	{
+		FScopeLock Lock(&WriteLock);
+		TUniquePtr<FSnapshot> Next = MakeUnique<FSnapshot>(Get());
+		Modify(*Next);
+		Current.store(Next.Get(), std::memory_order_release);
+		Snapshots.Add(MoveTemp(Next));
+	}
+
+	void ApplySavedToken(FSnapshot& Snapshot, const FPlayerTokenInfo& Token)
+	{
+		Snapshot.SavedToken = Token;
+		Snapshot.bSavedTokenLoaded = true;
+		if (Token.PlayerToken.IsEmpty() || !FDateTime::ParseIso8601(*Token.ExpiresAt, Snapshot.SavedTokenExpiry))
+		{
+			Snapshot.SavedTokenExpiry = FDateTime::MinValue();
+		}
+	}
+
+	void Refresh();
+
+	void ArmRefresh(float DelaySeconds)
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(RefreshHandle);
+		RefreshHandle = FTSTicker::GetCoreTicker().AddTicker(TEXT("PlayKitCredentialsRefresh"), DelaySeconds, [](float)
+		{
+			RefreshHandle.Reset();
+			Refresh();
+			return false;
+		});
+	}
+
+	/** Arm the refresh of the current saved token */
+	void ScheduleRefresh()
+	{
+		check(IsInGameThread());
+		if (!bRunning)
+		{
+			return;
+		}
+
+		FTSTicker::GetCoreTicker().RemoveTicker(RefreshHandle);
+		RefreshHandle.Reset();
+		RetryDelay = FirstRetrySeconds;
+
+		const FDateTime Expiry = Get().SavedTokenExpiry;
+		if (Expiry != FDateTime::MinValue())
+		{
+			const FDateTime RefreshTime = Expiry - FTimespan::FromHours(FPlayKitCredentials::RefreshLeadHours);
+			ArmRefresh(static_cast<float>(FMath::Max(0.0, (RefreshTime - FDateTime::UtcNow()).GetTotalSeconds())));
+		}
+	}
+
+	void FinishRefresh(bool bSucceeded, const FPlayerTokenInfo& NewToken)
+	{
+		bRefreshing = false;
+		RefreshRequest.Reset();
+		if (!bRunning)
+		{
+			return;
+		}
+
+		if (bSucceeded && !NewToken.PlayerToken.IsEmpty())
+		{
+			UE_LOG(LogTemp, Log, TEXT("[PlayKitCredentials] Player token refreshed, expires at %s"), *NewToken.ExpiresAt);
+			FPlayKitCredentials::SetSavedToken(NewToken);
+			return;
+		}
+
+		// Requests keep the current token; retry while it is still valid
+		if (FDateTime::UtcNow() >= Get().SavedTokenExpiry)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[PlayKitCredentials] Player token expired and could not be refreshed; sign in again"));
+			return;
+		}
+		UE_LOG(LogTemp, Warning, TEXT("[PlayKitCredentials] Player token refresh failed, retrying in %.0f s"), RetryDelay);
+		ArmRefresh(RetryDelay);
+		RetryDelay = FMath::Min(RetryDelay * 2.0f, MaxRetrySeconds);
+	}
+
+	void ExchangeJwt()
+	{
+		const UPlayKitSettings* Settings = UPlayKitSettings::Get();
+		const FString Url = FString::Printf(TEXT("%s/api/external/exchange-jwt"), Settings ? *Settings->GetBaseUrl() : TEXT("https://api.playkit.ai"));
+
+		TArray<uint8> Body;
+		FPlayKitJsonWriter Writer(Body);
+		Writer.BeginObject();
+		Writer.WriteString("jwt", RefreshJwt);
+		Writer.EndObject();
+
+		RefreshRequest = FPlayKitTransport::CreateRequest(Url, TEXT("POST"), TEXT("application/json"), RefreshJwt);
+		RefreshRequest->SetContent(MoveTemp(Body));
+		RefreshRequest->OnProcessRequestComplete().BindLambda([](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			FPlayerTokenInfo NewToken;
+			TSharedPtr<FJsonObject> JsonObject;
+			if (bWasSuccessful && Response.IsValid() && Response->GetResponseCode() == 200)
+			{
+				const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Response->GetContentAsString());
+				if (FJsonSerializer::Deserialize(Reader, JsonObject) && JsonObject.IsValid())
+				{
+					JsonObject->TryGetStringField(TEXT("userId"), NewToken.UserId);
+					JsonObject->TryGetStringField(TEXT("playerToken"), NewToken.PlayerToken);
+					JsonObject->TryGetStringField(TEXT("expiresAt"), NewToken.ExpiresAt);
+				}
+			}
+			FinishRefresh(!NewToken.PlayerToken.IsEmpty(), NewToken);
+		});
+		RefreshRequest->ProcessRequest();
+	}
+
+	void Refresh()
+	{
+		if (!bRunning || bRefreshing)
+		{
+			return;
+		}
+
+		if (Refresher)
+		{
+			bRefreshing = true;
+			Refresher([](bool bSucceeded, const FPlayerTokenInfo& NewToken) { FinishRefresh(bSucceeded, NewToken); });
+			return;
+		}
+		if (RefreshJwt.IsEmpty())
+		{
+			UE_LOG(LogTemp, Log, TEXT("[PlayKitCredentials] Player token expires at %s; nothing to refresh it with"),
+				*Get().SavedToken.ExpiresAt);
+			return;
+		}
+
+		bRefreshing = true;
+		ExchangeJwt();
+	}
+}
+
+FString FPlayKitCredentials::GetAuthToken()
+{
+	const PlayKitCredentials::FSnapshot& Snapshot = PlayKitCredentials::Get();
+	const UPlayKitSettings* Settings = UPlayKitSettings::Get();
+	const bool bUseDeveloperToken = !Snapshot.DeveloperToken.IsEmpty() && !(Settings && Settings->bIgnoreDeveloperToken);
+	return bUseDeveloperToken ? Snapshot.DeveloperToken : Snapshot.PlayerToken;
+}
+
+FString FPlayKitCredentials::GetDeveloperToken()
+{
+	return PlayKitCredentials::Get().DeveloperToken;
+}
+
+FString FPlayKitCredentials::GetPlayerToken()
+{
+	return PlayKitCredentials::Get().PlayerToken;
+}
+
+bool FPlayKitCredentials::GetSavedToken(FPlayerTokenInfo& OutToken, int32 HoursEarly)
+{
+	if (!PlayKitCredentials::Get().bSavedTokenLoaded && PlayKitCredentials::SavedTokenLoad.IsValid())
+	{
+		PlayKitCredentials::SavedTokenLoad.Wait();
+	}
+
+	const PlayKitCredentials::FSnapshot& Snapshot = PlayKitCredentials::Get();
+	if (Snapshot.SavedTokenExpiry == FDateTime::MinValue()
+		|| FDateTime::UtcNow() > Snapshot.SavedTokenExpiry - FTimespan::FromHours(HoursEarly))
+	{
+		return false;
+	}
+
+	OutToken = Snapshot.SavedToken;
+	return true;
+}
+
+void FPlayKitCredentials::SetDeveloperToken(const FString& Token)
+{
+	PlayKitCredentials::Publish([&Token](PlayKitCredentials::FSnapshot& Snapshot) { Snapshot.DeveloperToken = Token; });
+}
+
+void FPlayKitCredentials::SetPlayerToken(const FString& Token)
+{
+	PlayKitCredentials::Publish([&Token](PlayKitCredentials::FSnapshot& Snapshot) { Snapshot.PlayerToken = Token; });
+}
+
+void FPlayKitCredentials::SetSavedToken(const FPlayerTokenInfo& Token)
+{
+	check(IsInGameThread());
+	const FString PreviousToken = PlayKitCredentials::Get().SavedToken.PlayerToken;
+	PlayKitCredentials::Publish([&Token](PlayKitCredentials::FSnapshot& Snapshot) { PlayKitCredentials::ApplySavedToken(Snapshot, Token); });
+
+	// Requests authorized with the replaced token move to the new one
+	UPlayKitSettings* Settings = UPlayKitSettings::Get();
+	if (Settings && !PreviousToken.IsEmpty() && PreviousToken != Token.PlayerToken && GetPlayerToken() == PreviousToken)
+	{
+		Settings->SetPlayerToken(Token.PlayerToken);
+	}
+
+	// Writes stay in order: each waits for the one before
+	PlayKitCredentials::SavedTokenWrite = Async(EAsyncExecution::ThreadPool,
+		[Token, Path = GetSavedTokenPath(), Previous = MoveTemp(PlayKitCredentials::SavedTokenWrite)]()
+		{
+			if (Previous.IsValid())
+			{
+				Previous.Wait();
+			}
+			if (!UPlayKitAuthSubsystem::SaveTokenToFile(Token, Path))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("[PlayKitCredentials] Could not write %s"), *Path);
+			}
+		});
+
+	PlayKitCredentials::ScheduleRefresh();
+}
+
+void FPlayKitCredentials::SetRefreshJwt(const FString& Jwt)
+{
+	check(IsInGameThread());
+	PlayKitCredentials::RefreshJwt = Jwt;
+}
+
+void FPlayKitCredentials::SetRefresher(FRefresher InRefresher)
+{
+	check(IsInGameThread());
+	PlayKitCredentials::Refresher = MoveTemp(InRefresher);
+}
+
+FString FPlayKitCredentials::GetSavedTokenPath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("PlayKit/PlayerToken.dat");
+}
+
+void FPlayKitCredentials::Startup()
+{
+	if (PlayKitCredentials::bRunning)
+	{
+		return;
+	}
+	PlayKitCredentials::bRunning = true;
+
+	FString DeveloperToken;
+	FString PlayerToken;
+	if (const UPlayKitSettings* Settings = UPlayKitSettings::Get())
+	{
+		Settings->ReadStoredTokens(DeveloperToken, PlayerToken);
+	}
+	PlayKitCredentials::Publish([&](PlayKitCredentials::FSnapshot& Snapshot)
+	{
+		Snapshot.DeveloperToken = MoveTemp(DeveloperToken);
+		Snapshot.PlayerToken = MoveTemp(PlayerToken);
+	});
+
+	// Disk read and decryption stay off the game thread
+	PlayKitCredentials::SavedTokenLoad = Async(EAsyncExecution::ThreadPool, [Path = GetSavedTokenPath()]()
+	{
+		FPlayerTokenInfo Token;
+		UPlayKitAuthSubsystem::ReadTokenFile(Path, Token);
+		PlayKitCredentials::Publish([&Token](PlayKitCredentials::FSnapshot& Snapshot)
+		{
+			// A token saved in the meantime is newer
+			if (!Snapshot.bSavedTokenLoaded)
+			{
+				PlayKitCredentials::ApplySavedToken(Snapshot, Token);
+			}
+		});
+		FPlayKitGameThreadQueue::Enqueue([]() { PlayKitCredentials::ScheduleRefresh(); });
+	});
+}
+
+void FPlayKitCredentials::Shutdown()
+{
+	if (!PlayKitCredentials::bRunning)
+	{
+		return;
+	}
+	PlayKitCredentials::bRunning = false;
+
+	FTSTicker::GetCoreTicker().RemoveTicker(PlayKitCredentials::RefreshHandle);
+	PlayKitCredentials::RefreshHandle.Reset();
+	if (PlayKitCredentials::RefreshRequest.IsValid())
+	{
+		PlayKitCredentials::RefreshRequest->OnProcessRequestComplete().Unbind();
+		PlayKitCredentials::RefreshRequest->CancelRequest();
+		PlayKitCredentials::RefreshRequest.Reset();
+	}
+	PlayKitCredentials::bRefreshing = false;
+	PlayKitCredentials::Refresher = nullptr;
+	PlayKitCredentials::RefreshJwt.Empty();
+
+	for (TFuture<void>* Pending : { &PlayKitCredentials::SavedTokenLoad, &PlayKitCredentials::SavedTokenWrite })
+	{
+		if (Pending->IsValid())
+		{
+			Pending->Wait();
+			Pending->Reset();
+		}
+	}
+
+	FScopeLock Lock(&PlayKitCredentials::WriteLock);
+	PlayKitCredentials::Current.store(nullptr, std::memory_order_release);
+	PlayKitCredentials::Snapshots.Empty();
+}
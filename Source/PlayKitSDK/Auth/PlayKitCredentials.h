@@ -0,0 +1,69 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FPlayerTokenInfo;
+
+/**
+ * In-memory credentials behind every authorized request.
+ *
+ * The tokens are loaded once at module startup: the ini values on the game thread, the
+ * encrypted PlayerToken.dat on a worker thread. They are then published as an immutable
+ * snapshot that any thread reads with a single atomic load, so creating a request costs
+ * no ini lookup, file read or decryption. The setters store the token as before and
+ * publish a new snapshot.
+ *
+ * The saved player token is refreshed in the background RefreshLeadHours before its
+ * ExpiresAt, by exchanging the JWT it came from again (SetRefreshJwt) or with a custom
+ * refresher (SetRefresher). A failed refresh is retried with backoff while requests keep
+ * using the current token.
+ */
+class PLAYKITSDK_API FPlayKitCredentials
+{
+public:
+	/** Completion of a refresh; call on the game thread */
+	using FRefreshComplete = TUniqueFunction<void(bool bSucceeded, const FPlayerTokenInfo& NewToken)>;
+
+	/** Obtains a new player token, asynchronously */
+	using FRefresher = TFunction<void(FRefreshComplete&& OnComplete)>;
+
+	/** Hours before ExpiresAt a refresh starts; ahead of the 6 hours GetSavedToken treats as expired by default */
+	static constexpr int32 RefreshLeadHours = 7;
+
+	/** Token to authorize requests with: the developer token unless ignored, else the player token. Any thread. */
+	static FString GetAuthToken();
+
+	/** Token stores of UPlayKitSettings. Any thread. */
+	static FString GetDeveloperToken();
+	static FString GetPlayerToken();
+
+	/**
+	 * The saved player token, if it is valid for at least HoursEarly more hours.
+	 * Waits for the startup load if that is still running.
+	 */
+	static bool GetSavedToken(FPlayerTokenInfo& OutToken, int32 HoursEarly = 6);
+
+	/** Publish a token UPlayKitSettings has just stored */
+	static void SetDeveloperToken(const FString& Token);
+	static void SetPlayerToken(const FString& Token);
+
+	/** Publish a new saved player token, write it to PlayerToken.dat on a worker thread and schedule its refresh */
+	static void SetSavedToken(const FPlayerTokenInfo& Token);
+
+	/** JWT to exchange again for a fresh player token. Kept in memory only. Game thread. */
+	static void SetRefreshJwt(const FString& Jwt);
+
+	/** Replace the JWT exchange as the way the saved token is refreshed. Game thread. */
+	static void SetRefresher(FRefresher InRefresher);
+
+	/** Path of the encrypted player token file */
+	static FString GetSavedTokenPath();
+
+	/** Load the tokens and start reading the token file. Called at module startup. */
+	static void Startup();
+
+	/** Stop refreshing and release the snapshots */
+	static void Shutdown();
+};
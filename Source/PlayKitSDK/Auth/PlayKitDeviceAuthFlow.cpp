@@ -1,7 +1,7 @@
 // Copyright PlayKit. All Rights Reserved.
 
 #include "PlayKitDeviceAuthFlow.h"
-#include "HttpModule.h"
+#include "Net/PlayKitTransport.h"
 #include "Interfaces/IHttpResponse.h"
 #include "Dom/JsonObject.h"
 #include "Serialization/JsonSerializer.h"
@@ -165,7 +165,7 @@ void UPlayKitDeviceAuthFlow::RequestDeviceCode()
 {
 	const FString Url = BaseUrl / TEXT("api/auth/device/code");
 
-	CurrentHttpRequest = FHttpModule::Get().CreateRequest();
+	CurrentHttpRequest = FPlayKitTransport::Get().CreateRequest(Url);
 	CurrentHttpRequest->SetURL(Url);
 	CurrentHttpRequest->SetVerb(TEXT("POST"));
 	CurrentHttpRequest->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
@@ -295,7 +295,7 @@ void UPlayKitDeviceAuthFlow::PollForToken()
 
 	const FString Url = BaseUrl / TEXT("api/auth/device/token");
 
-	CurrentHttpRequest = FHttpModule::Get().CreateRequest();
+	CurrentHttpRequest = FPlayKitTransport::Get().CreateRequest(Url);
 	CurrentHttpRequest->SetURL(Url);
 	CurrentHttpRequest->SetVerb(TEXT("POST"));
 	CurrentHttpRequest->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
@@ -403,7 +403,7 @@ void UPlayKitDeviceAuthFlow::ExchangeForPlayerToken(const FString& InAccessToken
 {
 	const FString Url = BaseUrl / TEXT("api/external/exchange-jwt");
 
-	CurrentHttpRequest = FHttpModule::Get().CreateRequest();
+	CurrentHttpRequest = FPlayKitTransport::Get().CreateRequest(Url);
 	CurrentHttpRequest->SetURL(Url);
 	CurrentHttpRequest->SetVerb(TEXT("POST"));
 	CurrentHttpRequest->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
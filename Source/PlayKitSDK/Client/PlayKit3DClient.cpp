@@ -1,8 +1,11 @@
 // Copyright PlayKit. All Rights Reserved.
 
 #include "PlayKit3DClient.h"
+#include "PlayKitMemory.h"
 #include "PlayKitSettings.h"
-#include "HttpModule.h"
+#include "Net/PlayKitRequestScheduler.h"
+#include "Net/PlayKitJsonWriter.h"
+#include "Net/PlayKitTransport.h"
 #include "Interfaces/IHttpResponse.h"
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
@@ -41,10 +44,12 @@ void UPlayKit3DClient::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	StopPolling();
 	if (CurrentRequest.IsValid())
 	{
-		CurrentRequest->CancelRequest();
+		UPlayKitRequestScheduler::CancelRequest(this, CurrentRequest);
 		CurrentRequest.Reset();
 	}
 
+	NativePromise.Reset();
+
 	Super::EndPlay(EndPlayReason);
 }
 
@@ -98,17 +103,39 @@ void UPlayKit3DClient::Generate3DAdvanced(const FPlayKit3DConfig& Config)
 	CreateTask(Config);
 }
 
+TFuture<FPlayKit3DResponse> UPlayKit3DClient::Generate3DAsync(const FPlayKit3DConfig& Config)
+{
+	FPlayKit3DResponse Failed;
+	Failed.bSuccess = false;
+
+	if (bIsProcessing)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[PlayKit] 3D error [REQUEST_IN_PROGRESS]: A generation task is already in progress"));
+		Failed.ErrorMessage = TEXT("A generation task is already in progress");
+		return TPlayKitPromise<FPlayKit3DResponse>::MakeFulfilled(MoveTemp(Failed));
+	}
+
+	Failed.ErrorMessage = TEXT("Task cancelled");
+	NativePromise = MakeUnique<TPlayKitPromise<FPlayKit3DResponse>>(MoveTemp(Failed));
+	TFuture<FPlayKit3DResponse> Future = NativePromise->GetFuture();
+	Generate3DAdvanced(Config);
+	return Future;
+}
+
 void UPlayKit3DClient::CancelTask()
 {
 	if (CurrentRequest.IsValid())
 	{
-		CurrentRequest->CancelRequest();
+		UPlayKitRequestScheduler::CancelRequest(this, CurrentRequest);
 		CurrentRequest.Reset();
 	}
 
 	StopPolling();
 	CleanupCurrentTask();
 
+	// Completes the future as cancelled
+	NativePromise.Reset();
+
 	UE_LOG(LogTemp, Log, TEXT("[PlayKit] 3D generation task cancelled"));
 }
 
@@ -129,6 +156,7 @@ void UPlayKit3DClient::QueryTaskStatus(const FString& TaskId)
 
 void UPlayKit3DClient::CreateTask(const FPlayKit3DConfig& Config)
 {
+	LLM_SCOPE_BYTAG(PlayKit_Model3D);
 	UPlayKitSettings* Settings = UPlayKitSettings::Get();
 	if (!Settings)
 	{
@@ -145,55 +173,61 @@ void UPlayKit3DClient::CreateTask(const FPlayKit3DConfig& Config)
 
 	bIsProcessing = true;
 
-	// Build request body
-	TSharedPtr<FJsonObject> RequestBody = MakeShared<FJsonObject>();
-	RequestBody->SetStringField(TEXT("model"), ModelName);
-	RequestBody->SetStringField(TEXT("prompt"), Config.Prompt);
+	TArray<uint8> Body;
+	BuildCreateTaskBody(ModelName, Config, Body);
+
+	CurrentRequest = FPlayKitTransport::CreateAuthenticatedRequest(Url);
+	CurrentRequest->SetContent(MoveTemp(Body));
+	CurrentRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKit3DClient::HandleCreateTaskResponse);
+
+	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Creating 3D generation task: %s"), *Url);
+	UPlayKitRequestScheduler::ProcessRequest(this, CurrentRequest.ToSharedRef(), EPlayKitEndpoint::Model3D, EPlayKitRequestPriority::AssetGeneration);
+}
+
+void UPlayKit3DClient::BuildCreateTaskBody(const FString& Model, const FPlayKit3DConfig& Config, TArray<uint8>& OutBody)
+{
+	OutBody.Reset(320 + FPlayKitJsonWriter::EstimateStringSize(Model) + FPlayKitJsonWriter::EstimateStringSize(Config.Prompt)
+		+ FPlayKitJsonWriter::EstimateStringSize(Config.NegativePrompt) + FPlayKitJsonWriter::EstimateStringSize(Config.ModelVersion));
+
+	FPlayKitJsonWriter Writer(OutBody);
+	Writer.BeginObject();
+	Writer.WriteString("model", Model);
+	Writer.WriteString("prompt", Config.Prompt);
 
 	if (!Config.NegativePrompt.IsEmpty())
 	{
-		RequestBody->SetStringField(TEXT("negative_prompt"), Config.NegativePrompt);
+		Writer.WriteString("negative_prompt", Config.NegativePrompt);
 	}
 
 	if (!Config.ModelVersion.IsEmpty())
 	{
-		RequestBody->SetStringField(TEXT("model_version"), Config.ModelVersion);
+		Writer.WriteString("model_version", Config.ModelVersion);
 	}
 
-	RequestBody->SetBoolField(TEXT("texture"), Config.bTexture);
-	RequestBody->SetBoolField(TEXT("pbr"), Config.bPBR);
-	RequestBody->SetStringField(TEXT("texture_quality"), QualityToString(Config.TextureQuality));
-	RequestBody->SetStringField(TEXT("geometry_quality"), QualityToString(Config.GeometryQuality));
+	Writer.WriteBool("texture", Config.bTexture);
+	Writer.WriteBool("pbr", Config.bPBR);
+	Writer.WriteString("texture_quality", QualityToString(Config.TextureQuality));
+	Writer.WriteString("geometry_quality", QualityToString(Config.GeometryQuality));
 
 	if (Config.TextureSeed >= 0)
 	{
-		RequestBody->SetNumberField(TEXT("texture_seed"), Config.TextureSeed);
+		Writer.WriteNumber("texture_seed", Config.TextureSeed);
 	}
 
 	if (Config.FaceLimit > 0)
 	{
-		RequestBody->SetNumberField(TEXT("face_limit"), Config.FaceLimit);
+		Writer.WriteNumber("face_limit", Config.FaceLimit);
 	}
 
-	RequestBody->SetBoolField(TEXT("auto_size"), Config.bAutoSize);
-	RequestBody->SetBoolField(TEXT("quad"), Config.bQuad);
-	RequestBody->SetBoolField(TEXT("smart_low_poly"), Config.bSmartLowPoly);
-
-	// Serialize
-	FString RequestBodyStr;
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&RequestBodyStr);
-	FJsonSerializer::Serialize(RequestBody.ToSharedRef(), Writer);
-
-	CurrentRequest = CreateAuthenticatedRequest(Url);
-	CurrentRequest->SetContentAsString(RequestBodyStr);
-	CurrentRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKit3DClient::HandleCreateTaskResponse);
-
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Creating 3D generation task: %s"), *Url);
-	CurrentRequest->ProcessRequest();
+	Writer.WriteBool("auto_size", Config.bAutoSize);
+	Writer.WriteBool("quad", Config.bQuad);
+	Writer.WriteBool("smart_low_poly", Config.bSmartLowPoly);
+	Writer.EndObject();
 }
 
 void UPlayKit3DClient::HandleCreateTaskResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
 {
+	LLM_SCOPE_BYTAG(PlayKit_Model3D);
 	CurrentRequest.Reset();
 
 	if (!bWasSuccessful || !Response.IsValid())
@@ -299,6 +333,7 @@ void UPlayKit3DClient::OnPollTimer()
 
 void UPlayKit3DClient::PollTaskStatus()
 {
+	LLM_SCOPE_BYTAG(PlayKit_Model3D);
 	if (CurrentTaskId.IsEmpty())
 	{
 		StopPolling();
@@ -307,16 +342,16 @@ void UPlayKit3DClient::PollTaskStatus()
 
 	FString Url = BuildPollUrl(CurrentTaskId);
 
-	CurrentRequest = CreateAuthenticatedRequest(Url);
-	CurrentRequest->SetVerb(TEXT("GET"));  // Override to GET for polling
+	CurrentRequest = FPlayKitTransport::CreateAuthenticatedRequest(Url, TEXT("GET"));
 	CurrentRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKit3DClient::HandlePollResponse);
 
 	UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Polling task status: %s"), *Url);
-	CurrentRequest->ProcessRequest();
+	UPlayKitRequestScheduler::ProcessRequest(this, CurrentRequest.ToSharedRef(), EPlayKitEndpoint::Model3D, EPlayKitRequestPriority::AssetGeneration);
 }
 
 void UPlayKit3DClient::HandlePollResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
 {
+	LLM_SCOPE_BYTAG(PlayKit_Model3D);
 	CurrentRequest.Reset();
 
 	if (!bWasSuccessful || !Response.IsValid())
@@ -462,6 +497,12 @@ void UPlayKit3DClient::HandlePollResponse(FHttpRequestPtr Request, FHttpResponse
 		}
 
 		CleanupCurrentTask();
+		if (NativePromise.IsValid())
+		{
+			TUniquePtr<TPlayKitPromise<FPlayKit3DResponse>> Promise = MoveTemp(NativePromise);
+			Promise->SetValue(MoveTemp(Result));
+			return;
+		}
 		OnCompleted.Broadcast(Result);
 	}
 	else if (CurrentStatus == EPlayKit3DTaskStatus::Failed ||
@@ -489,28 +530,6 @@ void UPlayKit3DClient::HandlePollResponse(FHttpRequestPtr Request, FHttpResponse
 
 //========== Utility Methods ==========//
 
-TSharedRef<IHttpRequest, ESPMode::ThreadSafe> UPlayKit3DClient::CreateAuthenticatedRequest(const FString& Url)
-{
-	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
-	Request->SetURL(Url);
-	Request->SetVerb(TEXT("POST"));
-	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
-
-	UPlayKitSettings* Settings = UPlayKitSettings::Get();
-	if (Settings)
-	{
-		FString Token = Settings->HasDeveloperToken() && !Settings->bIgnoreDeveloperToken
-			? Settings->GetDeveloperToken()
-			: Settings->GetPlayerToken();
-		if (!Token.IsEmpty())
-		{
-			Request->SetHeader(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *Token));
-		}
-	}
-
-	return Request;
-}
-
 FString UPlayKit3DClient::BuildCreateUrl() const
 {
 	UPlayKitSettings* Settings = UPlayKitSettings::Get();
@@ -543,7 +562,7 @@ EPlayKit3DTaskStatus UPlayKit3DClient::ParseStatus(const FString& StatusString)
 	return EPlayKit3DTaskStatus::Unknown;
 }
 
-FString UPlayKit3DClient::QualityToString(EPlayKit3DQuality Quality) const
+FString UPlayKit3DClient::QualityToString(EPlayKit3DQuality Quality)
 {
 	return Quality == EPlayKit3DQuality::Detailed ? TEXT("detailed") : TEXT("standard");
 }
@@ -551,6 +570,17 @@ FString UPlayKit3DClient::QualityToString(EPlayKit3DQuality Quality) const
 void UPlayKit3DClient::BroadcastError(const FString& ErrorCode, const FString& ErrorMessage)
 {
 	UE_LOG(LogTemp, Error, TEXT("[PlayKit] 3D error [%s]: %s"), *ErrorCode, *ErrorMessage);
+
+	if (NativePromise.IsValid())
+	{
+		TUniquePtr<TPlayKitPromise<FPlayKit3DResponse>> Promise = MoveTemp(NativePromise);
+		FPlayKit3DResponse Failed;
+		Failed.bSuccess = false;
+		Failed.ErrorMessage = ErrorMessage;
+		Promise->SetValue(MoveTemp(Failed));
+		return;
+	}
+
 	OnError.Broadcast(ErrorCode, ErrorMessage);
 }
 
@@ -5,7 +5,9 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Interfaces/IHttpRequest.h"
+#include "Async/Future.h"
 #include "PlayKitTypes.h"
+#include "Net/PlayKitPromise.h"
 #include "PlayKit3DClient.generated.h"
 
 /**
@@ -138,6 +140,13 @@ public:
 	UFUNCTION(BlueprintCallable, Category="PlayKit|3D", meta=(DisplayName="Generate 3D Model (Advanced)"))
 	void Generate3DAdvanced(const FPlayKit3DConfig& Config);
 
+	/**
+	 * C++ alternative to Generate3DAdvanced: the finished task completes the returned future
+	 * instead of OnCompleted and OnError. OnProgress and OnStatusChanged still fire. The future
+	 * completes on the game thread; on failure or cancellation bSuccess is false.
+	 */
+	TFuture<FPlayKit3DResponse> Generate3DAsync(const FPlayKit3DConfig& Config);
+
 	/**
 	 * Cancel the current generation task and stop polling.
 	 */
@@ -152,6 +161,9 @@ public:
 	UFUNCTION(BlueprintCallable, Category="PlayKit|3D")
 	void QueryTaskStatus(const FString& TaskId);
 
+	/** Write the task creation request body as UTF-8 JSON into OutBody */
+	static void BuildCreateTaskBody(const FString& Model, const FPlayKit3DConfig& Config, TArray<uint8>& OutBody);
+
 private:
 	// HTTP request management
 	void CreateTask(const FPlayKit3DConfig& Config);
@@ -165,11 +177,10 @@ private:
 	void OnPollTimer();
 
 	// Parsing and utilities
-	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> CreateAuthenticatedRequest(const FString& Url);
 	FString BuildCreateUrl() const;
 	FString BuildPollUrl(const FString& TaskId) const;
 	EPlayKit3DTaskStatus ParseStatus(const FString& StatusString) const;
-	FString QualityToString(EPlayKit3DQuality Quality) const;
+	static FString QualityToString(EPlayKit3DQuality Quality);
 	void BroadcastError(const FString& ErrorCode, const FString& ErrorMessage);
 	void CleanupCurrentTask();
 
@@ -183,6 +194,9 @@ private:
 	// HTTP
 	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> CurrentRequest;
 
+	// Completion of a task started by Generate3DAsync; OnCompleted and OnError are not broadcast while set
+	TUniquePtr<TPlayKitPromise<FPlayKit3DResponse>> NativePromise;
+
 	// Polling timer
 	FTimerHandle PollTimerHandle;
 	int32 PollIntervalSeconds = 5;
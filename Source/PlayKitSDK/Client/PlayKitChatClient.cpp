@@ -2,12 +2,279 @@
 
 #include "PlayKitChatClient.h"
 #include "PlayKitSettings.h"
-#include "HttpModule.h"
+#include "PlayKitMemory.h"
+#include "Net/PlayKitSSEDecoder.h"
+#include "Net/PlayKitJsonWriter.h"
+#include "Net/PlayKitJsonReader.h"
+#include "Net/PlayKitJsonStreamParser.h"
+#include "Net/PlayKitResponseCache.h"
+#include "Net/PlayKitRequestTrace.h"
+#include "Net/PlayKitGameThreadQueue.h"
+#include "Net/PlayKitPromise.h"
+#include "Net/PlayKitTransport.h"
 #include "Interfaces/IHttpResponse.h"
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
 #include "Dom/JsonObject.h"
 
+enum class EPlayKitChatRequestKind : uint8
+{
+	Text,
+	Stream,
+	Structured,
+	StructuredStream
+};
+
+namespace PlayKitChat
+{
+	static FPlayKitChatResponse MakeFailedResponse(const FString& ErrorMessage, int32 RequestId = INDEX_NONE)
+	{
+		FPlayKitChatResponse Response;
+		Response.bSuccess = false;
+		Response.ErrorMessage = ErrorMessage;
+		Response.RequestId = RequestId;
+		return Response;
+	}
+}
+
+/** Completion of a request made through the native API; replaces the Blueprint events */
+struct FPlayKitChatNativeCompletion
+{
+	TPlayKitPromise<FPlayKitChatResponse> Promise { PlayKitChat::MakeFailedResponse(TEXT("Request cancelled")) };
+	TFunction<void(FStringView)> OnDelta;
+	TFunction<void(const FPlayKitJsonStreamValue&)> OnStructuredValue;
+};
+
+/** State of one in-flight chat request */
+struct FPlayKitChatRequestState
+{
+	int32 Id = INDEX_NONE;
+	EPlayKitChatRequestKind Kind = EPlayKitChatRequestKind::Text;
+	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> HttpRequest;
+
+	// Kept until the request is sent (after a cache miss)
+	FString Url;
+	TArray<uint8> Body;
+
+	/** Response cache key, empty when the request is not cacheable */
+	FString CacheKey;
+
+	// Streaming only
+	FPlayKitSSEDecoder Decoder;
+	FString AccumulatedContent;
+
+	/** Deltas not broadcast yet (EPlayKitChunkDelivery::PerFrame) */
+	FString PendingChunk;
+
+	/** Streamed structured output: fed on the thread that decodes the stream */
+	FPlayKitJsonStreamParser StructuredParser;
+
+	/** Set for requests made through the native API */
+	TUniquePtr<FPlayKitChatNativeCompletion> Native;
+
+	/** Set when the request is cancelled from inside one of its own events */
+	bool bCancelled = false;
+};
+
+/**
+ * A finished response, decoded on whichever thread the request completed on.
+ * An empty ErrorCode means success.
+ */
+struct FPlayKitChatOutcome
+{
+	FString ErrorCode;
+	FString ErrorMessage;
+
+	/** Text requests: the parsed completion */
+	FPlayKitChatResponse Response;
+
+	/** Structured requests: the result object, or the error payload */
+	FString StructuredJson;
+	bool bCacheable = false;
+
+	/** Stream requests: deltas decoded from the bytes after the last progress tick */
+	TArray<FString> Deltas;
+
+	/** Streamed structured requests: values completed by Deltas */
+	TArray<FPlayKitJsonStreamValue> StructuredValues;
+};
+
+/**
+ * Decoding steps shared by the game thread and off-thread handlers.
+ * They read only the response and the stream decoder and fire no events.
+ */
+namespace PlayKitChat
+{
+	static void DecodeChatResponse(const FHttpRequestPtr& Request, const FHttpResponsePtr& Response, bool bWasSuccessful, FPlayKitChatOutcome& Out)
+	{
+		LLM_SCOPE_BYTAG(PlayKit_Chat);
+		if (!bWasSuccessful && FPlayKitRequestTrace::HasTimedOut(Request.Get()))
+		{
+			UE_LOG(LogTemp, Error, TEXT("[PlayKit] Chat request timed out"));
+			Out.ErrorCode = TEXT("TIMEOUT");
+			Out.ErrorMessage = TEXT("No reply within the request's deadline");
+			return;
+		}
+
+		if (!bWasSuccessful || !Response.IsValid())
+		{
+			UE_LOG(LogTemp, Error, TEXT("[PlayKit] Response invalid or unsuccessful"));
+			Out.ErrorCode = TEXT("NETWORK_ERROR");
+			Out.ErrorMessage = TEXT("Network request failed");
+			return;
+		}
+
+		int32 ResponseCode = Response->GetResponseCode();
+		const FUtf8StringView ResponseBody = FPlayKitJsonReader::ToView(Response->GetContent());
+
+		UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Response code: %d, Content length: %d"), ResponseCode, ResponseBody.Len());
+		UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Response: %s"), *FPlayKitSSEDecoder::ToString(ResponseBody.Left(500)));
+
+		if (ResponseCode < 200 || ResponseCode >= 300)
+		{
+			Out.ErrorMessage = FPlayKitSSEDecoder::ToString(ResponseBody);
+			UE_LOG(LogTemp, Error, TEXT("[PlayKit] Chat error %d: %s"), ResponseCode, *Out.ErrorMessage);
+			Out.ErrorCode = FString::FromInt(ResponseCode);
+			return;
+		}
+
+		{
+			SCOPE_CYCLE_COUNTER(STAT_PlayKitResponseParse);
+			Out.Response = UPlayKitChatClient::ParseChatResponse(ResponseBody);
+		}
+		FPlayKitRequestTrace::SetUsage(Request.Get(), Out.Response.PromptTokens, Out.Response.CompletionTokens);
+		UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Parsed response - Success: %d, Content: %s"), Out.Response.bSuccess, *Out.Response.Content.Left(200));
+	}
+
+	/** Decode the events received since the last call into text deltas */
+	static void DecodeStreamDeltas(FPlayKitChatRequestState& State, const FHttpResponsePtr& Response, TArray<FString>& OutDeltas)
+	{
+		LLM_SCOPE_BYTAG(PlayKit_Chat);
+		SCOPE_CYCLE_COUNTER(STAT_PlayKitStreamDecode);
+		State.Decoder.ConsumeResponse(Response, [&State, &OutDeltas](FUtf8StringView Data)
+		{
+			FString Delta;
+			if (FPlayKitSSEDecoder::TryGetTextDelta(Data, Delta))
+			{
+				FPlayKitRequestTrace::MarkToken(State.HttpRequest.Get());
+				OutDeltas.Add(MoveTemp(Delta));
+			}
+		});
+	}
+
+	/** Decode bytes that arrived after the last progress tick, then any unterminated event */
+	static void DecodeStreamTail(FPlayKitChatRequestState& State, const FHttpResponsePtr& Response, bool bWasSuccessful, FPlayKitChatOutcome& Out)
+	{
+		LLM_SCOPE_BYTAG(PlayKit_Chat);
+		if (!bWasSuccessful && FPlayKitRequestTrace::HasTimedOut(State.HttpRequest.Get()))
+		{
+			UE_LOG(LogTemp, Error, TEXT("[PlayKit] Stream stalled or ran past its deadline"));
+			Out.ErrorCode = TEXT("TIMEOUT");
+			Out.ErrorMessage = TEXT("Stream timed out");
+			return;
+		}
+
+		if (!bWasSuccessful)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[PlayKit] Stream request failed"));
+			Out.ErrorCode = TEXT("NETWORK_ERROR");
+			Out.ErrorMessage = TEXT("Stream request failed");
+			return;
+		}
+
+		if (!Response.IsValid())
+		{
+			return;
+		}
+
+		int32 ResponseCode = Response->GetResponseCode();
+		UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Stream complete - Response code: %d"), ResponseCode);
+		if (ResponseCode < 200 || ResponseCode >= 300)
+		{
+			Out.ErrorMessage = Response->GetContentAsString();
+			UE_LOG(LogTemp, Error, TEXT("[PlayKit] Stream error: %s"), *Out.ErrorMessage);
+			Out.ErrorCode = FString::FromInt(ResponseCode);
+			return;
+		}
+
+		DecodeStreamDeltas(State, Response, Out.Deltas);
+		State.Decoder.Flush([&State, &Out](FUtf8StringView Data)
+		{
+			FString Delta;
+			if (FPlayKitSSEDecoder::TryGetTextDelta(Data, Delta))
+			{
+				FPlayKitRequestTrace::MarkToken(State.HttpRequest.Get());
+				Out.Deltas.Add(MoveTemp(Delta));
+			}
+		});
+	}
+
+	/** Feed streamed structured output to the request's parser; a no-op for other requests */
+	static void ParseStructuredDeltas(FPlayKitChatRequestState& State, TConstArrayView<FString> Deltas, TArray<FPlayKitJsonStreamValue>& OutValues)
+	{
+		if (State.Kind != EPlayKitChatRequestKind::StructuredStream)
+		{
+			return;
+		}
+
+		SCOPE_CYCLE_COUNTER(STAT_PlayKitResponseParse);
+		for (const FString& Delta : Deltas)
+		{
+			State.StructuredParser.Feed(Delta, OutValues);
+		}
+	}
+
+	/** Error payload of a structured request: server errors are JSON already */
+	static FString MakeStructuredErrorJson(const FString& ErrorMessage)
+	{
+		if (ErrorMessage.TrimStart().StartsWith(TEXT("{")))
+		{
+			return ErrorMessage;
+		}
+		return FString::Printf(TEXT("{\"error\": \"%s\"}"), *ErrorMessage.ReplaceCharWithEscapedChar());
+	}
+
+	static void DecodeStructuredResponse(const FHttpResponsePtr& Response, bool bWasSuccessful, FPlayKitChatOutcome& Out)
+	{
+		LLM_SCOPE_BYTAG(PlayKit_Chat);
+		if (!bWasSuccessful || !Response.IsValid())
+		{
+			Out.ErrorCode = TEXT("NETWORK_ERROR");
+			Out.StructuredJson = TEXT("{\"error\": \"Network request failed\"}");
+			return;
+		}
+
+		int32 ResponseCode = Response->GetResponseCode();
+		FString ResponseContent = Response->GetContentAsString();
+
+		if (ResponseCode < 200 || ResponseCode >= 300)
+		{
+			Out.ErrorCode = FString::FromInt(ResponseCode);
+			Out.StructuredJson = MoveTemp(ResponseContent);
+			return;
+		}
+
+		SCOPE_CYCLE_COUNTER(STAT_PlayKitResponseParse);
+
+		// Parse response to extract the object
+		TSharedPtr<FJsonObject> JsonObject;
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ResponseContent);
+		if (FJsonSerializer::Deserialize(Reader, JsonObject) && JsonObject.IsValid())
+		{
+			const TSharedPtr<FJsonObject>* ObjectResultPtr;
+			if (JsonObject->TryGetObjectField(TEXT("object"), ObjectResultPtr) && ObjectResultPtr)
+			{
+				TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Out.StructuredJson);
+				FJsonSerializer::Serialize((*ObjectResultPtr).ToSharedRef(), Writer);
+				Out.bCacheable = true;
+				return;
+			}
+		}
+
+		Out.StructuredJson = MoveTemp(ResponseContent);
+	}
+}
+
 UPlayKitChatClient::UPlayKitChatClient()
 {
 	PrimaryComponentTick.bCanEverTick = false;
@@ -50,29 +317,7 @@ FString UPlayKitChatClient::BuildRequestUrl() const
 	return FString::Printf(TEXT("%s/ai/%s/v2/chat"), *Settings->GetBaseUrl(), *Settings->GameId);
 }
 
-TSharedRef<IHttpRequest, ESPMode::ThreadSafe> UPlayKitChatClient::CreateAuthenticatedRequest(const FString& Url)
-{
-	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
-	Request->SetURL(Url);
-	Request->SetVerb(TEXT("POST"));
-	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
-
-	UPlayKitSettings* Settings = UPlayKitSettings::Get();
-	if (Settings)
-	{
-		FString Token = Settings->HasDeveloperToken() && !Settings->bIgnoreDeveloperToken
-			? Settings->GetDeveloperToken()
-			: Settings->GetPlayerToken();
-		if (!Token.IsEmpty())
-		{
-			Request->SetHeader(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *Token));
-		}
-	}
-
-	return Request;
-}
-
-void UPlayKitChatClient::GenerateText(const FString& Prompt)
+FPlayKitChatConfig UPlayKitChatClient::MakePromptConfig(const FString& Prompt) const
 {
 	FPlayKitChatConfig Config;
 
@@ -85,455 +330,957 @@ void UPlayKitChatClient::GenerateText(const FString& Prompt)
 	Config.Messages.Add(FPlayKitChatMessage(TEXT("user"), Prompt));
 	Config.Temperature = Temperature;
 	Config.MaxTokens = MaxTokens;
+	return Config;
+}
 
-	GenerateTextAdvanced(Config);
+int32 UPlayKitChatClient::GenerateText(const FString& Prompt)
+{
+	return GenerateTextAdvanced(MakePromptConfig(Prompt));
 }
 
-void UPlayKitChatClient::GenerateTextAdvanced(const FPlayKitChatConfig& Config)
+int32 UPlayKitChatClient::GenerateTextAdvanced(const FPlayKitChatConfig& Config)
 {
-	SendChatRequest(Config, false);
+	return SendChatRequest(Config, false);
 }
 
-void UPlayKitChatClient::GenerateTextStream(const FString& Prompt)
+int32 UPlayKitChatClient::GenerateTextStream(const FString& Prompt)
 {
-	FPlayKitChatConfig Config;
+	return GenerateTextStreamAdvanced(MakePromptConfig(Prompt));
+}
 
-	// Add system prompt if configured
-	if (!SystemPrompt.IsEmpty())
+int32 UPlayKitChatClient::GenerateTextStreamAdvanced(const FPlayKitChatConfig& Config)
+{
+	return SendChatRequest(Config, true);
+}
+
+//========== Native C++ API ==========//
+
+TFuture<FPlayKitChatResponse> UPlayKitChatClient::GenerateTextAsync(const FString& Prompt, int32* OutRequestId)
+{
+	return GenerateTextAdvancedAsync(MakePromptConfig(Prompt), OutRequestId);
+}
+
+TFuture<FPlayKitChatResponse> UPlayKitChatClient::GenerateTextAdvancedAsync(const FPlayKitChatConfig& Config, int32* OutRequestId)
+{
+	TUniquePtr<FPlayKitChatNativeCompletion> Native = MakeUnique<FPlayKitChatNativeCompletion>();
+	TFuture<FPlayKitChatResponse> Future = Native->Promise.GetFuture();
+	const int32 RequestId = SendChatRequest(Config, false, MoveTemp(Native));
+	if (OutRequestId)
 	{
-		Config.Messages.Add(FPlayKitChatMessage(TEXT("system"), SystemPrompt));
+		*OutRequestId = RequestId;
 	}
+	return Future;
+}
 
-	Config.Messages.Add(FPlayKitChatMessage(TEXT("user"), Prompt));
-	Config.Temperature = Temperature;
-	Config.MaxTokens = MaxTokens;
+TFuture<FPlayKitChatResponse> UPlayKitChatClient::GenerateTextStreamAsync(const FString& Prompt, TFunction<void(FStringView)> OnDelta, int32* OutRequestId)
+{
+	return GenerateTextStreamAdvancedAsync(MakePromptConfig(Prompt), MoveTemp(OnDelta), OutRequestId);
+}
 
-	GenerateTextStreamAdvanced(Config);
+TFuture<FPlayKitChatResponse> UPlayKitChatClient::GenerateTextStreamAdvancedAsync(const FPlayKitChatConfig& Config, TFunction<void(FStringView)> OnDelta,
+	int32* OutRequestId)
+{
+	TUniquePtr<FPlayKitChatNativeCompletion> Native = MakeUnique<FPlayKitChatNativeCompletion>();
+	Native->OnDelta = MoveTemp(OnDelta);
+	TFuture<FPlayKitChatResponse> Future = Native->Promise.GetFuture();
+	const int32 RequestId = SendChatRequest(Config, true, MoveTemp(Native));
+	if (OutRequestId)
+	{
+		*OutRequestId = RequestId;
+	}
+	return Future;
+}
+
+TFuture<FPlayKitChatResponse> UPlayKitChatClient::GenerateStructuredAsync(const FString& Prompt, const FString& SchemaJson, int32* OutRequestId)
+{
+	TUniquePtr<FPlayKitChatNativeCompletion> Native = MakeUnique<FPlayKitChatNativeCompletion>();
+	TFuture<FPlayKitChatResponse> Future = Native->Promise.GetFuture();
+	const int32 RequestId = StartStructured(Prompt, SchemaJson, MoveTemp(Native));
+	if (OutRequestId)
+	{
+		*OutRequestId = RequestId;
+	}
+	return Future;
+}
+
+TFuture<FPlayKitChatResponse> UPlayKitChatClient::GenerateStructuredStreamAsync(const FString& Prompt, const FString& SchemaJson,
+	TFunction<void(const FPlayKitJsonStreamValue&)> OnValue, int32* OutRequestId)
+{
+	TUniquePtr<FPlayKitChatNativeCompletion> Native = MakeUnique<FPlayKitChatNativeCompletion>();
+	Native->OnStructuredValue = MoveTemp(OnValue);
+	TFuture<FPlayKitChatResponse> Future = Native->Promise.GetFuture();
+	const int32 RequestId = StartStructured(Prompt, SchemaJson, MoveTemp(Native), true);
+	if (OutRequestId)
+	{
+		*OutRequestId = RequestId;
+	}
+	return Future;
+}
+
+bool UPlayKitChatClient::CanStartRequest() const
+{
+	return MaxConcurrentRequests <= 0 || ActiveRequests.Num() < MaxConcurrentRequests;
 }
 
-void UPlayKitChatClient::GenerateTextStreamAdvanced(const FPlayKitChatConfig& Config)
+int32 UPlayKitChatClient::StartRequest(const TSharedRef<FPlayKitChatRequestState>& State)
 {
-	SendChatRequest(Config, true);
+	LLM_SCOPE_BYTAG(PlayKit_Chat);
+	State->Id = NextRequestId++;
+	ActiveRequests.Add(State->Id, State);
+
+	UPlayKitResponseCache* Cache = State->CacheKey.IsEmpty() ? nullptr : UPlayKitResponseCache::Get(this);
+	if (Cache)
+	{
+		Cache->Lookup(State->CacheKey, [WeakThis = TWeakObjectPtr<UPlayKitChatClient>(this), RequestId = State->Id](const FString* CachedValue)
+		{
+			if (UPlayKitChatClient* This = WeakThis.Get())
+			{
+				This->HandleCacheLookup(RequestId, CachedValue);
+			}
+		});
+	}
+	else
+	{
+		SendHttpRequest(State);
+	}
+
+	return State->Id;
+}
+
+void UPlayKitChatClient::SendHttpRequest(const TSharedPtr<FPlayKitChatRequestState>& State)
+{
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> HttpRequest = FPlayKitTransport::CreateAuthenticatedRequest(State->Url);
+	HttpRequest->SetContent(MoveTemp(State->Body));
+	State->HttpRequest = HttpRequest;
+
+	if (DecodeThread != EPlayKitDecodeThread::GameThread)
+	{
+		BindOffThreadHandlers(HttpRequest, State);
+	}
+	else
+	{
+		switch (State->Kind)
+		{
+		case EPlayKitChatRequestKind::Stream:
+		case EPlayKitChatRequestKind::StructuredStream:
+			UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Using STREAMING mode"));
+			HttpRequest->OnRequestProgress64().BindUObject(this, &UPlayKitChatClient::HandleStreamProgress, State->Id);
+			HttpRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKitChatClient::HandleStreamComplete, State->Id);
+			break;
+		case EPlayKitChatRequestKind::Structured:
+			HttpRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKitChatClient::HandleStructuredResponse, State->Id);
+			break;
+		default:
+			UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Using NON-STREAMING mode"));
+			HttpRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKitChatClient::HandleChatResponse, State->Id);
+			break;
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Sending chat request %d to: %s"), State->Id, *State->Url);
+	UPlayKitRequestScheduler::ProcessRequest(this, HttpRequest, EPlayKitEndpoint::Chat, RequestPriority, true, DecodeThread);
+}
+
+void UPlayKitChatClient::BindOffThreadHandlers(const TSharedRef<IHttpRequest, ESPMode::ThreadSafe>& HttpRequest,
+	const TSharedPtr<FPlayKitChatRequestState>& State)
+{
+	// The handlers run on the HTTP thread or a worker. They only touch the stream decoder,
+	// which nothing else uses in this mode, and hand finished results to the game thread.
+	// The state is held weakly: the HTTP request is owned by it.
+	TWeakObjectPtr<UPlayKitChatClient> WeakThis(this);
+	TWeakPtr<FPlayKitChatRequestState> WeakState(State);
+	const int32 RequestId = State->Id;
+
+	switch (State->Kind)
+	{
+	case EPlayKitChatRequestKind::Stream:
+	case EPlayKitChatRequestKind::StructuredStream:
+		HttpRequest->OnRequestProgress64().BindLambda([WeakThis, WeakState, RequestId](FHttpRequestPtr Request, uint64, uint64)
+		{
+			TSharedPtr<FPlayKitChatRequestState> PinnedState = WeakState.Pin();
+			if (!PinnedState.IsValid() || !Request.IsValid())
+			{
+				return;
+			}
+
+			TArray<FString> Deltas;
+			PlayKitChat::DecodeStreamDeltas(*PinnedState, Request->GetResponse(), Deltas);
+			if (Deltas.Num() > 0)
+			{
+				TArray<FPlayKitJsonStreamValue> Values;
+				PlayKitChat::ParseStructuredDeltas(*PinnedState, Deltas, Values);
+				FPlayKitGameThreadQueue::Enqueue([WeakThis, RequestId, Deltas = MoveTemp(Deltas), Values = MoveTemp(Values)]()
+				{
+					UPlayKitChatClient* This = WeakThis.Get();
+					TSharedPtr<FPlayKitChatRequestState> State = This ? This->ActiveRequests.FindRef(RequestId) : nullptr;
+					if (!State.IsValid())
+					{
+						return;
+					}
+
+					if (State->Kind == EPlayKitChatRequestKind::StructuredStream)
+					{
+						This->ApplyStructuredValues(*State, Deltas, Values);
+					}
+					else
+					{
+						This->ApplyStreamDeltas(*State, Deltas);
+					}
+				});
+			}
+		});
+		HttpRequest->OnProcessRequestComplete().BindLambda([WeakThis, WeakState, RequestId](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			TSharedPtr<FPlayKitChatRequestState> PinnedState = WeakState.Pin();
+			if (!PinnedState.IsValid())
+			{
+				return;
+			}
+
+			FPlayKitChatOutcome Outcome;
+			PlayKitChat::DecodeStreamTail(*PinnedState, Response, bWasSuccessful, Outcome);
+			PlayKitChat::ParseStructuredDeltas(*PinnedState, Outcome.Deltas, Outcome.StructuredValues);
+			FPlayKitGameThreadQueue::Enqueue([WeakThis, RequestId, Outcome = MoveTemp(Outcome)]() mutable
+			{
+				if (UPlayKitChatClient* This = WeakThis.Get())
+				{
+					This->FinishStream(RequestId, Outcome);
+				}
+			});
+		});
+		break;
+	case EPlayKitChatRequestKind::Structured:
+		HttpRequest->OnProcessRequestComplete().BindLambda([WeakThis, RequestId](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			FPlayKitChatOutcome Outcome;
+			PlayKitChat::DecodeStructuredResponse(Response, bWasSuccessful, Outcome);
+			FPlayKitGameThreadQueue::Enqueue([WeakThis, RequestId, Outcome = MoveTemp(Outcome)]() mutable
+			{
+				if (UPlayKitChatClient* This = WeakThis.Get())
+				{
+					This->FinishStructured(RequestId, Outcome);
+				}
+			});
+		});
+		break;
+	default:
+		HttpRequest->OnProcessRequestComplete().BindLambda([WeakThis, RequestId](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			FPlayKitChatOutcome Outcome;
+			PlayKitChat::DecodeChatResponse(Request, Response, bWasSuccessful, Outcome);
+			FPlayKitGameThreadQueue::Enqueue([WeakThis, RequestId, Outcome = MoveTemp(Outcome)]() mutable
+			{
+				if (UPlayKitChatClient* This = WeakThis.Get())
+				{
+					This->FinishChatResponse(RequestId, Outcome);
+				}
+			});
+		});
+		break;
+	}
+}
+
+void UPlayKitChatClient::HandleCacheLookup(int32 RequestId, const FString* CachedValue)
+{
+	LLM_SCOPE_BYTAG(PlayKit_Chat);
+	// Cancelled while the lookup was pending
+	TSharedPtr<FPlayKitChatRequestState> State = ActiveRequests.FindRef(RequestId);
+	if (!State.IsValid())
+	{
+		return;
+	}
+
+	if (!CachedValue)
+	{
+		SendHttpRequest(State);
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Request %d served from response cache"), RequestId);
+	ActiveRequests.Remove(RequestId);
+
+	if (State->Native.IsValid())
+	{
+		if (State->Kind == EPlayKitChatRequestKind::Stream && State->Native->OnDelta)
+		{
+			State->Native->OnDelta(*CachedValue);
+		}
+		else if (State->Kind == EPlayKitChatRequestKind::StructuredStream && State->Native->OnStructuredValue)
+		{
+			State->StructuredParser.Feed(*CachedValue, [&State](const FPlayKitJsonStreamValue& Value)
+			{
+				State->Native->OnStructuredValue(Value);
+			});
+		}
+
+		FPlayKitChatResponse ChatResponse;
+		ChatResponse.bSuccess = true;
+		ChatResponse.Content = *CachedValue;
+		ChatResponse.FinishReason = TEXT("stop");
+		ChatResponse.RequestId = RequestId;
+		State->Native->Promise.SetValue(MoveTemp(ChatResponse));
+		return;
+	}
+
+	switch (State->Kind)
+	{
+	case EPlayKitChatRequestKind::Stream:
+		// Drive the same events as a live stream, so streaming Blueprint logic keeps working
+		State->AccumulatedContent = *CachedValue;
+		OnStreamChunk.Broadcast(State->AccumulatedContent);
+		OnRequestStreamChunk.Broadcast(RequestId, State->AccumulatedContent);
+		OnStreamComplete.Broadcast(State->AccumulatedContent);
+		OnRequestStreamComplete.Broadcast(RequestId, State->AccumulatedContent);
+		break;
+	case EPlayKitChatRequestKind::Structured:
+		BroadcastStructured(RequestId, true, *CachedValue);
+		break;
+	case EPlayKitChatRequestKind::StructuredStream:
+		// Field events first, as if the cached object were being generated
+		State->StructuredParser.Feed(*CachedValue, [this, RequestId](const FPlayKitJsonStreamValue& Value)
+		{
+			OnStructuredField.Broadcast(RequestId, Value.Path, Value.Json);
+		});
+		BroadcastStructured(RequestId, true, *CachedValue);
+		break;
+	default:
+		{
+			FPlayKitChatResponse ChatResponse;
+			ChatResponse.bSuccess = true;
+			ChatResponse.Content = *CachedValue;
+			ChatResponse.FinishReason = TEXT("stop");
+			ChatResponse.RequestId = RequestId;
+			OnChatResponse.Broadcast(ChatResponse);
+			OnRequestResponse.Broadcast(RequestId, ChatResponse);
+		}
+		break;
+	}
 }
 
-void UPlayKitChatClient::SendChatRequest(const FPlayKitChatConfig& Config, bool bStream)
+void UPlayKitChatClient::StoreInCache(const FPlayKitChatRequestState& State, const FString& Value)
 {
-	if (bIsProcessing)
+	if (State.CacheKey.IsEmpty() || Value.IsEmpty())
 	{
-		BroadcastError(TEXT("REQUEST_IN_PROGRESS"), TEXT("A request is already in progress"));
 		return;
 	}
 
+	if (UPlayKitResponseCache* Cache = UPlayKitResponseCache::Get(this))
+	{
+		Cache->Store(State.CacheKey, Value);
+	}
+}
+
+int32 UPlayKitChatClient::SendChatRequest(const FPlayKitChatConfig& Config, bool bStream, TUniquePtr<FPlayKitChatNativeCompletion> Native)
+{
+	if (!CanStartRequest())
+	{
+		RejectRequest(Native.Get(), TEXT("TOO_MANY_REQUESTS"), FString::Printf(TEXT("At most %d requests may be in flight"), MaxConcurrentRequests));
+		return INDEX_NONE;
+	}
+
 	FString Url = BuildRequestUrl();
 	if (Url.IsEmpty())
 	{
-		BroadcastError(TEXT("CONFIG_ERROR"), TEXT("Failed to build request URL"));
-		return;
+		RejectRequest(Native.Get(), TEXT("CONFIG_ERROR"), TEXT("Failed to build request URL"));
+		return INDEX_NONE;
 	}
 
-	bIsProcessing = true;
-	StreamBuffer.Empty();
-	AccumulatedContent.Empty();
-	LastProcessedOffset = 0;
+	TSharedRef<FPlayKitChatRequestState> State = MakeShared<FPlayKitChatRequestState>();
+	State->Kind = bStream ? EPlayKitChatRequestKind::Stream : EPlayKitChatRequestKind::Text;
+	State->Native = MoveTemp(Native);
+	State->Url = MoveTemp(Url);
+	BuildChatRequestBody(ModelName, Config, bStream, State->Body);
 
-	// Build request body
-	TSharedPtr<FJsonObject> RequestBody = MakeShared<FJsonObject>();
-	RequestBody->SetStringField(TEXT("model"), ModelName);
-	RequestBody->SetNumberField(TEXT("temperature"), Config.Temperature);
-	RequestBody->SetBoolField(TEXT("stream"), bStream);
+	UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Request body: %s"),
+		*FPlayKitSSEDecoder::ToString(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(State->Body.GetData()), FMath::Min(State->Body.Num(), 500))));
+
+	// Only temperature-0 output is deterministic enough to replay
+	if (bUseResponseCache && FMath::IsNearlyZero(Config.Temperature))
+	{
+		State->CacheKey = UPlayKitResponseCache::MakeKey(TEXT("text"), ModelName, Config.Messages, Config.Temperature, Config.MaxTokens);
+	}
+
+	return StartRequest(State);
+}
+
+void UPlayKitChatClient::BuildChatRequestBody(const FString& Model, const FPlayKitChatConfig& Config, bool bStream, TArray<uint8>& OutBody)
+{
+	int32 Estimate = 128 + FPlayKitJsonWriter::EstimateStringSize(Model);
+	for (const FPlayKitChatMessage& Message : Config.Messages)
+	{
+		Estimate += 64 + FPlayKitJsonWriter::EstimateStringSize(Message.Content) + FPlayKitJsonWriter::EstimateStringSize(Message.ToolCallId);
+	}
+	OutBody.Reset(Estimate);
+
+	FPlayKitJsonWriter Writer(OutBody);
+	Writer.BeginObject();
+	Writer.WriteString("model", Model);
+	Writer.WriteNumber("temperature", Config.Temperature);
+	Writer.WriteBool("stream", bStream);
 
 	if (Config.MaxTokens > 0)
 	{
-		RequestBody->SetNumberField(TEXT("max_tokens"), Config.MaxTokens);
+		Writer.WriteNumber("max_tokens", Config.MaxTokens);
 	}
 
-	// Add messages
-	TArray<TSharedPtr<FJsonValue>> MessagesArray;
+	Writer.BeginArray("messages");
 	for (const FPlayKitChatMessage& Message : Config.Messages)
 	{
-		TSharedPtr<FJsonObject> MessageObj = MakeShared<FJsonObject>();
-		MessageObj->SetStringField(TEXT("role"), Message.Role);
-		MessageObj->SetStringField(TEXT("content"), Message.Content);
+		Writer.BeginObject();
+		Writer.WriteString("role", Message.Role);
+		Writer.WriteString("content", Message.Content);
 		if (!Message.ToolCallId.IsEmpty())
 		{
-			MessageObj->SetStringField(TEXT("tool_call_id"), Message.ToolCallId);
+			Writer.WriteString("tool_call_id", Message.ToolCallId);
 		}
-		MessagesArray.Add(MakeShared<FJsonValueObject>(MessageObj));
+		Writer.EndObject();
 	}
-	RequestBody->SetArrayField(TEXT("messages"), MessagesArray);
-
-	// Serialize
-	FString RequestBodyStr;
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&RequestBodyStr);
-	FJsonSerializer::Serialize(RequestBody.ToSharedRef(), Writer);
+	Writer.EndArray();
+	Writer.EndObject();
+}
 
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Request body: %s"), *RequestBodyStr.Left(500));
+void UPlayKitChatClient::BuildStructuredRequestBody(const FString& Model, const FString& InSystemPrompt, const FString& Prompt,
+	const FString& SchemaJson, float InTemperature, TArray<uint8>& OutBody, bool bStream)
+{
+	OutBody.Reset(256 + FPlayKitJsonWriter::EstimateStringSize(Model) + FPlayKitJsonWriter::EstimateStringSize(InSystemPrompt)
+		+ FPlayKitJsonWriter::EstimateStringSize(Prompt) + SchemaJson.Len() * 3);
 
-	// Create and send request
-	CurrentRequest = CreateAuthenticatedRequest(Url);
-	CurrentRequest->SetContentAsString(RequestBodyStr);
+	FPlayKitJsonWriter Writer(OutBody);
+	Writer.BeginObject();
+	Writer.WriteString("model", Model);
 
-	if (bStream)
+	Writer.BeginArray("messages");
+	if (!InSystemPrompt.IsEmpty())
 	{
-		UE_LOG(LogTemp, Log, TEXT("[PlayKit] Using STREAMING mode"));
-		CurrentRequest->OnRequestProgress64().BindUObject(this, &UPlayKitChatClient::HandleStreamProgress);
-		CurrentRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKitChatClient::HandleStreamComplete);
+		Writer.BeginObject();
+		Writer.WriteString("role", TEXT("system"));
+		Writer.WriteString("content", InSystemPrompt);
+		Writer.EndObject();
 	}
-	else
+	Writer.BeginObject();
+	Writer.WriteString("role", TEXT("user"));
+	Writer.WriteString("content", Prompt);
+	Writer.EndObject();
+	Writer.EndArray();
+
+	Writer.WriteBool("stream", bStream);
+	Writer.WriteNumber("temperature", InTemperature);
+	Writer.WriteString("output", TEXT("object"));
+	Writer.WriteString("schemaName", TEXT("response"));
+	Writer.WriteString("schemaDescription", TEXT(""));
+	Writer.WriteRawJson("schema", SchemaJson);
+	Writer.EndObject();
+}
+
+void UPlayKitChatClient::HandleChatResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, int32 RequestId)
+{
+	LLM_SCOPE_BYTAG(PlayKit_Chat);
+	UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] HandleChatResponse called - RequestId: %d, bWasSuccessful: %d"), RequestId, bWasSuccessful);
+
+	// Cancelled requests are no longer tracked and fire no events
+	if (!ActiveRequests.Contains(RequestId))
 	{
-		UE_LOG(LogTemp, Log, TEXT("[PlayKit] Using NON-STREAMING mode"));
-		CurrentRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKitChatClient::HandleChatResponse);
+		return;
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Sending chat request to: %s"), *Url);
-	CurrentRequest->ProcessRequest();
+	FPlayKitChatOutcome Outcome;
+	PlayKitChat::DecodeChatResponse(Request, Response, bWasSuccessful, Outcome);
+	FinishChatResponse(RequestId, Outcome);
 }
 
-void UPlayKitChatClient::HandleChatResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+void UPlayKitChatClient::FinishChatResponse(int32 RequestId, FPlayKitChatOutcome& Outcome)
 {
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] HandleChatResponse called - bWasSuccessful: %d"), bWasSuccessful);
-
-	bIsProcessing = false;
-	CurrentRequest.Reset();
+	LLM_SCOPE_BYTAG(PlayKit_Chat);
+	TSharedPtr<FPlayKitChatRequestState> State;
+	if (!ActiveRequests.RemoveAndCopyValue(RequestId, State))
+	{
+		return;
+	}
 
-	if (!bWasSuccessful || !Response.IsValid())
+	if (!Outcome.ErrorCode.IsEmpty())
 	{
-		UE_LOG(LogTemp, Error, TEXT("[PlayKit] Response invalid or unsuccessful"));
-		BroadcastError(TEXT("NETWORK_ERROR"), TEXT("Network request failed"));
+		FailRequest(*State, Outcome.ErrorCode, Outcome.ErrorMessage);
 		return;
 	}
 
-	int32 ResponseCode = Response->GetResponseCode();
-	FString ResponseContent = Response->GetContentAsString();
+	FPlayKitChatResponse& ChatResponse = Outcome.Response;
+	ChatResponse.RequestId = RequestId;
 
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Response code: %d, Content length: %d"), ResponseCode, ResponseContent.Len());
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Response: %s"), *ResponseContent.Left(500));
+	// Tool calls are not replayable from text alone
+	if (ChatResponse.bSuccess && ChatResponse.ToolCalls.Num() == 0)
+	{
+		StoreInCache(*State, ChatResponse.Content);
+	}
 
-	if (ResponseCode < 200 || ResponseCode >= 300)
+	if (State->Native.IsValid())
 	{
-		UE_LOG(LogTemp, Error, TEXT("[PlayKit] Chat error %d: %s"), ResponseCode, *ResponseContent);
-		BroadcastError(FString::FromInt(ResponseCode), ResponseContent);
+		State->Native->Promise.SetValue(MoveTemp(ChatResponse));
 		return;
 	}
-
-	FPlayKitChatResponse ChatResponse = ParseChatResponse(ResponseContent);
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Parsed response - Success: %d, Content: %s"), ChatResponse.bSuccess, *ChatResponse.Content.Left(200));
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] OnChatResponse delegate bound: %s"), OnChatResponse.IsBound() ? TEXT("YES") : TEXT("NO"));
 	OnChatResponse.Broadcast(ChatResponse);
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] OnChatResponse.Broadcast completed"));
+	OnRequestResponse.Broadcast(RequestId, ChatResponse);
 }
 
-void UPlayKitChatClient::HandleStreamProgress(FHttpRequestPtr Request, uint64 BytesSent, uint64 BytesReceived)
+void UPlayKitChatClient::HandleStreamProgress(FHttpRequestPtr Request, uint64 BytesSent, uint64 BytesReceived, int32 RequestId)
 {
-	UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Stream progress - Sent: %llu, Received: %llu"), BytesSent, BytesReceived);
+	LLM_SCOPE_BYTAG(PlayKit_Chat);
+	UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Stream progress %d - Sent: %llu, Received: %llu"), RequestId, BytesSent, BytesReceived);
 
-	if (!Request.IsValid())
+	// Hold a reference: a listener may cancel this request while its events are dispatched
+	TSharedPtr<FPlayKitChatRequestState> State = ActiveRequests.FindRef(RequestId);
+	if (!State.IsValid() || !Request.IsValid())
 	{
 		return;
 	}
 
-	FHttpResponsePtr Response = Request->GetResponse();
-	if (!Response.IsValid())
+	TArray<FString> Deltas;
+	PlayKitChat::DecodeStreamDeltas(*State, Request->GetResponse(), Deltas);
+	if (State->Kind == EPlayKitChatRequestKind::StructuredStream)
 	{
+		TArray<FPlayKitJsonStreamValue> Values;
+		PlayKitChat::ParseStructuredDeltas(*State, Deltas, Values);
+		ApplyStructuredValues(*State, Deltas, Values);
 		return;
 	}
+	ApplyStreamDeltas(*State, Deltas);
+}
 
-	FString CurrentContent = Response->GetContentAsString();
-
-	// Process only new data
-	if (CurrentContent.Len() <= LastProcessedOffset)
+void UPlayKitChatClient::ApplyStreamDeltas(FPlayKitChatRequestState& State, TArrayView<const FString> Deltas)
+{
+	// Native callbacks cost no reflection, so they are never merged
+	if (State.Native.IsValid())
 	{
+		for (const FString& Delta : Deltas)
+		{
+			if (State.bCancelled)
+			{
+				return;
+			}
+
+			State.AccumulatedContent += Delta;
+			if (State.Native->OnDelta)
+			{
+				State.Native->OnDelta(Delta);
+			}
+		}
 		return;
 	}
 
-	FString NewData = CurrentContent.Mid(LastProcessedOffset);
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Stream new data: %s"), *NewData.Left(200));
-	LastProcessedOffset = CurrentContent.Len();
+	if (ChunkDelivery == EPlayKitChunkDelivery::PerFrame)
+	{
+		for (const FString& Delta : Deltas)
+		{
+			State.AccumulatedContent += Delta;
+			State.PendingChunk += Delta;
+		}
 
-	// Parse SSE data
-	TArray<FString> Lines;
-	NewData.ParseIntoArrayLines(Lines);
+		if (!State.PendingChunk.IsEmpty())
+		{
+			FPlayKitStreamChunkDispatcher::Schedule(this, this);
+		}
+		return;
+	}
 
-	for (const FString& Line : Lines)
+	for (const FString& Delta : Deltas)
 	{
-		if (Line.StartsWith(TEXT("data: ")))
+		if (State.bCancelled)
 		{
-			FString JsonStr = Line.Mid(6).TrimStartAndEnd();
+			return;
+		}
 
-			if (JsonStr == TEXT("[DONE]"))
-			{
-				continue;
-			}
+		State.AccumulatedContent += Delta;
+		OnStreamChunk.Broadcast(Delta);
+		OnRequestStreamChunk.Broadcast(State.Id, Delta);
+	}
+}
 
-			TSharedPtr<FJsonObject> JsonObject;
-			TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonStr);
-			if (FJsonSerializer::Deserialize(Reader, JsonObject) && JsonObject.IsValid())
-			{
-				// Try UI Message Stream format first (type, delta)
-				FString Type;
-				if (JsonObject->TryGetStringField(TEXT("type"), Type))
-				{
-					if (Type == TEXT("text-delta"))
-					{
-						FString Delta;
-						if (JsonObject->TryGetStringField(TEXT("delta"), Delta) && !Delta.IsEmpty())
-						{
-							AccumulatedContent += Delta;
-							OnStreamChunk.Broadcast(Delta);
-						}
-					}
-					// Handle other types like "start", "finish" if needed
-					continue;
-				}
+void UPlayKitChatClient::ApplyStructuredValues(FPlayKitChatRequestState& State, TArrayView<const FString> Deltas,
+	TArrayView<const FPlayKitJsonStreamValue> Values)
+{
+	for (const FString& Delta : Deltas)
+	{
+		State.AccumulatedContent += Delta;
+	}
 
-				// Fallback to legacy OpenAI format (choices, delta)
-				const TArray<TSharedPtr<FJsonValue>>* Choices;
-				if (JsonObject->TryGetArrayField(TEXT("choices"), Choices) && Choices->Num() > 0)
-				{
-					TSharedPtr<FJsonObject> Choice = (*Choices)[0]->AsObject();
-					const TSharedPtr<FJsonObject>* DeltaPtr;
-					if (Choice && Choice->TryGetObjectField(TEXT("delta"), DeltaPtr) && DeltaPtr)
-					{
-						FString Content;
-						if ((*DeltaPtr)->TryGetStringField(TEXT("content"), Content) && !Content.IsEmpty())
-						{
-							AccumulatedContent += Content;
-							OnStreamChunk.Broadcast(Content);
-						}
-					}
-				}
+	// Each value is a unit of content to build, so values are never merged per frame
+	for (const FPlayKitJsonStreamValue& Value : Values)
+	{
+		if (State.bCancelled)
+		{
+			return;
+		}
+
+		if (State.Native.IsValid())
+		{
+			if (State.Native->OnStructuredValue)
+			{
+				State.Native->OnStructuredValue(Value);
 			}
 		}
+		else
+		{
+			OnStructuredField.Broadcast(State.Id, Value.Path, Value.Json);
+		}
 	}
 }
 
-void UPlayKitChatClient::HandleStreamComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+void UPlayKitChatClient::FlushPendingChunk(FPlayKitChatRequestState& State)
 {
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] HandleStreamComplete called - bWasSuccessful: %d"), bWasSuccessful);
+	if (State.PendingChunk.IsEmpty() || State.bCancelled)
+	{
+		return;
+	}
 
-	bIsProcessing = false;
-	CurrentRequest.Reset();
+	const FString Chunk = MoveTemp(State.PendingChunk);
+	State.PendingChunk.Reset();
+	OnStreamChunk.Broadcast(Chunk);
+	OnRequestStreamChunk.Broadcast(State.Id, Chunk);
+}
 
-	if (!bWasSuccessful)
+int32 UPlayKitChatClient::BroadcastPendingChunks(int32 MaxBroadcasts)
+{
+	// Collect first: listeners may cancel or start requests
+	TArray<TSharedPtr<FPlayKitChatRequestState>, TInlineAllocator<8>> Pending;
+	for (const TPair<int32, TSharedPtr<FPlayKitChatRequestState>>& Pair : ActiveRequests)
 	{
-		UE_LOG(LogTemp, Error, TEXT("[PlayKit] Stream request failed"));
-		BroadcastError(TEXT("NETWORK_ERROR"), TEXT("Stream request failed"));
-		return;
+		if (!Pair.Value->PendingChunk.IsEmpty())
+		{
+			Pending.Add(Pair.Value);
+			if (Pending.Num() == MaxBroadcasts)
+			{
+				break;
+			}
+		}
 	}
 
-	if (Response.IsValid())
+	int32 Broadcasts = 0;
+	for (const TSharedPtr<FPlayKitChatRequestState>& State : Pending)
 	{
-		int32 ResponseCode = Response->GetResponseCode();
-		UE_LOG(LogTemp, Log, TEXT("[PlayKit] Stream complete - Response code: %d"), ResponseCode);
-		if (ResponseCode < 200 || ResponseCode >= 300)
+		if (!State->PendingChunk.IsEmpty() && !State->bCancelled)
 		{
-			UE_LOG(LogTemp, Error, TEXT("[PlayKit] Stream error: %s"), *Response->GetContentAsString());
-			BroadcastError(FString::FromInt(ResponseCode), Response->GetContentAsString());
-			return;
+			FlushPendingChunk(*State);
+			++Broadcasts;
+		}
+	}
+	return Broadcasts;
+}
+
+bool UPlayKitChatClient::HasPendingChunks() const
+{
+	for (const TPair<int32, TSharedPtr<FPlayKitChatRequestState>>& Pair : ActiveRequests)
+	{
+		if (!Pair.Value->PendingChunk.IsEmpty())
+		{
+			return true;
 		}
 	}
+	return false;
+}
 
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Stream complete - Accumulated content length: %d"), AccumulatedContent.Len());
-	OnStreamComplete.Broadcast(AccumulatedContent);
+void UPlayKitChatClient::HandleStreamComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, int32 RequestId)
+{
+	LLM_SCOPE_BYTAG(PlayKit_Chat);
+	UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] HandleStreamComplete called - RequestId: %d, bWasSuccessful: %d"), RequestId, bWasSuccessful);
+
+	TSharedPtr<FPlayKitChatRequestState> State = ActiveRequests.FindRef(RequestId);
+	if (!State.IsValid())
+	{
+		return;
+	}
+
+	FPlayKitChatOutcome Outcome;
+	PlayKitChat::DecodeStreamTail(*State, Response, bWasSuccessful, Outcome);
+	PlayKitChat::ParseStructuredDeltas(*State, Outcome.Deltas, Outcome.StructuredValues);
+	FinishStream(RequestId, Outcome);
 }
 
-void UPlayKitChatClient::GenerateStructured(const FString& Prompt, const FString& SchemaJson)
+void UPlayKitChatClient::FinishStream(int32 RequestId, FPlayKitChatOutcome& Outcome)
 {
-	if (bIsProcessing)
+	LLM_SCOPE_BYTAG(PlayKit_Chat);
+	TSharedPtr<FPlayKitChatRequestState> State;
+	if (!ActiveRequests.RemoveAndCopyValue(RequestId, State))
 	{
-		OnStructuredResponse.Broadcast(false, TEXT("{\"error\": \"Request already in progress\"}"));
 		return;
 	}
 
-	// Use the same /v2/chat endpoint with schema parameters
-	FString Url = BuildRequestUrl();
-	if (Url.IsEmpty())
+	if (State->Kind == EPlayKitChatRequestKind::StructuredStream)
 	{
-		OnStructuredResponse.Broadcast(false, TEXT("{\"error\": \"Failed to build request URL\"}"));
+		FinishStructuredStream(*State, Outcome);
 		return;
 	}
 
-	bIsProcessing = true;
+	// Text merged for the next frame goes out before the stream ends
+	if (!Outcome.ErrorCode.IsEmpty())
+	{
+		FlushPendingChunk(*State);
+		FailRequest(*State, Outcome.ErrorCode, Outcome.ErrorMessage);
+		return;
+	}
 
-	// Build messages array
-	TArray<TSharedPtr<FJsonValue>> MessagesArray;
+	ApplyStreamDeltas(*State, Outcome.Deltas);
+	FlushPendingChunk(*State);
+	if (State->bCancelled)
+	{
+		return;
+	}
 
-	if (!SystemPrompt.IsEmpty())
+	UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Stream complete - Accumulated content length: %d"), State->AccumulatedContent.Len());
+	StoreInCache(*State, State->AccumulatedContent);
+
+	if (State->Native.IsValid())
 	{
-		TSharedPtr<FJsonObject> SystemMsg = MakeShared<FJsonObject>();
-		SystemMsg->SetStringField(TEXT("role"), TEXT("system"));
-		SystemMsg->SetStringField(TEXT("content"), SystemPrompt);
-		MessagesArray.Add(MakeShared<FJsonValueObject>(SystemMsg));
+		FPlayKitChatResponse ChatResponse;
+		ChatResponse.bSuccess = true;
+		ChatResponse.Content = MoveTemp(State->AccumulatedContent);
+		ChatResponse.RequestId = RequestId;
+		State->Native->Promise.SetValue(MoveTemp(ChatResponse));
+		return;
 	}
+	OnStreamComplete.Broadcast(State->AccumulatedContent);
+	OnRequestStreamComplete.Broadcast(RequestId, State->AccumulatedContent);
+}
 
-	TSharedPtr<FJsonObject> UserMsg = MakeShared<FJsonObject>();
-	UserMsg->SetStringField(TEXT("role"), TEXT("user"));
-	UserMsg->SetStringField(TEXT("content"), Prompt);
-	MessagesArray.Add(MakeShared<FJsonValueObject>(UserMsg));
+void UPlayKitChatClient::FinishStructuredStream(FPlayKitChatRequestState& State, FPlayKitChatOutcome& Outcome)
+{
+	auto Fail = [this, &State](const FString& ErrorJson)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[PlayKit] Structured stream %d failed: %s"), State.Id, *ErrorJson);
+		if (State.Native.IsValid())
+		{
+			State.Native->Promise.SetValue(PlayKitChat::MakeFailedResponse(ErrorJson, State.Id));
+			return;
+		}
+		BroadcastStructured(State.Id, false, ErrorJson);
+	};
 
-	// Build request body using v2 chat format with schema
-	TSharedPtr<FJsonObject> RequestBody = MakeShared<FJsonObject>();
-	RequestBody->SetStringField(TEXT("model"), ModelName);
-	RequestBody->SetArrayField(TEXT("messages"), MessagesArray);
-	RequestBody->SetBoolField(TEXT("stream"), false);
-	RequestBody->SetNumberField(TEXT("temperature"), Temperature);
-	RequestBody->SetStringField(TEXT("output"), TEXT("object"));
-	RequestBody->SetStringField(TEXT("schemaName"), TEXT("response"));
-	RequestBody->SetStringField(TEXT("schemaDescription"), TEXT(""));
+	if (!Outcome.ErrorCode.IsEmpty())
+	{
+		Fail(PlayKitChat::MakeStructuredErrorJson(Outcome.ErrorMessage));
+		return;
+	}
 
-	// Parse schema JSON
-	TSharedPtr<FJsonObject> SchemaObject;
-	TSharedRef<TJsonReader<>> SchemaReader = TJsonReaderFactory<>::Create(SchemaJson);
-	if (FJsonSerializer::Deserialize(SchemaReader, SchemaObject) && SchemaObject.IsValid())
+	ApplyStructuredValues(State, Outcome.Deltas, Outcome.StructuredValues);
+	if (State.bCancelled)
 	{
-		RequestBody->SetObjectField(TEXT("schema"), SchemaObject);
+		return;
 	}
-	else
+
+	const FPlayKitJsonStreamParser& Parser = State.StructuredParser;
+	if (!Parser.IsComplete())
 	{
-		bIsProcessing = false;
-		OnStructuredResponse.Broadcast(false, TEXT("{\"error\": \"Invalid schema JSON\"}"));
+		Fail(Parser.HasError() ? TEXT("{\"error\": \"Malformed structured output\"}") : TEXT("{\"error\": \"Incomplete structured output\"}"));
 		return;
 	}
 
-	// Serialize
-	FString RequestBodyStr;
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&RequestBodyStr);
-	FJsonSerializer::Serialize(RequestBody.ToSharedRef(), Writer);
+	// The object without any text the model wrapped it in
+	FString ResultJson = State.AccumulatedContent.Mid(static_cast<int32>(Parser.GetRootStart()),
+		static_cast<int32>(Parser.GetRootEnd() - Parser.GetRootStart()));
+	StoreInCache(State, ResultJson);
 
-	CurrentRequest = CreateAuthenticatedRequest(Url);
-	CurrentRequest->SetContentAsString(RequestBodyStr);
-	CurrentRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKitChatClient::HandleStructuredResponse);
+	if (State.Native.IsValid())
+	{
+		FPlayKitChatResponse ChatResponse;
+		ChatResponse.bSuccess = true;
+		ChatResponse.Content = MoveTemp(ResultJson);
+		ChatResponse.RequestId = State.Id;
+		State.Native->Promise.SetValue(MoveTemp(ChatResponse));
+		return;
+	}
+	BroadcastStructured(State.Id, true, ResultJson);
+}
+
+int32 UPlayKitChatClient::GenerateStructured(const FString& Prompt, const FString& SchemaJson)
+{
+	return StartStructured(Prompt, SchemaJson, nullptr);
+}
 
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Sending structured request to: %s"), *Url);
-	CurrentRequest->ProcessRequest();
+int32 UPlayKitChatClient::GenerateStructuredStream(const FString& Prompt, const FString& SchemaJson)
+{
+	return StartStructured(Prompt, SchemaJson, nullptr, true);
 }
 
-void UPlayKitChatClient::HandleStructuredResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+int32 UPlayKitChatClient::StartStructured(const FString& Prompt, const FString& SchemaJson, TUniquePtr<FPlayKitChatNativeCompletion> Native, bool bStream)
 {
-	bIsProcessing = false;
-	CurrentRequest.Reset();
+	auto Reject = [this, &Native](const TCHAR* ErrorJson)
+	{
+		if (Native.IsValid())
+		{
+			Native->Promise.SetValue(PlayKitChat::MakeFailedResponse(ErrorJson));
+		}
+		else
+		{
+			BroadcastStructured(INDEX_NONE, false, ErrorJson);
+		}
+	};
 
-	if (!bWasSuccessful || !Response.IsValid())
+	if (!CanStartRequest())
 	{
-		OnStructuredResponse.Broadcast(false, TEXT("{\"error\": \"Network request failed\"}"));
-		return;
+		Reject(TEXT("{\"error\": \"Too many requests in flight\"}"));
+		return INDEX_NONE;
 	}
 
-	int32 ResponseCode = Response->GetResponseCode();
-	FString ResponseContent = Response->GetContentAsString();
+	// Use the same /v2/chat endpoint with schema parameters
+	FString Url = BuildRequestUrl();
+	if (Url.IsEmpty())
+	{
+		Reject(TEXT("{\"error\": \"Failed to build request URL\"}"));
+		return INDEX_NONE;
+	}
 
-	if (ResponseCode < 200 || ResponseCode >= 300)
+	// Validate the schema up front; it is copied into the body verbatim
+	TSharedPtr<FJsonObject> SchemaObject;
+	TSharedRef<TJsonReader<>> SchemaReader = TJsonReaderFactory<>::Create(SchemaJson);
+	if (!FJsonSerializer::Deserialize(SchemaReader, SchemaObject) || !SchemaObject.IsValid())
 	{
-		OnStructuredResponse.Broadcast(false, ResponseContent);
-		return;
+		Reject(TEXT("{\"error\": \"Invalid schema JSON\"}"));
+		return INDEX_NONE;
 	}
 
-	// Parse response to extract the object
-	TSharedPtr<FJsonObject> JsonObject;
-	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ResponseContent);
-	if (FJsonSerializer::Deserialize(Reader, JsonObject) && JsonObject.IsValid())
+	TSharedRef<FPlayKitChatRequestState> State = MakeShared<FPlayKitChatRequestState>();
+	State->Kind = bStream ? EPlayKitChatRequestKind::StructuredStream : EPlayKitChatRequestKind::Structured;
+	State->Native = MoveTemp(Native);
+	State->Url = MoveTemp(Url);
+	BuildStructuredRequestBody(ModelName, SystemPrompt, Prompt, SchemaJson, Temperature, State->Body, bStream);
+
+	// A fixed schema makes structured output deterministic enough to replay
+	if (bUseResponseCache)
 	{
-		const TSharedPtr<FJsonObject>* ObjectResultPtr;
-		if (JsonObject->TryGetObjectField(TEXT("object"), ObjectResultPtr) && ObjectResultPtr)
+		TArray<FPlayKitChatMessage> KeyMessages;
+		if (!SystemPrompt.IsEmpty())
 		{
-			FString ResultStr;
-			TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&ResultStr);
-			FJsonSerializer::Serialize((*ObjectResultPtr).ToSharedRef(), Writer);
-			OnStructuredResponse.Broadcast(true, ResultStr);
-			return;
+			KeyMessages.Add(FPlayKitChatMessage(TEXT("system"), SystemPrompt));
 		}
+		KeyMessages.Add(FPlayKitChatMessage(TEXT("user"), Prompt));
+		State->CacheKey = UPlayKitResponseCache::MakeKey(TEXT("structured"), ModelName, KeyMessages, Temperature, 0, SchemaJson);
 	}
 
-	OnStructuredResponse.Broadcast(true, ResponseContent);
+	return StartRequest(State);
 }
 
-FPlayKitChatResponse UPlayKitChatClient::ParseChatResponse(const FString& ResponseContent)
+void UPlayKitChatClient::HandleStructuredResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, int32 RequestId)
 {
-	FPlayKitChatResponse Result;
-
-	TSharedPtr<FJsonObject> JsonObject;
-	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ResponseContent);
-	if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
+	if (!ActiveRequests.Contains(RequestId))
 	{
-		Result.bSuccess = false;
-		Result.ErrorMessage = TEXT("Failed to parse response JSON");
-		return Result;
+		return;
 	}
 
-	Result.bSuccess = true;
+	FPlayKitChatOutcome Outcome;
+	PlayKitChat::DecodeStructuredResponse(Response, bWasSuccessful, Outcome);
+	FinishStructured(RequestId, Outcome);
+}
 
-	// Parse choices
-	const TArray<TSharedPtr<FJsonValue>>* Choices;
-	if (JsonObject->TryGetArrayField(TEXT("choices"), Choices) && Choices->Num() > 0)
+void UPlayKitChatClient::FinishStructured(int32 RequestId, FPlayKitChatOutcome& Outcome)
+{
+	LLM_SCOPE_BYTAG(PlayKit_Chat);
+	TSharedPtr<FPlayKitChatRequestState> State;
+	if (!ActiveRequests.RemoveAndCopyValue(RequestId, State))
 	{
-		TSharedPtr<FJsonObject> Choice = (*Choices)[0]->AsObject();
-		if (Choice)
-		{
-			Choice->TryGetStringField(TEXT("finish_reason"), Result.FinishReason);
+		return;
+	}
 
-			const TSharedPtr<FJsonObject>* MessagePtr;
-			if (Choice->TryGetObjectField(TEXT("message"), MessagePtr) && MessagePtr)
-			{
-				(*MessagePtr)->TryGetStringField(TEXT("content"), Result.Content);
+	const bool bSuccess = Outcome.ErrorCode.IsEmpty();
+	if (bSuccess && Outcome.bCacheable)
+	{
+		StoreInCache(*State, Outcome.StructuredJson);
+	}
 
-				// Parse tool calls
-				const TArray<TSharedPtr<FJsonValue>>* ToolCalls;
-				if ((*MessagePtr)->TryGetArrayField(TEXT("tool_calls"), ToolCalls))
-				{
-					for (const TSharedPtr<FJsonValue>& ToolCallValue : *ToolCalls)
-					{
-						TSharedPtr<FJsonObject> ToolCallObj = ToolCallValue->AsObject();
-						if (ToolCallObj)
-						{
-							FPlayKitToolCall ToolCall;
-							ToolCallObj->TryGetStringField(TEXT("id"), ToolCall.Id);
-							ToolCallObj->TryGetStringField(TEXT("type"), ToolCall.Type);
-
-							const TSharedPtr<FJsonObject>* FunctionPtr;
-							if (ToolCallObj->TryGetObjectField(TEXT("function"), FunctionPtr) && FunctionPtr)
-							{
-								(*FunctionPtr)->TryGetStringField(TEXT("name"), ToolCall.FunctionName);
-								(*FunctionPtr)->TryGetStringField(TEXT("arguments"), ToolCall.FunctionArguments);
-							}
-
-							Result.ToolCalls.Add(ToolCall);
-						}
-					}
-				}
-			}
+	if (State->Native.IsValid())
+	{
+		FPlayKitChatResponse ChatResponse = bSuccess ? FPlayKitChatResponse() : PlayKitChat::MakeFailedResponse(Outcome.StructuredJson, RequestId);
+		ChatResponse.bSuccess = bSuccess;
+		ChatResponse.RequestId = RequestId;
+		if (bSuccess)
+		{
+			ChatResponse.Content = MoveTemp(Outcome.StructuredJson);
 		}
+		State->Native->Promise.SetValue(MoveTemp(ChatResponse));
+		return;
 	}
+	BroadcastStructured(RequestId, bSuccess, Outcome.StructuredJson);
+}
 
-	// Parse usage
-	const TSharedPtr<FJsonObject>* UsagePtr;
-	if (JsonObject->TryGetObjectField(TEXT("usage"), UsagePtr) && UsagePtr)
+FPlayKitChatResponse UPlayKitChatClient::ParseChatResponse(FUtf8StringView ResponseBody)
+{
+	FPlayKitChatResponse Result;
+	Result.bSuccess = FPlayKitJsonReader::ParseChatCompletion(ResponseBody, Result);
+	if (!Result.bSuccess)
 	{
-		(*UsagePtr)->TryGetNumberField(TEXT("prompt_tokens"), Result.PromptTokens);
-		(*UsagePtr)->TryGetNumberField(TEXT("completion_tokens"), Result.CompletionTokens);
-		(*UsagePtr)->TryGetNumberField(TEXT("total_tokens"), Result.TotalTokens);
+		Result.ErrorMessage = TEXT("Failed to parse response JSON");
 	}
-
 	return Result;
 }
 
 void UPlayKitChatClient::CancelRequest()
 {
-	if (CurrentRequest.IsValid())
+	TArray<int32> RequestIds;
+	ActiveRequests.GenerateKeyArray(RequestIds);
+	for (int32 RequestId : RequestIds)
 	{
-		CurrentRequest->CancelRequest();
-		CurrentRequest.Reset();
+		CancelRequestById(RequestId);
 	}
-	bIsProcessing = false;
 }
 
-void UPlayKitChatClient::BroadcastError(const FString& ErrorCode, const FString& ErrorMessage)
+bool UPlayKitChatClient::CancelRequestById(int32 RequestId)
 {
-	UE_LOG(LogTemp, Error, TEXT("[PlayKit] Chat error [%s]: %s"), *ErrorCode, *ErrorMessage);
+	TSharedPtr<FPlayKitChatRequestState> State;
+	if (!ActiveRequests.RemoveAndCopyValue(RequestId, State))
+	{
+		return false;
+	}
+
+	// Untracked first, so the completion fired by CancelRequest is ignored
+	State->bCancelled = true;
+	// Completed here rather than when the state dies, which may be on the HTTP thread
+	if (State->Native.IsValid())
+	{
+		State->Native->Promise.SetValue(PlayKitChat::MakeFailedResponse(TEXT("Request cancelled"), RequestId));
+	}
+	// Null while a cache lookup is pending
+	UPlayKitRequestScheduler::CancelRequest(this, State->HttpRequest);
+	return true;
+}
+
+void UPlayKitChatClient::BroadcastError(int32 RequestId, const FString& ErrorCode, const FString& ErrorMessage)
+{
+	UE_LOG(LogTemp, Error, TEXT("[PlayKit] Chat error [%s] (request %d): %s"), *ErrorCode, RequestId, *ErrorMessage);
 	OnError.Broadcast(ErrorCode, ErrorMessage);
+	OnRequestError.Broadcast(RequestId, ErrorCode, ErrorMessage);
 
 	// Also broadcast a failed response
 	FPlayKitChatResponse FailedResponse;
 	FailedResponse.bSuccess = false;
 	FailedResponse.ErrorMessage = ErrorMessage;
+	FailedResponse.RequestId = RequestId;
 	OnChatResponse.Broadcast(FailedResponse);
+	OnRequestResponse.Broadcast(RequestId, FailedResponse);
+}
+
+void UPlayKitChatClient::FailRequest(FPlayKitChatRequestState& State, const FString& ErrorCode, const FString& ErrorMessage)
+{
+	if (!State.Native.IsValid())
+	{
+		BroadcastError(State.Id, ErrorCode, ErrorMessage);
+		return;
+	}
+
+	UE_LOG(LogTemp, Error, TEXT("[PlayKit] Chat error [%s] (request %d): %s"), *ErrorCode, State.Id, *ErrorMessage);
+	State.Native->Promise.SetValue(PlayKitChat::MakeFailedResponse(ErrorMessage, State.Id));
+}
+
+void UPlayKitChatClient::RejectRequest(FPlayKitChatNativeCompletion* Native, const FString& ErrorCode, const FString& ErrorMessage)
+{
+	if (!Native)
+	{
+		BroadcastError(INDEX_NONE, ErrorCode, ErrorMessage);
+		return;
+	}
+
+	UE_LOG(LogTemp, Error, TEXT("[PlayKit] Chat error [%s]: %s"), *ErrorCode, *ErrorMessage);
+	Native->Promise.SetValue(PlayKitChat::MakeFailedResponse(ErrorMessage));
+}
+
+void UPlayKitChatClient::BroadcastStructured(int32 RequestId, bool bSuccess, const FString& JsonResult)
+{
+	OnStructuredResponse.Broadcast(bSuccess, JsonResult);
+	OnStructuredRequestResponse.Broadcast(RequestId, bSuccess, JsonResult);
 }
@@ -3,11 +3,19 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Async/Future.h"
 #include "Components/ActorComponent.h"
 #include "Interfaces/IHttpRequest.h"
 #include "PlayKitTypes.h"
+#include "Net/PlayKitRequestScheduler.h"
+#include "Net/PlayKitStreamChunkDispatcher.h"
 #include "PlayKitChatClient.generated.h"
 
+struct FPlayKitChatRequestState;
+struct FPlayKitChatOutcome;
+struct FPlayKitChatNativeCompletion;
+struct FPlayKitJsonStreamValue;
+
 /**
  * PlayKit Chat Client Component
  * Provides AI text generation and chat functionality.
@@ -15,7 +23,7 @@
  * Features:
  * - Text generation (non-streaming)
  * - Streaming text generation
- * - Structured output generation
+ * - Structured output generation, optionally streamed field by field
  * - Tool calling support
  *
  * Usage:
@@ -23,9 +31,13 @@
  * 2. Configure properties in the Details panel (ModelName, Temperature, etc.)
  * 3. Bind to events using the "+" button (OnChatResponse, OnStreamChunk, etc.)
  * 4. Call GenerateText() or GenerateTextStream() to start generation
+ *
+ * Several requests can be in flight at once. Every Generate* call returns a
+ * request id; the OnRequest* events carry that id so results can be matched,
+ * and CancelRequestById() cancels a single request.
  */
 UCLASS(ClassGroup=(PlayKit), meta=(BlueprintSpawnableComponent))
-class PLAYKITSDK_API UPlayKitChatClient : public UActorComponent
+class PLAYKITSDK_API UPlayKitChatClient : public UActorComponent, public IPlayKitStreamChunkSource
 {
 	GENERATED_BODY()
 
@@ -55,6 +67,37 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|Chat", meta=(MultiLine=true))
 	FString SystemPrompt;
 
+	/** Maximum number of requests this component may have in flight (0 = no limit) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|Chat", meta=(ClampMin="0"))
+	int32 MaxConcurrentRequests = 0;
+
+	/**
+	 * Serve repeat requests from the response cache.
+	 * Applies to temperature-0 text generation and to structured output; a cache hit
+	 * still fires the regular (stream) events on the next tick.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|Chat")
+	bool bUseResponseCache = false;
+
+	/** Scheduling priority of this component's requests. Set PlayerDialogue for text the player is waiting on. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|Chat")
+	EPlayKitRequestPriority RequestPriority = EPlayKitRequestPriority::Ambient;
+
+	/**
+	 * Thread that parses responses and stream events. Off the game thread only finished
+	 * results (a parsed response, a batch of text deltas) are queued back, and events still
+	 * fire on the game thread. Off-thread requests are never coalesced with identical ones.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|Chat")
+	EPlayKitDecodeThread DecodeThread = EPlayKitDecodeThread::GameThread;
+
+	/**
+	 * How stream chunks are broadcast. Per Frame merges the deltas of each stream into one
+	 * OnStreamChunk / OnRequestStreamChunk per frame; use it when many streams update UI at once.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|Chat")
+	EPlayKitChunkDelivery ChunkDelivery = EPlayKitChunkDelivery::Immediate;
+
 	//========== Events (Click "+" to bind in Blueprint) ==========//
 
 	/** Fired when chat response is received (non-streaming) */
@@ -79,11 +122,54 @@ public:
 	UPROPERTY(BlueprintAssignable, Category="PlayKit|Chat|Structured")
 	FOnStructuredResponse OnStructuredResponse;
 
+	/** Delegate for a completed value of a streamed structured object */
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnStructuredField, int32, RequestId, const FString&, Path, const FString&, ValueJson);
+
+	/**
+	 * Fired by GenerateStructuredStream() as each top-level field, and each element of a
+	 * top-level array, of the object is complete. Path is "title", "objectives[2]", ...;
+	 * ValueJson is the value as JSON (strings keep their quotes).
+	 */
+	UPROPERTY(BlueprintAssignable, Category="PlayKit|Chat|Structured")
+	FOnStructuredField OnStructuredField;
+
+	//========== Per-Request Events ==========//
+
+	/** Fired when a non-streaming request completes */
+	UPROPERTY(BlueprintAssignable, Category="PlayKit|Chat|Requests")
+	FOnChatRequestResponse OnRequestResponse;
+
+	/** Fired for each chunk of a streaming request */
+	UPROPERTY(BlueprintAssignable, Category="PlayKit|Chat|Requests")
+	FOnChatRequestStreamChunk OnRequestStreamChunk;
+
+	/** Fired when a streaming request completes with full content */
+	UPROPERTY(BlueprintAssignable, Category="PlayKit|Chat|Requests")
+	FOnChatRequestStreamComplete OnRequestStreamComplete;
+
+	/** Fired when a request fails */
+	UPROPERTY(BlueprintAssignable, Category="PlayKit|Chat|Requests")
+	FOnChatRequestError OnRequestError;
+
+	/** Delegate for structured output response with request handle */
+	DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnStructuredRequestResponse, int32, RequestId, bool, bSuccess, const FString&, JsonResult);
+
+	UPROPERTY(BlueprintAssignable, Category="PlayKit|Chat|Requests")
+	FOnStructuredRequestResponse OnStructuredRequestResponse;
+
 	//========== Status ==========//
 
-	/** Check if a request is currently in progress */
+	/** Check if any request is currently in progress */
+	UFUNCTION(BlueprintPure, Category="PlayKit|Chat")
+	bool IsProcessing() const { return ActiveRequests.Num() > 0; }
+
+	/** Check if the given request is still in progress */
+	UFUNCTION(BlueprintPure, Category="PlayKit|Chat")
+	bool IsRequestActive(int32 RequestId) const { return ActiveRequests.Contains(RequestId); }
+
+	/** Number of requests currently in flight */
 	UFUNCTION(BlueprintPure, Category="PlayKit|Chat")
-	bool IsProcessing() const { return bIsProcessing; }
+	int32 GetActiveRequestCount() const { return ActiveRequests.Num(); }
 
 	//========== Configuration Methods ==========//
 
@@ -101,31 +187,35 @@ public:
 	 * Generate text from a simple prompt (non-streaming).
 	 * Uses the component's configured ModelName and Temperature.
 	 * @param Prompt The user's message
+	 * @return Request id, or -1 if the request could not be started
 	 */
 	UFUNCTION(BlueprintCallable, Category="PlayKit|Chat", meta=(DisplayName="Generate Text"))
-	void GenerateText(const FString& Prompt);
+	int32 GenerateText(const FString& Prompt);
 
 	/**
 	 * Generate text with full configuration (non-streaming).
 	 * @param Config Chat configuration with messages and settings
+	 * @return Request id, or -1 if the request could not be started
 	 */
 	UFUNCTION(BlueprintCallable, Category="PlayKit|Chat", meta=(DisplayName="Generate Text (Advanced)"))
-	void GenerateTextAdvanced(const FPlayKitChatConfig& Config);
+	int32 GenerateTextAdvanced(const FPlayKitChatConfig& Config);
 
 	/**
 	 * Generate text with streaming response.
 	 * Each chunk fires OnStreamChunk, completion fires OnStreamComplete.
 	 * @param Prompt The user's message
+	 * @return Request id, or -1 if the request could not be started
 	 */
 	UFUNCTION(BlueprintCallable, Category="PlayKit|Chat", meta=(DisplayName="Generate Text Stream"))
-	void GenerateTextStream(const FString& Prompt);
+	int32 GenerateTextStream(const FString& Prompt);
 
 	/**
 	 * Generate text with streaming and full configuration.
 	 * @param Config Chat configuration with messages and settings
+	 * @return Request id, or -1 if the request could not be started
 	 */
 	UFUNCTION(BlueprintCallable, Category="PlayKit|Chat", meta=(DisplayName="Generate Text Stream (Advanced)"))
-	void GenerateTextStreamAdvanced(const FPlayKitChatConfig& Config);
+	int32 GenerateTextStreamAdvanced(const FPlayKitChatConfig& Config);
 
 	//========== Structured Output ==========//
 
@@ -134,36 +224,105 @@ public:
 	 * The response will be a valid JSON object matching your schema.
 	 * @param Prompt The generation prompt
 	 * @param SchemaJson JSON schema defining the output structure
+	 * @return Request id, or -1 if the request could not be started
 	 */
 	UFUNCTION(BlueprintCallable, Category="PlayKit|Chat|Structured", meta=(DisplayName="Generate Structured"))
-	void GenerateStructured(const FString& Prompt, const FString& SchemaJson);
+	int32 GenerateStructured(const FString& Prompt, const FString& SchemaJson);
+
+	/**
+	 * Generate a structured JSON object and stream it as it is written.
+	 * OnStructuredField fires as each top-level field or top-level array element completes,
+	 * so content can be built while generation is still running; OnStructuredResponse
+	 * fires with the whole object at the end.
+	 * @param Prompt The generation prompt
+	 * @param SchemaJson JSON schema defining the output structure
+	 * @return Request id, or -1 if the request could not be started
+	 */
+	UFUNCTION(BlueprintCallable, Category="PlayKit|Chat|Structured", meta=(DisplayName="Generate Structured Stream"))
+	int32 GenerateStructuredStream(const FString& Prompt, const FString& SchemaJson);
 
 	//========== Cancel ==========//
 
-	/** Cancel any in-progress request */
+	/** Cancel all in-progress requests */
 	UFUNCTION(BlueprintCallable, Category="PlayKit|Chat")
 	void CancelRequest();
 
-private:
-	void SendChatRequest(const FPlayKitChatConfig& Config, bool bStream);
-	void HandleChatResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
-	void HandleStreamProgress(FHttpRequestPtr Request, uint64 BytesSent, uint64 BytesReceived);
-	void HandleStreamComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
-	void HandleStructuredResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
+	/** Cancel a single request. No further events are fired for it. */
+	UFUNCTION(BlueprintCallable, Category="PlayKit|Chat")
+	bool CancelRequestById(int32 RequestId);
 
-	FString BuildRequestUrl() const;
-	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> CreateAuthenticatedRequest(const FString& Url);
-	FPlayKitChatResponse ParseChatResponse(const FString& ResponseContent);
-	void BroadcastError(const FString& ErrorCode, const FString& ErrorMessage);
+	//========== Native C++ API ==========//
+	// Requests made here complete through the returned future instead of the events above, so
+	// results are moved to the caller rather than copied through reflection. Futures complete on
+	// the game thread; failed and cancelled requests, and requests outliving the component,
+	// complete with bSuccess false. OutRequestId receives the id for CancelRequestById(), or -1.
+
+	TFuture<FPlayKitChatResponse> GenerateTextAsync(const FString& Prompt, int32* OutRequestId = nullptr);
+	TFuture<FPlayKitChatResponse> GenerateTextAdvancedAsync(const FPlayKitChatConfig& Config, int32* OutRequestId = nullptr);
+
+	/** @param OnDelta Called on the game thread with each text delta; the view is only valid during the call */
+	TFuture<FPlayKitChatResponse> GenerateTextStreamAsync(const FString& Prompt, TFunction<void(FStringView)> OnDelta, int32* OutRequestId = nullptr);
+	TFuture<FPlayKitChatResponse> GenerateTextStreamAdvancedAsync(const FPlayKitChatConfig& Config, TFunction<void(FStringView)> OnDelta,
+		int32* OutRequestId = nullptr);
+
+	/** The result object arrives as JSON in Content */
+	TFuture<FPlayKitChatResponse> GenerateStructuredAsync(const FString& Prompt, const FString& SchemaJson, int32* OutRequestId = nullptr);
+
+	/** @param OnValue Called on the game thread with each completed top-level field or array element */
+	TFuture<FPlayKitChatResponse> GenerateStructuredStreamAsync(const FString& Prompt, const FString& SchemaJson,
+		TFunction<void(const FPlayKitJsonStreamValue&)> OnValue, int32* OutRequestId = nullptr);
+
+	//========== Request Bodies ==========//
+
+	/** Write the /v2/chat request body as UTF-8 JSON into OutBody, replacing its contents */
+	static void BuildChatRequestBody(const FString& Model, const FPlayKitChatConfig& Config, bool bStream, TArray<uint8>& OutBody);
+
+	/** Write the structured output request body. SchemaJson must already be valid JSON. */
+	static void BuildStructuredRequestBody(const FString& Model, const FString& InSystemPrompt, const FString& Prompt,
+		const FString& SchemaJson, float InTemperature, TArray<uint8>& OutBody, bool bStream = false);
+
+	/** Parse a non-streaming /v2/chat response body */
+	static FPlayKitChatResponse ParseChatResponse(FUtf8StringView ResponseBody);
+
+	//~ Begin IPlayKitStreamChunkSource Interface
+	virtual int32 BroadcastPendingChunks(int32 MaxBroadcasts) override;
+	virtual bool HasPendingChunks() const override;
+	//~ End IPlayKitStreamChunkSource Interface
 
 private:
-	bool bIsProcessing = false;
+	FPlayKitChatConfig MakePromptConfig(const FString& Prompt) const;
+	int32 SendChatRequest(const FPlayKitChatConfig& Config, bool bStream, TUniquePtr<FPlayKitChatNativeCompletion> Native = nullptr);
+	int32 StartStructured(const FString& Prompt, const FString& SchemaJson, TUniquePtr<FPlayKitChatNativeCompletion> Native, bool bStream = false);
+	int32 StartRequest(const TSharedRef<FPlayKitChatRequestState>& State);
+	void SendHttpRequest(const TSharedPtr<FPlayKitChatRequestState>& State);
+	void HandleCacheLookup(int32 RequestId, const FString* CachedValue);
+	void StoreInCache(const FPlayKitChatRequestState& State, const FString& Value);
+	bool CanStartRequest() const;
+	void BindOffThreadHandlers(const TSharedRef<IHttpRequest, ESPMode::ThreadSafe>& HttpRequest, const TSharedPtr<FPlayKitChatRequestState>& State);
+
+	// Game thread handlers: decode in place, then finish
+	void HandleChatResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, int32 RequestId);
+	void HandleStreamProgress(FHttpRequestPtr Request, uint64 BytesSent, uint64 BytesReceived, int32 RequestId);
+	void HandleStreamComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, int32 RequestId);
+	void HandleStructuredResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, int32 RequestId);
+
+	// Apply a decoded result on the game thread; stale or cancelled requests are ignored
+	void FinishChatResponse(int32 RequestId, FPlayKitChatOutcome& Outcome);
+	void FinishStructured(int32 RequestId, FPlayKitChatOutcome& Outcome);
+	void FinishStream(int32 RequestId, FPlayKitChatOutcome& Outcome);
+	void FinishStructuredStream(FPlayKitChatRequestState& State, FPlayKitChatOutcome& Outcome);
+	void ApplyStreamDeltas(FPlayKitChatRequestState& State, TArrayView<const FString> Deltas);
+	void ApplyStructuredValues(FPlayKitChatRequestState& State, TArrayView<const FString> Deltas, TArrayView<const FPlayKitJsonStreamValue> Values);
+	void FlushPendingChunk(FPlayKitChatRequestState& State);
 
-	// Streaming state
-	FString StreamBuffer;
-	FString AccumulatedContent;
-	int32 LastProcessedOffset = 0;
+	FString BuildRequestUrl() const;
+	void BroadcastError(int32 RequestId, const FString& ErrorCode, const FString& ErrorMessage);
+	void FailRequest(FPlayKitChatRequestState& State, const FString& ErrorCode, const FString& ErrorMessage);
+	void RejectRequest(FPlayKitChatNativeCompletion* Native, const FString& ErrorCode, const FString& ErrorMessage);
+	void BroadcastStructured(int32 RequestId, bool bSuccess, const FString& JsonResult);
 
-	// Current request
-	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> CurrentRequest;
+private:
+	// In-flight requests by id; each owns its HTTP request and stream state
+	TMap<int32, TSharedPtr<FPlayKitChatRequestState>> ActiveRequests;
+	int32 NextRequestId = 1;
 };
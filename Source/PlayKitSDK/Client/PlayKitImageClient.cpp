@@ -1,14 +1,102 @@
 // Copyright PlayKit. All Rights Reserved.
 
 #include "PlayKitImageClient.h"
+#include "PlayKitMemory.h"
 #include "PlayKitSettings.h"
-#include "HttpModule.h"
+#include "Net/PlayKitRequestScheduler.h"
+#include "Net/PlayKitJsonWriter.h"
+#include "Net/PlayKitRequestTrace.h"
+#include "Net/PlayKitGameThreadQueue.h"
+#include "Net/PlayKitTransport.h"
 #include "Interfaces/IHttpResponse.h"
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
 #include "Dom/JsonObject.h"
 #include "Misc/Base64.h"
 #include "ImageUtils.h"
+#include "ImageCore.h"
+#include "Tasks/Task.h"
+
+/** A parsed image response, produced on whichever thread the request completed on */
+struct FPlayKitImageOutcome
+{
+	/** Empty on success */
+	FString ErrorCode;
+	FString ErrorMessage;
+
+	TArray<FPlayKitGeneratedImage> Results;
+};
+
+namespace PlayKitImage
+{
+	/** Result of a failed GenerateImagesAsync: one image with the error */
+	static TArray<FPlayKitGeneratedImage> MakeFailedResults(const FString& ErrorMessage)
+	{
+		TArray<FPlayKitGeneratedImage> Results;
+		FPlayKitGeneratedImage& FailedImage = Results.AddDefaulted_GetRef();
+		FailedImage.bSuccess = false;
+		FailedImage.ErrorMessage = ErrorMessage;
+		return Results;
+	}
+
+	static void ParseImageResponse(const FHttpResponsePtr& Response, bool bWasSuccessful, const FString& Prompt, FPlayKitImageOutcome& Out)
+	{
+		LLM_SCOPE_BYTAG(PlayKit_Image);
+		if (!bWasSuccessful || !Response.IsValid())
+		{
+			Out.ErrorCode = TEXT("NETWORK_ERROR");
+			Out.ErrorMessage = TEXT("Network request failed");
+			return;
+		}
+
+		int32 ResponseCode = Response->GetResponseCode();
+		FString ResponseContent = Response->GetContentAsString();
+
+		if (ResponseCode < 200 || ResponseCode >= 300)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[PlayKit] Image error %d: %s"), ResponseCode, *ResponseContent);
+			Out.ErrorCode = FString::FromInt(ResponseCode);
+			Out.ErrorMessage = MoveTemp(ResponseContent);
+			return;
+		}
+
+		SCOPE_CYCLE_COUNTER(STAT_PlayKitResponseParse);
+
+		// Parse response
+		TSharedPtr<FJsonObject> JsonObject;
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ResponseContent);
+		if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
+		{
+			Out.ErrorCode = TEXT("PARSE_ERROR");
+			Out.ErrorMessage = TEXT("Failed to parse response");
+			return;
+		}
+
+		int64 Created = 0;
+		JsonObject->TryGetNumberField(TEXT("created"), Created);
+
+		const TArray<TSharedPtr<FJsonValue>>* DataArray;
+		if (JsonObject->TryGetArrayField(TEXT("data"), DataArray))
+		{
+			for (const TSharedPtr<FJsonValue>& DataValue : *DataArray)
+			{
+				TSharedPtr<FJsonObject> DataObj = DataValue->AsObject();
+				if (DataObj)
+				{
+					FPlayKitGeneratedImage& Image = Out.Results.AddDefaulted_GetRef();
+					Image.bSuccess = true;
+					Image.OriginalPrompt = Prompt;
+					Image.GeneratedAt = FDateTime::FromUnixTimestamp(Created);
+
+					DataObj->TryGetStringField(TEXT("b64_json"), Image.ImageBase64);
+					DataObj->TryGetStringField(TEXT("revised_prompt"), Image.RevisedPrompt);
+					DataObj->TryGetStringField(TEXT("b64_json_original"), Image.OriginalImageBase64);
+					DataObj->TryGetBoolField(TEXT("transparent_success"), Image.bTransparentSuccess);
+				}
+			}
+		}
+	}
+}
 
 UPlayKitImageClient::UPlayKitImageClient()
 {
@@ -42,28 +130,6 @@ void UPlayKitImageClient::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	Super::EndPlay(EndPlayReason);
 }
 
-TSharedRef<IHttpRequest, ESPMode::ThreadSafe> UPlayKitImageClient::CreateAuthenticatedRequest(const FString& Url)
-{
-	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
-	Request->SetURL(Url);
-	Request->SetVerb(TEXT("POST"));
-	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
-
-	UPlayKitSettings* Settings = UPlayKitSettings::Get();
-	if (Settings)
-	{
-		FString Token = Settings->HasDeveloperToken() && !Settings->bIgnoreDeveloperToken
-			? Settings->GetDeveloperToken()
-			: Settings->GetPlayerToken();
-		if (!Token.IsEmpty())
-		{
-			Request->SetHeader(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *Token));
-		}
-	}
-
-	return Request;
-}
-
 void UPlayKitImageClient::GenerateImage(const FString& Prompt)
 {
 	FPlayKitImageOptions Options;
@@ -87,8 +153,23 @@ void UPlayKitImageClient::GenerateImagesAdvanced(const FString& Prompt, const FP
 	SendImageRequest(Prompt, Options);
 }
 
+TFuture<TArray<FPlayKitGeneratedImage>> UPlayKitImageClient::GenerateImagesAsync(const FString& Prompt, const FPlayKitImageOptions& Options)
+{
+	if (bIsProcessing)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[PlayKit] Image error [REQUEST_IN_PROGRESS]: A request is already in progress"));
+		return TPlayKitPromise<TArray<FPlayKitGeneratedImage>>::MakeFulfilled(PlayKitImage::MakeFailedResults(TEXT("A request is already in progress")));
+	}
+
+	NativePromise = MakeUnique<TPlayKitPromise<TArray<FPlayKitGeneratedImage>>>(PlayKitImage::MakeFailedResults(TEXT("Request cancelled")));
+	TFuture<TArray<FPlayKitGeneratedImage>> Future = NativePromise->GetFuture();
+	SendImageRequest(Prompt, Options);
+	return Future;
+}
+
 void UPlayKitImageClient::SendImageRequest(const FString& Prompt, const FPlayKitImageOptions& Options)
 {
+	LLM_SCOPE_BYTAG(PlayKit_Image);
 	if (bIsProcessing)
 	{
 		BroadcastError(TEXT("REQUEST_IN_PROGRESS"), TEXT("A request is already in progress"));
@@ -113,96 +194,95 @@ void UPlayKitImageClient::SendImageRequest(const FString& Prompt, const FPlayKit
 	bIsProcessing = true;
 	LastPrompt = Prompt;
 
-	// Build request body
-	TSharedPtr<FJsonObject> RequestBody = MakeShared<FJsonObject>();
-	RequestBody->SetStringField(TEXT("model"), ModelName);
-	RequestBody->SetStringField(TEXT("prompt"), Prompt);
-	RequestBody->SetNumberField(TEXT("n"), FMath::Clamp(Options.Count, 1, 10));
-	RequestBody->SetStringField(TEXT("size"), Options.Size);
-	RequestBody->SetStringField(TEXT("response_format"), TEXT("b64_json"));
+	TArray<uint8> Body;
+	BuildRequestBody(ModelName, Prompt, Options, Body);
 
-	if (Options.Seed >= 0)
+	CurrentRequest = FPlayKitTransport::CreateAuthenticatedRequest(Url);
+	CurrentRequest->SetContent(MoveTemp(Body));
+	if (DecodeThread != EPlayKitDecodeThread::GameThread)
 	{
-		RequestBody->SetNumberField(TEXT("seed"), Options.Seed);
+		// Parse where the request completes; the results are dropped if the request was cancelled or replaced meanwhile
+		TWeakObjectPtr<UPlayKitImageClient> WeakThis(this);
+		TWeakPtr<IHttpRequest, ESPMode::ThreadSafe> WeakRequest(CurrentRequest);
+		CurrentRequest->OnProcessRequestComplete().BindLambda([WeakThis, WeakRequest, Prompt](FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+		{
+			FPlayKitImageOutcome Outcome;
+			PlayKitImage::ParseImageResponse(Response, bWasSuccessful, Prompt, Outcome);
+			FPlayKitGameThreadQueue::Enqueue([WeakThis, WeakRequest, Outcome = MoveTemp(Outcome)]() mutable
+			{
+				UPlayKitImageClient* This = WeakThis.Get();
+				if (This && This->CurrentRequest.IsValid() && This->CurrentRequest == WeakRequest.Pin())
+				{
+					This->FinishImageResponse(Outcome);
+				}
+			});
+		});
 	}
-	
-	if (Options.bTransparent)
+	else
 	{
-		RequestBody->SetBoolField(TEXT("transparent"), true);
+		CurrentRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKitImageClient::HandleImageResponse);
 	}
 
-	// Serialize
-	FString RequestBodyStr;
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&RequestBodyStr);
-	FJsonSerializer::Serialize(RequestBody.ToSharedRef(), Writer);
-
-	CurrentRequest = CreateAuthenticatedRequest(Url);
-	CurrentRequest->SetContentAsString(RequestBodyStr);
-	CurrentRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKitImageClient::HandleImageResponse);
-
 	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Sending image request to: %s"), *Url);
-	CurrentRequest->ProcessRequest();
+	UPlayKitRequestScheduler::ProcessRequest(this, CurrentRequest.ToSharedRef(), EPlayKitEndpoint::Image, EPlayKitRequestPriority::AssetGeneration,
+		true, DecodeThread);
 }
 
-void UPlayKitImageClient::HandleImageResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+void UPlayKitImageClient::BuildRequestBody(const FString& Model, const FString& Prompt, const FPlayKitImageOptions& Options, TArray<uint8>& OutBody)
 {
-	bIsProcessing = false;
-	CurrentRequest.Reset();
-
-	if (!bWasSuccessful || !Response.IsValid())
-	{
-		BroadcastError(TEXT("NETWORK_ERROR"), TEXT("Network request failed"));
-		return;
-	}
+	OutBody.Reset(160 + FPlayKitJsonWriter::EstimateStringSize(Model) + FPlayKitJsonWriter::EstimateStringSize(Prompt)
+		+ FPlayKitJsonWriter::EstimateStringSize(Options.Size));
 
-	int32 ResponseCode = Response->GetResponseCode();
-	FString ResponseContent = Response->GetContentAsString();
+	FPlayKitJsonWriter Writer(OutBody);
+	Writer.BeginObject();
+	Writer.WriteString("model", Model);
+	Writer.WriteString("prompt", Prompt);
+	Writer.WriteNumber("n", FMath::Clamp(Options.Count, 1, 10));
+	Writer.WriteString("size", Options.Size);
+	Writer.WriteString("response_format", TEXT("b64_json"));
 
-	if (ResponseCode < 200 || ResponseCode >= 300)
+	if (Options.Seed >= 0)
 	{
-		UE_LOG(LogTemp, Error, TEXT("[PlayKit] Image error %d: %s"), ResponseCode, *ResponseContent);
-		BroadcastError(FString::FromInt(ResponseCode), ResponseContent);
-		return;
+		Writer.WriteNumber("seed", Options.Seed);
 	}
 
-	// Parse response
-	TSharedPtr<FJsonObject> JsonObject;
-	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ResponseContent);
-	if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
+	if (Options.bTransparent)
 	{
-		BroadcastError(TEXT("PARSE_ERROR"), TEXT("Failed to parse response"));
-		return;
+		Writer.WriteBool("transparent", true);
 	}
 
-	TArray<FPlayKitGeneratedImage> Results;
-	int64 Created = 0;
-	JsonObject->TryGetNumberField(TEXT("created"), Created);
+	Writer.EndObject();
+}
 
-	const TArray<TSharedPtr<FJsonValue>>* DataArray;
-	if (JsonObject->TryGetArrayField(TEXT("data"), DataArray))
-	{
-		for (const TSharedPtr<FJsonValue>& DataValue : *DataArray)
-		{
-			TSharedPtr<FJsonObject> DataObj = DataValue->AsObject();
-			if (DataObj)
-			{
-				FPlayKitGeneratedImage Image;
-				Image.bSuccess = true;
-				Image.OriginalPrompt = LastPrompt;
-				Image.GeneratedAt = FDateTime::FromUnixTimestamp(Created);
+void UPlayKitImageClient::HandleImageResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+{
+	FPlayKitImageOutcome Outcome;
+	PlayKitImage::ParseImageResponse(Response, bWasSuccessful, LastPrompt, Outcome);
+	FinishImageResponse(Outcome);
+}
 
-				DataObj->TryGetStringField(TEXT("b64_json"), Image.ImageBase64);
-				DataObj->TryGetStringField(TEXT("revised_prompt"), Image.RevisedPrompt);
-				DataObj->TryGetStringField(TEXT("b64_json_original"), Image.OriginalImageBase64);
-				DataObj->TryGetBoolField(TEXT("transparent_success"), Image.bTransparentSuccess);
+void UPlayKitImageClient::FinishImageResponse(FPlayKitImageOutcome& Outcome)
+{
+	LLM_SCOPE_BYTAG(PlayKit_Image);
+	bIsProcessing = false;
+	CurrentRequest.Reset();
 
-				Results.Add(Image);
-			}
-		}
+	if (!Outcome.ErrorCode.IsEmpty())
+	{
+		BroadcastError(Outcome.ErrorCode, Outcome.ErrorMessage);
+		return;
 	}
 
+	const TArray<FPlayKitGeneratedImage>& Results = Outcome.Results;
 	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Generated %d images"), Results.Num());
 
+	if (NativePromise.IsValid())
+	{
+		TUniquePtr<TPlayKitPromise<TArray<FPlayKitGeneratedImage>>> Promise = MoveTemp(NativePromise);
+		Promise->SetValue(MoveTemp(Outcome.Results));
+		return;
+	}
+
 	// Broadcast results
 	if (Results.Num() == 1)
 	{
@@ -213,6 +293,7 @@ void UPlayKitImageClient::HandleImageResponse(FHttpRequestPtr Request, FHttpResp
 
 UTexture2D* UPlayKitImageClient::Base64ToTexture2D(const FString& Base64Data)
 {
+	LLM_SCOPE_BYTAG(PlayKit_Image);
 	if (Base64Data.IsEmpty())
 	{
 		UE_LOG(LogTemp, Error, TEXT("[PlayKit] Base64 data is empty"));
@@ -237,19 +318,53 @@ UTexture2D* UPlayKitImageClient::Base64ToTexture2D(const FString& Base64Data)
 	return Texture;
 }
 
+void UPlayKitImageClient::Base64ToTexture2DAsync(const FString& Base64Data, TUniqueFunction<void(UTexture2D*)>&& OnTexture)
+{
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [Base64Data, OnTexture = MoveTemp(OnTexture)]() mutable
+	{
+		LLM_SCOPE_BYTAG(PlayKit_Image);
+		FImage Image;
+		TArray<uint8> DecodedData;
+		const bool bDecoded = !Base64Data.IsEmpty() && FBase64::Decode(Base64Data, DecodedData)
+			&& FImageUtils::DecompressImage(DecodedData.GetData(), DecodedData.Num(), Image);
+
+		FPlayKitGameThreadQueue::Enqueue([Image = MoveTemp(Image), bDecoded, OnTexture = MoveTemp(OnTexture)]() mutable
+		{
+			LLM_SCOPE_BYTAG(PlayKit_Image);
+			UTexture2D* Texture = bDecoded ? FImageUtils::CreateTexture2DFromImage(Image) : nullptr;
+			if (!Texture)
+			{
+				UE_LOG(LogTemp, Error, TEXT("[PlayKit] Failed to create texture from image data"));
+			}
+			OnTexture(Texture);
+		});
+	});
+}
+
 void UPlayKitImageClient::CancelRequest()
 {
 	if (CurrentRequest.IsValid())
 	{
-		CurrentRequest->CancelRequest();
+		UPlayKitRequestScheduler::CancelRequest(this, CurrentRequest);
 		CurrentRequest.Reset();
 	}
 	bIsProcessing = false;
+
+	// Completes the future as cancelled
+	NativePromise.Reset();
 }
 
 void UPlayKitImageClient::BroadcastError(const FString& ErrorCode, const FString& ErrorMessage)
 {
 	UE_LOG(LogTemp, Error, TEXT("[PlayKit] Image error [%s]: %s"), *ErrorCode, *ErrorMessage);
+
+	if (NativePromise.IsValid())
+	{
+		TUniquePtr<TPlayKitPromise<TArray<FPlayKitGeneratedImage>>> Promise = MoveTemp(NativePromise);
+		Promise->SetValue(PlayKitImage::MakeFailedResults(ErrorMessage));
+		return;
+	}
+
 	OnError.Broadcast(ErrorCode, ErrorMessage);
 
 	// Also broadcast a failed image result
@@ -5,10 +5,15 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Interfaces/IHttpRequest.h"
+#include "Async/Future.h"
 #include "Engine/Texture2D.h"
 #include "PlayKitTypes.h"
+#include "Net/PlayKitPromise.h"
+#include "Net/PlayKitRequestScheduler.h"
 #include "PlayKitImageClient.generated.h"
 
+struct FPlayKitImageOutcome;
+
 /**
  * PlayKit Image Client Component
  * Provides AI image generation functionality.
@@ -60,6 +65,10 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|Image")
 	int32 Seed = -1;
 
+	/** Thread that parses responses. Image payloads are large; off the game thread only the parsed results are queued back. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|Image")
+	EPlayKitDecodeThread DecodeThread = EPlayKitDecodeThread::GameThread;
+
 	//========== Events (Click "+" to bind in Blueprint) ==========//
 
 	/** Fired when a single image is generated */
@@ -120,6 +129,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category="PlayKit|Image", meta=(DisplayName="Generate Images (Advanced)"))
 	void GenerateImagesAdvanced(const FString& Prompt, const FPlayKitImageOptions& Options);
 
+	/**
+	 * C++ alternative to GenerateImagesAdvanced: the images complete the returned future
+	 * instead of OnImageGenerated, OnImagesGenerated and OnError, so the Base64 payloads are
+	 * moved to the caller rather than copied through reflection. The future completes on the
+	 * game thread; on failure or cancellation it holds a single image with bSuccess false.
+	 */
+	TFuture<TArray<FPlayKitGeneratedImage>> GenerateImagesAsync(const FString& Prompt, const FPlayKitImageOptions& Options);
+
 	//========== Utility ==========//
 
 	/**
@@ -130,14 +147,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category="PlayKit|Image|Utility", meta=(DisplayName="Base64 to Texture2D"))
 	static UTexture2D* Base64ToTexture2D(const FString& Base64Data);
 
+	/**
+	 * Base64ToTexture2D without the hitch: the data is decoded and decompressed on a worker,
+	 * and only the texture is created on the game thread.
+	 * @param OnTexture Called on the game thread with the texture, or nullptr on failure
+	 */
+	static void Base64ToTexture2DAsync(const FString& Base64Data, TUniqueFunction<void(UTexture2D*)>&& OnTexture);
+
 	/** Cancel any in-progress request */
 	UFUNCTION(BlueprintCallable, Category="PlayKit|Image")
 	void CancelRequest();
 
+	/** Write the image generation request body as UTF-8 JSON into OutBody */
+	static void BuildRequestBody(const FString& Model, const FString& Prompt, const FPlayKitImageOptions& Options, TArray<uint8>& OutBody);
+
 private:
 	void SendImageRequest(const FString& Prompt, const FPlayKitImageOptions& Options);
 	void HandleImageResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
-	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> CreateAuthenticatedRequest(const FString& Url);
+	void FinishImageResponse(FPlayKitImageOutcome& Outcome);
 	void BroadcastError(const FString& ErrorCode, const FString& ErrorMessage);
 
 private:
@@ -145,4 +172,7 @@ private:
 	FString LastPrompt;
 
 	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> CurrentRequest;
+
+	/** Completion of a request started by GenerateImagesAsync; its events are not broadcast while set */
+	TUniquePtr<TPlayKitPromise<TArray<FPlayKitGeneratedImage>>> NativePromise;
 };
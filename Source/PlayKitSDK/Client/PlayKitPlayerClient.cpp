@@ -2,7 +2,8 @@
 
 #include "PlayKitPlayerClient.h"
 #include "PlayKitSettings.h"
-#include "HttpModule.h"
+#include "Net/PlayKitTransport.h"
+#include "Auth/PlayKitCredentials.h"
 #include "Interfaces/IHttpResponse.h"
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
@@ -66,31 +67,25 @@ bool UPlayKitPlayerClient::HasValidToken() const
 
 TSharedRef<IHttpRequest, ESPMode::ThreadSafe> UPlayKitPlayerClient::CreateAuthenticatedRequest(const FString& Url, const FString& Verb)
 {
-	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
-	Request->SetURL(Url);
-	Request->SetVerb(Verb);
-	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
-
+	// Player endpoints prefer the player token over the developer token
+	FString Token;
 	UPlayKitSettings* Settings = UPlayKitSettings::Get();
 	if (Settings)
 	{
-		FString Token = Settings->GetPlayerToken();
+		Token = Settings->GetPlayerToken();
 		if (Token.IsEmpty() && Settings->HasDeveloperToken())
 		{
 			Token = Settings->GetDeveloperToken();
 		}
-		if (!Token.IsEmpty())
-		{
-			Request->SetHeader(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *Token));
-		}
+	}
 
-		// Add X-Game-Id header to support Global Developer Token
-		// When using a Global Developer Token (without game_id), the server needs
-		// to know which game's owner wallet to query
-		if (!Settings->GameId.IsEmpty())
-		{
-			Request->SetHeader(TEXT("X-Game-Id"), Settings->GameId);
-		}
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FPlayKitTransport::CreateRequest(Url, Verb, TEXT("application/json"), Token);
+	// Add X-Game-Id header to support Global Developer Token
+	// When using a Global Developer Token (without game_id), the server needs
+	// to know which game's owner wallet to query
+	if (Settings && !Settings->GameId.IsEmpty())
+	{
+		Request->SetHeader(TEXT("X-Game-Id"), Settings->GameId);
 	}
 
 	return Request;
@@ -326,11 +321,7 @@ void UPlayKitPlayerClient::ExchangeJWT(const FString& JWT)
 
 	FString Url = FString::Printf(TEXT("%s/api/external/exchange-jwt"), *Settings->GetBaseUrl());
 
-	CurrentRequest = FHttpModule::Get().CreateRequest();
-	CurrentRequest->SetURL(Url);
-	CurrentRequest->SetVerb(TEXT("POST"));
-	CurrentRequest->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
-	CurrentRequest->SetHeader(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *JWT));
+	CurrentRequest = FPlayKitTransport::CreateRequest(Url, TEXT("POST"), TEXT("application/json"), JWT);
 	CurrentRequest->SetContentAsString(TEXT("{}"));
 	CurrentRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKitPlayerClient::HandleJWTExchangeResponse);
 
@@ -380,6 +371,9 @@ void UPlayKitPlayerClient::HandleJWTExchangeResponse(FHttpRequestPtr Request, FH
 			Settings->SetPlayerToken(PlayerToken);
 		}
 
+		// Kept to refresh the saved player token with
+		FPlayKitCredentials::SetRefreshJwt(CurrentJWT);
+
 		UE_LOG(LogTemp, Log, TEXT("[PlayKit] Player token received"));
 		OnPlayerTokenReceived.Broadcast(PlayerToken);
 
@@ -1,8 +1,10 @@
 // Copyright PlayKit. All Rights Reserved.
 
 #include "PlayKitSTTClient.h"
+#include "PlayKitMemory.h"
 #include "PlayKitSettings.h"
-#include "HttpModule.h"
+#include "Net/PlayKitRequestScheduler.h"
+#include "Net/PlayKitTransport.h"
 #include "Interfaces/IHttpResponse.h"
 #include "Serialization/JsonReader.h"
 #include "Serialization/JsonSerializer.h"
@@ -41,27 +43,6 @@ void UPlayKitSTTClient::EndPlay(const EEndPlayReason::Type EndPlayReason)
 	Super::EndPlay(EndPlayReason);
 }
 
-TSharedRef<IHttpRequest, ESPMode::ThreadSafe> UPlayKitSTTClient::CreateAuthenticatedRequest(const FString& Url)
-{
-	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
-	Request->SetURL(Url);
-	Request->SetVerb(TEXT("POST"));
-
-	UPlayKitSettings* Settings = UPlayKitSettings::Get();
-	if (Settings)
-	{
-		FString Token = Settings->HasDeveloperToken() && !Settings->bIgnoreDeveloperToken
-			? Settings->GetDeveloperToken()
-			: Settings->GetPlayerToken();
-		if (!Token.IsEmpty())
-		{
-			Request->SetHeader(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *Token));
-		}
-	}
-
-	return Request;
-}
-
 void UPlayKitSTTClient::TranscribeFile(const FString& FilePath)
 {
 	TranscribeFileWithLanguage(FilePath, Language);
@@ -69,6 +50,7 @@ void UPlayKitSTTClient::TranscribeFile(const FString& FilePath)
 
 void UPlayKitSTTClient::TranscribeFileWithLanguage(const FString& FilePath, const FString& InLanguage)
 {
+	LLM_SCOPE_BYTAG(PlayKit_Audio);
 	if (bIsProcessing)
 	{
 		BroadcastError(TEXT("REQUEST_IN_PROGRESS"), TEXT("A request is already in progress"));
@@ -94,6 +76,7 @@ void UPlayKitSTTClient::TranscribeFileWithLanguage(const FString& FilePath, cons
 
 void UPlayKitSTTClient::TranscribeAudioData(const TArray<uint8>& AudioData, const FString& FileName)
 {
+	LLM_SCOPE_BYTAG(PlayKit_Audio);
 	if (bIsProcessing)
 	{
 		BroadcastError(TEXT("REQUEST_IN_PROGRESS"), TEXT("A request is already in progress"));
@@ -109,6 +92,44 @@ void UPlayKitSTTClient::TranscribeAudioData(const TArray<uint8>& AudioData, cons
 	SendTranscriptionRequest(AudioData, FileName, Language);
 }
 
+TFuture<FPlayKitTranscriptionResult> UPlayKitSTTClient::TranscribeFileAsync(const FString& FilePath)
+{
+	TFuture<FPlayKitTranscriptionResult> Future = StartNativeRequest();
+	if (NativePromise.IsValid())
+	{
+		TranscribeFile(FilePath);
+	}
+	return Future;
+}
+
+TFuture<FPlayKitTranscriptionResult> UPlayKitSTTClient::TranscribeAudioDataAsync(const TArray<uint8>& AudioData, const FString& FileName)
+{
+	TFuture<FPlayKitTranscriptionResult> Future = StartNativeRequest();
+	if (NativePromise.IsValid())
+	{
+		TranscribeAudioData(AudioData, FileName);
+	}
+	return Future;
+}
+
+TFuture<FPlayKitTranscriptionResult> UPlayKitSTTClient::StartNativeRequest()
+{
+	FPlayKitTranscriptionResult Failed;
+	Failed.bSuccess = false;
+
+	// Checked here so the request in flight keeps its own promise
+	if (bIsProcessing)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[PlayKit] STT error [REQUEST_IN_PROGRESS]: A request is already in progress"));
+		Failed.ErrorMessage = TEXT("A request is already in progress");
+		return TPlayKitPromise<FPlayKitTranscriptionResult>::MakeFulfilled(MoveTemp(Failed));
+	}
+
+	Failed.ErrorMessage = TEXT("Request cancelled");
+	NativePromise = MakeUnique<TPlayKitPromise<FPlayKitTranscriptionResult>>(MoveTemp(Failed));
+	return NativePromise->GetFuture();
+}
+
 void UPlayKitSTTClient::SendTranscriptionRequest(const TArray<uint8>& AudioData, const FString& FileName, const FString& InLanguage)
 {
 	UPlayKitSettings* Settings = UPlayKitSettings::Get();
@@ -126,67 +147,67 @@ void UPlayKitSTTClient::SendTranscriptionRequest(const TArray<uint8>& AudioData,
 	FString Boundary = FString::Printf(TEXT("----PlayKitBoundary%d"), FMath::RandRange(100000, 999999));
 
 	TArray<uint8> RequestBody;
+	BuildMultipartBody(Boundary, ModelName, InLanguage, AudioData, FileName, RequestBody);
 
-	// Add model field
+	CurrentRequest = FPlayKitTransport::CreateRequest(Url, TEXT("POST"), FString(), FPlayKitTransport::GetAuthToken());
+	CurrentRequest->SetHeader(TEXT("Content-Type"), FString::Printf(TEXT("multipart/form-data; boundary=%s"), *Boundary));
+	CurrentRequest->SetContent(MoveTemp(RequestBody));
+	CurrentRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKitSTTClient::HandleTranscriptionResponse);
+
+	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Sending transcription request to: %s"), *Url);
+	UPlayKitRequestScheduler::ProcessRequest(this, CurrentRequest.ToSharedRef(), EPlayKitEndpoint::Transcription, EPlayKitRequestPriority::PlayerDialogue);
+}
+
+void UPlayKitSTTClient::BuildMultipartBody(const FString& Boundary, const FString& InModelName, const FString& InLanguage,
+	const TArray<uint8>& AudioData, const FString& FileName, TArray<uint8>& OutBody)
+{
+	// Append the UTF-8 bytes of Text; the byte count is the converted length, not the TCHAR count
+	auto AppendText = [&OutBody](const FString& Text)
 	{
-		FString FieldHeader = FString::Printf(TEXT("--%s\r\nContent-Disposition: form-data; name=\"model\"\r\n\r\n%s\r\n"), *Boundary, *ModelName);
-		RequestBody.Append((uint8*)TCHAR_TO_UTF8(*FieldHeader), FieldHeader.Len());
-	}
+		FTCHARToUTF8 Converter(*Text, Text.Len());
+		OutBody.Append(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+	};
+
+	OutBody.Reset(AudioData.Num() + 512);
+
+	// Add model field
+	AppendText(FString::Printf(TEXT("--%s\r\nContent-Disposition: form-data; name=\"model\"\r\n\r\n%s\r\n"), *Boundary, *InModelName));
 
 	// Add language field if specified
 	if (!InLanguage.IsEmpty())
 	{
-		FString FieldHeader = FString::Printf(TEXT("--%s\r\nContent-Disposition: form-data; name=\"language\"\r\n\r\n%s\r\n"), *Boundary, *InLanguage);
-		RequestBody.Append((uint8*)TCHAR_TO_UTF8(*FieldHeader), FieldHeader.Len());
+		AppendText(FString::Printf(TEXT("--%s\r\nContent-Disposition: form-data; name=\"language\"\r\n\r\n%s\r\n"), *Boundary, *InLanguage));
 	}
 
 	// Add response format
-	{
-		FString FieldHeader = FString::Printf(TEXT("--%s\r\nContent-Disposition: form-data; name=\"response_format\"\r\n\r\nverbose_json\r\n"), *Boundary);
-		RequestBody.Append((uint8*)TCHAR_TO_UTF8(*FieldHeader), FieldHeader.Len());
-	}
+	AppendText(FString::Printf(TEXT("--%s\r\nContent-Disposition: form-data; name=\"response_format\"\r\n\r\nverbose_json\r\n"), *Boundary));
 
 	// Add file field
+	const TCHAR* ContentType = TEXT("audio/wav");
+	if (FileName.EndsWith(TEXT(".mp3")))
 	{
-		FString ContentType = TEXT("audio/wav");
-		if (FileName.EndsWith(TEXT(".mp3")))
-		{
-			ContentType = TEXT("audio/mpeg");
-		}
-		else if (FileName.EndsWith(TEXT(".m4a")))
-		{
-			ContentType = TEXT("audio/mp4");
-		}
-		else if (FileName.EndsWith(TEXT(".ogg")))
-		{
-			ContentType = TEXT("audio/ogg");
-		}
-
-		FString FileHeader = FString::Printf(TEXT("--%s\r\nContent-Disposition: form-data; name=\"file\"; filename=\"%s\"\r\nContent-Type: %s\r\n\r\n"), *Boundary, *FileName, *ContentType);
-		RequestBody.Append((uint8*)TCHAR_TO_UTF8(*FileHeader), FileHeader.Len());
-		RequestBody.Append(AudioData);
-
-		FString FileTail = TEXT("\r\n");
-		RequestBody.Append((uint8*)TCHAR_TO_UTF8(*FileTail), FileTail.Len());
+		ContentType = TEXT("audio/mpeg");
 	}
-
-	// Add closing boundary
+	else if (FileName.EndsWith(TEXT(".m4a")))
+	{
+		ContentType = TEXT("audio/mp4");
+	}
+	else if (FileName.EndsWith(TEXT(".ogg")))
 	{
-		FString ClosingBoundary = FString::Printf(TEXT("--%s--\r\n"), *Boundary);
-		RequestBody.Append((uint8*)TCHAR_TO_UTF8(*ClosingBoundary), ClosingBoundary.Len());
+		ContentType = TEXT("audio/ogg");
 	}
 
-	CurrentRequest = CreateAuthenticatedRequest(Url);
-	CurrentRequest->SetHeader(TEXT("Content-Type"), FString::Printf(TEXT("multipart/form-data; boundary=%s"), *Boundary));
-	CurrentRequest->SetContent(RequestBody);
-	CurrentRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKitSTTClient::HandleTranscriptionResponse);
+	AppendText(FString::Printf(TEXT("--%s\r\nContent-Disposition: form-data; name=\"file\"; filename=\"%s\"\r\nContent-Type: %s\r\n\r\n"), *Boundary, *FileName, ContentType));
+	OutBody.Append(AudioData);
+	AppendText(TEXT("\r\n"));
 
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Sending transcription request to: %s"), *Url);
-	CurrentRequest->ProcessRequest();
+	// Add closing boundary
+	AppendText(FString::Printf(TEXT("--%s--\r\n"), *Boundary));
 }
 
 void UPlayKitSTTClient::HandleTranscriptionResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
 {
+	LLM_SCOPE_BYTAG(PlayKit_Audio);
 	bIsProcessing = false;
 	CurrentRequest.Reset();
 
@@ -240,7 +261,13 @@ void UPlayKitSTTClient::HandleTranscriptionResponse(FHttpRequestPtr Request, FHt
 		}
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Transcription complete: %s"), *Result.Text.Left(100));
+	UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Transcription complete: %s"), *Result.Text.Left(100));
+	if (NativePromise.IsValid())
+	{
+		TUniquePtr<TPlayKitPromise<FPlayKitTranscriptionResult>> Promise = MoveTemp(NativePromise);
+		Promise->SetValue(MoveTemp(Result));
+		return;
+	}
 	OnTranscriptionComplete.Broadcast(Result);
 }
 
@@ -248,15 +275,29 @@ void UPlayKitSTTClient::CancelRequest()
 {
 	if (CurrentRequest.IsValid())
 	{
-		CurrentRequest->CancelRequest();
+		UPlayKitRequestScheduler::CancelRequest(this, CurrentRequest);
 		CurrentRequest.Reset();
 	}
 	bIsProcessing = false;
+
+	// Completes the future as cancelled
+	NativePromise.Reset();
 }
 
 void UPlayKitSTTClient::BroadcastError(const FString& ErrorCode, const FString& ErrorMessage)
 {
 	UE_LOG(LogTemp, Error, TEXT("[PlayKit] STT error [%s]: %s"), *ErrorCode, *ErrorMessage);
+
+	if (NativePromise.IsValid())
+	{
+		TUniquePtr<TPlayKitPromise<FPlayKitTranscriptionResult>> Promise = MoveTemp(NativePromise);
+		FPlayKitTranscriptionResult Failed;
+		Failed.bSuccess = false;
+		Failed.ErrorMessage = ErrorMessage;
+		Promise->SetValue(MoveTemp(Failed));
+		return;
+	}
+
 	OnError.Broadcast(ErrorCode, ErrorMessage);
 
 	// Also broadcast a failed result
@@ -5,7 +5,9 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Interfaces/IHttpRequest.h"
+#include "Async/Future.h"
 #include "PlayKitTypes.h"
+#include "Net/PlayKitPromise.h"
 #include "PlayKitSTTClient.generated.h"
 
 /**
@@ -99,18 +101,34 @@ public:
 	UFUNCTION(BlueprintCallable, Category="PlayKit|STT", meta=(DisplayName="Transcribe Audio Data"))
 	void TranscribeAudioData(const TArray<uint8>& AudioData, const FString& FileName = TEXT("audio.wav"));
 
+	// C++ alternatives to TranscribeFile/TranscribeAudioData: the result completes the returned
+	// future instead of OnTranscriptionComplete and OnError. Futures complete on the game thread;
+	// on failure or cancellation bSuccess is false.
+	TFuture<FPlayKitTranscriptionResult> TranscribeFileAsync(const FString& FilePath);
+	TFuture<FPlayKitTranscriptionResult> TranscribeAudioDataAsync(const TArray<uint8>& AudioData, const FString& FileName = TEXT("audio.wav"));
+
 	/** Cancel any in-progress request */
 	UFUNCTION(BlueprintCallable, Category="PlayKit|STT")
 	void CancelRequest();
 
+	/**
+	 * Build the multipart/form-data body of a transcription request.
+	 * Text fields are written as UTF-8, so model, language and file names may be non-ASCII.
+	 */
+	static void BuildMultipartBody(const FString& Boundary, const FString& InModelName, const FString& InLanguage,
+		const TArray<uint8>& AudioData, const FString& FileName, TArray<uint8>& OutBody);
+
 private:
 	void SendTranscriptionRequest(const TArray<uint8>& AudioData, const FString& FileName, const FString& InLanguage);
 	void HandleTranscriptionResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
-	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> CreateAuthenticatedRequest(const FString& Url);
 	void BroadcastError(const FString& ErrorCode, const FString& ErrorMessage);
+	TFuture<FPlayKitTranscriptionResult> StartNativeRequest();
 
 private:
 	bool bIsProcessing = false;
 
 	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> CurrentRequest;
+
+	/** Completion of a request started by one of the Async methods; its events are not broadcast while set */
+	TUniquePtr<TPlayKitPromise<FPlayKitTranscriptionResult>> NativePromise;
 };
@@ -1,7 +1,10 @@
 // Copyright PlayKit. All Rights Reserved.
 
 #include "PlayKitSTTComponent.h"
+#include "PlayKitMemory.h"
 #include "PlayKitSettings.h"
+#include "Net/PlayKitRequestScheduler.h"
+#include "Net/PlayKitTransport.h"
 #include "Misc/Paths.h"
 #include "HAL/FileManager.h"
 #include "Misc/FileHelper.h"
@@ -19,20 +22,6 @@ FString UPlayKitSTTComponent::GetTranscriptionUrl() const
 	return TEXT("https://api.playkit.ai/ai/v2/audio/transcriptions");
 }
 
-FString UPlayKitSTTComponent::GetAuthToken() const
-{
-	UPlayKitSettings* Settings = UPlayKitSettings::Get();
-	if (Settings)
-	{
-		if (Settings->HasDeveloperToken() && !Settings->bIgnoreDeveloperToken)
-		{
-			return Settings->GetDeveloperToken();
-		}
-		return Settings->GetPlayerToken();
-	}
-	return TEXT("");
-}
-
 UPlayKitSTTComponent::UPlayKitSTTComponent()
 {
 	PrimaryComponentTick.bCanEverTick = false;
@@ -70,6 +59,7 @@ void UPlayKitSTTComponent::BeginPlay()
 
 void UPlayKitSTTComponent::StartRecording()
 {
+	LLM_SCOPE_BYTAG(PlayKit_Audio);
 	if (GetWorld())
 	{
 		UE_LOG(LogTemp, Log, TEXT("[STT] StartRecording: World=%s"), *GetWorld()->GetName());
@@ -95,6 +85,7 @@ void UPlayKitSTTComponent::StartRecording()
 
 void UPlayKitSTTComponent::StopRecording()
 {
+	LLM_SCOPE_BYTAG(PlayKit_Audio);
 	UE_LOG(LogTemp, Log, TEXT("[STT] StopRecording called"));
 	FString SaveDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("CaptureSound"));
 	SaveDir = FPaths::ConvertRelativePathToFull(SaveDir);
@@ -144,6 +135,7 @@ void UPlayKitSTTComponent::StartTranscriptionSimple()
 
 void UPlayKitSTTComponent::UploadRecordingJson(const FPlayKitTranscriptionRequest& Request)
 {
+	LLM_SCOPE_BYTAG(PlayKit_Audio);
 	if (LastSavedFilePath.IsEmpty())
 	{
 		OnPlayKitTranscriptionError.Broadcast(TEXT("No recording file"), TEXT("NO_FILE"));
@@ -168,10 +160,10 @@ void UPlayKitSTTComponent::UploadRecordingJson(const FPlayKitTranscriptionReques
 	JsonObject->SetStringField(TEXT("language"), Lang);
 	JsonObject->SetStringField(TEXT("prompt"), Prompt);
 	const FString JsonString = UPlayKitTool::JsonObjectToString(JsonObject);
-	UE_LOG(LogTemp, Log, TEXT("[STT] Request JSON:\n%s"), *UPlayKitTool::JsonObjectToString(JsonObject, true));
+	UE_LOG(LogTemp, Verbose, TEXT("[STT] Request JSON:\n%s"), *UPlayKitTool::JsonObjectToString(JsonObject, true));
 
-	// Get auth token automatically (same as other clients)
-	const FString AuthToken = GetAuthToken();
+	// Same token as every other client, so credential changes reach STT
+	const FString AuthToken = FPlayKitTransport::GetAuthToken();
 	if (AuthToken.IsEmpty())
 	{
 		OnPlayKitTranscriptionError.Broadcast(TEXT("Not authenticated"), TEXT("NOT_AUTHENTICATED"));
@@ -180,19 +172,16 @@ void UPlayKitSTTComponent::UploadRecordingJson(const FPlayKitTranscriptionReques
 	}
 
 	const FString Url = GetTranscriptionUrl();
-	CurrentHttpRequest = FHttpModule::Get().CreateRequest();
-	CurrentHttpRequest->SetURL(Url);
-	CurrentHttpRequest->SetVerb(TEXT("POST"));
-	CurrentHttpRequest->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
-	CurrentHttpRequest->SetHeader(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *AuthToken));
+	CurrentHttpRequest = FPlayKitTransport::CreateRequest(Url, TEXT("POST"), TEXT("application/json"), AuthToken);
 	CurrentHttpRequest->SetContentAsString(JsonString);
 	CurrentHttpRequest->OnProcessRequestComplete().BindUObject(this, &UPlayKitSTTComponent::HandleTranscriptionResponse);
 	UE_LOG(LogTemp, Log, TEXT("[STT] UploadRecordingJson: Request sent to %s"), *Url);
-	CurrentHttpRequest->ProcessRequest();
+	UPlayKitRequestScheduler::ProcessRequest(this, CurrentHttpRequest.ToSharedRef(), EPlayKitEndpoint::Transcription, EPlayKitRequestPriority::PlayerDialogue);
 }
 
 void UPlayKitSTTComponent::HandleTranscriptionResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
 {
+	LLM_SCOPE_BYTAG(PlayKit_Audio);
 	if(!Response.IsValid() || !Request.IsValid())
 	{
 		OnPlayKitTranscriptionError.Broadcast(TEXT("Request failed"), TEXT("REQUEST_FAILED"));
@@ -259,7 +248,7 @@ void UPlayKitSTTComponent::HandleTranscriptionResponse(FHttpRequestPtr Request,
 		return;
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("[STT] Response JSON: %s"), *Response->GetContentAsString());
+	UE_LOG(LogTemp, Verbose, TEXT("[STT] Response JSON: %s"), *Response->GetContentAsString());
 	TSharedPtr<FJsonObject> JsonObject;
 	UPlayKitTool::StringToJsonObject(Response->GetContentAsString(), JsonObject, true);
 
@@ -269,5 +258,5 @@ void UPlayKitSTTComponent::HandleTranscriptionResponse(FHttpRequestPtr Request,
 	Transcription.durationInSeconds = static_cast<float>(JsonObject->GetNumberField(TEXT("durationInSeconds")));
 
 	OnPlayKitTranscriptionResponded.Broadcast(Transcription);
-	UE_LOG(LogTemp, Log, TEXT("[STT] Transcription success: text=\"%s\", language=%s, duration=%.2fs"), *Transcription.text, *Transcription.language, Transcription.durationInSeconds);
+	UE_LOG(LogTemp, Verbose, TEXT("[STT] Transcription success: text=\"%s\", language=%s, duration=%.2fs"), *Transcription.text, *Transcription.language, Transcription.durationInSeconds);
 }
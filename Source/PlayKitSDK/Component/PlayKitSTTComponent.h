@@ -96,7 +96,6 @@ private:
 	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> CurrentHttpRequest;
 
 	FString GetTranscriptionUrl() const;
-	FString GetAuthToken() const;
 	void UploadRecordingJson(const FPlayKitTranscriptionRequest& Request);
 	void HandleTranscriptionResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
 };
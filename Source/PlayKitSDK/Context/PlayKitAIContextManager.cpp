@@ -1,10 +1,27 @@
 // Copyright PlayKit. All Rights Reserved.
 
 #include "PlayKitAIContextManager.h"
+#include "PlayKitMemory.h"
 #include "PlayKitSDK/NPC/PlayKitNPCClient.h"
 #include "Engine/GameInstance.h"
 #include "Engine/World.h"
 #include "TimerManager.h"
+#include "HAL/IConsoleManager.h"
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice CmdPlayKitMemReport(
+	TEXT("PlayKit.MemReport"),
+	TEXT("List the memory held by every PlayKit NPC. Add to [MemReportCommands] in DefaultEngine.ini to include it in memreport."),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (UPlayKitAIContextManager* Manager = UPlayKitAIContextManager::Get(World))
+		{
+			Manager->DumpMemoryFootprint(Ar);
+		}
+		else
+		{
+			Ar.Log(TEXT("PlayKit memory: no game instance"));
+		}
+	}));
 
 void UPlayKitAIContextManager::Initialize(FSubsystemCollectionBase& Collection)
 {
@@ -45,6 +62,7 @@ UPlayKitAIContextManager* UPlayKitAIContextManager::Get(UObject* WorldContextObj
 
 void UPlayKitAIContextManager::SetPlayerDescription(const FString& Description)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	PlayerDescription = Description;
 	OnPlayerDescriptionChanged.Broadcast(Description);
 	UE_LOG(LogTemp, Log, TEXT("[AIContextManager] Player description set"));
@@ -61,6 +79,7 @@ void UPlayKitAIContextManager::ClearPlayerDescription()
 
 void UPlayKitAIContextManager::RegisterNPC(UPlayKitNPCClient* NPC)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	if (!NPC)
 	{
 		return;
@@ -88,6 +107,7 @@ void UPlayKitAIContextManager::UnregisterNPC(UPlayKitNPCClient* NPC)
 
 void UPlayKitAIContextManager::RecordConversation(UPlayKitNPCClient* NPC)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	if (!NPC)
 	{
 		return;
@@ -130,6 +150,70 @@ FNPCConversationState UPlayKitAIContextManager::GetNPCState(UPlayKitNPCClient* N
 	return State ? *State : FNPCConversationState();
 }
 
+//========== Diagnostics ==========//
+
+FPlayKitContextMemoryFootprint UPlayKitAIContextManager::GetMemoryFootprint() const
+{
+	FPlayKitContextMemoryFootprint Footprint;
+	Footprint.ContextBytes = GetContextBytes();
+
+	for (const auto& Pair : NPCStates)
+	{
+		if (Pair.Key && Pair.Value.NPC.IsValid())
+		{
+			const int64 Bytes = Pair.Key->GetMemoryFootprint().TotalBytes;
+			Footprint.BytesPerNPC.Add(Pair.Key, Bytes);
+			Footprint.NPCBytes += Bytes;
+		}
+	}
+
+	Footprint.TotalBytes = Footprint.ContextBytes + Footprint.NPCBytes;
+	return Footprint;
+}
+
+void UPlayKitAIContextManager::DumpMemoryFootprint(FOutputDevice& Ar) const
+{
+	TArray<TPair<UPlayKitNPCClient*, FPlayKitNPCMemoryFootprint>> Rows;
+	int64 Total = GetContextBytes();
+	for (const auto& Pair : NPCStates)
+	{
+		if (Pair.Key && Pair.Value.NPC.IsValid())
+		{
+			Rows.Emplace(Pair.Key, Pair.Key->GetMemoryFootprint());
+			Total += Rows.Last().Value.TotalBytes;
+		}
+	}
+
+	Rows.Sort([](const TPair<UPlayKitNPCClient*, FPlayKitNPCMemoryFootprint>& A, const TPair<UPlayKitNPCClient*, FPlayKitNPCMemoryFootprint>& B)
+	{
+		return A.Value.TotalBytes > B.Value.TotalBytes;
+	});
+
+	Ar.Logf(TEXT("PlayKit memory: %d NPCs, %.1f KB total"), Rows.Num(), Total / 1024.0);
+	Ar.Logf(TEXT("%12s %10s %10s %10s %10s %10s %10s  %s"),
+		TEXT("Total"), TEXT("History"), TEXT("Memories"), TEXT("Prompt"), TEXT("Stream"), TEXT("Requests"), TEXT("Other"), TEXT("NPC"));
+	for (const TPair<UPlayKitNPCClient*, FPlayKitNPCMemoryFootprint>& Row : Rows)
+	{
+		const FPlayKitNPCMemoryFootprint& F = Row.Value;
+		Ar.Logf(TEXT("%12lld %10lld %10lld %10lld %10lld %10lld %10lld  %s"),
+			F.TotalBytes, F.HistoryBytes, F.MemoryBytes, F.PromptCacheBytes, F.StreamBytes, F.RequestBytes, F.OtherBytes,
+			*Row.Key->GetPathName());
+	}
+}
+
+int64 UPlayKitAIContextManager::GetContextBytes() const
+{
+	return PlayerDescription.GetAllocatedSize() + NPCStates.GetAllocatedSize() + FastModel.GetAllocatedSize();
+}
+
+void UPlayKitAIContextManager::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+
+	// NPCs report their own footprint; only count what the manager holds
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(GetContextBytes());
+}
+
 //========== Auto Compaction ==========//
 
 void UPlayKitAIContextManager::EnableAutoCompact(float TimeoutSeconds, int32 MinMessages)
@@ -193,6 +277,7 @@ bool UPlayKitAIContextManager::IsEligibleForCompaction(UPlayKitNPCClient* NPC) c
 
 void UPlayKitAIContextManager::CompactConversation(UPlayKitNPCClient* NPC)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	if (!NPC)
 	{
 		return;
@@ -239,6 +324,7 @@ int32 UPlayKitAIContextManager::CompactAllEligible()
 
 void UPlayKitAIContextManager::CheckAutoCompaction()
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	if (!bAutoCompactEnabled)
 	{
 		return;
@@ -29,6 +29,30 @@ struct FNPCConversationState
 	bool bEligibleForCompaction = false;
 };
 
+/**
+ * Memory held by the context manager and the NPCs it tracks, in bytes
+ */
+USTRUCT(BlueprintType)
+struct FPlayKitContextMemoryFootprint
+{
+	GENERATED_BODY()
+
+	/** The manager's own state: player description and conversation tracking */
+	UPROPERTY(BlueprintReadOnly)
+	int64 ContextBytes = 0;
+
+	/** Sum of the registered NPCs' footprints */
+	UPROPERTY(BlueprintReadOnly)
+	int64 NPCBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 TotalBytes = 0;
+
+	/** Footprint of every registered NPC, see UPlayKitNPCClient::GetMemoryFootprint */
+	UPROPERTY(BlueprintReadOnly)
+	TMap<TObjectPtr<UPlayKitNPCClient>, int64> BytesPerNPC;
+};
+
 // Delegates
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnNPCCompacted, UPlayKitNPCClient*, NPC);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnCompactionFailed, UPlayKitNPCClient*, NPC, FString, ErrorMessage);
@@ -111,6 +135,19 @@ public:
 	UFUNCTION(BlueprintCallable, Category="PlayKit|Context")
 	int32 CompactAllEligible();
 
+	//========== Diagnostics ==========//
+
+	/** Bytes held by the manager and by each registered NPC */
+	UFUNCTION(BlueprintPure, Category="PlayKit|Context")
+	FPlayKitContextMemoryFootprint GetMemoryFootprint() const;
+
+	/** Log the footprint of every registered NPC, largest first */
+	void DumpMemoryFootprint(FOutputDevice& Ar) const;
+
+	//~ Begin UObject Interface
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+	//~ End UObject Interface
+
 public:
 	//========== Events ==========//
 
@@ -144,6 +181,9 @@ public:
 private:
 	void CheckAutoCompaction();
 
+	/** Bytes held by the manager itself, excluding the NPCs */
+	int64 GetContextBytes() const;
+
 private:
 	FString PlayerDescription;
 
@@ -2,12 +2,182 @@
 
 #include "PlayKitNPCClient.h"
 #include "PlayKitSettings.h"
-#include "HttpModule.h"
+#include "PlayKitMemory.h"
+#include "Net/PlayKitTransport.h"
 #include "Interfaces/IHttpResponse.h"
 #include "Dom/JsonObject.h"
 #include "Dom/JsonValue.h"
 #include "Serialization/JsonSerializer.h"
 #include "Tool/PlayKitTool.h"
+#include "Net/PlayKitSSEDecoder.h"
+#include "Net/PlayKitJsonWriter.h"
+#include "Net/PlayKitJsonReader.h"
+#include "Net/PlayKitRequestTrace.h"
+#include "Net/PlayKitGameThreadQueue.h"
+#include "Net/PlayKitHistorySync.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hedged Turns"), STAT_PlayKitHedgesSent, STATGROUP_PlayKit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hedged Turns Won By Hedge"), STAT_PlayKitHedgesWon, STATGROUP_PlayKit);
+
+namespace PlayKitNPC
+{
+	// Initial capacity of the streamed reply; a typical NPC line fits without regrowth
+	constexpr int32 StreamedContentReserve = 1024;
+}
+
+/** Decoding state of one conversation turn, shared with the handlers of its request */
+struct FPlayKitNPCTurn
+{
+	bool bStream = false;
+
+	/** Key of the request's timeline; never dereferenced */
+	const IHttpRequest* TraceRequest = nullptr;
+
+	// Streaming: raw bytes are decoded and dropped every tick, only the reply text is kept
+	FPlayKitSSEDecoder Decoder;
+	TSharedPtr<FPlayKitStreamBodySink, ESPMode::ThreadSafe> Sink;
+	TArray<uint8> Bytes;
+
+	// History sync: messages the server already held when the turn was sent (-1 when not synced),
+	// the messages it holds once the turn succeeds, and the system prompt generation it was built with
+	int32 HistoryBase = -1;
+	int32 HistorySyncCount = 0;
+	int32 HistoryGeneration = 0;
+};
+
+/** Outcome of a turn, decoded on whichever thread its request completed on */
+struct FPlayKitNPCTurnResult
+{
+	FNPCResponse Response;
+
+	/** Set on failure, together with Response.ErrorMessage */
+	FString ErrorCode;
+	FString ErrorMessage;
+
+	/** Stream turns: deltas decoded from the bytes after the last progress tick */
+	TArray<FString> Deltas;
+
+	/** The server could not continue the synced history; the turn is resent in full */
+	bool bHistoryMismatch = false;
+};
+
+namespace PlayKitNPC
+{
+	/** Decode the stream bytes received since the last call into text deltas */
+	static void DecodeStreamDeltas(FPlayKitNPCTurn& Turn, const FHttpResponsePtr& Response, TArray<FString>& OutDeltas)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_PlayKitStreamDecode);
+		auto OnEvent = [&Turn, &OutDeltas](FUtf8StringView Data)
+		{
+			FString ChunkContent;
+			if (FPlayKitSSEDecoder::TryGetTextDelta(Data, ChunkContent))
+			{
+				FPlayKitRequestTrace::MarkToken(Turn.TraceRequest);
+				OutDeltas.Add(MoveTemp(ChunkContent));
+			}
+		};
+
+		if (Turn.Sink.IsValid())
+		{
+			Turn.Sink->Drain(Turn.Bytes);
+			Turn.Decoder.Feed(Turn.Bytes.GetData(), Turn.Bytes.Num(), OnEvent);
+			Turn.Bytes.Reset();
+		}
+		else
+		{
+			// Platform without receive stream support: decode in place, only new bytes
+			Turn.Decoder.ConsumeResponse(Response, OnEvent);
+		}
+	}
+
+	/** Decode the finished request of a turn. Reads only the turn and the response; fires no events. */
+	static void DecodeTurn(FPlayKitNPCTurn& Turn, const FHttpRequestPtr& Request, const FHttpResponsePtr& Response, bool bWasSuccessful,
+		FPlayKitNPCTurnResult& Out)
+	{
+		LLM_SCOPE_BYTAG(PlayKit_NPC);
+		FNPCResponse& NPCResponse = Out.Response;
+
+		if (!bWasSuccessful && FPlayKitRequestTrace::HasTimedOut(Request.Get()))
+		{
+			NPCResponse.bSuccess = false;
+			NPCResponse.ErrorMessage = TEXT("Request timed out");
+			Out.ErrorCode = TEXT("TIMEOUT");
+			Out.ErrorMessage = TEXT("No reply within the request's deadline");
+			return;
+		}
+
+		if (!bWasSuccessful || !Response.IsValid())
+		{
+			NPCResponse.bSuccess = false;
+			NPCResponse.ErrorMessage = TEXT("Network error");
+			Out.ErrorCode = TEXT("NETWORK_ERROR");
+			Out.ErrorMessage = TEXT("Failed to get response");
+			return;
+		}
+
+		const int32 ResponseCode = Response->GetResponseCode();
+		UE_LOG(LogTemp, Verbose, TEXT("[NPCClient] Chat response: HTTP %d"), ResponseCode);
+
+		if (ResponseCode != 200)
+		{
+			// With a receive stream the error body went to the sink instead of the response
+			FString ErrorBody = Response->GetContentAsString();
+			if (Turn.Sink.IsValid())
+			{
+				Turn.Sink->Drain(Turn.Bytes);
+				ErrorBody = FPlayKitSSEDecoder::ToString(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Turn.Bytes.GetData()), Turn.Bytes.Num()));
+			}
+
+			NPCResponse.bSuccess = false;
+			NPCResponse.ErrorMessage = FString::Printf(TEXT("HTTP %d: %s"), ResponseCode, *ErrorBody);
+			Out.ErrorCode = TEXT("HTTP_ERROR");
+			Out.ErrorMessage = NPCResponse.ErrorMessage;
+			Out.bHistoryMismatch = ResponseCode == 409 && Turn.HistoryBase > 0 && ErrorBody.Contains(PlayKitHistorySync::MismatchCode);
+			return;
+		}
+
+		if (Turn.bStream)
+		{
+			// Content was accumulated as deltas arrived; only the tail of the body is left
+			DecodeStreamDeltas(Turn, Response, Out.Deltas);
+			Turn.Decoder.Flush([&Turn, &Out](FUtf8StringView Data)
+			{
+				FString ChunkContent;
+				if (FPlayKitSSEDecoder::TryGetTextDelta(Data, ChunkContent))
+				{
+					FPlayKitRequestTrace::MarkToken(Turn.TraceRequest);
+					Out.Deltas.Add(MoveTemp(ChunkContent));
+				}
+			});
+			NPCResponse.bSuccess = true;
+			return;
+		}
+
+		// Parse non-streaming response
+		FPlayKitChatResponse Completion;
+		bool bParsed;
+		{
+			SCOPE_CYCLE_COUNTER(STAT_PlayKitResponseParse);
+			bParsed = FPlayKitJsonReader::ParseChatCompletion(FPlayKitJsonReader::ToView(Response->GetContent()), Completion);
+		}
+		FPlayKitRequestTrace::SetUsage(Request.Get(), Completion.PromptTokens, Completion.CompletionTokens);
+		if (!bParsed)
+		{
+			NPCResponse.bSuccess = false;
+			NPCResponse.ErrorMessage = TEXT("Failed to parse response");
+			Out.ErrorCode = TEXT("PARSE_ERROR");
+			Out.ErrorMessage = NPCResponse.ErrorMessage;
+			return;
+		}
+
+		NPCResponse.Content = MoveTemp(Completion.Content);
+
+		// Check for tool calls / actions
+		UPlayKitNPCClient::ParseActionCalls(Completion.ToolCalls, NPCResponse.ActionCalls);
+
+		NPCResponse.bSuccess = true;
+	}
+}
 
 UPlayKitNPCClient::UPlayKitNPCClient()
 {
@@ -21,6 +191,7 @@ void UPlayKitNPCClient::BeginPlay()
 
 void UPlayKitNPCClient::Setup(const FString& ModelName)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	UPlayKitSettings* Settings = UPlayKitSettings::Get();
 	if (Settings)
 	{
@@ -67,27 +238,21 @@ FString UPlayKitNPCClient::GetAuthToken() const
 	}
 
 	// Otherwise use SDK token
-	UPlayKitSettings* Settings = UPlayKitSettings::Get();
-	if (Settings)
-	{
-		if (Settings->HasDeveloperToken() && !Settings->bIgnoreDeveloperToken)
-		{
-			return Settings->GetDeveloperToken();
-		}
-		return Settings->GetPlayerToken();
-	}
-	return TEXT("");
+	return FPlayKitTransport::GetAuthToken();
 }
 
 void UPlayKitNPCClient::SetCharacterDesign(const FString& Design)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	CharacterDesign = Design;
+	InvalidateEncodedSystemPrompt();
 }
 
 //========== Memory System ==========//
 
 void UPlayKitNPCClient::SetMemory(const FString& MemoryName, const FString& MemoryContent)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	if (MemoryContent.IsEmpty())
 	{
 		Memories.Remove(MemoryName);
@@ -96,6 +261,7 @@ void UPlayKitNPCClient::SetMemory(const FString& MemoryName, const FString& Memo
 	{
 		Memories.Add(MemoryName, MemoryContent);
 	}
+	InvalidateEncodedSystemPrompt();
 }
 
 FString UPlayKitNPCClient::GetMemory(const FString& MemoryName) const
@@ -114,12 +280,102 @@ TArray<FString> UPlayKitNPCClient::GetMemoryNames() const
 void UPlayKitNPCClient::ClearMemories()
 {
 	Memories.Empty();
+	InvalidateEncodedSystemPrompt();
+}
+
+//========== Diagnostics ==========//
+
+static int64 GetStringMapSize(const TMap<FString, FString>& Map)
+{
+	int64 Bytes = Map.GetAllocatedSize();
+	for (const TPair<FString, FString>& Pair : Map)
+	{
+		Bytes += Pair.Key.GetAllocatedSize() + Pair.Value.GetAllocatedSize();
+	}
+	return Bytes;
+}
+
+/**
+ * Request body plus what has arrived of the reply. A streamed reply is counted through its sink,
+ * which guards its buffer; other response content is only read when the handlers run on the game
+ * thread, since off the game thread the HTTP thread may still be appending to it.
+ */
+static int64 GetRequestSize(const TSharedPtr<IHttpRequest, ESPMode::ThreadSafe>& Request, EPlayKitDecodeThread DecodeThread,
+	const TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe>& Turn = nullptr)
+{
+	if (!Request.IsValid())
+	{
+		return 0;
+	}
+
+	int64 Bytes = Request->GetContent().GetAllocatedSize();
+	if (Turn.IsValid() && Turn->Sink.IsValid())
+	{
+		Bytes += Turn->Sink->GetAllocatedSize();
+	}
+	else if (DecodeThread == EPlayKitDecodeThread::GameThread)
+	{
+		if (FHttpResponsePtr Response = Request->GetResponse())
+		{
+			Bytes += Response->GetContent().GetAllocatedSize();
+		}
+	}
+	return Bytes;
+}
+
+FPlayKitNPCMemoryFootprint UPlayKitNPCClient::GetMemoryFootprint() const
+{
+	FPlayKitNPCMemoryFootprint Footprint;
+
+	Footprint.HistoryBytes = ConversationHistory.GetAllocatedSize();
+	for (const FNPCMessage& Msg : ConversationHistory)
+	{
+		Footprint.HistoryBytes += Msg.Role.GetAllocatedSize() + Msg.Content.GetAllocatedSize();
+	}
+
+	Footprint.MemoryBytes = GetStringMapSize(Memories);
+
+	Footprint.PromptCacheBytes = EncodedHistory.GetAllocatedSize() + EncodedHistoryEnds.GetAllocatedSize()
+		+ EncodedHistoryHashes.GetAllocatedSize() + EncodedSystemPrompt.GetAllocatedSize();
+
+	Footprint.StreamBytes = StreamedContent.GetAllocatedSize() + PendingChunk.GetAllocatedSize();
+	if (CurrentTurn.IsValid())
+	{
+		Footprint.StreamBytes += sizeof(FPlayKitNPCTurn);
+
+		// Off the game thread the decoder belongs to the HTTP thread until the turn ends
+		if (DecodeThread == EPlayKitDecodeThread::GameThread)
+		{
+			Footprint.StreamBytes += CurrentTurn->Decoder.GetAllocatedSize() + CurrentTurn->Bytes.GetAllocatedSize();
+		}
+		if (CurrentTurn->Sink.IsValid())
+		{
+			Footprint.StreamBytes += sizeof(FPlayKitStreamBodySink);
+		}
+	}
+
+	Footprint.RequestBytes = GetRequestSize(CurrentRequest, DecodeThread, CurrentTurn) + GetRequestSize(HedgeRequest, DecodeThread, HedgeTurn)
+		+ GetRequestSize(PredictionsRequest, EPlayKitDecodeThread::GameThread);
+
+	Footprint.OtherBytes = PlayerToken.GetAllocatedSize() + Model.GetAllocatedSize() + CharacterDesign.GetAllocatedSize()
+		+ PendingUserMessage.GetAllocatedSize() + GetStringMapSize(PendingActionResults);
+
+	Footprint.TotalBytes = Footprint.HistoryBytes + Footprint.MemoryBytes + Footprint.PromptCacheBytes
+		+ Footprint.StreamBytes + Footprint.RequestBytes + Footprint.OtherBytes;
+	return Footprint;
+}
+
+void UPlayKitNPCClient::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(GetMemoryFootprint().TotalBytes);
 }
 
 //========== Conversation ==========//
 
 void UPlayKitNPCClient::Talk(const FString& Message)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	if (bIsTalking)
 	{
 		OnError.Broadcast(TEXT("BUSY"), TEXT("NPC is already processing a message"));
@@ -139,6 +395,7 @@ void UPlayKitNPCClient::Talk(const FString& Message)
 
 void UPlayKitNPCClient::TalkStream(const FString& Message)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	if (bIsTalking)
 	{
 		OnError.Broadcast(TEXT("BUSY"), TEXT("NPC is already processing a message"));
@@ -153,24 +410,46 @@ void UPlayKitNPCClient::TalkStream(const FString& Message)
 
 	PendingUserMessage = Message;
 	bIsTalking = true;
-	StreamBuffer.Empty();
+	bIsStreaming = true;
+	StreamedContent.Reset(PlayKitNPC::StreamedContentReserve);
 	SendChatRequest(true);
 }
 
-TSharedRef<IHttpRequest, ESPMode::ThreadSafe> UPlayKitNPCClient::CreateAuthenticatedRequest(const FString& Url)
+TFuture<FNPCResponse> UPlayKitNPCClient::TalkAsync(const FString& Message, TFunction<void(FStringView)> OnDelta)
 {
-	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
-	Request->SetURL(Url);
-	Request->SetVerb(TEXT("POST"));
-	Request->SetHeader(TEXT("Content-Type"), TEXT("application/json"));
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
+	FNPCResponse Failed;
+	Failed.bSuccess = false;
 
-	FString Token = GetAuthToken();
-	if (!Token.IsEmpty())
+	if (bIsTalking)
 	{
-		Request->SetHeader(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *Token));
+		UE_LOG(LogTemp, Warning, TEXT("[NPCClient] TalkAsync rejected: NPC is already processing a message"));
+		Failed.ErrorMessage = TEXT("NPC is already processing a message");
+		return TPlayKitPromise<FNPCResponse>::MakeFulfilled(MoveTemp(Failed));
 	}
 
-	return Request;
+	if (GetAuthToken().IsEmpty())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[NPCClient] TalkAsync rejected: no auth token available"));
+		Failed.ErrorMessage = TEXT("No auth token available");
+		return TPlayKitPromise<FNPCResponse>::MakeFulfilled(MoveTemp(Failed));
+	}
+
+	Failed.ErrorMessage = TEXT("NPC destroyed");
+	NativePromise = MakeUnique<TPlayKitPromise<FNPCResponse>>(MoveTemp(Failed));
+	TFuture<FNPCResponse> Future = NativePromise->GetFuture();
+
+	const bool bStream = (bool)OnDelta;
+	NativeOnDelta = MoveTemp(OnDelta);
+	PendingUserMessage = Message;
+	bIsTalking = true;
+	if (bStream)
+	{
+		bIsStreaming = true;
+		StreamedContent.Reset(PlayKitNPC::StreamedContentReserve);
+	}
+	SendChatRequest(bStream);
+	return Future;
 }
 
 FString UPlayKitNPCClient::BuildSystemPrompt() const
@@ -191,232 +470,509 @@ FString UPlayKitNPCClient::BuildSystemPrompt() const
 }
 
 void UPlayKitNPCClient::SendChatRequest(bool bStream)
+{
+	CancelHedge();
+	bTurnClaimed = false;
+	CurrentTurn = StartTurnRequest(Model, bStream, CurrentRequest);
+
+	if (bStream && bHedgeRequests)
+	{
+		ScheduleHedge();
+	}
+}
+
+TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe> UPlayKitNPCClient::StartTurnRequest(const FString& InModel, bool bStream,
+	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe>& OutRequest)
 {
 	const FString Url = FString::Printf(TEXT("%s/ai/%s/v2/chat"), *GetBaseUrl(), *GetGameId());
-	CurrentRequest = CreateAuthenticatedRequest(Url);
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FPlayKitTransport::CreateRequest(Url, TEXT("POST"), TEXT("application/json"), GetAuthToken());
+	OutRequest = Request;
 
-	// Build messages array
-	TArray<TSharedPtr<FJsonValue>> MessagesArray;
+	TArray<uint8> Body;
+	BuildTurnRequestBody(InModel, PendingUserMessage, bStream, Body);
+	Request->SetContent(MoveTemp(Body));
 
-	// System message
-	FString SystemPrompt = BuildSystemPrompt();
-	if (!SystemPrompt.IsEmpty())
+	TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe> Turn = MakeShared<FPlayKitNPCTurn, ESPMode::ThreadSafe>();
+	Turn->bStream = bStream;
+	Turn->TraceRequest = &Request.Get();
+	if (bUseHistorySync)
 	{
-		TSharedPtr<FJsonObject> SystemMsg = MakeShared<FJsonObject>();
-		SystemMsg->SetStringField(TEXT("role"), TEXT("system"));
-		SystemMsg->SetStringField(TEXT("content"), SystemPrompt);
-		MessagesArray.Add(MakeShared<FJsonValueObject>(SystemMsg));
+		Turn->HistoryBase = FMath::Min(HistorySyncedCount, ConversationHistory.Num());
+		Turn->HistorySyncCount = ConversationHistory.Num() + 1;
+		Turn->HistoryGeneration = HistorySyncGeneration;
 	}
+	if (bStream)
+	{
+		// Keep the SSE body out of the HTTP response; it is decoded and dropped as it arrives
+		TSharedRef<FPlayKitStreamBodySink, ESPMode::ThreadSafe> Sink = MakeShared<FPlayKitStreamBodySink, ESPMode::ThreadSafe>();
+		if (Request->SetResponseBodyReceiveStream(Sink))
+		{
+			Turn->Sink = Sink;
 
-	// History messages
-	for (const FNPCMessage& Msg : ConversationHistory)
+			// A retried request streams its reply from the start: drop what the failed attempt wrote
+			Request->OnRequestWillRetry().BindLambda([Turn](FHttpRequestPtr, FHttpResponsePtr, float)
+			{
+				Turn->Sink->Drain(Turn->Bytes);
+				Turn->Bytes.Reset();
+				Turn->Decoder.Reset();
+			});
+		}
+	}
+
+	if (DecodeThread != EPlayKitDecodeThread::GameThread)
 	{
-		TSharedPtr<FJsonObject> HistoryMsg = MakeShared<FJsonObject>();
-		HistoryMsg->SetStringField(TEXT("role"), Msg.Role);
-		HistoryMsg->SetStringField(TEXT("content"), Msg.Content);
-		MessagesArray.Add(MakeShared<FJsonValueObject>(HistoryMsg));
+		BindOffThreadHandlers(Turn, Request);
 	}
+	else
+	{
+		if (bStream)
+		{
+			Request->OnRequestProgress64().BindUObject(
+				this, &UPlayKitNPCClient::HandleStreamProgress);
+		}
 
-	// Current user message
-	TSharedPtr<FJsonObject> UserMsg = MakeShared<FJsonObject>();
-	UserMsg->SetStringField(TEXT("role"), TEXT("user"));
-	UserMsg->SetStringField(TEXT("content"), PendingUserMessage);
-	MessagesArray.Add(MakeShared<FJsonValueObject>(UserMsg));
+		Request->OnProcessRequestComplete().BindUObject(
+			this, &UPlayKitNPCClient::HandleChatResponse);
+	}
 
-	// Build request body
-	TSharedPtr<FJsonObject> RequestBody = MakeShared<FJsonObject>();
-	RequestBody->SetStringField(TEXT("model"), Model);
-	RequestBody->SetArrayField(TEXT("messages"), MessagesArray);
-	RequestBody->SetNumberField(TEXT("temperature"), Temperature);
-	RequestBody->SetBoolField(TEXT("stream"), bStream);
+	UE_LOG(LogTemp, Log, TEXT("[NPCClient] Sending chat request, stream=%s"), bStream ? TEXT("true") : TEXT("false"));
+	UPlayKitRequestScheduler::ProcessRequest(this, Request, EPlayKitEndpoint::Chat, RequestPriority, false, DecodeThread, Deadlines);
+	return Turn;
+}
 
-	FString JsonString;
-	TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
-	FJsonSerializer::Serialize(RequestBody.ToSharedRef(), Writer);
-	CurrentRequest->SetContentAsString(JsonString);
+void UPlayKitNPCClient::BindOffThreadHandlers(const TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe>& Turn, const TSharedPtr<IHttpRequest, ESPMode::ThreadSafe>& Request)
+{
+	// The handlers own the turn's decoder while the request runs; the game thread only
+	// receives finished deltas and the decoded result. A turn that is no longer current
+	// by the time its result is drained is dropped.
+	TWeakObjectPtr<UPlayKitNPCClient> WeakThis(this);
 
-	if (bStream)
+	if (Turn->bStream)
 	{
-		CurrentRequest->OnRequestProgress64().BindUObject(
-			this, &UPlayKitNPCClient::HandleStreamProgress);
+		Request->OnRequestProgress64().BindLambda([WeakThis, Turn](FHttpRequestPtr InRequest, uint64, uint64)
+		{
+			if (!InRequest.IsValid())
+			{
+				return;
+			}
+
+			TArray<FString> Deltas;
+			PlayKitNPC::DecodeStreamDeltas(*Turn, InRequest->GetResponse(), Deltas);
+			if (Deltas.Num() > 0)
+			{
+				FPlayKitGameThreadQueue::Enqueue([WeakThis, Turn, Deltas = MoveTemp(Deltas)]()
+				{
+					UPlayKitNPCClient* This = WeakThis.Get();
+					if (This && This->ClaimTurn(Turn))
+					{
+						This->ApplyStreamDeltas(Deltas);
+					}
+				});
+			}
+		});
 	}
 
-	CurrentRequest->OnProcessRequestComplete().BindUObject(
-		this, &UPlayKitNPCClient::HandleChatResponse);
+	Request->OnProcessRequestComplete().BindLambda([WeakThis, Turn](FHttpRequestPtr InRequest, FHttpResponsePtr Response, bool bWasSuccessful)
+	{
+		FPlayKitNPCTurnResult Result;
+		PlayKitNPC::DecodeTurn(*Turn, InRequest, Response, bWasSuccessful, Result);
+		FPlayKitGameThreadQueue::Enqueue([WeakThis, Turn, Result = MoveTemp(Result)]() mutable
+		{
+			if (UPlayKitNPCClient* This = WeakThis.Get())
+			{
+				This->FinishTurn(Turn, Result);
+			}
+		});
+	});
+}
 
-	UE_LOG(LogTemp, Log, TEXT("[NPCClient] Sending chat request, stream=%s"), bStream ? TEXT("true") : TEXT("false"));
-	CurrentRequest->ProcessRequest();
+TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe> UPlayKitNPCClient::FindTurn(const IHttpRequest* Request) const
+{
+	if (Request && Request == CurrentRequest.Get())
+	{
+		return CurrentTurn;
+	}
+	if (Request && Request == HedgeRequest.Get())
+	{
+		return HedgeTurn;
+	}
+	return nullptr;
 }
 
-void UPlayKitNPCClient::HandleStreamProgress(FHttpRequestPtr Request, uint64 BytesSent, uint64 BytesReceived)
+//========== Hedging ==========//
+
+void UPlayKitNPCClient::ScheduleHedge()
 {
-	if (!Request.IsValid() || !Request->GetResponse().IsValid())
+	// Too few timed requests to know what a slow one is
+	const double Delay = FPlayKitRequestTrace::GetRecentTimeToFirstToken(EPlayKitEndpoint::Chat, 0.95);
+	if (Delay <= 0.0)
 	{
 		return;
 	}
 
-	FString Content = Request->GetResponse()->GetContentAsString();
-	if (Content.Len() <= StreamBuffer.Len())
+	TWeakObjectPtr<UPlayKitNPCClient> WeakThis(this);
+	TWeakPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe> WeakTurn(CurrentTurn);
+	HedgeTicker = FTSTicker::GetCoreTicker().AddTicker(TEXT("PlayKitNPCHedge"), static_cast<float>(Delay),
+		[WeakThis, WeakTurn](float)
+		{
+			UPlayKitNPCClient* This = WeakThis.Get();
+			if (This && This->CurrentTurn.IsValid() && This->CurrentTurn == WeakTurn.Pin())
+			{
+				This->HedgeTicker.Reset();
+				This->SendHedgeRequest();
+			}
+			return false;
+		});
+}
+
+void UPlayKitNPCClient::SendHedgeRequest()
+{
+	if (bTurnClaimed || HedgeTurn.IsValid() || !CurrentTurn.IsValid())
 	{
 		return;
 	}
 
-	// Get new content
-	FString NewContent = Content.RightChop(StreamBuffer.Len());
-	StreamBuffer = Content;
+	const UPlayKitSettings* Settings = UPlayKitSettings::Get();
+	const FString& HedgeModel = bHedgeWithFastModel && Settings && !Settings->FastModel.IsEmpty() ? Settings->FastModel : Model;
 
-	// Parse SSE format
-	TArray<FString> Lines;
-	NewContent.ParseIntoArray(Lines, TEXT("\n"), true);
+	UE_LOG(LogTemp, Log, TEXT("[NPCClient] No reply yet, hedging the turn with model %s"), *HedgeModel);
+	INC_DWORD_STAT(STAT_PlayKitHedgesSent);
+	HedgeTurn = StartTurnRequest(HedgeModel, CurrentTurn->bStream, HedgeRequest);
+}
 
-	for (const FString& Line : Lines)
+bool UPlayKitNPCClient::ClaimTurn(const TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe>& Turn)
+{
+	if (!Turn.IsValid() || (Turn != CurrentTurn && Turn != HedgeTurn))
 	{
-		if (Line.StartsWith(TEXT("data: ")))
-		{
-			FString Data = Line.RightChop(6);
-			if (Data == TEXT("[DONE]"))
-			{
-				continue;
-			}
+		return false;
+	}
 
-			TSharedPtr<FJsonObject> JsonObject;
-			TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Data);
-			if (FJsonSerializer::Deserialize(Reader, JsonObject))
-			{
-				const TArray<TSharedPtr<FJsonValue>>* Choices;
-				if (JsonObject->TryGetArrayField(TEXT("choices"), Choices) && Choices->Num() > 0)
-				{
-					TSharedPtr<FJsonObject> Choice = (*Choices)[0]->AsObject();
-					const TSharedPtr<FJsonObject>* DeltaPtr;
-					if (Choice->TryGetObjectField(TEXT("delta"), DeltaPtr) && DeltaPtr)
-					{
-						FString ChunkContent;
-						if ((*DeltaPtr)->TryGetStringField(TEXT("content"), ChunkContent))
-						{
-							OnStreamChunk.Broadcast(ChunkContent);
-						}
-					}
-				}
-			}
-		}
+	if (Turn == HedgeTurn)
+	{
+		UE_LOG(LogTemp, Log, TEXT("[NPCClient] Hedge request answered first"));
+		INC_DWORD_STAT(STAT_PlayKitHedgesWon);
+		Swap(CurrentTurn, HedgeTurn);
+		Swap(CurrentRequest, HedgeRequest);
 	}
+
+	// The race is decided: the other request is no longer wanted
+	bTurnClaimed = true;
+	CancelHedge();
+	return true;
 }
 
-void UPlayKitNPCClient::HandleChatResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+void UPlayKitNPCClient::CancelHedge()
 {
-	bIsTalking = false;
+	FTSTicker::GetCoreTicker().RemoveTicker(HedgeTicker);
+	HedgeTicker.Reset();
 
-	FNPCResponse NPCResponse;
+	if (HedgeRequest.IsValid())
+	{
+		UPlayKitRequestScheduler::CancelRequest(this, HedgeRequest);
+	}
+	HedgeRequest.Reset();
+	HedgeTurn.Reset();
+}
 
-	if (!bWasSuccessful || !Response.IsValid())
+void UPlayKitNPCClient::BuildTurnRequestBody(const FString& InModel, const FString& UserMessage, bool bStream, TArray<uint8>& OutBody)
+{
+	if (!bEncodedSystemPromptValid)
 	{
-		NPCResponse.bSuccess = false;
-		NPCResponse.ErrorMessage = TEXT("Network error");
-		OnResponse.Broadcast(NPCResponse);
-		OnError.Broadcast(TEXT("NETWORK_ERROR"), TEXT("Failed to get response"));
+		const FString SystemPrompt = BuildSystemPrompt();
+		if (!SystemPrompt.IsEmpty())
+		{
+			EncodeMessage(EncodedSystemPrompt, TEXT("system"), SystemPrompt);
+		}
+		bEncodedSystemPromptValid = true;
+	}
+
+	SyncEncodedHistory();
+	if (!bUseHistorySync)
+	{
+		BuildChatRequestBodyFromEncoded(InModel, EncodedSystemPrompt, EncodedHistory, UserMessage, Temperature, bStream, OutBody);
 		return;
 	}
 
-	const int32 ResponseCode = Response->GetResponseCode();
-	UE_LOG(LogTemp, Log, TEXT("[NPCClient] Chat response: HTTP %d"), ResponseCode);
+	for (int32 Index = EncodedHistoryHashes.Num(); Index < ConversationHistory.Num(); ++Index)
+	{
+		const FNPCMessage& Msg = ConversationHistory[Index];
+		const uint64 Previous = Index > 0 ? EncodedHistoryHashes[Index - 1] : PlayKitHistorySync::EmptyHash;
+		EncodedHistoryHashes.Add(PlayKitHistorySync::Chain(Previous, Msg.Role, Msg.Content));
+	}
 
-	if (ResponseCode != 200)
+	if (HistorySyncId.IsEmpty())
+	{
+		HistorySyncId = FGuid::NewGuid().ToString(EGuidFormats::DigitsLower);
+	}
+
+	// Only what the server has not seen; the system prompt goes with full uploads
+	PlayKitHistorySync::FHeader History;
+	History.Id = HistorySyncId;
+	History.Base = FMath::Min(HistorySyncedCount, ConversationHistory.Num());
+	History.Hash = History.Base > 0 ? EncodedHistoryHashes[History.Base - 1] : PlayKitHistorySync::EmptyHash;
+
+	const int32 DeltaStart = History.Base > 0 ? EncodedHistoryEnds[History.Base - 1] : 0;
+	BuildChatRequestBodyFromEncoded(InModel, History.Base > 0 ? TConstArrayView<uint8>() : TConstArrayView<uint8>(EncodedSystemPrompt),
+		TConstArrayView<uint8>(EncodedHistory).Slice(DeltaStart, EncodedHistory.Num() - DeltaStart),
+		UserMessage, Temperature, bStream, OutBody, &History);
+}
+
+void UPlayKitNPCClient::SyncEncodedHistory()
+{
+	// History only grows at the end between reverts, so encode just the new tail
+	for (int32 Index = EncodedHistoryEnds.Num(); Index < ConversationHistory.Num(); ++Index)
+	{
+		const FNPCMessage& Msg = ConversationHistory[Index];
+		EncodeMessage(EncodedHistory, Msg.Role, Msg.Content);
+		EncodedHistoryEnds.Add(EncodedHistory.Num());
+	}
+}
+
+void UPlayKitNPCClient::TruncateEncodedHistory()
+{
+	const int32 NumKept = FMath::Min(EncodedHistoryEnds.Num(), ConversationHistory.Num());
+	EncodedHistoryEnds.SetNum(NumKept, EAllowShrinking::No);
+	EncodedHistory.SetNum(NumKept > 0 ? EncodedHistoryEnds.Last() : 0, EAllowShrinking::No);
+	EncodedHistoryHashes.SetNum(FMath::Min(EncodedHistoryHashes.Num(), NumKept), EAllowShrinking::No);
+	HistorySyncedCount = FMath::Min(HistorySyncedCount, ConversationHistory.Num());
+}
+
+void UPlayKitNPCClient::EncodeMessage(TArray<uint8>& Out, const FString& Role, const FString& Content)
+{
+	FPlayKitJsonWriter Writer(Out);
+	Writer.BeginObject();
+	Writer.WriteString("role", Role);
+	Writer.WriteString("content", Content);
+	Writer.EndObject();
+	Out.Add(',');
+}
+
+void UPlayKitNPCClient::BuildChatRequestBody(const FString& InModel, const FString& SystemPrompt, TConstArrayView<FNPCMessage> History,
+	const FString& UserMessage, float InTemperature, bool bStream, TArray<uint8>& OutBody)
+{
+	int32 Estimate = FPlayKitJsonWriter::EstimateStringSize(SystemPrompt);
+	for (const FNPCMessage& Msg : History)
+	{
+		Estimate += 32 + FPlayKitJsonWriter::EstimateStringSize(Msg.Content);
+	}
+
+	TArray<uint8> EncodedMessages;
+	EncodedMessages.Reserve(Estimate);
+	if (!SystemPrompt.IsEmpty())
+	{
+		EncodeMessage(EncodedMessages, TEXT("system"), SystemPrompt);
+	}
+	for (const FNPCMessage& Msg : History)
+	{
+		EncodeMessage(EncodedMessages, Msg.Role, Msg.Content);
+	}
+
+	BuildChatRequestBodyFromEncoded(InModel, EncodedMessages, TConstArrayView<uint8>(), UserMessage, InTemperature, bStream, OutBody);
+}
+
+void UPlayKitNPCClient::BuildChatRequestBodyFromEncoded(const FString& InModel, TConstArrayView<uint8> EncodedMessages, TConstArrayView<uint8> EncodedHistory,
+	const FString& UserMessage, float InTemperature, bool bStream, TArray<uint8>& OutBody, const PlayKitHistorySync::FHeader* History)
+{
+	OutBody.Reset(128 + FPlayKitJsonWriter::EstimateStringSize(InModel) + EncodedMessages.Num() + EncodedHistory.Num()
+		+ FPlayKitJsonWriter::EstimateStringSize(UserMessage));
+
+	FPlayKitJsonWriter Writer(OutBody);
+	Writer.BeginObject();
+	Writer.WriteString("model", InModel);
+
+	// System and history messages are pre-encoded, each followed by a comma
+	Writer.BeginArray("messages");
+	OutBody.Append(EncodedMessages.GetData(), EncodedMessages.Num());
+	OutBody.Append(EncodedHistory.GetData(), EncodedHistory.Num());
+
+	// Current user message
+	Writer.BeginObject();
+	Writer.WriteString("role", TEXT("user"));
+	Writer.WriteString("content", UserMessage);
+	Writer.EndObject();
+
+	Writer.EndArray();
+
+	Writer.WriteNumber("temperature", InTemperature);
+	Writer.WriteBool("stream", bStream);
+
+	if (History)
+	{
+		Writer.BeginObject("history");
+		Writer.WriteString("id", History->Id);
+		Writer.WriteNumber("base", History->Base);
+		Writer.WriteString("hash", PlayKitHistorySync::ToString(History->Hash));
+		Writer.EndObject();
+	}
+	Writer.EndObject();
+}
+
+void UPlayKitNPCClient::HandleStreamProgress(FHttpRequestPtr Request, uint64 BytesSent, uint64 BytesReceived)
+{
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
+	const TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe> Turn = FindTurn(Request.Get());
+	if (!Request.IsValid() || !bIsStreaming || !Turn.IsValid())
 	{
-		NPCResponse.bSuccess = false;
-		NPCResponse.ErrorMessage = FString::Printf(TEXT("HTTP %d: %s"), ResponseCode, *Response->GetContentAsString());
-		OnResponse.Broadcast(NPCResponse);
-		OnError.Broadcast(TEXT("HTTP_ERROR"), NPCResponse.ErrorMessage);
 		return;
 	}
 
-	// For streaming, extract full content from buffer
-	if (!StreamBuffer.IsEmpty())
+	TArray<FString> Deltas;
+	PlayKitNPC::DecodeStreamDeltas(*Turn, Request->GetResponse(), Deltas);
+	if (Deltas.Num() > 0 && ClaimTurn(Turn))
 	{
-		// Parse final content from stream
-		FString FullContent;
-		TArray<FString> Lines;
-		StreamBuffer.ParseIntoArray(Lines, TEXT("\n"), true);
+		ApplyStreamDeltas(Deltas);
+	}
+}
 
-		for (const FString& Line : Lines)
+void UPlayKitNPCClient::ApplyStreamDeltas(TArrayView<const FString> Deltas)
+{
+	// Native callbacks cost no reflection, so they are never merged
+	if (NativePromise.IsValid())
+	{
+		for (const FString& ChunkContent : Deltas)
 		{
-			if (Line.StartsWith(TEXT("data: ")))
+			StreamedContent += ChunkContent;
+			if (NativeOnDelta)
 			{
-				FString Data = Line.RightChop(6);
-				if (Data == TEXT("[DONE]"))
-				{
-					continue;
-				}
-
-				TSharedPtr<FJsonObject> JsonObject;
-				TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Data);
-				if (FJsonSerializer::Deserialize(Reader, JsonObject))
-				{
-					const TArray<TSharedPtr<FJsonValue>>* Choices;
-					if (JsonObject->TryGetArrayField(TEXT("choices"), Choices) && Choices->Num() > 0)
-					{
-						TSharedPtr<FJsonObject> Choice = (*Choices)[0]->AsObject();
-						const TSharedPtr<FJsonObject>* DeltaPtr;
-						if (Choice->TryGetObjectField(TEXT("delta"), DeltaPtr) && DeltaPtr)
-						{
-							FString ChunkContent;
-							if ((*DeltaPtr)->TryGetStringField(TEXT("content"), ChunkContent))
-							{
-								FullContent += ChunkContent;
-							}
-						}
-					}
-				}
+				NativeOnDelta(ChunkContent);
 			}
 		}
+		return;
+	}
 
-		NPCResponse.bSuccess = true;
-		NPCResponse.Content = FullContent;
+	const bool bPerFrame = ChunkDelivery == EPlayKitChunkDelivery::PerFrame;
+	for (const FString& ChunkContent : Deltas)
+	{
+		StreamedContent += ChunkContent;
+		if (bPerFrame)
+		{
+			PendingChunk += ChunkContent;
+		}
+		else
+		{
+			OnStreamChunk.Broadcast(ChunkContent);
+		}
+	}
 
-		// Add to history
-		ConversationHistory.Add(FNPCMessage(TEXT("user"), PendingUserMessage));
-		ConversationHistory.Add(FNPCMessage(TEXT("assistant"), FullContent));
+	if (!PendingChunk.IsEmpty())
+	{
+		FPlayKitStreamChunkDispatcher::Schedule(this, this);
+	}
+}
 
-		OnStreamComplete.Broadcast(FullContent);
-		OnResponse.Broadcast(NPCResponse);
-		StreamBuffer.Empty();
+void UPlayKitNPCClient::FlushPendingChunk()
+{
+	if (!PendingChunk.IsEmpty())
+	{
+		const FString Chunk = MoveTemp(PendingChunk);
+		PendingChunk.Reset();
+		OnStreamChunk.Broadcast(Chunk);
 	}
-	else
+}
+
+int32 UPlayKitNPCClient::BroadcastPendingChunks(int32 MaxBroadcasts)
+{
+	if (PendingChunk.IsEmpty() || MaxBroadcasts <= 0)
 	{
-		// Parse non-streaming response
-		TSharedPtr<FJsonObject> JsonObject;
-		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Response->GetContentAsString());
-		if (!FJsonSerializer::Deserialize(Reader, JsonObject))
-		{
-			NPCResponse.bSuccess = false;
-			NPCResponse.ErrorMessage = TEXT("Failed to parse response");
-			OnResponse.Broadcast(NPCResponse);
-			OnError.Broadcast(TEXT("PARSE_ERROR"), NPCResponse.ErrorMessage);
-			return;
-		}
+		return 0;
+	}
 
-		// Extract content
-		const TArray<TSharedPtr<FJsonValue>>* Choices;
-		if (JsonObject->TryGetArrayField(TEXT("choices"), Choices) && Choices->Num() > 0)
+	FlushPendingChunk();
+	return 1;
+}
+
+void UPlayKitNPCClient::HandleChatResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+{
+	const TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe> Turn = FindTurn(Request.Get());
+	if (!Turn.IsValid())
+	{
+		return;
+	}
+
+	FPlayKitNPCTurnResult Result;
+	PlayKitNPC::DecodeTurn(*Turn, Request, Response, bWasSuccessful, Result);
+	FinishTurn(Turn, Result);
+}
+
+void UPlayKitNPCClient::FinishTurn(const TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe>& Turn, FPlayKitNPCTurnResult& Result)
+{
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
+	if (!Turn.IsValid() || (Turn != CurrentTurn && Turn != HedgeTurn))
+	{
+		return;
+	}
+
+	if (HedgeTurn.IsValid())
+	{
+		if (!Result.ErrorCode.IsEmpty())
 		{
-			TSharedPtr<FJsonObject> Choice = (*Choices)[0]->AsObject();
-			const TSharedPtr<FJsonObject>* MessagePtr;
-			if (Choice->TryGetObjectField(TEXT("message"), MessagePtr) && MessagePtr)
+			// The other request of the hedged turn may still answer
+			UE_LOG(LogTemp, Log, TEXT("[NPCClient] Hedged request failed [%s], waiting for the other"), *Result.ErrorCode);
+			if (Turn == CurrentTurn)
 			{
-				(*MessagePtr)->TryGetStringField(TEXT("content"), NPCResponse.Content);
-
-				// Check for tool calls / actions
-				const TArray<TSharedPtr<FJsonValue>>* ToolCalls;
-				if ((*MessagePtr)->TryGetArrayField(TEXT("tool_calls"), ToolCalls))
-				{
-					ParseActionCalls(*MessagePtr, NPCResponse.ActionCalls);
-				}
+				CurrentTurn = MoveTemp(HedgeTurn);
+				CurrentRequest = MoveTemp(HedgeRequest);
 			}
+			HedgeTurn.Reset();
+			HedgeRequest.Reset();
+			return;
 		}
+		ClaimTurn(Turn);
+	}
+	CancelHedge();
 
-		NPCResponse.bSuccess = true;
+	if (Result.bHistoryMismatch)
+	{
+		// The server no longer holds the history the turn built on: send the whole conversation
+		UE_LOG(LogTemp, Log, TEXT("[NPCClient] History out of sync at %d messages, resending in full"), Turn->HistoryBase);
+		HistorySyncedCount = 0;
+		SendChatRequest(Turn->bStream);
+		return;
+	}
+	// A system prompt changed mid-turn stays unsynced, so the next turn uploads it in full
+	if (Result.ErrorCode.IsEmpty() && Turn->HistoryBase >= 0 && Turn->HistoryGeneration == HistorySyncGeneration)
+	{
+		HistorySyncedCount = Turn->HistorySyncCount;
+	}
+
+	CurrentTurn.Reset();
+	bIsTalking = false;
+	bIsStreaming = false;
+
+	// Text merged for the next frame goes out before the turn ends
+	FlushPendingChunk();
+
+	FNPCResponse& NPCResponse = Result.Response;
+	if (NativePromise.IsValid())
+	{
+		FinishNativeTurn(*Turn, Result);
+		return;
+	}
+
+	if (!Result.ErrorCode.IsEmpty())
+	{
+		OnResponse.Broadcast(NPCResponse);
+		OnError.Broadcast(Result.ErrorCode, Result.ErrorMessage);
+		return;
+	}
+
+	if (Turn->bStream)
+	{
+		ApplyStreamDeltas(Result.Deltas);
+		FlushPendingChunk();
+		NPCResponse.Content = StreamedContent;
 
 		// Add to history
-		ConversationHistory.Add(FNPCMessage(TEXT("user"), PendingUserMessage));
+		ConversationHistory.Add(FNPCMessage(TEXT("user"), MoveTemp(PendingUserMessage)));
+		ConversationHistory.Add(FNPCMessage(TEXT("assistant"), MoveTemp(StreamedContent)));
+
+		OnStreamComplete.Broadcast(NPCResponse.Content);
+		OnResponse.Broadcast(NPCResponse);
+	}
+	else
+	{
+		// Add to history
+		ConversationHistory.Add(FNPCMessage(TEXT("user"), MoveTemp(PendingUserMessage)));
 		ConversationHistory.Add(FNPCMessage(TEXT("assistant"), NPCResponse.Content));
 
 		// Broadcast action triggers
@@ -435,43 +991,66 @@ void UPlayKitNPCClient::HandleChatResponse(FHttpRequestPtr Request, FHttpRespons
 	}
 }
 
-void UPlayKitNPCClient::ParseActionCalls(const TSharedPtr<FJsonObject>& JsonObject, TArray<FNPCActionCall>& OutActionCalls)
+void UPlayKitNPCClient::FinishNativeTurn(const FPlayKitNPCTurn& Turn, FPlayKitNPCTurnResult& Result)
 {
-	const TArray<TSharedPtr<FJsonValue>>* ToolCalls;
-	if (!JsonObject->TryGetArrayField(TEXT("tool_calls"), ToolCalls))
+	// Taken first: the continuation may start the next turn
+	TUniquePtr<TPlayKitPromise<FNPCResponse>> Promise = MoveTemp(NativePromise);
+	FNPCResponse& NPCResponse = Result.Response;
+	const bool bSuccess = Result.ErrorCode.IsEmpty();
+
+	if (!bSuccess)
 	{
-		return;
+		UE_LOG(LogTemp, Error, TEXT("[NPCClient] Error [%s]: %s"), *Result.ErrorCode, *Result.ErrorMessage);
 	}
-
-	for (const TSharedPtr<FJsonValue>& ToolCallValue : *ToolCalls)
+	else
 	{
-		TSharedPtr<FJsonObject> ToolCall = ToolCallValue->AsObject();
-		if (!ToolCall.IsValid())
+		if (Turn.bStream)
 		{
-			continue;
+			ApplyStreamDeltas(Result.Deltas);
+			NPCResponse.Content = MoveTemp(StreamedContent);
 		}
 
-		FNPCActionCall ActionCall;
-		ActionCall.CallId = ToolCall->GetStringField(TEXT("id"));
+		// Add to history
+		ConversationHistory.Add(FNPCMessage(TEXT("user"), MoveTemp(PendingUserMessage)));
+		ConversationHistory.Add(FNPCMessage(TEXT("assistant"), NPCResponse.Content));
+	}
+
+	NativeOnDelta = nullptr;
+	Promise->SetValue(MoveTemp(NPCResponse));
+
+	// Auto-generate predictions if enabled
+	if (bSuccess && bAutoGenerateReplyPredictions)
+	{
+		GenerateReplyPredictions(PredictionCount);
+	}
+}
 
-		const TSharedPtr<FJsonObject>* FunctionPtr;
-		if (ToolCall->TryGetObjectField(TEXT("function"), FunctionPtr) && FunctionPtr)
+void UPlayKitNPCClient::ParseActionCalls(const TArray<FPlayKitToolCall>& ToolCalls, TArray<FNPCActionCall>& OutActionCalls)
+{
+	for (const FPlayKitToolCall& ToolCall : ToolCalls)
+	{
+		FNPCActionCall& ActionCall = OutActionCalls.AddDefaulted_GetRef();
+		ActionCall.CallId = ToolCall.Id;
+		ActionCall.ActionName = ToolCall.FunctionName;
+
+		// Arguments arrive as a JSON object encoded in a string; flatten its members to strings
+		const FTCHARToUTF8 Arguments(*ToolCall.FunctionArguments, ToolCall.FunctionArguments.Len());
+		FPlayKitJsonReader Reader(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Arguments.Get()), Arguments.Length()));
+		if (Reader.PeekType() != EPlayKitJsonType::Object)
 		{
-			ActionCall.ActionName = (*FunctionPtr)->GetStringField(TEXT("name"));
+			continue;
+		}
 
-			FString ArgumentsStr = (*FunctionPtr)->GetStringField(TEXT("arguments"));
-			TSharedPtr<FJsonObject> Arguments;
-			TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ArgumentsStr);
-			if (FJsonSerializer::Deserialize(Reader, Arguments))
+		FUtf8StringView Key;
+		Reader.BeginObject();
+		while (Reader.NextMember(Key))
+		{
+			FString Value;
+			if (Reader.ReadScalarAsString(Value))
 			{
-				for (const auto& Pair : Arguments->Values)
-				{
-					ActionCall.Parameters.Add(Pair.Key, Pair.Value->AsString());
-				}
+				ActionCall.Parameters.Add(FPlayKitSSEDecoder::ToString(Key), MoveTemp(Value));
 			}
 		}
-
-		OutActionCalls.Add(ActionCall);
 	}
 }
 
@@ -480,6 +1059,7 @@ void UPlayKitNPCClient::ParseActionCalls(const TSharedPtr<FJsonObject>& JsonObje
 void UPlayKitNPCClient::ClearHistory()
 {
 	ConversationHistory.Empty();
+	TruncateEncodedHistory();
 }
 
 bool UPlayKitNPCClient::RevertHistory()
@@ -489,6 +1069,7 @@ bool UPlayKitNPCClient::RevertHistory()
 	{
 		ConversationHistory.RemoveAt(ConversationHistory.Num() - 1);
 		ConversationHistory.RemoveAt(ConversationHistory.Num() - 1);
+		TruncateEncodedHistory();
 		return true;
 	}
 	return false;
@@ -501,16 +1082,19 @@ int32 UPlayKitNPCClient::RevertChatMessages(int32 Count)
 	{
 		ConversationHistory.RemoveAt(ConversationHistory.Num() - 1);
 	}
+	TruncateEncodedHistory();
 	return Removed;
 }
 
 void UPlayKitNPCClient::AppendChatMessage(const FString& Role, const FString& Content)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	ConversationHistory.Add(FNPCMessage(Role, Content));
 }
 
 FString UPlayKitNPCClient::SaveHistory() const
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	TArray<TSharedPtr<FJsonValue>> HistoryArray;
 
 	for (const FNPCMessage& Msg : ConversationHistory)
@@ -538,6 +1122,7 @@ FString UPlayKitNPCClient::SaveHistory() const
 
 bool UPlayKitNPCClient::LoadHistory(const FString& SaveData)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	TSharedPtr<FJsonObject> SaveObj;
 	if (!UPlayKitTool::StringToJsonObject(SaveData, SaveObj, true))
 	{
@@ -546,6 +1131,8 @@ bool UPlayKitNPCClient::LoadHistory(const FString& SaveData)
 
 	// Load history
 	ConversationHistory.Empty();
+	TruncateEncodedHistory();
+	InvalidateEncodedSystemPrompt();
 	const TArray<TSharedPtr<FJsonValue>>* HistoryArray;
 	if (SaveObj->TryGetArrayField(TEXT("history"), HistoryArray))
 	{
@@ -583,11 +1170,13 @@ bool UPlayKitNPCClient::LoadHistory(const FString& SaveData)
 
 void UPlayKitNPCClient::ReportActionResult(const FString& CallId, const FString& Result)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	PendingActionResults.Add(CallId, Result);
 }
 
 void UPlayKitNPCClient::ReportActionResults(const TMap<FString, FString>& Results)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	for (const auto& Pair : Results)
 	{
 		PendingActionResults.Add(Pair.Key, Pair.Value);
@@ -598,6 +1187,7 @@ void UPlayKitNPCClient::ReportActionResults(const TMap<FString, FString>& Result
 
 void UPlayKitNPCClient::GenerateReplyPredictions(int32 Count)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	if (GetAuthToken().IsEmpty())
 	{
 		OnError.Broadcast(TEXT("NOT_AUTHENTICATED"), TEXT("No auth token available"));
@@ -619,7 +1209,7 @@ void UPlayKitNPCClient::GenerateReplyPredictions(int32 Count)
 	}
 
 	const FString Url = FString::Printf(TEXT("%s/ai/%s/v2/chat"), *GetBaseUrl(), *GetGameId());
-	PredictionsRequest = CreateAuthenticatedRequest(Url);
+	PredictionsRequest = FPlayKitTransport::CreateRequest(Url, TEXT("POST"), TEXT("application/json"), GetAuthToken());
 
 	// Build the prompt with detailed context (aligned with Unity SDK)
 	FString RecentHistory = BuildRecentHistoryString();
@@ -665,11 +1255,12 @@ void UPlayKitNPCClient::GenerateReplyPredictions(int32 Count)
 		this, &UPlayKitNPCClient::HandlePredictionsResponse);
 
 	UE_LOG(LogTemp, Log, TEXT("[NPCClient] Generating %d predictions using model: %s"), Count, *FastModelName);
-	PredictionsRequest->ProcessRequest();
+	UPlayKitRequestScheduler::ProcessRequest(this, PredictionsRequest.ToSharedRef(), EPlayKitEndpoint::Chat, EPlayKitRequestPriority::Prediction, true);
 }
 
 void UPlayKitNPCClient::HandlePredictionsResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
 {
+	LLM_SCOPE_BYTAG(PlayKit_NPC);
 	if (!bWasSuccessful || !Response.IsValid() || Response->GetResponseCode() != 200)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("[NPCClient] Failed to generate predictions: HTTP error"));
@@ -677,37 +1268,27 @@ void UPlayKitNPCClient::HandlePredictionsResponse(FHttpRequestPtr Request, FHttp
 		return;
 	}
 
-	TSharedPtr<FJsonObject> JsonObject;
-	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Response->GetContentAsString());
-	if (!FJsonSerializer::Deserialize(Reader, JsonObject))
+	FPlayKitChatResponse Completion;
+	if (!FPlayKitJsonReader::ParseChatCompletion(FPlayKitJsonReader::ToView(Response->GetContent()), Completion))
 	{
 		UE_LOG(LogTemp, Warning, TEXT("[NPCClient] Failed to parse predictions response JSON"));
 		OnError.Broadcast(TEXT("PARSE_ERROR"), TEXT("Failed to parse predictions response"));
 		return;
 	}
+	FPlayKitRequestTrace::SetUsage(Request.Get(), Completion.PromptTokens, Completion.CompletionTokens);
 
 	TArray<FString> Predictions;
 
-	const TArray<TSharedPtr<FJsonValue>>* Choices;
-	if (JsonObject->TryGetArrayField(TEXT("choices"), Choices) && Choices->Num() > 0)
+	if (!Completion.Content.IsEmpty())
 	{
-		TSharedPtr<FJsonObject> Choice = (*Choices)[0]->AsObject();
-		const TSharedPtr<FJsonObject>* MessagePtr;
-		if (Choice->TryGetObjectField(TEXT("message"), MessagePtr) && MessagePtr)
-		{
-			FString Content;
-			if ((*MessagePtr)->TryGetStringField(TEXT("content"), Content))
-			{
-				// Primary: Try to parse as JSON array
-				Predictions = ParsePredictionsFromJson(Content);
+		// Primary: Try to parse as JSON array
+		Predictions = ParsePredictionsFromJson(Completion.Content);
 
-				// Fallback: If JSON parsing failed or returned empty, try text extraction
-				if (Predictions.Num() == 0)
-				{
-					UE_LOG(LogTemp, Log, TEXT("[NPCClient] JSON parsing failed, trying text extraction fallback"));
-					Predictions = ExtractPredictionsFromText(Content, PredictionCount);
-				}
-			}
+		// Fallback: If JSON parsing failed or returned empty, try text extraction
+		if (Predictions.Num() == 0)
+		{
+			UE_LOG(LogTemp, Log, TEXT("[NPCClient] JSON parsing failed, trying text extraction fallback"));
+			Predictions = ExtractPredictionsFromText(Completion.Content, PredictionCount);
 		}
 	}
 
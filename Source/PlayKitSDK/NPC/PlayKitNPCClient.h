@@ -5,8 +5,19 @@
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
 #include "Interfaces/IHttpRequest.h"
+#include "Async/Future.h"
+#include "Containers/Ticker.h"
+#include "Net/PlayKitSSEDecoder.h"
+#include "Net/PlayKitPromise.h"
+#include "Net/PlayKitRequestScheduler.h"
+#include "Net/PlayKitStreamChunkDispatcher.h"
 #include "PlayKitNPCClient.generated.h"
 
+struct FPlayKitToolCall;
+struct FPlayKitNPCTurn;
+struct FPlayKitNPCTurnResult;
+namespace PlayKitHistorySync { struct FHeader; }
+
 /**
  * NPC Message Structure
  */
@@ -23,6 +34,7 @@ struct FNPCMessage
 
 	FNPCMessage() {}
 	FNPCMessage(const FString& InRole, const FString& InContent) : Role(InRole), Content(InContent) {}
+	FNPCMessage(const FString& InRole, FString&& InContent) : Role(InRole), Content(MoveTemp(InContent)) {}
 };
 
 /**
@@ -64,6 +76,43 @@ struct FNPCResponse
 	FString ErrorMessage;
 };
 
+/**
+ * Heap memory held by one NPC client, in bytes.
+ * Allocated sizes (including slack) of the data the component owns; the component object itself is not included.
+ */
+USTRUCT(BlueprintType)
+struct FPlayKitNPCMemoryFootprint
+{
+	GENERATED_BODY()
+
+	/** Conversation history */
+	UPROPERTY(BlueprintReadOnly)
+	int64 HistoryBytes = 0;
+
+	/** Named memories */
+	UPROPERTY(BlueprintReadOnly)
+	int64 MemoryBytes = 0;
+
+	/** Encoded system prompt and history kept to build request bodies */
+	UPROPERTY(BlueprintReadOnly)
+	int64 PromptCacheBytes = 0;
+
+	/** Stream decoder, decode buffers and the reply being streamed */
+	UPROPERTY(BlueprintReadOnly)
+	int64 StreamBytes = 0;
+
+	/** Bodies of the requests in flight and their responses, streamed bytes not yet decoded included */
+	UPROPERTY(BlueprintReadOnly)
+	int64 RequestBytes = 0;
+
+	/** Character design, pending message and action results */
+	UPROPERTY(BlueprintReadOnly)
+	int64 OtherBytes = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int64 TotalBytes = 0;
+};
+
 /**
  * Memory Entry Structure
  */
@@ -92,7 +141,7 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnNPCError, FString, ErrorCode, FS
  * Manages NPC conversations with memory, actions, and history
  */
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
-class PLAYKITSDK_API UPlayKitNPCClient : public UActorComponent
+class PLAYKITSDK_API UPlayKitNPCClient : public UActorComponent, public IPlayKitStreamChunkSource
 {
 	GENERATED_BODY()
 
@@ -144,6 +193,21 @@ public:
 	UFUNCTION(BlueprintCallable, Category="PlayKit|NPC|Memory")
 	void ClearMemories();
 
+	//========== Diagnostics ==========//
+
+	/** Bytes held by this NPC (history, memories, caches, buffers). Also reported to memreport's obj list. */
+	UFUNCTION(BlueprintPure, Category="PlayKit|NPC|Diagnostics")
+	FPlayKitNPCMemoryFootprint GetMemoryFootprint() const;
+
+	//~ Begin UObject Interface
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
+	//~ End UObject Interface
+
+	//~ Begin IPlayKitStreamChunkSource Interface
+	virtual int32 BroadcastPendingChunks(int32 MaxBroadcasts) override;
+	virtual bool HasPendingChunks() const override { return !PendingChunk.IsEmpty(); }
+	//~ End IPlayKitStreamChunkSource Interface
+
 	//========== Conversation ==========//
 
 	/** Send a message to the NPC and get a response */
@@ -158,6 +222,16 @@ public:
 	UFUNCTION(BlueprintPure, Category="PlayKit|NPC")
 	bool IsTalking() const { return bIsTalking; }
 
+	/**
+	 * C++ alternative to Talk/TalkStream: the reply completes the returned future instead of
+	 * OnResponse, OnError, OnStreamComplete and OnActionTriggered, so it is moved to the caller
+	 * rather than copied through reflection. The turn is streamed when OnDelta is set; OnDelta
+	 * then receives each text delta on the game thread. History, memories and auto predictions
+	 * behave as for Talk. Futures complete on the game thread, with bSuccess false on failure
+	 * or if the component is destroyed first.
+	 */
+	TFuture<FNPCResponse> TalkAsync(const FString& Message, TFunction<void(FStringView)> OnDelta = nullptr);
+
 	//========== History Management ==========//
 
 	/** Get the conversation history */
@@ -250,19 +324,99 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|NPC", meta=(ClampMin="0.0", ClampMax="2.0"))
 	float Temperature = 0.7f;
 
+	/**
+	 * Scheduling priority of conversation requests. NPCs default to Ambient, so crowds of
+	 * them never take the chat slots reserved for the player; set PlayerDialogue on the NPC
+	 * the player is talking to.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|NPC")
+	EPlayKitRequestPriority RequestPriority = EPlayKitRequestPriority::Ambient;
+
+	/**
+	 * Thread that decodes replies. Off the game thread, stream deltas and the parsed reply
+	 * are queued back and all events still fire on the game thread.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|NPC")
+	EPlayKitDecodeThread DecodeThread = EPlayKitDecodeThread::GameThread;
+
+	/** How stream chunks are broadcast. Per Frame merges deltas into at most one OnStreamChunk per frame; use it for crowds of talking NPCs. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|NPC")
+	EPlayKitChunkDelivery ChunkDelivery = EPlayKitChunkDelivery::Immediate;
+
+	/**
+	 * Upload only the messages added since the last turn, plus a hash of the history the server
+	 * already holds, instead of the system prompt and full history every turn. A turn the server
+	 * cannot continue is resent in full. Needs server support (see Net/PlayKitHistorySync.h).
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|NPC")
+	bool bUseHistorySync = false;
+
+	/** Deadlines of conversation requests; zero fields use the chat defaults of the project settings */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|NPC")
+	FPlayKitRequestDeadlines Deadlines;
+
+	/**
+	 * Send a second request for a streamed turn that has not started answering by the recent
+	 * 95th percentile time to first token. Whichever request streams text first is kept and the
+	 * other is cancelled. Only hedges once enough chat requests have been timed.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|NPC")
+	bool bHedgeRequests = false;
+
+	/** Send the hedge request to the Fast Model of the project settings instead of this NPC's model */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|NPC", meta=(EditCondition="bHedgeRequests"))
+	bool bHedgeWithFastModel = false;
+
+	/** Write the /v2/chat request body (system prompt, history, new user message) as UTF-8 JSON into OutBody */
+	static void BuildChatRequestBody(const FString& InModel, const FString& SystemPrompt, TConstArrayView<FNPCMessage> History,
+		const FString& UserMessage, float InTemperature, bool bStream, TArray<uint8>& OutBody);
+
+	/**
+	 * Write the request body of the next turn of this NPC.
+	 * Reuses the encoded system prompt and history, so only messages added since the last turn are encoded.
+	 */
+	void BuildTurnRequestBody(const FString& UserMessage, bool bStream, TArray<uint8>& OutBody)
+	{
+		BuildTurnRequestBody(Model, UserMessage, bStream, OutBody);
+	}
+	void BuildTurnRequestBody(const FString& InModel, const FString& UserMessage, bool bStream, TArray<uint8>& OutBody);
+
+	/** Turn the tool calls of a reply into action calls with flattened string parameters */
+	static void ParseActionCalls(const TArray<FPlayKitToolCall>& ToolCalls, TArray<FNPCActionCall>& OutActionCalls);
+
+	/** Collect the strings of the outermost JSON array in a predictions reply, ignoring any text around it */
+	static TArray<FString> ParsePredictionsFromJson(const FString& Response);
+
+	/** Fallback when the reply is not JSON: take up to ExpectedCount numbered or bulleted lines */
+	static TArray<FString> ExtractPredictionsFromText(const FString& Response, int32 ExpectedCount);
+
 private:
 	// Internal methods
 	void SendChatRequest(bool bStream);
+	TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe> StartTurnRequest(const FString& InModel, bool bStream,
+		TSharedPtr<IHttpRequest, ESPMode::ThreadSafe>& OutRequest);
 	void HandleChatResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
 	void HandleStreamProgress(FHttpRequestPtr Request, uint64 BytesSent, uint64 BytesReceived);
+	void BindOffThreadHandlers(const TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe>& Turn, const TSharedPtr<IHttpRequest, ESPMode::ThreadSafe>& Request);
+	TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe> FindTurn(const IHttpRequest* Request) const;
+	void ScheduleHedge();
+	void SendHedgeRequest();
+	bool ClaimTurn(const TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe>& Turn);
+	void CancelHedge();
+	void ApplyStreamDeltas(TArrayView<const FString> Deltas);
+	void FlushPendingChunk();
+	void FinishTurn(const TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe>& Turn, FPlayKitNPCTurnResult& Result);
+	void FinishNativeTurn(const FPlayKitNPCTurn& Turn, FPlayKitNPCTurnResult& Result);
 	void HandlePredictionsResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
 	FString BuildSystemPrompt() const;
-	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> CreateAuthenticatedRequest(const FString& Url);
-	void ParseActionCalls(const TSharedPtr<FJsonObject>& JsonObject, TArray<FNPCActionCall>& OutActionCalls);
+	void SyncEncodedHistory();
+	void TruncateEncodedHistory();
+	void InvalidateEncodedSystemPrompt() { EncodedSystemPrompt.Reset(); bEncodedSystemPromptValid = false; HistorySyncedCount = 0; ++HistorySyncGeneration; }
+	static void EncodeMessage(TArray<uint8>& Out, const FString& Role, const FString& Content);
+	static void BuildChatRequestBodyFromEncoded(const FString& InModel, TConstArrayView<uint8> EncodedMessages, TConstArrayView<uint8> EncodedHistory,
+		const FString& UserMessage, float InTemperature, bool bStream, TArray<uint8>& OutBody, const PlayKitHistorySync::FHeader* History = nullptr);
 
 	// Reply prediction helpers
-	TArray<FString> ParsePredictionsFromJson(const FString& Response);
-	TArray<FString> ExtractPredictionsFromText(const FString& Response, int32 ExpectedCount);
 	FString BuildRecentHistoryString() const;
 	FString GetLastNPCMessage() const;
 
@@ -280,8 +434,25 @@ private:
 
 	// State
 	bool bIsTalking = false;
+	bool bIsStreaming = false;
 	FString PendingUserMessage;
-	FString StreamBuffer;
+
+	// Decoding state of the turn in flight, and the reply text streamed so far
+	TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe> CurrentTurn;
+	FString StreamedContent;
+
+	// Hedging: the second request of the turn while neither has streamed text, and whether one has
+	TSharedPtr<FPlayKitNPCTurn, ESPMode::ThreadSafe> HedgeTurn;
+	TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> HedgeRequest;
+	FTSTicker::FDelegateHandle HedgeTicker;
+	bool bTurnClaimed = false;
+
+	// Deltas not broadcast yet (EPlayKitChunkDelivery::PerFrame)
+	FString PendingChunk;
+
+	// Completion of a turn started by TalkAsync; the turn's events are not broadcast while set
+	TUniquePtr<TPlayKitPromise<FNPCResponse>> NativePromise;
+	TFunction<void(FStringView)> NativeOnDelta;
 
 	// Memory
 	TMap<FString, FString> Memories;
@@ -289,6 +460,22 @@ private:
 	// History
 	TArray<FNPCMessage> ConversationHistory;
 
+	// Request body cache: history messages encoded as UTF-8 JSON ("{...},{...},"), appended as the conversation grows.
+	// EncodedHistoryEnds[i] is the end offset of message i, so reverts only truncate.
+	TArray<uint8> EncodedHistory;
+	TArray<int32> EncodedHistoryEnds;
+	TArray<uint8> EncodedSystemPrompt;
+	bool bEncodedSystemPromptValid = false;
+
+	// History sync: EncodedHistoryHashes[i] is the hash of messages 0..i, HistorySyncedCount the
+	// number of history messages the server holds (0 uploads everything, system prompt included)
+	TArray<uint64> EncodedHistoryHashes;
+	FString HistorySyncId;
+	int32 HistorySyncedCount = 0;
+
+	/** Bumped when the system prompt changes, so turns already in flight do not mark the new one as synced */
+	int32 HistorySyncGeneration = 0;
+
 	// Pending action results
 	TMap<FString, FString> PendingActionResults;
 
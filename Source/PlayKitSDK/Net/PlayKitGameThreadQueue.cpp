@@ -0,0 +1,60 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitGameThreadQueue.h"
+#include "PlayKitRequestTrace.h"
+#include "Containers/MpscQueue.h"
+#include "Containers/Ticker.h"
+
+DECLARE_CYCLE_STAT(TEXT("Game Thread Queue"), STAT_PlayKitGameThreadQueue, STATGROUP_PlayKit);
+
+namespace PlayKitGameThreadQueue
+{
+	TMpscQueue<TUniqueFunction<void()>>& GetQueue()
+	{
+		static TMpscQueue<TUniqueFunction<void()>> Queue;
+		return Queue;
+	}
+
+	FTSTicker::FDelegateHandle TickerHandle;
+}
+
+void FPlayKitGameThreadQueue::Enqueue(TUniqueFunction<void()>&& Work)
+{
+	PlayKitGameThreadQueue::GetQueue().Enqueue(MoveTemp(Work));
+}
+
+void FPlayKitGameThreadQueue::Drain()
+{
+	check(IsInGameThread());
+	SCOPE_CYCLE_COUNTER(STAT_PlayKitGameThreadQueue);
+
+	TUniqueFunction<void()> Work;
+	while (PlayKitGameThreadQueue::GetQueue().Dequeue(Work))
+	{
+		Work();
+	}
+}
+
+void FPlayKitGameThreadQueue::Startup()
+{
+	if (!PlayKitGameThreadQueue::TickerHandle.IsValid())
+	{
+		PlayKitGameThreadQueue::TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+			TEXT("PlayKitGameThreadQueue"), 0.0f, [](float)
+			{
+				Drain();
+				return true;
+			});
+	}
+}
+
+void FPlayKitGameThreadQueue::Shutdown()
+{
+	if (PlayKitGameThreadQueue::TickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(PlayKitGameThreadQueue::TickerHandle);
+		PlayKitGameThreadQueue::TickerHandle.Reset();
+	}
+
+	Drain();
+}
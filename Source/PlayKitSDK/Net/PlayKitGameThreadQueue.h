@@ -0,0 +1,32 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Hands finished results from HTTP or worker threads to the game thread.
+ *
+ * Producers on any thread push work into a lock-free multi-producer single-consumer
+ * queue; the game thread runs everything queued once per frame from the core ticker,
+ * in submission order. Work from one producer thread therefore runs in the order it
+ * was queued, which keeps stream deltas and their completion in sequence.
+ *
+ * Work runs on the game thread after its owner may have been destroyed or the
+ * request cancelled: capture weak pointers and request ids, and check them.
+ */
+class PLAYKITSDK_API FPlayKitGameThreadQueue
+{
+public:
+	/** Queue Work for the next drain. Any thread. */
+	static void Enqueue(TUniqueFunction<void()>&& Work);
+
+	/** Run all queued work. Game thread only; also called by the core ticker every frame. */
+	static void Drain();
+
+	/** Register the per-frame drain with the core ticker. Called at module startup. */
+	static void Startup();
+
+	/** Unregister the drain and run what is still queued */
+	static void Shutdown();
+};
@@ -0,0 +1,55 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Hash/CityHash.h"
+
+/**
+ * Delta history for /v2/chat (UPlayKitNPCClient::bUseHistorySync).
+ *
+ * Instead of the whole conversation, a turn sends the messages the server has not
+ * seen yet, plus a "history" member naming what it builds on:
+ *
+ *   "history": { "id": "<conversation id>", "base": 12, "hash": "9f0c..." }
+ *
+ *   base 0   "messages" is the whole conversation (system message first, if any). The
+ *            server replaces whatever it held for the id.
+ *   base N   "messages" continues after the first N conversation messages the server
+ *            holds, not counting the system message. "hash" is Chain() over those N;
+ *            the server drops anything it holds past them, then appends.
+ *
+ * If the server does not hold N messages or its hash differs, it answers 409 with
+ * code MismatchCode and the client repeats the turn with base 0.
+ */
+namespace PlayKitHistorySync
+{
+	/** Error code of a 409 reply to a base the server cannot continue from */
+	inline const TCHAR* MismatchCode = TEXT("HISTORY_MISMATCH");
+
+	/** Hash of an empty conversation */
+	constexpr uint64 EmptyHash = 0;
+
+	/** Extend the hash of a conversation by one message. Role and content are hashed as UTF-8. */
+	inline uint64 Chain(uint64 Previous, const FString& Role, const FString& Content)
+	{
+		const FTCHARToUTF8 Utf8Role(*Role, Role.Len());
+		const FTCHARToUTF8 Utf8Content(*Content, Content.Len());
+		const uint64 RoleHash = CityHash64WithSeed(Utf8Role.Get(), Utf8Role.Length(), Previous);
+		return CityHash64WithSeed(Utf8Content.Get(), Utf8Content.Length(), RoleHash);
+	}
+
+	/** The "history" member of a request */
+	struct FHeader
+	{
+		FString Id;
+		int32 Base = 0;
+		uint64 Hash = EmptyHash;
+	};
+
+	/** Hash as sent in "hash": 16 lowercase hex digits */
+	inline FString ToString(uint64 Hash)
+	{
+		return FString::Printf(TEXT("%016llx"), Hash);
+	}
+}
@@ -0,0 +1,618 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitJsonReader.h"
+
+namespace PlayKitJsonReader
+{
+	// Strings longer than this are unescaped on the heap
+	constexpr int32 InlineStringCapacity = 256;
+
+	int32 HexValue(UTF8CHAR Char)
+	{
+		if (Char >= '0' && Char <= '9') return Char - '0';
+		if (Char >= 'a' && Char <= 'f') return Char - 'a' + 10;
+		if (Char >= 'A' && Char <= 'F') return Char - 'A' + 10;
+		return -1;
+	}
+
+	bool ParseHex4(const UTF8CHAR* Chars, uint32& OutValue)
+	{
+		OutValue = 0;
+		for (int32 Index = 0; Index < 4; ++Index)
+		{
+			const int32 Digit = HexValue(Chars[Index]);
+			if (Digit < 0)
+			{
+				return false;
+			}
+			OutValue = (OutValue << 4) | static_cast<uint32>(Digit);
+		}
+		return true;
+	}
+
+	template <typename AllocatorType>
+	void AppendUtf8(TArray<UTF8CHAR, AllocatorType>& Out, uint32 CodePoint)
+	{
+		if (CodePoint < 0x80)
+		{
+			Out.Add(static_cast<UTF8CHAR>(CodePoint));
+		}
+		else if (CodePoint < 0x800)
+		{
+			Out.Add(static_cast<UTF8CHAR>(0xC0 | (CodePoint >> 6)));
+			Out.Add(static_cast<UTF8CHAR>(0x80 | (CodePoint & 0x3F)));
+		}
+		else if (CodePoint < 0x10000)
+		{
+			Out.Add(static_cast<UTF8CHAR>(0xE0 | (CodePoint >> 12)));
+			Out.Add(static_cast<UTF8CHAR>(0x80 | ((CodePoint >> 6) & 0x3F)));
+			Out.Add(static_cast<UTF8CHAR>(0x80 | (CodePoint & 0x3F)));
+		}
+		else
+		{
+			Out.Add(static_cast<UTF8CHAR>(0xF0 | (CodePoint >> 18)));
+			Out.Add(static_cast<UTF8CHAR>(0x80 | ((CodePoint >> 12) & 0x3F)));
+			Out.Add(static_cast<UTF8CHAR>(0x80 | ((CodePoint >> 6) & 0x3F)));
+			Out.Add(static_cast<UTF8CHAR>(0x80 | (CodePoint & 0x3F)));
+		}
+	}
+
+	void AssignUtf8(FString& Out, const UTF8CHAR* Chars, int32 Num)
+	{
+		if (Num == 0)
+		{
+			Out.Reset();
+			return;
+		}
+
+		const auto Converted = StringCast<TCHAR>(Chars, Num);
+		Out = FString(Converted.Length(), Converted.Get());
+	}
+
+	/** Read one tool call object of choices[0].message.tool_calls */
+	void ReadToolCall(FPlayKitJsonReader& Reader, FPlayKitToolCall& OutToolCall)
+	{
+		FUtf8StringView Key;
+		if (!Reader.BeginObject())
+		{
+			return;
+		}
+
+		while (Reader.NextMember(Key))
+		{
+			if (Key == UTF8TEXTVIEW("id"))
+			{
+				Reader.ReadString(OutToolCall.Id);
+			}
+			else if (Key == UTF8TEXTVIEW("type"))
+			{
+				Reader.ReadString(OutToolCall.Type);
+			}
+			else if (Key == UTF8TEXTVIEW("function") && Reader.PeekType() == EPlayKitJsonType::Object)
+			{
+				Reader.BeginObject();
+				while (Reader.NextMember(Key))
+				{
+					if (Key == UTF8TEXTVIEW("name"))
+					{
+						Reader.ReadString(OutToolCall.FunctionName);
+					}
+					else if (Key == UTF8TEXTVIEW("arguments"))
+					{
+						Reader.ReadString(OutToolCall.FunctionArguments);
+					}
+					else
+					{
+						Reader.SkipValue();
+					}
+				}
+			}
+			else
+			{
+				Reader.SkipValue();
+			}
+		}
+	}
+
+	void ReadMessage(FPlayKitJsonReader& Reader, FPlayKitChatResponse& OutResponse)
+	{
+		FUtf8StringView Key;
+		Reader.BeginObject();
+		while (Reader.NextMember(Key))
+		{
+			if (Key == UTF8TEXTVIEW("content"))
+			{
+				Reader.ReadString(OutResponse.Content);
+			}
+			else if (Key == UTF8TEXTVIEW("tool_calls") && Reader.PeekType() == EPlayKitJsonType::Array)
+			{
+				Reader.BeginArray();
+				while (Reader.NextElement())
+				{
+					if (Reader.PeekType() == EPlayKitJsonType::Object)
+					{
+						ReadToolCall(Reader, OutResponse.ToolCalls.AddDefaulted_GetRef());
+					}
+					else
+					{
+						Reader.SkipValue();
+					}
+				}
+			}
+			else
+			{
+				Reader.SkipValue();
+			}
+		}
+	}
+
+	void ReadChoice(FPlayKitJsonReader& Reader, FPlayKitChatResponse& OutResponse)
+	{
+		FUtf8StringView Key;
+		Reader.BeginObject();
+		while (Reader.NextMember(Key))
+		{
+			if (Key == UTF8TEXTVIEW("finish_reason"))
+			{
+				Reader.ReadString(OutResponse.FinishReason);
+			}
+			else if (Key == UTF8TEXTVIEW("message") && Reader.PeekType() == EPlayKitJsonType::Object)
+			{
+				ReadMessage(Reader, OutResponse);
+			}
+			else
+			{
+				Reader.SkipValue();
+			}
+		}
+	}
+
+	void ReadUsage(FPlayKitJsonReader& Reader, FPlayKitChatResponse& OutResponse)
+	{
+		FUtf8StringView Key;
+		Reader.BeginObject();
+		while (Reader.NextMember(Key))
+		{
+			if (Key == UTF8TEXTVIEW("prompt_tokens"))
+			{
+				Reader.ReadInt(OutResponse.PromptTokens);
+			}
+			else if (Key == UTF8TEXTVIEW("completion_tokens"))
+			{
+				Reader.ReadInt(OutResponse.CompletionTokens);
+			}
+			else if (Key == UTF8TEXTVIEW("total_tokens"))
+			{
+				Reader.ReadInt(OutResponse.TotalTokens);
+			}
+			else
+			{
+				Reader.SkipValue();
+			}
+		}
+	}
+}
+
+FPlayKitJsonReader::FPlayKitJsonReader(FUtf8StringView InJson)
+	: Data(InJson.GetData())
+	, Len(InJson.Len())
+{
+}
+
+EPlayKitJsonType FPlayKitJsonReader::PeekType()
+{
+	SkipWhitespace();
+	if (bError || Pos >= Len)
+	{
+		return EPlayKitJsonType::None;
+	}
+
+	switch (Data[Pos])
+	{
+	case '{': return EPlayKitJsonType::Object;
+	case '[': return EPlayKitJsonType::Array;
+	case '"': return EPlayKitJsonType::String;
+	case 't':
+	case 'f': return EPlayKitJsonType::Boolean;
+	case 'n': return EPlayKitJsonType::Null;
+	default:
+		return (Data[Pos] == '-' || (Data[Pos] >= '0' && Data[Pos] <= '9')) ? EPlayKitJsonType::Number : EPlayKitJsonType::None;
+	}
+}
+
+bool FPlayKitJsonReader::BeginObject()
+{
+	return Consume('{');
+}
+
+bool FPlayKitJsonReader::NextMember(FUtf8StringView& OutKey)
+{
+	SkipWhitespace();
+	if (bError || Pos >= Len)
+	{
+		return Fail();
+	}
+
+	if (Data[Pos] == '}')
+	{
+		++Pos;
+		return false;
+	}
+
+	if (Data[Pos] == ',')
+	{
+		++Pos;
+	}
+
+	int32 Start = 0;
+	int32 End = 0;
+	bool bHasEscapes = false;
+	if (!ScanString(Start, End, bHasEscapes) || !Consume(':'))
+	{
+		return Fail();
+	}
+
+	OutKey = FUtf8StringView(Data + Start, End - Start);
+	return true;
+}
+
+bool FPlayKitJsonReader::BeginArray()
+{
+	return Consume('[');
+}
+
+bool FPlayKitJsonReader::NextElement()
+{
+	SkipWhitespace();
+	if (bError || Pos >= Len)
+	{
+		return Fail();
+	}
+
+	if (Data[Pos] == ']')
+	{
+		++Pos;
+		return false;
+	}
+
+	if (Data[Pos] == ',')
+	{
+		++Pos;
+	}
+	return true;
+}
+
+bool FPlayKitJsonReader::ReadString(FString& OutValue)
+{
+	const EPlayKitJsonType Type = PeekType();
+	if (Type == EPlayKitJsonType::Null)
+	{
+		OutValue.Reset();
+		return SkipValue();
+	}
+
+	int32 Start = 0;
+	int32 End = 0;
+	bool bHasEscapes = false;
+	if (Type != EPlayKitJsonType::String || !ScanString(Start, End, bHasEscapes))
+	{
+		return Fail();
+	}
+
+	if (!bHasEscapes)
+	{
+		PlayKitJsonReader::AssignUtf8(OutValue, Data + Start, End - Start);
+		return true;
+	}
+
+	TArray<UTF8CHAR, TInlineAllocator<PlayKitJsonReader::InlineStringCapacity>> Unescaped;
+	Unescaped.Reserve(End - Start);
+	for (int32 Index = Start; Index < End; ++Index)
+	{
+		const UTF8CHAR Char = Data[Index];
+		if (Char != '\\')
+		{
+			Unescaped.Add(Char);
+			continue;
+		}
+
+		// ScanString guarantees a character after every backslash
+		const UTF8CHAR Escaped = Data[++Index];
+		switch (Escaped)
+		{
+		case 'n': Unescaped.Add('\n'); break;
+		case 'r': Unescaped.Add('\r'); break;
+		case 't': Unescaped.Add('\t'); break;
+		case 'b': Unescaped.Add('\b'); break;
+		case 'f': Unescaped.Add('\f'); break;
+		case 'u':
+			{
+				uint32 CodePoint = 0;
+				if (Index + 4 >= End || !PlayKitJsonReader::ParseHex4(Data + Index + 1, CodePoint))
+				{
+					return Fail();
+				}
+				Index += 4;
+
+				if (StringConv::IsHighSurrogate(CodePoint))
+				{
+					uint32 Low = 0;
+					if (Index + 6 < End && Data[Index + 1] == '\\' && Data[Index + 2] == 'u'
+						&& PlayKitJsonReader::ParseHex4(Data + Index + 3, Low) && StringConv::IsLowSurrogate(Low))
+					{
+						CodePoint = StringConv::EncodeSurrogate(static_cast<uint16>(CodePoint), static_cast<uint16>(Low));
+						Index += 6;
+					}
+					else
+					{
+						CodePoint = 0xFFFD;
+					}
+				}
+				else if (StringConv::IsLowSurrogate(CodePoint))
+				{
+					CodePoint = 0xFFFD;
+				}
+
+				PlayKitJsonReader::AppendUtf8(Unescaped, CodePoint);
+			}
+			break;
+		default:
+			// \" \\ \/
+			Unescaped.Add(Escaped);
+			break;
+		}
+	}
+
+	PlayKitJsonReader::AssignUtf8(OutValue, Unescaped.GetData(), Unescaped.Num());
+	return true;
+}
+
+bool FPlayKitJsonReader::ReadRawString(FUtf8StringView& OutValue)
+{
+	int32 Start = 0;
+	int32 End = 0;
+	bool bHasEscapes = false;
+	if (PeekType() != EPlayKitJsonType::String || !ScanString(Start, End, bHasEscapes))
+	{
+		return Fail();
+	}
+
+	OutValue = FUtf8StringView(Data + Start, End - Start);
+	return true;
+}
+
+bool FPlayKitJsonReader::ReadNumber(double& OutValue)
+{
+	int32 Start = 0;
+	int32 End = 0;
+	if (PeekType() != EPlayKitJsonType::Number || !ScanLiteral(Start, End))
+	{
+		return Fail();
+	}
+
+	ANSICHAR Buffer[64];
+	const int32 Num = FMath::Min(End - Start, static_cast<int32>(UE_ARRAY_COUNT(Buffer)) - 1);
+	FMemory::Memcpy(Buffer, Data + Start, Num);
+	Buffer[Num] = '\0';
+	OutValue = FCStringAnsi::Atod(Buffer);
+	return true;
+}
+
+bool FPlayKitJsonReader::ReadInt(int32& OutValue)
+{
+	double Value = 0.0;
+	if (!ReadNumber(Value))
+	{
+		return false;
+	}
+
+	OutValue = static_cast<int32>(Value);
+	return true;
+}
+
+bool FPlayKitJsonReader::ReadBool(bool& bOutValue)
+{
+	int32 Start = 0;
+	int32 End = 0;
+	if (PeekType() != EPlayKitJsonType::Boolean || !ScanLiteral(Start, End))
+	{
+		return Fail();
+	}
+
+	bOutValue = Data[Start] == 't';
+	return true;
+}
+
+bool FPlayKitJsonReader::ReadScalarAsString(FString& OutValue)
+{
+	switch (PeekType())
+	{
+	case EPlayKitJsonType::String:
+	case EPlayKitJsonType::Null:
+		return ReadString(OutValue);
+	case EPlayKitJsonType::Number:
+	case EPlayKitJsonType::Boolean:
+		{
+			int32 Start = 0;
+			int32 End = 0;
+			if (!ScanLiteral(Start, End))
+			{
+				return Fail();
+			}
+			PlayKitJsonReader::AssignUtf8(OutValue, Data + Start, End - Start);
+			return true;
+		}
+	default:
+		OutValue.Reset();
+		return SkipValue();
+	}
+}
+
+bool FPlayKitJsonReader::SkipValue()
+{
+	int32 Start = 0;
+	int32 End = 0;
+	bool bHasEscapes = false;
+
+	switch (PeekType())
+	{
+	case EPlayKitJsonType::String:
+		return ScanString(Start, End, bHasEscapes);
+	case EPlayKitJsonType::Number:
+	case EPlayKitJsonType::Boolean:
+	case EPlayKitJsonType::Null:
+		return ScanLiteral(Start, End);
+	case EPlayKitJsonType::Object:
+	case EPlayKitJsonType::Array:
+		break;
+	default:
+		return Fail();
+	}
+
+	// Containers: track depth only, strings are scanned so brackets inside them are ignored
+	int32 Depth = 0;
+	while (Pos < Len)
+	{
+		const UTF8CHAR Char = Data[Pos];
+		if (Char == '"')
+		{
+			if (!ScanString(Start, End, bHasEscapes))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		++Pos;
+		if (Char == '{' || Char == '[')
+		{
+			++Depth;
+		}
+		else if (Char == '}' || Char == ']')
+		{
+			if (--Depth == 0)
+			{
+				return true;
+			}
+		}
+	}
+
+	return Fail();
+}
+
+bool FPlayKitJsonReader::ParseChatCompletion(FUtf8StringView Json, FPlayKitChatResponse& OutResponse)
+{
+	FPlayKitJsonReader Reader(Json);
+	if (Reader.PeekType() != EPlayKitJsonType::Object)
+	{
+		return false;
+	}
+
+	FUtf8StringView Key;
+	Reader.BeginObject();
+	while (Reader.NextMember(Key))
+	{
+		if (Key == UTF8TEXTVIEW("choices") && Reader.PeekType() == EPlayKitJsonType::Array)
+		{
+			// Only the first choice is used
+			Reader.BeginArray();
+			bool bFirst = true;
+			while (Reader.NextElement())
+			{
+				if (bFirst && Reader.PeekType() == EPlayKitJsonType::Object)
+				{
+					PlayKitJsonReader::ReadChoice(Reader, OutResponse);
+				}
+				else
+				{
+					Reader.SkipValue();
+				}
+				bFirst = false;
+			}
+		}
+		else if (Key == UTF8TEXTVIEW("usage") && Reader.PeekType() == EPlayKitJsonType::Object)
+		{
+			PlayKitJsonReader::ReadUsage(Reader, OutResponse);
+		}
+		else
+		{
+			Reader.SkipValue();
+		}
+	}
+
+	return !Reader.HasError();
+}
+
+void FPlayKitJsonReader::SkipWhitespace()
+{
+	while (Pos < Len && (Data[Pos] == ' ' || Data[Pos] == '\n' || Data[Pos] == '\r' || Data[Pos] == '\t'))
+	{
+		++Pos;
+	}
+}
+
+bool FPlayKitJsonReader::Consume(UTF8CHAR Expected)
+{
+	SkipWhitespace();
+	if (bError || Pos >= Len || Data[Pos] != Expected)
+	{
+		return Fail();
+	}
+
+	++Pos;
+	return true;
+}
+
+bool FPlayKitJsonReader::ScanString(int32& OutStart, int32& OutEnd, bool& bOutHasEscapes)
+{
+	SkipWhitespace();
+	if (bError || Pos >= Len || Data[Pos] != '"')
+	{
+		return Fail();
+	}
+
+	bOutHasEscapes = false;
+	OutStart = ++Pos;
+	while (Pos < Len)
+	{
+		const UTF8CHAR Char = Data[Pos];
+		if (Char == '"')
+		{
+			OutEnd = Pos++;
+			return true;
+		}
+
+		if (Char == '\\')
+		{
+			bOutHasEscapes = true;
+			++Pos;
+		}
+		++Pos;
+	}
+
+	return Fail();
+}
+
+bool FPlayKitJsonReader::ScanLiteral(int32& OutStart, int32& OutEnd)
+{
+	SkipWhitespace();
+	OutStart = Pos;
+	while (Pos < Len)
+	{
+		const UTF8CHAR Char = Data[Pos];
+		if (Char == ',' || Char == '}' || Char == ']' || Char == ' ' || Char == '\n' || Char == '\r' || Char == '\t')
+		{
+			break;
+		}
+		++Pos;
+	}
+
+	OutEnd = Pos;
+	return OutEnd > OutStart || Fail();
+}
+
+bool FPlayKitJsonReader::Fail()
+{
+	bError = true;
+	return false;
+}
@@ -0,0 +1,114 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlayKitTypes.h"
+
+/**
+ * Type of the next JSON value
+ */
+enum class EPlayKitJsonType : uint8
+{
+	None,
+	Object,
+	Array,
+	String,
+	Number,
+	Boolean,
+	Null
+};
+
+/**
+ * Forward-only pull parser over UTF-8 JSON.
+ *
+ * Walks a response body in place instead of building an FJsonObject tree: the
+ * caller asks for the members it cares about and skips everything else, which
+ * costs nothing but a scan. Only strings that are actually read are converted
+ * to FString.
+ *
+ * Every value must be consumed (read or skipped) before moving to the next
+ * member or element. Errors are sticky: after malformed input every call
+ * returns false and HasError() is set.
+ *
+ * Usage:
+ *   FPlayKitJsonReader Reader(Json);
+ *   FUtf8StringView Key;
+ *   if (Reader.BeginObject())
+ *   {
+ *       while (Reader.NextMember(Key))
+ *       {
+ *           if (Key == UTF8TEXTVIEW("content")) { Reader.ReadString(Content); }
+ *           else { Reader.SkipValue(); }
+ *       }
+ *   }
+ */
+class PLAYKITSDK_API FPlayKitJsonReader
+{
+public:
+	explicit FPlayKitJsonReader(FUtf8StringView InJson);
+
+	/** Type of the next value, without consuming it */
+	EPlayKitJsonType PeekType();
+
+	/** Consume '{' */
+	bool BeginObject();
+
+	/**
+	 * Advance to the next member of the current object.
+	 * @param OutKey Raw (still escaped) key; keys of the PlayKit API never need unescaping
+	 * @return false at the closing '}' (which is consumed) or on error
+	 */
+	bool NextMember(FUtf8StringView& OutKey);
+
+	/** Consume '[' */
+	bool BeginArray();
+
+	/** Advance to the next element of the current array. @return false at the closing ']' (which is consumed) or on error */
+	bool NextElement();
+
+	/** Read a string value, unescaped. Null is read as an empty string. */
+	bool ReadString(FString& OutValue);
+
+	/** Read a string value without unescaping or copying it. Meant for comparing identifiers. */
+	bool ReadRawString(FUtf8StringView& OutValue);
+
+	bool ReadNumber(double& OutValue);
+	bool ReadInt(int32& OutValue);
+	bool ReadBool(bool& bOutValue);
+
+	/** Read a scalar value as text: strings are unescaped, numbers and literals are returned as written, null is empty */
+	bool ReadScalarAsString(FString& OutValue);
+
+	/** Skip the next value, including nested objects and arrays, without allocating */
+	bool SkipValue();
+
+	bool HasError() const { return bError; }
+
+	/**
+	 * Extract what FPlayKitChatResponse needs from a /v2/chat completion:
+	 * choices[0].message (content, tool_calls), choices[0].finish_reason and usage.
+	 * Leaves bSuccess and ErrorMessage to the caller.
+	 * @return false if the body is not a valid JSON object
+	 */
+	static bool ParseChatCompletion(FUtf8StringView Json, FPlayKitChatResponse& OutResponse);
+
+	/** View the bytes of an HTTP response body as UTF-8 */
+	static FUtf8StringView ToView(const TArray<uint8>& Bytes)
+	{
+		return FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Bytes.GetData()), Bytes.Num());
+	}
+
+private:
+	void SkipWhitespace();
+	bool Consume(UTF8CHAR Expected);
+	bool ScanString(int32& OutStart, int32& OutEnd, bool& bOutHasEscapes);
+	bool ScanLiteral(int32& OutStart, int32& OutEnd);
+	bool Fail();
+
+private:
+	const UTF8CHAR* Data = nullptr;
+	int32 Len = 0;
+	int32 Pos = 0;
+	bool bError = false;
+};
@@ -0,0 +1,213 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitJsonStreamParser.h"
+
+namespace
+{
+	bool IsJsonWhitespace(TCHAR Char)
+	{
+		return Char == TEXT(' ') || Char == TEXT('\t') || Char == TEXT('\n') || Char == TEXT('\r');
+	}
+}
+
+bool FPlayKitJsonStreamParser::Feed(FStringView Text, TArray<FPlayKitJsonStreamValue>& OutValues)
+{
+	return Feed(Text, [&OutValues](const FPlayKitJsonStreamValue& Value)
+	{
+		OutValues.Add(Value);
+	});
+}
+
+bool FPlayKitJsonStreamParser::Feed(FStringView Text, FOnValue OnValue)
+{
+	for (int32 Index = 0; Index < Text.Len() && !bError && !bComplete; ++Index, ++Offset)
+	{
+		const TCHAR Char = Text[Index];
+
+		if (bInString)
+		{
+			const bool bClosingQuote = !bEscape && Char == TEXT('"');
+			if (!bReadingKey)
+			{
+				Append(Char);
+			}
+			else if (!bClosingQuote)
+			{
+				// Keys are reported as written, escapes included
+				Key.AppendChar(Char);
+			}
+
+			if (bEscape)
+			{
+				bEscape = false;
+			}
+			else if (Char == TEXT('\\'))
+			{
+				bEscape = true;
+			}
+			else if (Char == TEXT('"'))
+			{
+				bInString = false;
+				if (bReadingKey)
+				{
+					bReadingKey = false;
+				}
+				else
+				{
+					EndValue(OnValue);
+				}
+			}
+			continue;
+		}
+
+		// Text before the root value is not JSON the parser was asked for
+		if (RootStart < 0 && Char != TEXT('{') && Char != TEXT('['))
+		{
+			continue;
+		}
+
+		if (IsJsonWhitespace(Char))
+		{
+			EndScalar(OnValue);
+			continue;
+		}
+
+		switch (Char)
+		{
+		case TEXT('"'):
+			EndScalar(OnValue);
+			bInString = true;
+			if (Stack.Num() == 1 && Stack.Last() && bExpectKey)
+			{
+				bReadingKey = true;
+				Key.Reset();
+			}
+			else
+			{
+				BeginValue();
+				Append(Char);
+			}
+			break;
+
+		case TEXT('{'):
+		case TEXT('['):
+			EndScalar(OnValue);
+			BeginValue();
+			Append(Char);
+			Stack.Add(Char == TEXT('{'));
+			bExpectKey = Char == TEXT('{');
+			break;
+
+		case TEXT('}'):
+		case TEXT(']'):
+			EndScalar(OnValue);
+			if (Stack.Num() == 0 || Stack.Last() != (Char == TEXT('}')))
+			{
+				bError = true;
+				break;
+			}
+			if (Stack.Num() >= 2)
+			{
+				Append(Char);
+			}
+			Stack.Pop(EAllowShrinking::No);
+			bExpectKey = false;
+			EndValue(OnValue);
+			break;
+
+		case TEXT(','):
+			EndScalar(OnValue);
+			if (Stack.Num() >= 2)
+			{
+				Append(Char);
+			}
+			bExpectKey = Stack.Num() > 0 && Stack.Last();
+			break;
+
+		case TEXT(':'):
+			if (Stack.Num() >= 2)
+			{
+				Append(Char);
+			}
+			bExpectKey = false;
+			break;
+
+		default:
+			// Numbers, true, false and null
+			if (!bInScalar)
+			{
+				BeginValue();
+				bInScalar = true;
+			}
+			Append(Char);
+			break;
+		}
+	}
+
+	return !bError;
+}
+
+void FPlayKitJsonStreamParser::BeginValue()
+{
+	const int32 Depth = Stack.Num();
+	if (Depth == 0)
+	{
+		RootStart = Offset;
+	}
+	else if (Depth == 1)
+	{
+		Current.Reset();
+		ElementIndex = 0;
+	}
+	else if (Depth == 2 && Stack[0] && !Stack[1])
+	{
+		ElementStart = Current.Len();
+	}
+}
+
+void FPlayKitJsonStreamParser::EndValue(FOnValue OnValue)
+{
+	const int32 Depth = Stack.Num();
+	if (Depth == 0)
+	{
+		RootEnd = Offset + 1;
+		bComplete = true;
+	}
+	else if (Depth == 1)
+	{
+		FPlayKitJsonStreamValue Value;
+		Value.Path = Stack[0] ? Key : FString::Printf(TEXT("[%d]"), RootElementIndex++);
+		Value.Json = MoveTemp(Current);
+		Current.Reset();
+		OnValue(Value);
+	}
+	else if (Depth == 2 && Stack[0] && !Stack[1])
+	{
+		FPlayKitJsonStreamValue Value;
+		Value.Path = FString::Printf(TEXT("%s[%d]"), *Key, ElementIndex++);
+		Value.Json = Current.Mid(ElementStart);
+		OnValue(Value);
+	}
+}
+
+void FPlayKitJsonStreamParser::EndScalar(FOnValue OnValue)
+{
+	if (bInScalar)
+	{
+		bInScalar = false;
+		EndValue(OnValue);
+	}
+}
+
+void FPlayKitJsonStreamParser::Append(TCHAR Char)
+{
+	if (Stack.Num() >= 1)
+	{
+		Current.AppendChar(Char);
+	}
+}
+
+void FPlayKitJsonStreamParser::Reset()
+{
+	*this = FPlayKitJsonStreamParser();
+}
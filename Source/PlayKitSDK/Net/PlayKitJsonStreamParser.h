@@ -0,0 +1,89 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** A value completed by FPlayKitJsonStreamParser */
+struct FPlayKitJsonStreamValue
+{
+	/** "title", "objectives[2]", or "[2]" for an element of a root array */
+	FString Path;
+
+	/** The value as compact JSON: strings keep their quotes and escapes */
+	FString Json;
+};
+
+/**
+ * Incremental JSON parser for structured output that arrives as text deltas.
+ *
+ * Text can be fed in pieces of any size, split anywhere (inside strings, escapes or
+ * numbers). Each top-level field of the root object is reported once its value is complete,
+ * and so is each element of a top-level array field, before the array itself:
+ *
+ *   {"title":"Iron","objectives":[{"id":1},{"id":2}]}
+ *   -> title "Iron", objectives[0] {"id":1}, objectives[1] {"id":2}, objectives [{"id":1},{"id":2}]
+ *
+ * Only the text of the top-level value being read is buffered. Anything before the root
+ * value (such as a Markdown code fence) and after it is skipped. The parser tracks structure,
+ * not full JSON grammar, so values are meant to be parsed again by their consumer.
+ */
+class PLAYKITSDK_API FPlayKitJsonStreamParser
+{
+public:
+	using FOnValue = TFunctionRef<void(const FPlayKitJsonStreamValue& Value)>;
+
+	/**
+	 * Parse the next piece of text.
+	 * @return false once the text is not well-formed; later calls do nothing
+	 */
+	bool Feed(FStringView Text, FOnValue OnValue);
+
+	/** Convenience for Feed(): completed values are appended to OutValues */
+	bool Feed(FStringView Text, TArray<FPlayKitJsonStreamValue>& OutValues);
+
+	/** The root value has been closed */
+	bool IsComplete() const { return bComplete; }
+	bool HasError() const { return bError; }
+
+	/** Offsets in the fed text of the root value's first character and one past its last; valid once complete */
+	int64 GetRootStart() const { return RootStart; }
+	int64 GetRootEnd() const { return RootEnd; }
+
+	void Reset();
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Stack.GetAllocatedSize() + Key.GetAllocatedSize() + Current.GetAllocatedSize();
+	}
+
+private:
+	void BeginValue();
+	void EndValue(FOnValue OnValue);
+	void EndScalar(FOnValue OnValue);
+	void Append(TCHAR Char);
+
+	/** Open containers, innermost last: true for objects */
+	TArray<bool, TInlineAllocator<16>> Stack;
+
+	/** Key of the top-level field being read */
+	FString Key;
+
+	/** Text of the top-level value being read, and where its current array element starts */
+	FString Current;
+	int32 ElementStart = 0;
+	int32 ElementIndex = 0;
+	int32 RootElementIndex = 0;
+
+	int64 Offset = 0;
+	int64 RootStart = -1;
+	int64 RootEnd = -1;
+
+	bool bInString = false;
+	bool bEscape = false;
+	bool bReadingKey = false;
+	bool bExpectKey = false;
+	bool bInScalar = false;
+	bool bComplete = false;
+	bool bError = false;
+};
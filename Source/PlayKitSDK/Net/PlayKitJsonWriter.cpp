@@ -0,0 +1,246 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitJsonWriter.h"
+
+namespace PlayKitJsonWriter
+{
+	/** Format with the fewest significant digits that still round-trips, so 0.7f is written as 0.7 */
+	template <typename T>
+	int32 FormatShortest(ANSICHAR (&Buffer)[32], T Value, int32 MaxDigits)
+	{
+		int32 Len = 0;
+		for (int32 Digits = 1; Digits <= MaxDigits; ++Digits)
+		{
+			Len = FCStringAnsi::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), "%.*g", Digits, static_cast<double>(Value));
+			if (static_cast<T>(FCStringAnsi::Atod(Buffer)) == Value)
+			{
+				break;
+			}
+		}
+		return Len;
+	}
+
+	void AppendUtf8(TArray<uint8>& Out, uint32 CodePoint)
+	{
+		if (CodePoint < 0x80)
+		{
+			Out.Add(static_cast<uint8>(CodePoint));
+		}
+		else if (CodePoint < 0x800)
+		{
+			const uint8 Bytes[] = { uint8(0xC0 | (CodePoint >> 6)), uint8(0x80 | (CodePoint & 0x3F)) };
+			Out.Append(Bytes, UE_ARRAY_COUNT(Bytes));
+		}
+		else if (CodePoint < 0x10000)
+		{
+			const uint8 Bytes[] = { uint8(0xE0 | (CodePoint >> 12)), uint8(0x80 | ((CodePoint >> 6) & 0x3F)), uint8(0x80 | (CodePoint & 0x3F)) };
+			Out.Append(Bytes, UE_ARRAY_COUNT(Bytes));
+		}
+		else
+		{
+			const uint8 Bytes[] = { uint8(0xF0 | (CodePoint >> 18)), uint8(0x80 | ((CodePoint >> 12) & 0x3F)), uint8(0x80 | ((CodePoint >> 6) & 0x3F)), uint8(0x80 | (CodePoint & 0x3F)) };
+			Out.Append(Bytes, UE_ARRAY_COUNT(Bytes));
+		}
+	}
+
+	/** Transcode UTF-16 to UTF-8; unpaired surrogates become U+FFFD. Escapes JSON specials when bEscape is set. */
+	void AppendTranscoded(TArray<uint8>& Out, FStringView Value, bool bEscape)
+	{
+		static const ANSICHAR HexDigits[] = "0123456789abcdef";
+
+		const TCHAR* Chars = Value.GetData();
+		const int32 Len = Value.Len();
+		int32 Index = 0;
+		while (Index < Len)
+		{
+			// Plain ASCII runs are the common case; copy them without per-character branching
+			const int32 RunStart = Index;
+			while (Index < Len && Chars[Index] >= 0x20 && Chars[Index] < 0x80 && (!bEscape || (Chars[Index] != '"' && Chars[Index] != '\\')))
+			{
+				++Index;
+			}
+			if (Index > RunStart)
+			{
+				const int32 Base = Out.AddUninitialized(Index - RunStart);
+				uint8* Dest = Out.GetData() + Base;
+				for (int32 Src = RunStart; Src < Index; ++Src)
+				{
+					*Dest++ = static_cast<uint8>(Chars[Src]);
+				}
+			}
+			if (Index >= Len)
+			{
+				break;
+			}
+
+			const uint32 Char = static_cast<uint32>(Chars[Index++]);
+			if (Char < 0x80)
+			{
+				if (!bEscape)
+				{
+					Out.Add(static_cast<uint8>(Char));
+					continue;
+				}
+
+				Out.Add('\\');
+				switch (Char)
+				{
+				case '"':  Out.Add('"'); break;
+				case '\\': Out.Add('\\'); break;
+				case '\n': Out.Add('n'); break;
+				case '\r': Out.Add('r'); break;
+				case '\t': Out.Add('t'); break;
+				case '\b': Out.Add('b'); break;
+				case '\f': Out.Add('f'); break;
+				default:
+					{
+						const uint8 Escape[] = { 'u', '0', '0', uint8(HexDigits[Char >> 4]), uint8(HexDigits[Char & 0xF]) };
+						Out.Append(Escape, UE_ARRAY_COUNT(Escape));
+					}
+					break;
+				}
+				continue;
+			}
+
+			uint32 CodePoint = Char;
+			if (StringConv::IsHighSurrogate(Char))
+			{
+				if (Index < Len && StringConv::IsLowSurrogate(Chars[Index]))
+				{
+					CodePoint = StringConv::EncodeSurrogate(static_cast<uint16>(Char), static_cast<uint16>(Chars[Index++]));
+				}
+				else
+				{
+					CodePoint = 0xFFFD;
+				}
+			}
+			else if (StringConv::IsLowSurrogate(Char))
+			{
+				CodePoint = 0xFFFD;
+			}
+
+			AppendUtf8(Out, CodePoint);
+		}
+	}
+}
+
+FPlayKitJsonWriter::FPlayKitJsonWriter(TArray<uint8>& InOut)
+	: Out(InOut)
+{
+}
+
+void FPlayKitJsonWriter::BeginObject()
+{
+	WriteSeparator();
+	Append('{');
+	bNeedComma = false;
+}
+
+void FPlayKitJsonWriter::BeginObject(FAnsiStringView Key)
+{
+	WriteKey(Key);
+	Append('{');
+	bNeedComma = false;
+}
+
+void FPlayKitJsonWriter::EndObject()
+{
+	Append('}');
+	bNeedComma = true;
+}
+
+void FPlayKitJsonWriter::BeginArray()
+{
+	WriteSeparator();
+	Append('[');
+	bNeedComma = false;
+}
+
+void FPlayKitJsonWriter::BeginArray(FAnsiStringView Key)
+{
+	WriteKey(Key);
+	Append('[');
+	bNeedComma = false;
+}
+
+void FPlayKitJsonWriter::EndArray()
+{
+	Append(']');
+	bNeedComma = true;
+}
+
+void FPlayKitJsonWriter::WriteString(FAnsiStringView Key, FStringView Value)
+{
+	WriteKey(Key);
+	AppendEscapedString(Out, Value);
+}
+
+void FPlayKitJsonWriter::WriteNumber(FAnsiStringView Key, float Value)
+{
+	WriteKey(Key);
+	ANSICHAR Buffer[32];
+	Append(FAnsiStringView(Buffer, PlayKitJsonWriter::FormatShortest(Buffer, Value, 9)));
+}
+
+void FPlayKitJsonWriter::WriteNumber(FAnsiStringView Key, double Value)
+{
+	WriteKey(Key);
+	ANSICHAR Buffer[32];
+	Append(FAnsiStringView(Buffer, PlayKitJsonWriter::FormatShortest(Buffer, Value, 17)));
+}
+
+void FPlayKitJsonWriter::WriteNumber(FAnsiStringView Key, int64 Value)
+{
+	WriteKey(Key);
+	ANSICHAR Buffer[32];
+	const int32 Len = FCStringAnsi::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), "%lld", static_cast<long long>(Value));
+	Append(FAnsiStringView(Buffer, Len));
+}
+
+void FPlayKitJsonWriter::WriteBool(FAnsiStringView Key, bool bValue)
+{
+	WriteKey(Key);
+	Append(bValue ? FAnsiStringView("true") : FAnsiStringView("false"));
+}
+
+void FPlayKitJsonWriter::WriteRawJson(FAnsiStringView Key, FStringView Json)
+{
+	WriteKey(Key);
+	PlayKitJsonWriter::AppendTranscoded(Out, Json, false);
+}
+
+void FPlayKitJsonWriter::WriteStringValue(FStringView Value)
+{
+	WriteSeparator();
+	AppendEscapedString(Out, Value);
+	bNeedComma = true;
+}
+
+void FPlayKitJsonWriter::AppendEscapedString(TArray<uint8>& OutBytes, FStringView Value)
+{
+	OutBytes.Add('"');
+	PlayKitJsonWriter::AppendTranscoded(OutBytes, Value, true);
+	OutBytes.Add('"');
+}
+
+void FPlayKitJsonWriter::WriteKey(FAnsiStringView Key)
+{
+	WriteSeparator();
+	Append('"');
+	Append(Key);
+	Append("\":");
+	bNeedComma = true;
+}
+
+void FPlayKitJsonWriter::WriteSeparator()
+{
+	if (bNeedComma)
+	{
+		Append(',');
+	}
+}
+
+void FPlayKitJsonWriter::Append(FAnsiStringView Text)
+{
+	Out.Append(reinterpret_cast<const uint8*>(Text.GetData()), Text.Len());
+}
@@ -0,0 +1,71 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Minimal streaming JSON writer that emits UTF-8 straight into a byte buffer.
+ *
+ * Request bodies are write-only, so there is no need to build an FJsonObject
+ * tree or go through a UTF-16 FString: strings are escaped and transcoded in a
+ * single pass, and the finished buffer can be moved into IHttpRequest::SetContent.
+ * Keys are compile-time literals and are written as-is (they must not need escaping).
+ *
+ * The writer does not validate nesting; callers are expected to balance
+ * Begin/End calls like they would with TJsonWriter.
+ *
+ * Usage:
+ *   TArray<uint8> Body;
+ *   FPlayKitJsonWriter Writer(Body);
+ *   Writer.BeginObject();
+ *   Writer.WriteString("model", Model);
+ *   Writer.EndObject();
+ *   Request->SetContent(MoveTemp(Body));
+ */
+class PLAYKITSDK_API FPlayKitJsonWriter
+{
+public:
+	/** Appends to Out; call Out.Reset() first to reuse a buffer */
+	explicit FPlayKitJsonWriter(TArray<uint8>& Out);
+
+	// Objects and arrays (the keyless overloads are for the root and for array elements)
+	void BeginObject();
+	void BeginObject(FAnsiStringView Key);
+	void EndObject();
+	void BeginArray();
+	void BeginArray(FAnsiStringView Key);
+	void EndArray();
+
+	// Object members
+	void WriteString(FAnsiStringView Key, FStringView Value);
+	void WriteNumber(FAnsiStringView Key, float Value);
+	void WriteNumber(FAnsiStringView Key, double Value);
+	void WriteNumber(FAnsiStringView Key, int64 Value);
+	void WriteNumber(FAnsiStringView Key, int32 Value) { WriteNumber(Key, static_cast<int64>(Value)); }
+	void WriteBool(FAnsiStringView Key, bool bValue);
+
+	/** Write a value that is already valid JSON (e.g. a schema), converted to UTF-8 verbatim */
+	void WriteRawJson(FAnsiStringView Key, FStringView Json);
+
+	// Array elements
+	void WriteStringValue(FStringView Value);
+
+	/** Append Value as a quoted, escaped UTF-8 JSON string */
+	static void AppendEscapedString(TArray<uint8>& OutBytes, FStringView Value);
+
+	/** Encoded size bound of a string value (exceeded only by control characters), for reserving buffers */
+	static int32 EstimateStringSize(FStringView Value) { return Value.Len() * 3 + 2; }
+
+private:
+	void WriteKey(FAnsiStringView Key);
+	void WriteSeparator();
+	void Append(FAnsiStringView Text);
+	void Append(ANSICHAR Char) { Out.Add(static_cast<uint8>(Char)); }
+
+private:
+	TArray<uint8>& Out;
+
+	/** A value was written at the current nesting level, so the next one needs a comma */
+	bool bNeedComma = false;
+};
@@ -0,0 +1,107 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitLoopbackTransport.h"
+#include "PlayKitTransportRequest.h"
+#include "Containers/Ticker.h"
+
+void FPlayKitLoopbackReply::AddChunk(FStringView Text)
+{
+	const FTCHARToUTF8 Utf8(Text.GetData(), Text.Len());
+	Chunks.Emplace(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+}
+
+/** A request served by a loopback handler */
+class FPlayKitLoopbackRequest : public FPlayKitTransportRequest
+{
+public:
+	explicit FPlayKitLoopbackRequest(const TSharedRef<FPlayKitLoopbackTransport::FHandlerState, ESPMode::ThreadSafe>& InHandler)
+		: Handler(InHandler)
+	{
+	}
+
+protected:
+	//~ Begin FPlayKitTransportRequest Interface
+	virtual bool StartRequest() override;
+	virtual void StopRequest() override { bStopped = true; }
+	//~ End FPlayKitTransportRequest Interface
+
+private:
+	/** Deliver the next chunk, or complete. @return true once the request is finished */
+	bool Deliver();
+
+	TSharedRef<FPlayKitLoopbackTransport::FHandlerState, ESPMode::ThreadSafe> Handler;
+	FPlayKitLoopbackReply Reply;
+	int32 NextChunk = 0;
+	bool bStopped = false;
+};
+
+bool FPlayKitLoopbackRequest::StartRequest()
+{
+	++Handler->RequestCount;
+
+	Reply = FPlayKitLoopbackReply();
+	Handler->Handler(*this, Reply);
+	if (!Reply.ContentType.IsEmpty())
+	{
+		Reply.Headers.Add(TEXT("Content-Type"), Reply.ContentType);
+	}
+	NextChunk = 0;
+	bStopped = false;
+
+	// The ticker holds the request until it completes, as the HTTP manager does
+	TSharedRef<FPlayKitLoopbackRequest, ESPMode::ThreadSafe> This = StaticCastSharedRef<FPlayKitLoopbackRequest>(AsShared());
+	FTSTicker::GetCoreTicker().AddTicker(TEXT("PlayKitLoopbackRequest"), 0.0f, [This](float)
+	{
+		return !This->Deliver();
+	});
+	return true;
+}
+
+bool FPlayKitLoopbackRequest::Deliver()
+{
+	// Cancelled or timed out; the base class completes the request
+	if (bStopped || !IsProcessing())
+	{
+		Reply = FPlayKitLoopbackReply();
+		return true;
+	}
+
+	if (Reply.bConnectionError)
+	{
+		Finish(false, EHttpFailureReason::ConnectionError);
+		return true;
+	}
+
+	if (!HasResponded())
+	{
+		// Status and headers arrive with the first tick
+		ReceiveHead(Reply.StatusCode, Reply.Headers);
+	}
+
+	if (NextChunk < Reply.Chunks.Num())
+	{
+		TArray<uint8>& Chunk = Reply.Chunks[NextChunk++];
+		ReceiveBody(Chunk.GetData(), Chunk.Num());
+		Chunk.Empty();
+
+		if (NextChunk < Reply.Chunks.Num())
+		{
+			return false;
+		}
+	}
+
+	Finish(true, EHttpFailureReason::None);
+	Reply = FPlayKitLoopbackReply();
+	return true;
+}
+
+FPlayKitLoopbackTransport::FPlayKitLoopbackTransport(FHandler InHandler)
+	: Handler(MakeShared<FHandlerState, ESPMode::ThreadSafe>())
+{
+	Handler->Handler = MoveTemp(InHandler);
+}
+
+TSharedRef<IHttpRequest, ESPMode::ThreadSafe> FPlayKitLoopbackTransport::CreateRequest(const FString& Url)
+{
+	return MakeShared<FPlayKitLoopbackRequest, ESPMode::ThreadSafe>(Handler);
+}
@@ -0,0 +1,77 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlayKitTransport.h"
+
+/**
+ * Reply of a loopback handler
+ */
+struct PLAYKITSDK_API FPlayKitLoopbackReply
+{
+	int32 StatusCode = 200;
+
+	/** Response headers; Content-Type is taken from ContentType */
+	TMap<FString, FString> Headers;
+	FString ContentType = TEXT("application/json");
+
+	/**
+	 * Response body in pieces. One piece is delivered per tick, each followed by a
+	 * progress callback, so streaming clients see the body arrive incrementally.
+	 */
+	TArray<TArray<uint8>> Chunks;
+
+	/** Fail the request as a connection error instead of replying */
+	bool bConnectionError = false;
+
+	/** Append a body piece, UTF-8 encoded */
+	void AddChunk(FStringView Text);
+	void AddChunk(FUtf8StringView Text) { Chunks.Emplace(reinterpret_cast<const uint8*>(Text.GetData()), Text.Len()); }
+	void AddChunk(TArray<uint8>&& Bytes) { Chunks.Add(MoveTemp(Bytes)); }
+};
+
+/**
+ * In-process transport for tests and benchmarks: requests never leave the process.
+ *
+ * When a request is processed, the handler is called right away (game thread) with the
+ * configured request and fills in the reply. Delivery then runs on the core ticker: one
+ * body chunk per tick, then completion. There is no socket, TLS or HTTP parsing, so a
+ * benchmark run over the loopback measures what the SDK itself costs.
+ *
+ * All delegates are called on the game thread, whatever the request's delegate thread
+ * policy; off-thread decoding (EPlayKitDecodeThread) still works, it just runs there.
+ *
+ * Usage:
+ *   FPlayKitTransport::Set(MakeShared<FPlayKitLoopbackTransport, ESPMode::ThreadSafe>(
+ *       [](const IHttpRequest& Request, FPlayKitLoopbackReply& Reply) { Reply.AddChunk(TEXT("{}")); }));
+ *   ...
+ *   FPlayKitTransport::Set(nullptr);
+ */
+class PLAYKITSDK_API FPlayKitLoopbackTransport : public IPlayKitTransport
+{
+public:
+	using FHandler = TFunction<void(const IHttpRequest& Request, FPlayKitLoopbackReply& OutReply)>;
+
+	explicit FPlayKitLoopbackTransport(FHandler InHandler);
+
+	//~ Begin IPlayKitTransport Interface
+	virtual const TCHAR* GetName() const override { return TEXT("Loopback"); }
+	virtual TSharedRef<IHttpRequest, ESPMode::ThreadSafe> CreateRequest(const FString& Url) override;
+	//~ End IPlayKitTransport Interface
+
+	/** Requests processed so far */
+	int64 GetRequestCount() const { return Handler->RequestCount; }
+
+private:
+	friend class FPlayKitLoopbackRequest;
+
+	/** Shared with the requests, which may outlive the transport */
+	struct FHandlerState
+	{
+		FHandler Handler;
+		int64 RequestCount = 0;
+	};
+
+	TSharedRef<FHandlerState, ESPMode::ThreadSafe> Handler;
+};
@@ -0,0 +1,66 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+
+/**
+ * Promise behind the native (TFuture) API of the PlayKit clients.
+ *
+ * A plain TPromise must be fulfilled before it is destroyed. Requests can be dropped
+ * without completing (cancelled, or their component destroyed), so this one completes
+ * its future with the failed result given at construction instead.
+ *
+ * Continuations attached with TFuture::Then() run on the thread that fulfills the
+ * promise; the clients always fulfill on the game thread.
+ */
+template<typename ResultType>
+class TPlayKitPromise
+{
+public:
+	explicit TPlayKitPromise(ResultType&& InBrokenValue)
+		: BrokenValue(MoveTemp(InBrokenValue))
+	{
+	}
+
+	~TPlayKitPromise()
+	{
+		if (!bFulfilled)
+		{
+			Promise.SetValue(MoveTemp(BrokenValue));
+		}
+	}
+
+	TPlayKitPromise(const TPlayKitPromise&) = delete;
+	TPlayKitPromise& operator=(const TPlayKitPromise&) = delete;
+
+	/** Get the future; only once */
+	TFuture<ResultType> GetFuture()
+	{
+		return Promise.GetFuture();
+	}
+
+	/** Complete the future. Later calls are ignored. */
+	void SetValue(ResultType&& Value)
+	{
+		if (!bFulfilled)
+		{
+			bFulfilled = true;
+			Promise.SetValue(MoveTemp(Value));
+		}
+	}
+
+	/** A completed future, for requests rejected before they start */
+	static TFuture<ResultType> MakeFulfilled(ResultType&& Value)
+	{
+		TPromise<ResultType> Fulfilled;
+		Fulfilled.SetValue(MoveTemp(Value));
+		return Fulfilled.GetFuture();
+	}
+
+private:
+	TPromise<ResultType> Promise;
+	ResultType BrokenValue;
+	bool bFulfilled = false;
+};
@@ -0,0 +1,304 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitRateLimiter.h"
+#include "PlayKitRequestTrace.h"
+#include "PlayKitRetryPolicy.h"
+#include "PlayKitSettings.h"
+#include "Misc/ScopeLock.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Sends Delayed By Rate Limit"), STAT_PlayKitRateDelayed, STATGROUP_PlayKit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Throttled Replies"), STAT_PlayKitThrottled, STATGROUP_PlayKit);
+
+namespace
+{
+	/** Slowest rate the limiter backs off to, so a paused endpoint still probes the server */
+	constexpr double MinRequestsPerSecond = 1.0 / 60.0;
+
+	/** Window over which the send rate is measured when the first 429 arrives without a configured rate */
+	constexpr double SendRateWindow = 10.0;
+	constexpr int32 MaxSendTimes = 64;
+
+	/** Reset values larger than this are Unix times rather than seconds from now */
+	constexpr double UnixTimeThreshold = 1.0e9;
+
+	struct FEndpointState
+	{
+		FPlayKitRateLimit Config;
+		double RequestsPerSecond = 0.0;
+		double Tokens = 0.0;
+		double LastRefill = 0.0;
+		double PausedUntil = 0.0;
+
+		/** The pause waits for a spent quota to reset, after which the window is full again */
+		bool bQuotaSpent = false;
+
+		/** Ring of recent send times */
+		TArray<double> SendTimes;
+		int32 NextSendTime = 0;
+
+		int32 Delayed = 0;
+		int32 Throttled = 0;
+	};
+
+	constexpr int32 NumEndpoints = static_cast<int32>(EPlayKitEndpoint::MAX);
+
+	FCriticalSection StateMutex;
+	FEndpointState Endpoints[NumEndpoints];
+
+	/** Call with StateMutex held */
+	FEndpointState& GetState(EPlayKitEndpoint Endpoint)
+	{
+		return Endpoints[FMath::Clamp(static_cast<int32>(Endpoint), 0, NumEndpoints - 1)];
+	}
+
+	/** Call with StateMutex held */
+	void Refill(FEndpointState& State, double Now)
+	{
+		// Unlimited endpoints keep a full bucket, so a limit learned later starts with a burst
+		State.Tokens = State.RequestsPerSecond > 0.0
+			? FMath::Min(State.Config.Burst, State.Tokens + (Now - State.LastRefill) * State.RequestsPerSecond)
+			: State.Config.Burst;
+		State.LastRefill = Now;
+	}
+
+	/** Call with StateMutex held */
+	double GetRecentSendRate(const FEndpointState& State, double Now)
+	{
+		int32 Recent = 0;
+		for (double Time : State.SendTimes)
+		{
+			Recent += Now - Time <= SendRateWindow ? 1 : 0;
+		}
+		return Recent / SendRateWindow;
+	}
+
+	/** Call with StateMutex held */
+	void ResetState(FEndpointState& State)
+	{
+		const FPlayKitRateLimit Config = State.Config;
+		State = FEndpointState();
+		State.Config = Config;
+		State.RequestsPerSecond = Config.RequestsPerSecond;
+		State.Tokens = Config.Burst;
+		State.LastRefill = FPlatformTime::Seconds();
+	}
+
+	/** First present header of a rate limit field: the IETF name, then the X- variant */
+	FString GetRateLimitHeader(const FHttpResponsePtr& Response, const TCHAR* Name)
+	{
+		FString Value = Response->GetHeader(FString(TEXT("RateLimit-")) + Name);
+		if (Value.IsEmpty())
+		{
+			Value = Response->GetHeader(FString(TEXT("X-RateLimit-")) + Name);
+		}
+		return Value.TrimStartAndEnd();
+	}
+}
+
+FPlayKitRateLimit FPlayKitRateLimit::FromSettings(EPlayKitEndpoint Endpoint)
+{
+	FPlayKitRateLimit Result;
+	if (const UPlayKitSettings* Settings = UPlayKitSettings::Get())
+	{
+		int32 PerMinute = 0;
+		switch (Endpoint)
+		{
+		case EPlayKitEndpoint::Chat:			PerMinute = Settings->ChatRequestsPerMinute; break;
+		case EPlayKitEndpoint::Image:			PerMinute = Settings->ImageRequestsPerMinute; break;
+		case EPlayKitEndpoint::Transcription:	PerMinute = Settings->TranscriptionRequestsPerMinute; break;
+		case EPlayKitEndpoint::Model3D:			PerMinute = Settings->Model3DRequestsPerMinute; break;
+		default:								break;
+		}
+
+		Result.RequestsPerSecond = FMath::Max(0, PerMinute) / 60.0;
+		Result.Burst = FMath::Max(1, Settings->RateLimitBurst);
+		Result.bAdaptive = Settings->bAdaptRateLimits;
+	}
+	return Result;
+}
+
+void FPlayKitRateLimiter::Configure(EPlayKitEndpoint Endpoint, const FPlayKitRateLimit& Limit)
+{
+	FScopeLock Lock(&StateMutex);
+	FEndpointState& State = GetState(Endpoint);
+	State.Config = Limit;
+	State.Config.Burst = FMath::Max(1.0, Limit.Burst);
+	State.RequestsPerSecond = Limit.RequestsPerSecond;
+	State.Tokens = FMath::Min(State.Tokens, State.Config.Burst);
+}
+
+double FPlayKitRateLimiter::TryAcquire(EPlayKitEndpoint Endpoint)
+{
+	FScopeLock Lock(&StateMutex);
+	FEndpointState& State = GetState(Endpoint);
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now < State.PausedUntil)
+	{
+		++State.Delayed;
+		INC_DWORD_STAT(STAT_PlayKitRateDelayed);
+		return State.PausedUntil - Now;
+	}
+
+	// The quota has reset: send at the configured rate until the server reports the new one
+	if (State.bQuotaSpent)
+	{
+		State.bQuotaSpent = false;
+		State.RequestsPerSecond = State.Config.RequestsPerSecond;
+		State.Tokens = State.Config.Burst;
+		State.LastRefill = Now;
+	}
+
+	Refill(State, Now);
+	if (State.RequestsPerSecond > 0.0)
+	{
+		if (State.Tokens < 1.0)
+		{
+			++State.Delayed;
+			INC_DWORD_STAT(STAT_PlayKitRateDelayed);
+			return (1.0 - State.Tokens) / State.RequestsPerSecond;
+		}
+		State.Tokens -= 1.0;
+	}
+
+	if (State.SendTimes.Num() < MaxSendTimes)
+	{
+		State.SendTimes.Add(Now);
+	}
+	else
+	{
+		State.SendTimes[State.NextSendTime] = Now;
+	}
+	State.NextSendTime = (State.NextSendTime + 1) % MaxSendTimes;
+	return 0.0;
+}
+
+void FPlayKitRateLimiter::OnResponse(EPlayKitEndpoint Endpoint, const FHttpResponsePtr& Response)
+{
+	if (!Response.IsValid())
+	{
+		return;
+	}
+
+	const FString Remaining = GetRateLimitHeader(Response, TEXT("Remaining"));
+	const FString Reset = GetRateLimitHeader(Response, TEXT("Reset"));
+	const bool bHasQuotaHeaders = Remaining.IsNumeric() && Reset.IsNumeric();
+	if (bHasQuotaHeaders)
+	{
+		double ResetSeconds = FCString::Atod(*Reset);
+		if (ResetSeconds > UnixTimeThreshold)
+		{
+			ResetSeconds -= static_cast<double>(FDateTime::UtcNow().ToUnixTimestamp());
+		}
+		OnQuota(Endpoint, FCString::Atoi(*Remaining), ResetSeconds);
+	}
+
+	if (Response->GetResponseCode() == 429)
+	{
+		OnThrottled(Endpoint, FPlayKitRetryPolicy::GetRetryAfter(Response), bHasQuotaHeaders);
+		return;
+	}
+
+	// Accepted without being told the quota: creep back towards the configured rate
+	const int32 ResponseCode = Response->GetResponseCode();
+	if (!bHasQuotaHeaders && ResponseCode >= 200 && ResponseCode < 300)
+	{
+		FScopeLock Lock(&StateMutex);
+		FEndpointState& State = GetState(Endpoint);
+		const double Configured = State.Config.RequestsPerSecond;
+		if (State.RequestsPerSecond > 0.0 && (Configured <= 0.0 || State.RequestsPerSecond < Configured))
+		{
+			State.RequestsPerSecond *= 1.05;
+			if (Configured > 0.0)
+			{
+				State.RequestsPerSecond = FMath::Min(State.RequestsPerSecond, Configured);
+			}
+			else if (State.RequestsPerSecond > 2.0 * GetRecentSendRate(State, FPlatformTime::Seconds()))
+			{
+				// No longer holding anything back: unlimited again, as configured
+				State.RequestsPerSecond = 0.0;
+			}
+		}
+	}
+}
+
+void FPlayKitRateLimiter::OnThrottled(EPlayKitEndpoint Endpoint, double RetryAfter, bool bHasQuotaHeaders)
+{
+	FScopeLock Lock(&StateMutex);
+	FEndpointState& State = GetState(Endpoint);
+	++State.Throttled;
+	INC_DWORD_STAT(STAT_PlayKitThrottled);
+
+	if (!State.Config.bAdaptive)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	Refill(State, Now);
+	State.Tokens = 0.0;
+	if (RetryAfter > 0.0)
+	{
+		State.PausedUntil = FMath::Max(State.PausedUntil, Now + RetryAfter);
+	}
+
+	// The quota headers already set the rate; otherwise back off from what was being sent
+	if (!bHasQuotaHeaders)
+	{
+		const double Current = State.RequestsPerSecond > 0.0 ? State.RequestsPerSecond : GetRecentSendRate(State, Now);
+		State.RequestsPerSecond = FMath::Max(MinRequestsPerSecond, Current * 0.5);
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("[PlayKit] %s rate limited by the server; pausing %.1fs, then sending at most %.2f requests/s"),
+		FPlayKitRequestTrace::GetEndpointName(Endpoint), FMath::Max(0.0, RetryAfter), State.RequestsPerSecond);
+}
+
+void FPlayKitRateLimiter::OnQuota(EPlayKitEndpoint Endpoint, int32 Remaining, double ResetSeconds)
+{
+	FScopeLock Lock(&StateMutex);
+	FEndpointState& State = GetState(Endpoint);
+	if (!State.Config.bAdaptive || ResetSeconds <= 0.0)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	Refill(State, Now);
+
+	// Requests already sent may use part of the remaining quota; the bucket never holds more than is left
+	Remaining = FMath::Max(0, Remaining);
+	State.Tokens = FMath::Min(State.Tokens, static_cast<double>(Remaining));
+	State.RequestsPerSecond = FMath::Max(MinRequestsPerSecond, Remaining / ResetSeconds);
+	if (Remaining == 0)
+	{
+		State.PausedUntil = FMath::Max(State.PausedUntil, Now + ResetSeconds);
+		State.bQuotaSpent = true;
+	}
+	else
+	{
+		State.bQuotaSpent = false;
+	}
+}
+
+FPlayKitRateLimiterStats FPlayKitRateLimiter::GetStats(EPlayKitEndpoint Endpoint)
+{
+	FScopeLock Lock(&StateMutex);
+	FEndpointState& State = GetState(Endpoint);
+	Refill(State, FPlatformTime::Seconds());
+
+	FPlayKitRateLimiterStats Result;
+	Result.RequestsPerSecond = State.RequestsPerSecond;
+	Result.Tokens = State.Tokens;
+	Result.Delayed = State.Delayed;
+	Result.Throttled = State.Throttled;
+	return Result;
+}
+
+void FPlayKitRateLimiter::Reset()
+{
+	FScopeLock Lock(&StateMutex);
+	for (FEndpointState& State : Endpoints)
+	{
+		ResetState(State);
+	}
+}
@@ -0,0 +1,86 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpResponse.h"
+#include "PlayKitRequestScheduler.h"
+
+/**
+ * Configured rate limit of one endpoint
+ */
+struct PLAYKITSDK_API FPlayKitRateLimit
+{
+	/** Sustained requests per second; 0 sends freely until the server reports a limit */
+	double RequestsPerSecond = 0.0;
+
+	/** Requests that may be sent back to back after a quiet period */
+	double Burst = 4.0;
+
+	/** Learn the limit from 429 replies and rate limit headers */
+	bool bAdaptive = true;
+
+	/** Values of UPlayKitSettings. Game thread. */
+	static FPlayKitRateLimit FromSettings(EPlayKitEndpoint Endpoint);
+};
+
+/**
+ * Rate limit state of one endpoint
+ */
+struct PLAYKITSDK_API FPlayKitRateLimiterStats
+{
+	/** Requests per second currently allowed; 0 while unlimited */
+	double RequestsPerSecond = 0.0;
+	double Tokens = 0.0;
+
+	/** Times a send was held back for a token */
+	int32 Delayed = 0;
+
+	/** 429 replies received */
+	int32 Throttled = 0;
+};
+
+/**
+ * Client-side rate shaping of the request scheduler: one token bucket per endpoint.
+ *
+ * Each request takes a token before it is sent. Tokens refill at the endpoint's rate up to
+ * Burst, and a request without one waits in its queue until the next is due instead of being
+ * sent and rejected. The buckets are shared by every scheduler in the process, because the
+ * server counts requests per game.
+ *
+ * The rate starts at the configured value and follows the server:
+ * - RateLimit-Remaining / RateLimit-Reset (or the X-RateLimit- variants) set the rate that
+ *   spends the remaining quota exactly by the reset, so throughput stays at the server limit
+ *   rather than bursting into it and backing off below it. A spent quota pauses the endpoint
+ *   until the reset, then refills the bucket and restores the configured rate.
+ * - A 429 empties the bucket and pauses the endpoint for its Retry-After. Without rate limit
+ *   headers it also halves the rate (or starts limiting at half the recent send rate), which
+ *   then recovers by 5% per accepted reply up to the configured rate.
+ *
+ * Thread-safe: replies of requests that decode off the game thread are reported from the HTTP thread.
+ */
+class PLAYKITSDK_API FPlayKitRateLimiter
+{
+public:
+	static void Configure(EPlayKitEndpoint Endpoint, const FPlayKitRateLimit& Limit);
+
+	/**
+	 * Take a token for a request about to be sent.
+	 * @return 0 if the request may be sent now, otherwise seconds until a token is due (none was taken)
+	 */
+	static double TryAcquire(EPlayKitEndpoint Endpoint);
+
+	/** Learn from the status and rate limit headers of a reply */
+	static void OnResponse(EPlayKitEndpoint Endpoint, const FHttpResponsePtr& Response);
+
+	/** The server rejected a request for its rate limit. RetryAfter <= 0 when it did not say how long to wait. */
+	static void OnThrottled(EPlayKitEndpoint Endpoint, double RetryAfter, bool bHasQuotaHeaders = false);
+
+	/** The server reported Remaining requests left in a window that resets in ResetSeconds */
+	static void OnQuota(EPlayKitEndpoint Endpoint, int32 Remaining, double ResetSeconds);
+
+	static FPlayKitRateLimiterStats GetStats(EPlayKitEndpoint Endpoint);
+
+	/** Restore the configured limits, refill the buckets and clear the counters */
+	static void Reset();
+};
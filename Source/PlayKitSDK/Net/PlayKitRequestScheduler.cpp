@@ -0,0 +1,1005 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitRequestScheduler.h"
+#include "PlayKitRequestTrace.h"
+#include "PlayKitGameThreadQueue.h"
+#include "PlayKitRetryPolicy.h"
+#include "PlayKitRateLimiter.h"
+#include "PlayKitMemory.h"
+#include "PlayKitSettings.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Hash/xxhash.h"
+#include "Tasks/Task.h"
+
+void UPlayKitRequestScheduler::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Queues.SetNum(NumEndpoints * NumPriorities);
+	FPlayKitRetryPolicy::Configure(FPlayKitRetryConfig::FromSettings());
+	for (int32 EndpointIndex = 0; EndpointIndex < NumEndpoints; ++EndpointIndex)
+	{
+		const EPlayKitEndpoint Endpoint = static_cast<EPlayKitEndpoint>(EndpointIndex);
+		FPlayKitRateLimiter::Configure(Endpoint, FPlayKitRateLimit::FromSettings(Endpoint));
+	}
+
+	DeadlineTicker = FTSTicker::GetCoreTicker().AddTicker(
+		FTickerDelegate::CreateUObject(this, &UPlayKitRequestScheduler::CheckDeadlines), 0.1f);
+}
+
+void UPlayKitRequestScheduler::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(DeadlineTicker);
+	for (FTSTicker::FDelegateHandle& Handle : RatePumpHandles)
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(Handle);
+		Handle.Reset();
+	}
+
+	// Requests that never started (queued or attached) are failed so their owners can reset
+	TArray<TSharedPtr<FEntry>> Pending;
+	for (const TPair<IHttpRequest*, TSharedPtr<FEntry>>& Pair : Entries)
+	{
+		if (Pair.Value->RetryHandle.IsValid())
+		{
+			FTSTicker::GetCoreTicker().RemoveTicker(Pair.Value->RetryHandle);
+		}
+
+		if (!Pair.Value->bActive && !Pair.Value->bOrphaned)
+		{
+			Pending.Add(Pair.Value);
+		}
+	}
+
+	Entries.Reset();
+	Coalescible.Reset();
+	Queues.Reset();
+
+	for (const TSharedPtr<FEntry>& Entry : Pending)
+	{
+		if (Entry->Leader.IsValid())
+		{
+			Entry->OnComplete.ExecuteIfBound(Entry->Request, nullptr, false);
+		}
+		else
+		{
+			Entry->Followers.Reset();
+			Entry->Request->OnProcessRequestComplete().ExecuteIfBound(Entry->Request, nullptr, false);
+		}
+	}
+
+	Super::Deinitialize();
+}
+
+UPlayKitRequestScheduler* UPlayKitRequestScheduler::Get(const UObject* WorldContextObject)
+{
+	if (!WorldContextObject || !GEngine)
+	{
+		return nullptr;
+	}
+
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UPlayKitRequestScheduler>() : nullptr;
+}
+
+void UPlayKitRequestScheduler::ProcessRequest(const UObject* Owner, const FHttpRequestRef& Request,
+	EPlayKitEndpoint Endpoint, EPlayKitRequestPriority Priority, bool bCoalesce, EPlayKitDecodeThread DecodeThread,
+	const FPlayKitRequestDeadlines& Deadlines)
+{
+	if (UPlayKitRequestScheduler* Scheduler = Get(Owner))
+	{
+		Scheduler->Submit(Request, Endpoint, Priority, Owner, bCoalesce, DecodeThread, Deadlines);
+	}
+	else
+	{
+		// Not scheduled, but still traced; only the total deadline is kept, by the HTTP module
+		FPlayKitRequestTrace::Begin(&Request.Get(), Endpoint);
+
+		const float TotalSeconds = ResolveDeadlines(Endpoint, Deadlines).TotalSeconds;
+		if (TotalSeconds > 0.0f)
+		{
+			Request->SetTimeout(TotalSeconds);
+		}
+
+		if (DecodeThread != EPlayKitDecodeThread::GameThread)
+		{
+			Request->SetDelegateThreadPolicy(EHttpRequestDelegateThreadPolicy::CompleteOnHttpThread);
+		}
+
+		FHttpRequestCompleteDelegate OwnerComplete = Request->OnProcessRequestComplete();
+		Request->OnProcessRequestComplete().BindLambda(
+			[OwnerComplete, DecodeThread](FHttpRequestPtr InRequest, FHttpResponsePtr InResponse, bool bWasSuccessful)
+			{
+				RunCompletion(DecodeThread, [OwnerComplete, InRequest, InResponse, bWasSuccessful]()
+				{
+					OwnerComplete.ExecuteIfBound(InRequest, InResponse, bWasSuccessful);
+					FPlayKitRequestTrace::End(InRequest.Get(), InResponse, bWasSuccessful);
+				});
+			});
+
+		FHttpRequestProgressDelegate64 OwnerProgress = Request->OnRequestProgress64();
+		Request->OnRequestProgress64().BindLambda(
+			[OwnerProgress](FHttpRequestPtr InRequest, uint64 BytesSent, uint64 BytesReceived)
+			{
+				FPlayKitRequestTrace::MarkReceived(InRequest.Get(), BytesReceived);
+				OwnerProgress.ExecuteIfBound(InRequest, BytesSent, BytesReceived);
+			});
+
+		FPlayKitRequestTrace::MarkSent(&Request.Get());
+		Request->ProcessRequest();
+	}
+}
+
+void UPlayKitRequestScheduler::CancelRequest(const UObject* Owner, const FHttpRequestPtrTS& Request)
+{
+	if (!Request.IsValid())
+	{
+		return;
+	}
+
+	UPlayKitRequestScheduler* Scheduler = Get(Owner);
+	if (!Scheduler || !Scheduler->Cancel(Request))
+	{
+		Request->CancelRequest();
+	}
+}
+
+void UPlayKitRequestScheduler::Submit(const FHttpRequestRef& Request, EPlayKitEndpoint Endpoint,
+	EPlayKitRequestPriority Priority, const UObject* Owner, bool bCoalesce, EPlayKitDecodeThread DecodeThread,
+	const FPlayKitRequestDeadlines& Deadlines)
+{
+	LLM_SCOPE_BYTAG(PlayKit_Transport);
+
+	if (!FPlayKitRetryPolicy::AllowRequest(Endpoint))
+	{
+		FailFast(Request, Endpoint);
+		return;
+	}
+
+	// Followers are fanned out from the leader's completion, which has to run on the game thread
+	if (DecodeThread != EPlayKitDecodeThread::GameThread)
+	{
+		Request->SetDelegateThreadPolicy(EHttpRequestDelegateThreadPolicy::CompleteOnHttpThread);
+		bCoalesce = false;
+	}
+
+	TSharedPtr<FEntry> Entry = MakeShared<FEntry>();
+	Entry->Request = Request;
+	Entry->Endpoint = Endpoint;
+	Entry->Priority = Priority;
+	Entry->Owner = FObjectKey(Owner);
+	Entry->SubmitTime = FPlatformTime::Seconds();
+	Entry->FirstSubmitTime = Entry->SubmitTime;
+	Entry->DecodeThread = DecodeThread;
+	Entry->Deadlines = ResolveDeadlines(Endpoint, Deadlines);
+	Entry->bCoalescible = bCoalesce;
+	Entries.Add(&Request.Get(), Entry);
+
+	if (bCoalesce)
+	{
+		Entry->CoalesceKey = ComputeCoalesceKey(*Request);
+		if (TryAttachFollower(Entry))
+		{
+			return;
+		}
+		Coalescible.Add(Entry->CoalesceKey, Entry);
+	}
+
+	FPlayKitRequestTrace::Begin(&Request.Get(), Endpoint);
+	BindWrappers(Entry);
+	Enqueue(Entry);
+	Pump(Endpoint);
+}
+
+bool UPlayKitRequestScheduler::Cancel(const FHttpRequestPtrTS& Request)
+{
+	TSharedPtr<FEntry> Entry = Entries.FindRef(Request.Get());
+	if (!Entry.IsValid())
+	{
+		return false;
+	}
+
+	if (Entry->Leader.IsValid())
+	{
+		DetachFollower(Entry);
+		return true;
+	}
+
+	// Identical requests are still waiting on this one: keep it running, just stop reporting to its owner
+	if (Entry->Followers.Num() > 0)
+	{
+		Entry->bOrphaned = true;
+		return true;
+	}
+
+	Entry->bOrphaned = true;
+	if (!Entry->bActive)
+	{
+		if (Entry->RetryHandle.IsValid())
+		{
+			FTSTicker::GetCoreTicker().RemoveTicker(Entry->RetryHandle);
+			Entry->RetryHandle.Reset();
+		}
+		Dequeue(Entry);
+		Forget(Entry);
+		FPlayKitRequestTrace::End(Entry->Request.Get(), nullptr, false);
+	}
+	else
+	{
+		// The completion wrapper releases the slot
+		Entry->Request->CancelRequest();
+	}
+	return true;
+}
+
+uint64 UPlayKitRequestScheduler::ComputeCoalesceKey(const IHttpRequest& Request)
+{
+	FXxHash64Builder Builder;
+	auto AddString = [&Builder](const FString& Value)
+	{
+		Builder.Update(*Value, Value.Len() * sizeof(TCHAR));
+	};
+
+	AddString(Request.GetURL());
+	AddString(Request.GetVerb());
+	AddString(Request.GetHeader(TEXT("Authorization")));
+
+	const TArray<uint8>& Content = Request.GetContent();
+	Builder.Update(Content.GetData(), Content.Num());
+	return Builder.Finalize().Hash;
+}
+
+bool UPlayKitRequestScheduler::IsSameRequest(const IHttpRequest& A, const IHttpRequest& B)
+{
+	// The hash selects the candidate; compare everything so a collision can never merge different calls
+	return A.GetContent() == B.GetContent()
+		&& A.GetURL() == B.GetURL()
+		&& A.GetVerb() == B.GetVerb()
+		&& A.GetHeader(TEXT("Authorization")) == B.GetHeader(TEXT("Authorization"));
+}
+
+void UPlayKitRequestScheduler::RunCompletion(EPlayKitDecodeThread DecodeThread, TUniqueFunction<void()>&& Complete)
+{
+	if (DecodeThread == EPlayKitDecodeThread::Worker && !IsInGameThread())
+	{
+		UE::Tasks::Launch(UE_SOURCE_LOCATION, MoveTemp(Complete));
+	}
+	else
+	{
+		Complete();
+	}
+}
+
+void UPlayKitRequestScheduler::BindWrappers(const TSharedPtr<FEntry>& Entry)
+{
+	TWeakPtr<FEntry> WeakEntry = Entry;
+
+	if (Entry->DecodeThread != EPlayKitDecodeThread::GameThread)
+	{
+		BindOffThreadWrappers(Entry);
+		return;
+	}
+
+	// Release the slot before the owner's handler runs, so it can submit follow-up requests
+	FHttpRequestCompleteDelegate OwnerComplete = Entry->Request->OnProcessRequestComplete();
+	Entry->Request->OnProcessRequestComplete().BindLambda(
+		[WeakThis = TWeakObjectPtr<UPlayKitRequestScheduler>(this), WeakEntry, OwnerComplete]
+		(FHttpRequestPtr InRequest, FHttpResponsePtr InResponse, bool bWasSuccessful)
+		{
+			TSharedPtr<FEntry> Finished = WeakEntry.Pin();
+			UPlayKitRequestScheduler* Scheduler = WeakThis.Get();
+
+			// Nobody hears of an attempt that is going to be repeated
+			double RetryDelay = 0.0;
+			if (Finished.IsValid() && Scheduler && ShouldRetry(Finished, InResponse, bWasSuccessful, RetryDelay)
+				&& Scheduler->RetryLater(Finished, InResponse, RetryDelay))
+			{
+				return;
+			}
+
+			TArray<TSharedPtr<FEntry>> Followers;
+			if (Finished.IsValid())
+			{
+				Followers = MoveTemp(Finished->Followers);
+				if (Scheduler)
+				{
+					Scheduler->HandleRequestFinished(Finished);
+					for (const TSharedPtr<FEntry>& Follower : Followers)
+					{
+						Scheduler->Entries.Remove(Follower->Request.Get());
+					}
+				}
+			}
+
+			if (!Finished.IsValid() || !Finished->bOrphaned)
+			{
+				OwnerComplete.ExecuteIfBound(InRequest, InResponse, bWasSuccessful);
+			}
+
+			// Fan the single response out to every identical request
+			for (const TSharedPtr<FEntry>& Follower : Followers)
+			{
+				if (!Follower->bOrphaned)
+				{
+					Follower->OnComplete.ExecuteIfBound(InRequest, InResponse, bWasSuccessful);
+				}
+			}
+
+			// After the handlers, so the usage they parsed is part of the timeline
+			FPlayKitRequestTrace::End(InRequest.Get(), InResponse, bWasSuccessful);
+		});
+
+	// Followers replay the leader's progress, so stream decoders see the same byte sequence
+	FHttpRequestProgressDelegate64 OwnerProgress = Entry->Request->OnRequestProgress64();
+	Entry->Request->OnRequestProgress64().BindLambda(
+		[WeakEntry, OwnerProgress](FHttpRequestPtr InRequest, uint64 BytesSent, uint64 BytesReceived)
+		{
+			FPlayKitRequestTrace::MarkReceived(InRequest.Get(), BytesReceived);
+
+			TSharedPtr<FEntry> Leader = WeakEntry.Pin();
+			if (Leader.IsValid())
+			{
+				MarkReceived(*Leader, BytesReceived);
+			}
+
+			if (IsRetryableReply(InRequest))
+			{
+				return;
+			}
+
+			if (Leader.IsValid() && BytesReceived > 0)
+			{
+				Leader->bDelivered = true;
+			}
+
+			if (!Leader.IsValid() || !Leader->bOrphaned)
+			{
+				OwnerProgress.ExecuteIfBound(InRequest, BytesSent, BytesReceived);
+			}
+
+			if (Leader.IsValid() && Leader->Followers.Num() > 0)
+			{
+				// Copy: a follower may cancel itself from inside its callback
+				TArray<TSharedPtr<FEntry>> Followers = Leader->Followers;
+				for (const TSharedPtr<FEntry>& Follower : Followers)
+				{
+					if (!Follower->bOrphaned)
+					{
+						Follower->OnProgress.ExecuteIfBound(InRequest, BytesSent, BytesReceived);
+					}
+				}
+			}
+		});
+}
+
+void UPlayKitRequestScheduler::BindOffThreadWrappers(const TSharedPtr<FEntry>& Entry)
+{
+	const EPlayKitDecodeThread DecodeThread = Entry->DecodeThread;
+
+	// The owner decodes off the game thread; the slot is released on the game thread
+	FHttpRequestCompleteDelegate OwnerComplete = Entry->Request->OnProcessRequestComplete();
+	Entry->Request->OnProcessRequestComplete().BindLambda(
+		[WeakThis = TWeakObjectPtr<UPlayKitRequestScheduler>(this), WeakEntry = TWeakPtr<FEntry>(Entry), OwnerComplete, DecodeThread]
+		(FHttpRequestPtr InRequest, FHttpResponsePtr InResponse, bool bWasSuccessful)
+		{
+			// Decided here, so the owner's handler is never started for an attempt that is repeated
+			double RetryDelay = 0.0;
+			TSharedPtr<FEntry> Attempted = WeakEntry.Pin();
+			if (Attempted.IsValid() && ShouldRetry(Attempted, InResponse, bWasSuccessful, RetryDelay))
+			{
+				FPlayKitGameThreadQueue::Enqueue([WeakThis, WeakEntry, OwnerComplete, InRequest, InResponse, bWasSuccessful, RetryDelay]()
+				{
+					TSharedPtr<FEntry> Finished = WeakEntry.Pin();
+					UPlayKitRequestScheduler* Scheduler = WeakThis.Get();
+					if (Finished.IsValid() && Scheduler)
+					{
+						if (Scheduler->RetryLater(Finished, InResponse, RetryDelay))
+						{
+							return;
+						}
+						Scheduler->HandleRequestFinished(Finished);
+					}
+
+					// The request was dropped in the meantime: report the attempt after all
+					OwnerComplete.ExecuteIfBound(InRequest, InResponse, bWasSuccessful);
+					FPlayKitRequestTrace::End(InRequest.Get(), InResponse, bWasSuccessful);
+				});
+				return;
+			}
+
+			FPlayKitGameThreadQueue::Enqueue([WeakThis, WeakEntry]()
+			{
+				TSharedPtr<FEntry> Finished = WeakEntry.Pin();
+				UPlayKitRequestScheduler* Scheduler = WeakThis.Get();
+				if (Finished.IsValid() && Scheduler)
+				{
+					Scheduler->HandleRequestFinished(Finished);
+				}
+			});
+
+			RunCompletion(DecodeThread, [OwnerComplete, InRequest, InResponse, bWasSuccessful]()
+			{
+				OwnerComplete.ExecuteIfBound(InRequest, InResponse, bWasSuccessful);
+				FPlayKitRequestTrace::End(InRequest.Get(), InResponse, bWasSuccessful);
+			});
+		});
+
+	FHttpRequestProgressDelegate64 OwnerProgress = Entry->Request->OnRequestProgress64();
+	Entry->Request->OnRequestProgress64().BindLambda(
+		[WeakEntry = TWeakPtr<FEntry>(Entry), OwnerProgress](FHttpRequestPtr InRequest, uint64 BytesSent, uint64 BytesReceived)
+		{
+			FPlayKitRequestTrace::MarkReceived(InRequest.Get(), BytesReceived);
+
+			TSharedPtr<FEntry> Attempted = WeakEntry.Pin();
+			if (Attempted.IsValid())
+			{
+				MarkReceived(*Attempted, BytesReceived);
+			}
+
+			if (IsRetryableReply(InRequest))
+			{
+				return;
+			}
+
+			if (Attempted.IsValid() && BytesReceived > 0)
+			{
+				Attempted->bDelivered = true;
+			}
+			OwnerProgress.ExecuteIfBound(InRequest, BytesSent, BytesReceived);
+		});
+}
+
+bool UPlayKitRequestScheduler::TryAttachFollower(const TSharedPtr<FEntry>& Entry)
+{
+	TSharedPtr<FEntry> Leader = Coalescible.FindRef(Entry->CoalesceKey);
+	if (!Leader.IsValid() || !IsSameRequest(*Leader->Request, *Entry->Request))
+	{
+		return false;
+	}
+
+	Entry->Leader = Leader;
+	Entry->OnComplete = Entry->Request->OnProcessRequestComplete();
+	Entry->OnProgress = Entry->Request->OnRequestProgress64();
+	Leader->Followers.Add(Entry);
+	++CoalescedCount;
+
+	// A waiting leader inherits the most urgent priority of its followers
+	if (!Leader->bActive && Entry->Priority < Leader->Priority)
+	{
+		Dequeue(Leader);
+		Leader->Priority = Entry->Priority;
+		Enqueue(Leader);
+		Pump(Leader->Endpoint);
+	}
+
+	UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Scheduler coalesced request into one %s (%d waiting)"),
+		Leader->bActive ? TEXT("in flight") : TEXT("queued"), Leader->Followers.Num());
+	return true;
+}
+
+void UPlayKitRequestScheduler::DetachFollower(const TSharedPtr<FEntry>& Follower)
+{
+	Follower->bOrphaned = true;
+	Entries.Remove(Follower->Request.Get());
+
+	TSharedPtr<FEntry> Leader = Follower->Leader.Pin();
+	if (!Leader.IsValid())
+	{
+		return;
+	}
+
+	Leader->Followers.Remove(Follower);
+
+	// Nobody is interested in the shared request anymore
+	if (Leader->bOrphaned && Leader->Followers.Num() == 0)
+	{
+		if (Leader->bActive)
+		{
+			Leader->Request->CancelRequest();
+		}
+		else
+		{
+			Dequeue(Leader);
+			Forget(Leader);
+		}
+	}
+}
+
+void UPlayKitRequestScheduler::Enqueue(const TSharedPtr<FEntry>& Entry)
+{
+	FPriorityQueue& Queue = GetQueue(Entry->Endpoint, Entry->Priority);
+	FOwnerQueue* OwnerQueue = Queue.Owners.FindByPredicate([&Entry](const FOwnerQueue& Existing)
+	{
+		return Existing.Owner == Entry->Owner;
+	});
+	if (!OwnerQueue)
+	{
+		OwnerQueue = &Queue.Owners.AddDefaulted_GetRef();
+		OwnerQueue->Owner = Entry->Owner;
+	}
+	OwnerQueue->Entries.Add(Entry);
+	++Queue.Num;
+}
+
+bool UPlayKitRequestScheduler::Dequeue(const TSharedPtr<FEntry>& Entry)
+{
+	FPriorityQueue& Queue = GetQueue(Entry->Endpoint, Entry->Priority);
+	for (int32 OwnerIndex = 0; OwnerIndex < Queue.Owners.Num(); ++OwnerIndex)
+	{
+		FOwnerQueue& OwnerQueue = Queue.Owners[OwnerIndex];
+		if (OwnerQueue.Entries.Remove(Entry) > 0)
+		{
+			--Queue.Num;
+			if (OwnerQueue.Entries.Num() == 0)
+			{
+				Queue.Owners.RemoveAt(OwnerIndex);
+				if (Queue.NextOwner > OwnerIndex)
+				{
+					--Queue.NextOwner;
+				}
+			}
+			return true;
+		}
+	}
+	return false;
+}
+
+void UPlayKitRequestScheduler::Forget(const TSharedPtr<FEntry>& Entry)
+{
+	Entries.Remove(Entry->Request.Get());
+	if (Entry->bCoalescible && Coalescible.FindRef(Entry->CoalesceKey) == Entry)
+	{
+		Coalescible.Remove(Entry->CoalesceKey);
+	}
+}
+
+UPlayKitRequestScheduler::FPriorityQueue& UPlayKitRequestScheduler::GetQueue(EPlayKitEndpoint Endpoint, EPlayKitRequestPriority Priority)
+{
+	return Queues[static_cast<int32>(Endpoint) * NumPriorities + static_cast<int32>(Priority)];
+}
+
+int32 UPlayKitRequestScheduler::GetEndpointCap(EPlayKitEndpoint Endpoint) const
+{
+	const UPlayKitSettings* Settings = UPlayKitSettings::Get();
+	if (!Settings)
+	{
+		return 4;
+	}
+
+	switch (Endpoint)
+	{
+	case EPlayKitEndpoint::Chat:			return FMath::Max(1, Settings->MaxConcurrentChatRequests);
+	case EPlayKitEndpoint::Image:			return FMath::Max(1, Settings->MaxConcurrentImageRequests);
+	case EPlayKitEndpoint::Transcription:	return FMath::Max(1, Settings->MaxConcurrentTranscriptionRequests);
+	case EPlayKitEndpoint::Model3D:			return FMath::Max(1, Settings->MaxConcurrent3DRequests);
+	default:								return 1;
+	}
+}
+
+int32 UPlayKitRequestScheduler::GetReservedSlots(EPlayKitEndpoint Endpoint) const
+{
+	const UPlayKitSettings* Settings = UPlayKitSettings::Get();
+	if (!Settings || Endpoint != EPlayKitEndpoint::Chat)
+	{
+		return 0;
+	}
+
+	// Always leave at least one slot for the other priority classes
+	return FMath::Clamp(Settings->ReservedDialogueChatSlots, 0, GetEndpointCap(Endpoint) - 1);
+}
+
+TSharedPtr<UPlayKitRequestScheduler::FEntry> UPlayKitRequestScheduler::PopNext(FPriorityQueue& Queue)
+{
+	if (Queue.NextOwner >= Queue.Owners.Num())
+	{
+		Queue.NextOwner = 0;
+	}
+
+	FOwnerQueue& OwnerQueue = Queue.Owners[Queue.NextOwner];
+	TSharedPtr<FEntry> Entry = OwnerQueue.Entries[0];
+	OwnerQueue.Entries.RemoveAt(0);
+	--Queue.Num;
+
+	// The next owner moves into this index when the current one runs empty
+	if (OwnerQueue.Entries.Num() == 0)
+	{
+		Queue.Owners.RemoveAt(Queue.NextOwner);
+	}
+	else
+	{
+		++Queue.NextOwner;
+	}
+
+	return Entry;
+}
+
+void UPlayKitRequestScheduler::Pump(EPlayKitEndpoint Endpoint)
+{
+	const int32 EndpointIndex = static_cast<int32>(Endpoint);
+	const int32 Cap = GetEndpointCap(Endpoint);
+	const int32 SharedCap = Cap - GetReservedSlots(Endpoint);
+
+	while (ActiveCount[EndpointIndex] < Cap)
+	{
+		FPriorityQueue* Next = nullptr;
+		for (int32 PriorityIndex = 0; PriorityIndex < NumPriorities; ++PriorityIndex)
+		{
+			const EPlayKitRequestPriority Priority = static_cast<EPlayKitRequestPriority>(PriorityIndex);
+
+			// Reserved slots are only handed to player dialogue
+			if (Priority != EPlayKitRequestPriority::PlayerDialogue && ActiveCount[EndpointIndex] >= SharedCap)
+			{
+				break;
+			}
+
+			FPriorityQueue& Queue = GetQueue(Endpoint, Priority);
+			if (Queue.Num > 0)
+			{
+				Next = &Queue;
+				break;
+			}
+		}
+
+		if (!Next)
+		{
+			break;
+		}
+
+		// Over the rate limit: the request waits here rather than being rejected by the server
+		const double RateDelay = FPlayKitRateLimiter::TryAcquire(Endpoint);
+		if (RateDelay > 0.0)
+		{
+			PumpLater(Endpoint, RateDelay);
+			break;
+		}
+
+		Start(PopNext(*Next));
+	}
+}
+
+void UPlayKitRequestScheduler::PumpLater(EPlayKitEndpoint Endpoint, double Delay)
+{
+	FTSTicker::FDelegateHandle& Handle = RatePumpHandles[static_cast<int32>(Endpoint)];
+	if (Handle.IsValid())
+	{
+		return;
+	}
+
+	Handle = FTSTicker::GetCoreTicker().AddTicker(TEXT("PlayKitRateLimit"), static_cast<float>(Delay),
+		[WeakThis = TWeakObjectPtr<UPlayKitRequestScheduler>(this), Endpoint](float)
+		{
+			if (UPlayKitRequestScheduler* Scheduler = WeakThis.Get())
+			{
+				Scheduler->RatePumpHandles[static_cast<int32>(Endpoint)].Reset();
+				Scheduler->Pump(Endpoint);
+			}
+			return false;
+		});
+}
+
+void UPlayKitRequestScheduler::Start(const TSharedPtr<FEntry>& Entry)
+{
+	Entry->bActive = true;
+	++ActiveCount[static_cast<int32>(Entry->Endpoint)];
+
+	const double Wait = FPlatformTime::Seconds() - Entry->SubmitTime;
+	FWaitStats& Stats = WaitStats[static_cast<int32>(Entry->Priority)];
+	++Stats.Dispatched;
+	Stats.TotalWait += Wait;
+	Stats.MaxWait = FMath::Max(Stats.MaxWait, Wait);
+
+	UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Scheduler starting %s request after %.3fs (active %d)"),
+		*UEnum::GetValueAsString(Entry->Priority), Wait, ActiveCount[static_cast<int32>(Entry->Endpoint)]);
+
+	Entry->AttemptStartTime = FPlatformTime::Seconds();
+	Entry->FirstByteTime = 0.0;
+	Entry->LastByteTime = 0.0;
+
+	FPlayKitRequestTrace::MarkSent(Entry->Request.Get());
+	Entry->Request->ProcessRequest();
+}
+
+void UPlayKitRequestScheduler::HandleRequestFinished(const TSharedPtr<FEntry>& Entry)
+{
+	if (!Entries.Contains(Entry->Request.Get()))
+	{
+		return;
+	}
+
+	Forget(Entry);
+
+	if (!Entry->bActive)
+	{
+		// Cancelled directly on the request while still queued
+		Dequeue(Entry);
+		return;
+	}
+
+	--ActiveCount[static_cast<int32>(Entry->Endpoint)];
+	Pump(Entry->Endpoint);
+}
+
+bool UPlayKitRequestScheduler::IsRetryableReply(const FHttpRequestPtr& Request)
+{
+	const FHttpResponsePtr Response = Request.IsValid() ? Request->GetResponse() : nullptr;
+	return Response.IsValid() && FPlayKitRetryPolicy::IsRetryableStatus(Response->GetResponseCode());
+}
+
+bool UPlayKitRequestScheduler::ShouldRetry(const TSharedPtr<FEntry>& Entry, const FHttpResponsePtr& Response, bool bWasSuccessful, double& OutDelay)
+{
+	// Never sent, so nothing to learn from and nothing to repeat
+	if (Entry->bExpiredUnsent)
+	{
+		return false;
+	}
+
+	// Every finished attempt passes here; its status and headers tune the endpoint's rate limit
+	FPlayKitRateLimiter::OnResponse(Entry->Endpoint, Response);
+
+	// Off-thread requests decide on the HTTP thread; followers only exist for game thread requests,
+	// so there the list is always empty and only the orphaned flag can change under us
+	const bool bWanted = !Entry->bOrphaned || Entry->Followers.Num() > 0;
+	return FPlayKitRetryPolicy::OnAttemptFinished(Entry->Endpoint, Entry->Request, Response, bWasSuccessful,
+		Entry->Retries, bWanted && !Entry->bDelivered, OutDelay);
+}
+
+bool UPlayKitRequestScheduler::RetryLater(const TSharedPtr<FEntry>& Entry, const FHttpResponsePtr& Response, double Delay)
+{
+	// Forgotten while the decision was on its way from the HTTP thread
+	if (Entries.FindRef(Entry->Request.Get()) != Entry || !Entry->bActive)
+	{
+		return false;
+	}
+
+	// A retry that could not start before the total deadline would only time out
+	const float TotalSeconds = Entry->Deadlines.TotalSeconds;
+	if (TotalSeconds > 0.0f && FPlatformTime::Seconds() + Delay >= Entry->FirstSubmitTime + TotalSeconds)
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Scheduler not retrying %s request, its total deadline passes first"),
+			FPlayKitRequestTrace::GetEndpointName(Entry->Endpoint));
+		return false;
+	}
+
+	Entry->bActive = false;
+	--ActiveCount[static_cast<int32>(Entry->Endpoint)];
+	++Entry->Retries;
+
+	UE_LOG(LogTemp, Warning, TEXT("[PlayKit] Scheduler retrying %s request in %.2fs (retry %d, status %d)"),
+		FPlayKitRequestTrace::GetEndpointName(Entry->Endpoint), Delay, Entry->Retries,
+		Response.IsValid() ? Response->GetResponseCode() : 0);
+
+	Entry->Request->OnRequestWillRetry().ExecuteIfBound(Entry->Request, Response, static_cast<float>(Delay));
+
+	Entry->RetryHandle = FTSTicker::GetCoreTicker().AddTicker(TEXT("PlayKitRequestRetry"), static_cast<float>(Delay),
+		[WeakThis = TWeakObjectPtr<UPlayKitRequestScheduler>(this), WeakEntry = TWeakPtr<FEntry>(Entry)](float)
+		{
+			TSharedPtr<FEntry> Retried = WeakEntry.Pin();
+			UPlayKitRequestScheduler* Scheduler = WeakThis.Get();
+			if (Retried.IsValid() && Scheduler)
+			{
+				Retried->RetryHandle.Reset();
+				if (Scheduler->Entries.FindRef(Retried->Request.Get()) == Retried)
+				{
+					// Queue wait is measured from here, not from the first submit
+					Retried->SubmitTime = FPlatformTime::Seconds();
+					Scheduler->Enqueue(Retried);
+					Scheduler->Pump(Retried->Endpoint);
+				}
+			}
+			return false;
+		});
+
+	Pump(Entry->Endpoint);
+	return true;
+}
+
+FPlayKitRequestDeadlines UPlayKitRequestScheduler::ResolveDeadlines(EPlayKitEndpoint Endpoint, const FPlayKitRequestDeadlines& Overrides)
+{
+	FPlayKitRequestDeadlines Defaults;
+	if (const UPlayKitSettings* Settings = UPlayKitSettings::Get())
+	{
+		if (Endpoint == EPlayKitEndpoint::Chat)
+		{
+			Defaults.FirstByteSeconds = Settings->ChatFirstByteTimeout;
+			Defaults.IdleSeconds = Settings->ChatStreamIdleTimeout;
+			Defaults.TotalSeconds = Settings->ChatTotalTimeout;
+		}
+		else
+		{
+			Defaults.TotalSeconds = Settings->MediaTotalTimeout;
+		}
+	}
+
+	auto Resolve = [](float Override, float Default)
+	{
+		return Override > 0.0f ? Override : (Override < 0.0f ? 0.0f : FMath::Max(0.0f, Default));
+	};
+
+	FPlayKitRequestDeadlines Result;
+	Result.FirstByteSeconds = Resolve(Overrides.FirstByteSeconds, Defaults.FirstByteSeconds);
+	Result.IdleSeconds = Resolve(Overrides.IdleSeconds, Defaults.IdleSeconds);
+	Result.TotalSeconds = Resolve(Overrides.TotalSeconds, Defaults.TotalSeconds);
+	return Result;
+}
+
+void UPlayKitRequestScheduler::MarkReceived(FEntry& Entry, uint64 BytesReceived)
+{
+	if (BytesReceived == 0)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	double NotYet = 0.0;
+	Entry.FirstByteTime.compare_exchange_strong(NotYet, Now);
+	Entry.LastByteTime = Now;
+}
+
+bool UPlayKitRequestScheduler::CheckDeadlines(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+	TArray<TPair<TSharedPtr<FEntry>, const TCHAR*>> Expired;
+	TArray<TSharedPtr<FEntry>> ExpiredUnsent;
+	for (const TPair<IHttpRequest*, TSharedPtr<FEntry>>& Pair : Entries)
+	{
+		const FEntry& Entry = *Pair.Value;
+		if (FPlayKitRequestTrace::HasTimedOut(Entry.Request.Get()))
+		{
+			continue;
+		}
+
+		// Followers share their leader's fate
+		if (!Entry.bActive)
+		{
+			if (!Entry.Leader.IsValid() && Entry.Deadlines.TotalSeconds > 0.0f && Now - Entry.FirstSubmitTime > Entry.Deadlines.TotalSeconds)
+			{
+				ExpiredUnsent.Add(Pair.Value);
+			}
+			continue;
+		}
+
+		const FPlayKitRequestDeadlines& Deadlines = Entry.Deadlines;
+		const double FirstByte = Entry.FirstByteTime;
+		const double Elapsed = Now - Entry.AttemptStartTime;
+		if (Deadlines.TotalSeconds > 0.0f && Now - Entry.FirstSubmitTime > Deadlines.TotalSeconds)
+		{
+			Expired.Emplace(Pair.Value, TEXT("total"));
+		}
+		else if (FirstByte == 0.0 && Deadlines.FirstByteSeconds > 0.0f && Elapsed > Deadlines.FirstByteSeconds)
+		{
+			Expired.Emplace(Pair.Value, TEXT("first byte"));
+		}
+		else if (FirstByte > 0.0 && Deadlines.IdleSeconds > 0.0f && Now - Entry.LastByteTime > Deadlines.IdleSeconds)
+		{
+			Expired.Emplace(Pair.Value, TEXT("idle"));
+		}
+	}
+
+	for (const TPair<TSharedPtr<FEntry>, const TCHAR*>& Pair : Expired)
+	{
+		const TSharedPtr<FEntry>& Entry = Pair.Key;
+		UE_LOG(LogTemp, Warning, TEXT("[PlayKit] Scheduler cancelling %s request after %.1fs: %s deadline passed"),
+			FPlayKitRequestTrace::GetEndpointName(Entry->Endpoint), Now - Entry->FirstSubmitTime, Pair.Value);
+
+		++TimedOutCount;
+		FPlayKitRequestTrace::MarkTimedOut(Entry->Request.Get());
+		Entry->Request->CancelRequest();
+	}
+
+	for (const TSharedPtr<FEntry>& Entry : ExpiredUnsent)
+	{
+		// An earlier completion may have cancelled or started it
+		if (Entries.FindRef(Entry->Request.Get()) == Entry && !Entry->bActive)
+		{
+			FailUnsent(Entry);
+		}
+	}
+	return true;
+}
+
+void UPlayKitRequestScheduler::FailUnsent(const TSharedPtr<FEntry>& Entry)
+{
+	UE_LOG(LogTemp, Warning, TEXT("[PlayKit] Scheduler failing %s request after %.1fs without sending it: total deadline passed"),
+		FPlayKitRequestTrace::GetEndpointName(Entry->Endpoint), FPlatformTime::Seconds() - Entry->FirstSubmitTime);
+
+	if (Entry->RetryHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(Entry->RetryHandle);
+		Entry->RetryHandle.Reset();
+	}
+	Dequeue(Entry);
+	Forget(Entry);
+
+	++TimedOutCount;
+	Entry->bExpiredUnsent = true;
+	FPlayKitRequestTrace::MarkTimedOut(Entry->Request.Get());
+
+	// Through the wrappers, so followers and the trace are completed as for a sent request
+	Entry->Request->OnProcessRequestComplete().ExecuteIfBound(Entry->Request, nullptr, false);
+}
+
+void UPlayKitRequestScheduler::FailFast(const FHttpRequestRef& Request, EPlayKitEndpoint Endpoint)
+{
+	UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] Scheduler failing %s request, circuit is open"), FPlayKitRequestTrace::GetEndpointName(Endpoint));
+	FPlayKitRequestTrace::Begin(&Request.Get(), Endpoint);
+
+	// Owners expect completion after ProcessRequest has returned, as with a request that was sent
+	FTSTicker::GetCoreTicker().AddTicker(TEXT("PlayKitRequestFailFast"), 0.0f, [Request](float)
+	{
+		Request->OnProcessRequestComplete().ExecuteIfBound(Request, nullptr, false);
+		FPlayKitRequestTrace::End(&Request.Get(), nullptr, false);
+		return false;
+	});
+}
+
+FPlayKitSchedulerStats UPlayKitRequestScheduler::GetStats() const
+{
+	FPlayKitSchedulerStats Result;
+	Result.Priorities.SetNum(NumPriorities);
+	Result.ActiveByEndpoint.SetNum(NumEndpoints);
+
+	for (int32 PriorityIndex = 0; PriorityIndex < NumPriorities; ++PriorityIndex)
+	{
+		FPlayKitSchedulerPriorityStats& Stats = Result.Priorities[PriorityIndex];
+		Stats.QueueDepth = GetQueueDepth(static_cast<EPlayKitRequestPriority>(PriorityIndex));
+		Stats.Dispatched = WaitStats[PriorityIndex].Dispatched;
+		Stats.AverageWaitSeconds = Stats.Dispatched > 0 ? static_cast<float>(WaitStats[PriorityIndex].TotalWait / Stats.Dispatched) : 0.0f;
+		Stats.MaxWaitSeconds = static_cast<float>(WaitStats[PriorityIndex].MaxWait);
+		Result.TotalQueued += Stats.QueueDepth;
+	}
+
+	for (int32 EndpointIndex = 0; EndpointIndex < NumEndpoints; ++EndpointIndex)
+	{
+		Result.ActiveByEndpoint[EndpointIndex] = ActiveCount[EndpointIndex];
+		Result.TotalActive += ActiveCount[EndpointIndex];
+	}
+
+	Result.TotalCoalesced = CoalescedCount;
+	Result.TotalTimedOut = TimedOutCount;
+
+	Result.CircuitByEndpoint.SetNum(NumEndpoints);
+	Result.RetriesByEndpoint.SetNum(NumEndpoints);
+	for (int32 EndpointIndex = 0; EndpointIndex < NumEndpoints; ++EndpointIndex)
+	{
+		const FPlayKitRetryEndpointStats Retry = FPlayKitRetryPolicy::GetStats(static_cast<EPlayKitEndpoint>(EndpointIndex));
+		Result.CircuitByEndpoint[EndpointIndex] = Retry.Circuit;
+		Result.RetriesByEndpoint[EndpointIndex] = Retry.Retries;
+		Result.TotalRetries += Retry.Retries;
+		Result.TotalRetriesDenied += Retry.RetriesDenied;
+		Result.TotalFailedFast += Retry.FailedFast;
+	}
+
+	Result.RateLimitByEndpoint.SetNum(NumEndpoints);
+	for (int32 EndpointIndex = 0; EndpointIndex < NumEndpoints; ++EndpointIndex)
+	{
+		const FPlayKitRateLimiterStats Rate = FPlayKitRateLimiter::GetStats(static_cast<EPlayKitEndpoint>(EndpointIndex));
+		Result.RateLimitByEndpoint[EndpointIndex] = static_cast<float>(Rate.RequestsPerSecond * 60.0);
+		Result.TotalRateDelayed += Rate.Delayed;
+		Result.TotalThrottled += Rate.Throttled;
+	}
+
+	return Result;
+}
+
+int32 UPlayKitRequestScheduler::GetQueueDepth(EPlayKitRequestPriority Priority) const
+{
+	if (Queues.Num() == 0)
+	{
+		return 0;
+	}
+
+	int32 Depth = 0;
+	for (int32 EndpointIndex = 0; EndpointIndex < NumEndpoints; ++EndpointIndex)
+	{
+		Depth += Queues[EndpointIndex * NumPriorities + static_cast<int32>(Priority)].Num;
+	}
+	return Depth;
+}
+
+int32 UPlayKitRequestScheduler::GetActiveCount(EPlayKitEndpoint Endpoint) const
+{
+	return Endpoint < EPlayKitEndpoint::MAX ? ActiveCount[static_cast<int32>(Endpoint)] : 0;
+}
@@ -0,0 +1,421 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Interfaces/IHttpRequest.h"
+#include "UObject/ObjectKey.h"
+#include "Containers/Ticker.h"
+#include <atomic>
+#include "PlayKitRequestScheduler.generated.h"
+
+/**
+ * Priority class of a PlayKit request.
+ * Lower values are dispatched first.
+ */
+UENUM(BlueprintType)
+enum class EPlayKitRequestPriority : uint8
+{
+	PlayerDialogue		UMETA(DisplayName = "Player Dialogue"),
+	Ambient				UMETA(DisplayName = "Ambient"),
+	Prediction			UMETA(DisplayName = "Prediction"),
+	Compaction			UMETA(DisplayName = "Compaction"),
+	AssetGeneration		UMETA(DisplayName = "Asset Generation"),
+	MAX					UMETA(Hidden)
+};
+
+/**
+ * Backend endpoint group. Each group has its own concurrency cap.
+ */
+UENUM(BlueprintType)
+enum class EPlayKitEndpoint : uint8
+{
+	Chat				UMETA(DisplayName = "Chat"),
+	Image				UMETA(DisplayName = "Image"),
+	Transcription		UMETA(DisplayName = "Transcription"),
+	Model3D				UMETA(DisplayName = "3D Model"),
+	MAX					UMETA(Hidden)
+};
+
+/**
+ * Thread that runs a request's completion and progress handlers.
+ */
+UENUM(BlueprintType)
+enum class EPlayKitDecodeThread : uint8
+{
+	/** Handlers run on the game thread (default) */
+	GameThread			UMETA(DisplayName = "Game Thread"),
+	/** Handlers run on the HTTP thread; they decode there and queue the finished result for the game thread */
+	HttpThread			UMETA(DisplayName = "HTTP Thread"),
+	/** As HttpThread, but the completion handler runs on a worker so large bodies do not hold up other transfers */
+	Worker				UMETA(DisplayName = "Worker Thread"),
+};
+
+/**
+ * Circuit breaker state of an endpoint group (see FPlayKitRetryPolicy)
+ */
+UENUM(BlueprintType)
+enum class EPlayKitCircuitState : uint8
+{
+	/** Requests are sent */
+	Closed				UMETA(DisplayName = "Closed"),
+	/** The backend keeps failing; requests fail without being sent */
+	Open				UMETA(DisplayName = "Open"),
+	/** One probe request is let through to see whether the backend is back */
+	HalfOpen			UMETA(DisplayName = "Half Open"),
+};
+
+/**
+ * Deadlines of one request, in seconds from each attempt's start.
+ * 0 uses the endpoint's default from UPlayKitSettings, a negative value disables the deadline.
+ * A request that runs past one is cancelled and completes as failed.
+ */
+USTRUCT(BlueprintType)
+struct PLAYKITSDK_API FPlayKitRequestDeadlines
+{
+	GENERATED_BODY()
+
+	/** Until the first byte of the reply (the first token of a stream) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|Scheduler")
+	float FirstByteSeconds = 0.0f;
+
+	/** Longest gap between two pieces of the reply once it has started */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|Scheduler")
+	float IdleSeconds = 0.0f;
+
+	/** From submission until the request has completed, retries included */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="PlayKit|Scheduler")
+	float TotalSeconds = 0.0f;
+};
+
+/**
+ * Queue statistics of one priority class
+ */
+USTRUCT(BlueprintType)
+struct PLAYKITSDK_API FPlayKitSchedulerPriorityStats
+{
+	GENERATED_BODY()
+
+	/** Requests currently waiting for a slot */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	int32 QueueDepth = 0;
+
+	/** Requests started since the scheduler was created */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	int32 Dispatched = 0;
+
+	/** Average time between submit and start */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	float AverageWaitSeconds = 0.0f;
+
+	/** Longest time between submit and start */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	float MaxWaitSeconds = 0.0f;
+};
+
+/**
+ * Snapshot of the scheduler state
+ */
+USTRUCT(BlueprintType)
+struct PLAYKITSDK_API FPlayKitSchedulerStats
+{
+	GENERATED_BODY()
+
+	/** Indexed by EPlayKitRequestPriority */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	TArray<FPlayKitSchedulerPriorityStats> Priorities;
+
+	/** In-flight requests, indexed by EPlayKitEndpoint */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	TArray<int32> ActiveByEndpoint;
+
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	int32 TotalQueued = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	int32 TotalActive = 0;
+
+	/** Requests that were attached to an identical in-flight request instead of being sent */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	int32 TotalCoalesced = 0;
+
+	/** Circuit breaker state, indexed by EPlayKitEndpoint */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	TArray<EPlayKitCircuitState> CircuitByEndpoint;
+
+	/** Retries sent, indexed by EPlayKitEndpoint */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	TArray<int32> RetriesByEndpoint;
+
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	int32 TotalRetries = 0;
+
+	/** Retries refused because the endpoint's retry budget was spent */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	int32 TotalRetriesDenied = 0;
+
+	/** Requests failed without being sent because their endpoint's circuit was open */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	int32 TotalFailedFast = 0;
+
+	/** Requests cancelled because they ran past a deadline */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	int32 TotalTimedOut = 0;
+
+	/** Requests per minute the rate limiter currently lets through (0 = unlimited), indexed by EPlayKitEndpoint */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	TArray<float> RateLimitByEndpoint;
+
+	/** Times a send was held back to stay under an endpoint's rate limit */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	int32 TotalRateDelayed = 0;
+
+	/** Replies rejected by the server's rate limit (429) */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Scheduler")
+	int32 TotalThrottled = 0;
+};
+
+/**
+ * PlayKit Request Scheduler
+ * Owns all outbound AI requests of a game instance.
+ *
+ * Requests are queued per endpoint and started when the endpoint has a free slot
+ * (caps come from UPlayKitSettings). Higher priority classes always go first, and
+ * a few chat slots are reserved for player dialogue so a burst of ambient NPC
+ * traffic cannot hold up the player's conversation. Within a priority class,
+ * owners (usually components) are served round-robin.
+ *
+ * Requests submitted with bCoalesce are hashed (URL, verb, auth, body). A request
+ * identical to one already queued or in flight is not sent; it is attached to the
+ * existing one and receives the same progress and completion callbacks, so
+ * streaming subscribers decode the same bytes and see the same deltas.
+ *
+ * Clients hand a fully configured request (delegates bound) to ProcessRequest()
+ * instead of calling IHttpRequest::ProcessRequest() themselves. Every request that
+ * is actually sent is timed by FPlayKitRequestTrace.
+ *
+ * Requests submitted with a DecodeThread other than GameThread call their owner's
+ * handlers off the game thread. Those handlers must only decode and then hand the
+ * result over with FPlayKitGameThreadQueue; they are also called for requests that
+ * were cancelled, so the game-thread side has to check the request is still wanted.
+ * Such requests are never coalesced.
+ *
+ * Failed attempts are retried and failing endpoints are cut off as FPlayKitRetryPolicy
+ * decides. A retried request waits out its backoff, then queues again at its priority;
+ * its owner only hears of the final attempt, and OnRequestWillRetry() is called before
+ * each retry so a client that installed a receive stream can reset it. Progress of a
+ * reply with a retryable status is held back, so the owner never decodes a failed attempt.
+ * While an endpoint's circuit is open, submitted requests complete as failed on the next
+ * tick without being sent.
+ *
+ * Sends are also paced by FPlayKitRateLimiter: a request whose endpoint has no rate limit
+ * token left stays queued until one is due, rather than being sent into a 429.
+ *
+ * Every attempt is watched against its FPlayKitRequestDeadlines: time to first byte and the
+ * gap between received pieces per attempt, and the total across retries. One that runs past
+ * a deadline is cancelled, and one still waiting (queued, held by the rate limiter or backing
+ * off before a retry) when its total passes fails without being sent;
+ * FPlayKitRequestTrace::HasTimedOut() tells its handler the failure was a timeout.
+ */
+UCLASS()
+class PLAYKITSDK_API UPlayKitRequestScheduler : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	using FHttpRequestRef = TSharedRef<IHttpRequest, ESPMode::ThreadSafe>;
+	using FHttpRequestPtrTS = TSharedPtr<IHttpRequest, ESPMode::ThreadSafe>;
+
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End USubsystem Interface
+
+	/** Get the scheduler of the game instance that owns WorldContextObject */
+	static UPlayKitRequestScheduler* Get(const UObject* WorldContextObject);
+
+	/**
+	 * Submit a request through the scheduler of Owner's game instance.
+	 * Falls back to starting the request directly when there is no game instance
+	 * (e.g. editor utilities).
+	 */
+	static void ProcessRequest(const UObject* Owner, const FHttpRequestRef& Request,
+		EPlayKitEndpoint Endpoint, EPlayKitRequestPriority Priority, bool bCoalesce = false,
+		EPlayKitDecodeThread DecodeThread = EPlayKitDecodeThread::GameThread,
+		const FPlayKitRequestDeadlines& Deadlines = FPlayKitRequestDeadlines());
+
+	/**
+	 * Cancel a request submitted with ProcessRequest().
+	 * The owner's delegates are not invoked for a request cancelled through the scheduler.
+	 * A request that identical requests are attached to keeps running for them.
+	 */
+	static void CancelRequest(const UObject* Owner, const FHttpRequestPtrTS& Request);
+
+	/**
+	 * Queue a request; it is started as soon as its endpoint has a free slot.
+	 * @param bCoalesce Attach to an identical queued or in-flight request instead of sending a new one.
+	 *                  Only use for requests that do not install a response receive stream.
+	 * @param DecodeThread Thread the request's handlers run on
+	 * @param Deadlines Overrides of the endpoint's default deadlines
+	 */
+	void Submit(const FHttpRequestRef& Request, EPlayKitEndpoint Endpoint,
+		EPlayKitRequestPriority Priority, const UObject* Owner, bool bCoalesce = false,
+		EPlayKitDecodeThread DecodeThread = EPlayKitDecodeThread::GameThread,
+		const FPlayKitRequestDeadlines& Deadlines = FPlayKitRequestDeadlines());
+
+	/**
+	 * Cancel a submitted request.
+	 * @return false if the scheduler does not know the request
+	 */
+	bool Cancel(const FHttpRequestPtrTS& Request);
+
+	/** Current queue depths, wait times and in-flight counts */
+	UFUNCTION(BlueprintPure, Category="PlayKit|Scheduler")
+	FPlayKitSchedulerStats GetStats() const;
+
+	/** Number of requests waiting in a priority class */
+	UFUNCTION(BlueprintPure, Category="PlayKit|Scheduler")
+	int32 GetQueueDepth(EPlayKitRequestPriority Priority) const;
+
+	/** Number of in-flight requests for an endpoint */
+	UFUNCTION(BlueprintPure, Category="PlayKit|Scheduler")
+	int32 GetActiveCount(EPlayKitEndpoint Endpoint) const;
+
+private:
+	struct FEntry
+	{
+		FHttpRequestPtrTS Request;
+		EPlayKitEndpoint Endpoint = EPlayKitEndpoint::Chat;
+		EPlayKitRequestPriority Priority = EPlayKitRequestPriority::Ambient;
+		FObjectKey Owner;
+		double SubmitTime = 0.0;
+		EPlayKitDecodeThread DecodeThread = EPlayKitDecodeThread::GameThread;
+		bool bActive = false;
+
+		/** Owner cancelled, but the request keeps running for its followers. Set on the game thread, read by retry decisions on the HTTP thread. */
+		std::atomic<bool> bOrphaned { false };
+
+		// Retries
+		int32 Retries = 0;
+		FTSTicker::FDelegateHandle RetryHandle;
+
+		/** Response bytes were passed to a handler; the request can no longer be sent again */
+		std::atomic<bool> bDelivered { false };
+
+		/** Failed by its total deadline before it was sent; its completion is not an attempt */
+		bool bExpiredUnsent = false;
+
+		// Deadlines (resolved, 0 = none) and the current attempt's timing; bytes are marked from the HTTP thread.
+		// The total deadline runs from the first submit, which unlike SubmitTime is kept across retries.
+		FPlayKitRequestDeadlines Deadlines;
+		double FirstSubmitTime = 0.0;
+		double AttemptStartTime = 0.0;
+		std::atomic<double> FirstByteTime { 0.0 };
+		std::atomic<double> LastByteTime { 0.0 };
+
+		// Coalescing
+		bool bCoalescible = false;
+		uint64 CoalesceKey = 0;
+		TArray<TSharedPtr<FEntry>> Followers;
+		TWeakPtr<FEntry> Leader;
+
+		// Owner delegates of a follower, invoked with the leader's request and response
+		FHttpRequestCompleteDelegate OnComplete;
+		FHttpRequestProgressDelegate64 OnProgress;
+	};
+
+	/** Requests of one owner within a priority class, in submit order */
+	struct FOwnerQueue
+	{
+		FObjectKey Owner;
+		TArray<TSharedPtr<FEntry>> Entries;
+	};
+
+	/** Round-robin queue of one priority class for one endpoint */
+	struct FPriorityQueue
+	{
+		TArray<FOwnerQueue> Owners;
+		int32 NextOwner = 0;
+		int32 Num = 0;
+	};
+
+	struct FWaitStats
+	{
+		int32 Dispatched = 0;
+		double TotalWait = 0.0;
+		double MaxWait = 0.0;
+	};
+
+	static constexpr int32 NumEndpoints = static_cast<int32>(EPlayKitEndpoint::MAX);
+	static constexpr int32 NumPriorities = static_cast<int32>(EPlayKitRequestPriority::MAX);
+
+	static uint64 ComputeCoalesceKey(const IHttpRequest& Request);
+
+	/** Called on the thread a request completed on: run Complete there, or on a worker for EPlayKitDecodeThread::Worker */
+	static void RunCompletion(EPlayKitDecodeThread DecodeThread, TUniqueFunction<void()>&& Complete);
+	static bool IsSameRequest(const IHttpRequest& A, const IHttpRequest& B);
+
+	void BindWrappers(const TSharedPtr<FEntry>& Entry);
+	void BindOffThreadWrappers(const TSharedPtr<FEntry>& Entry);
+	bool TryAttachFollower(const TSharedPtr<FEntry>& Entry);
+	void DetachFollower(const TSharedPtr<FEntry>& Follower);
+	void Enqueue(const TSharedPtr<FEntry>& Entry);
+	bool Dequeue(const TSharedPtr<FEntry>& Entry);
+	void Forget(const TSharedPtr<FEntry>& Entry);
+
+	FPriorityQueue& GetQueue(EPlayKitEndpoint Endpoint, EPlayKitRequestPriority Priority);
+	int32 GetEndpointCap(EPlayKitEndpoint Endpoint) const;
+	int32 GetReservedSlots(EPlayKitEndpoint Endpoint) const;
+	TSharedPtr<FEntry> PopNext(FPriorityQueue& Queue);
+	void Pump(EPlayKitEndpoint Endpoint);
+
+	/** Pump an endpoint again once its rate limiter has a token */
+	void PumpLater(EPlayKitEndpoint Endpoint, double Delay);
+	void Start(const TSharedPtr<FEntry>& Entry);
+	void HandleRequestFinished(const TSharedPtr<FEntry>& Entry);
+
+	/** The reply has a status the attempt may be repeated for; its progress is held back */
+	static bool IsRetryableReply(const FHttpRequestPtr& Request);
+
+	/** Called on the thread the attempt completed on */
+	static bool ShouldRetry(const TSharedPtr<FEntry>& Entry, const FHttpResponsePtr& Response, bool bWasSuccessful, double& OutDelay);
+
+	/**
+	 * Release the slot of a failed attempt and queue the request again after Delay.
+	 * @return false if the scheduler no longer tracks the request
+	 */
+	bool RetryLater(const TSharedPtr<FEntry>& Entry, const FHttpResponsePtr& Response, double Delay);
+
+	/** Deadlines with the endpoint's defaults filled in */
+	static FPlayKitRequestDeadlines ResolveDeadlines(EPlayKitEndpoint Endpoint, const FPlayKitRequestDeadlines& Overrides);
+
+	/** Record received bytes of an attempt; any thread */
+	static void MarkReceived(FEntry& Entry, uint64 BytesReceived);
+
+	/** Cancel the attempts that ran past a deadline, and fail waiting requests past their total */
+	bool CheckDeadlines(float DeltaTime);
+
+	/** Fail a request that is queued or waiting to retry without sending it */
+	void FailUnsent(const TSharedPtr<FEntry>& Entry);
+
+	/** Complete a request its endpoint's open circuit keeps from being sent */
+	static void FailFast(const FHttpRequestRef& Request, EPlayKitEndpoint Endpoint);
+
+private:
+	/** [Endpoint * NumPriorities + Priority] */
+	TArray<FPriorityQueue> Queues;
+
+	/** Every submitted request that has not finished yet, including followers */
+	TMap<IHttpRequest*, TSharedPtr<FEntry>> Entries;
+
+	/** Coalescible requests that are queued or in flight, by body hash */
+	TMap<uint64, TSharedPtr<FEntry>> Coalescible;
+
+	int32 ActiveCount[NumEndpoints] = {};
+	FWaitStats WaitStats[NumPriorities];
+	int32 CoalescedCount = 0;
+	int32 TimedOutCount = 0;
+	FTSTicker::FDelegateHandle DeadlineTicker;
+	FTSTicker::FDelegateHandle RatePumpHandles[NumEndpoints];
+};
@@ -0,0 +1,353 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitRequestTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include "Misc/ScopeLock.h"
+
+DEFINE_STAT(STAT_PlayKitStreamDecode);
+DEFINE_STAT(STAT_PlayKitResponseParse);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Requests Queued"), STAT_PlayKitRequestsQueued, STATGROUP_PlayKit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Requests In Flight"), STAT_PlayKitRequestsInFlight, STATGROUP_PlayKit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Requests Succeeded"), STAT_PlayKitRequestsSucceeded, STATGROUP_PlayKit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Requests Failed"), STAT_PlayKitRequestsFailed, STATGROUP_PlayKit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Requests Timed Out"), STAT_PlayKitRequestsTimedOut, STATGROUP_PlayKit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bytes Sent"), STAT_PlayKitBytesSent, STATGROUP_PlayKit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Bytes Received"), STAT_PlayKitBytesReceived, STATGROUP_PlayKit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Prompt Tokens"), STAT_PlayKitPromptTokens, STATGROUP_PlayKit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Completion Tokens"), STAT_PlayKitCompletionTokens, STATGROUP_PlayKit);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Queue Wait (ms)"), STAT_PlayKitQueueMs, STATGROUP_PlayKit);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Time To First Byte (ms)"), STAT_PlayKitTimeToFirstByteMs, STATGROUP_PlayKit);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Time To First Token (ms)"), STAT_PlayKitTimeToFirstTokenMs, STATGROUP_PlayKit);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Total (ms)"), STAT_PlayKitTotalMs, STATGROUP_PlayKit);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last Tokens Per Second"), STAT_PlayKitTokensPerSecond, STATGROUP_PlayKit);
+
+CSV_DEFINE_CATEGORY(PlayKit, true);
+
+UE_TRACE_CHANNEL_DEFINE(PlayKitChannel)
+
+UE_TRACE_EVENT_BEGIN(PlayKit, RequestTimeline)
+	UE_TRACE_EVENT_FIELD(uint32, RequestId)
+	UE_TRACE_EVENT_FIELD(uint8, Endpoint)
+	UE_TRACE_EVENT_FIELD(uint64, QueuedCycle)
+	UE_TRACE_EVENT_FIELD(uint64, SentCycle)
+	UE_TRACE_EVENT_FIELD(uint64, FirstByteCycle)
+	UE_TRACE_EVENT_FIELD(uint64, FirstTokenCycle)
+	UE_TRACE_EVENT_FIELD(uint64, LastTokenCycle)
+	UE_TRACE_EVENT_FIELD(uint64, CompletedCycle)
+	UE_TRACE_EVENT_FIELD(uint64, BytesSent)
+	UE_TRACE_EVENT_FIELD(uint64, BytesReceived)
+	UE_TRACE_EVENT_FIELD(uint32, PromptTokens)
+	UE_TRACE_EVENT_FIELD(uint32, CompletionTokens)
+	UE_TRACE_EVENT_FIELD(int32, ResponseCode)
+	UE_TRACE_EVENT_FIELD(bool, Succeeded)
+UE_TRACE_EVENT_END()
+
+namespace
+{
+	/** Requests between Begin and End */
+	TMap<const IHttpRequest*, FPlayKitRequestTimeline> Timelines;
+	uint32 NextTimelineId = 1;
+
+	/** Requests that decode off the game thread mark progress and tokens from the HTTP thread */
+	FCriticalSection TimelinesMutex;
+
+	/** Time to first token of the last streamed requests per endpoint, as a ring; guarded by TimelinesMutex */
+	constexpr int32 MaxFirstTokenSamples = 128;
+	TArray<double> FirstTokenSamples[static_cast<int32>(EPlayKitEndpoint::MAX)];
+	int32 NextFirstTokenSample[static_cast<int32>(EPlayKitEndpoint::MAX)] = {};
+
+	/** Call with TimelinesMutex held */
+	FPlayKitRequestTimeline* FindTimeline(const IHttpRequest* Request)
+	{
+		return Request ? Timelines.Find(Request) : nullptr;
+	}
+
+	/** Unique per request, so overlapping requests get separate regions */
+	FString GetRegionName(const FPlayKitRequestTimeline& Timeline)
+	{
+		return FString::Printf(TEXT("PlayKit %s #%u"), FPlayKitRequestTrace::GetEndpointName(Timeline.Endpoint), Timeline.Id);
+	}
+
+	float ToMilliseconds(double Seconds)
+	{
+		return static_cast<float>(Seconds * 1000.0);
+	}
+}
+
+double FPlayKitRequestTimeline::Span(uint64 From, uint64 To)
+{
+	return (From != 0 && To >= From) ? FPlatformTime::ToSeconds64(To - From) : 0.0;
+}
+
+double FPlayKitRequestTimeline::GetTokensPerSecond() const
+{
+	const int32 Tokens = CompletionTokens > 0 ? CompletionTokens : StreamedTokens;
+
+	// A stream generates between its first and last delta; a plain response over the whole exchange
+	double Seconds = StreamedTokens > 1 ? Span(FirstTokenCycles, LastTokenCycles) : 0.0;
+	if (Seconds <= 0.0)
+	{
+		Seconds = Span(SentCycles, CompletedCycles);
+	}
+	return (Tokens > 0 && Seconds > 0.0) ? Tokens / Seconds : 0.0;
+}
+
+void FPlayKitRequestTrace::Begin(const IHttpRequest* Request, EPlayKitEndpoint Endpoint)
+{
+	if (!Request)
+	{
+		return;
+	}
+
+	FScopeLock Lock(&TimelinesMutex);
+	FPlayKitRequestTimeline& Timeline = Timelines.FindOrAdd(Request);
+	Timeline = FPlayKitRequestTimeline();
+	Timeline.Id = NextTimelineId++;
+	Timeline.Endpoint = Endpoint;
+	Timeline.QueuedCycles = FPlatformTime::Cycles64();
+
+	INC_DWORD_STAT(STAT_PlayKitRequestsQueued);
+}
+
+void FPlayKitRequestTrace::MarkSent(const IHttpRequest* Request)
+{
+	FScopeLock Lock(&TimelinesMutex);
+	FPlayKitRequestTimeline* Timeline = FindTimeline(Request);
+	if (!Timeline || Timeline->SentCycles != 0)
+	{
+		return;
+	}
+
+	Timeline->SentCycles = FPlatformTime::Cycles64();
+	Timeline->BytesSent = Request->GetContentLength();
+
+	DEC_DWORD_STAT(STAT_PlayKitRequestsQueued);
+	INC_DWORD_STAT(STAT_PlayKitRequestsInFlight);
+	INC_DWORD_STAT_BY(STAT_PlayKitBytesSent, Timeline->BytesSent);
+	CSV_CUSTOM_STAT(PlayKit, BytesSent, static_cast<int32>(Timeline->BytesSent), ECsvCustomStatOp::Accumulate);
+	CSV_CUSTOM_STAT(PlayKit, RequestsSent, 1, ECsvCustomStatOp::Accumulate);
+
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(PlayKitChannel))
+	{
+		TRACE_BEGIN_REGION(*GetRegionName(*Timeline));
+	}
+}
+
+void FPlayKitRequestTrace::MarkReceived(const IHttpRequest* Request, uint64 BytesReceived)
+{
+	FScopeLock Lock(&TimelinesMutex);
+	FPlayKitRequestTimeline* Timeline = FindTimeline(Request);
+	if (!Timeline || BytesReceived == 0)
+	{
+		return;
+	}
+
+	if (Timeline->FirstByteCycles == 0)
+	{
+		Timeline->FirstByteCycles = FPlatformTime::Cycles64();
+	}
+	Timeline->BytesReceived = FMath::Max<int64>(Timeline->BytesReceived, BytesReceived);
+}
+
+void FPlayKitRequestTrace::MarkToken(const IHttpRequest* Request)
+{
+	FScopeLock Lock(&TimelinesMutex);
+	FPlayKitRequestTimeline* Timeline = FindTimeline(Request);
+	if (!Timeline)
+	{
+		return;
+	}
+
+	Timeline->LastTokenCycles = FPlatformTime::Cycles64();
+	if (Timeline->FirstTokenCycles == 0)
+	{
+		Timeline->FirstTokenCycles = Timeline->LastTokenCycles;
+	}
+	++Timeline->StreamedTokens;
+}
+
+void FPlayKitRequestTrace::SetUsage(const IHttpRequest* Request, int32 PromptTokens, int32 CompletionTokens)
+{
+	FScopeLock Lock(&TimelinesMutex);
+	if (FPlayKitRequestTimeline* Timeline = FindTimeline(Request))
+	{
+		Timeline->PromptTokens = PromptTokens;
+		Timeline->CompletionTokens = CompletionTokens;
+	}
+}
+
+void FPlayKitRequestTrace::MarkTimedOut(const IHttpRequest* Request)
+{
+	FScopeLock Lock(&TimelinesMutex);
+	if (FPlayKitRequestTimeline* Timeline = FindTimeline(Request))
+	{
+		Timeline->bTimedOut = true;
+	}
+}
+
+bool FPlayKitRequestTrace::HasTimedOut(const IHttpRequest* Request)
+{
+	FScopeLock Lock(&TimelinesMutex);
+	const FPlayKitRequestTimeline* Timeline = FindTimeline(Request);
+	return Timeline && Timeline->bTimedOut;
+}
+
+double FPlayKitRequestTrace::GetRecentTimeToFirstToken(EPlayKitEndpoint Endpoint, double Percentile, int32 MinSamples)
+{
+	if (Endpoint >= EPlayKitEndpoint::MAX)
+	{
+		return 0.0;
+	}
+
+	TArray<double> Sorted;
+	{
+		FScopeLock Lock(&TimelinesMutex);
+		Sorted = FirstTokenSamples[static_cast<int32>(Endpoint)];
+	}
+	if (Sorted.Num() == 0 || Sorted.Num() < MinSamples)
+	{
+		return 0.0;
+	}
+
+	Sorted.Sort();
+	const int32 Rank = FMath::Clamp(FMath::CeilToInt(Percentile * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+	return Sorted[Rank];
+}
+
+void FPlayKitRequestTrace::End(const IHttpRequest* Request, const FHttpResponsePtr& Response, bool bSucceeded)
+{
+	FPlayKitRequestTimeline Timeline;
+	{
+		FScopeLock Lock(&TimelinesMutex);
+		if (!Request || !Timelines.RemoveAndCopyValue(Request, Timeline))
+		{
+			return;
+		}
+	}
+
+	Timeline.CompletedCycles = FPlatformTime::Cycles64();
+	if (Response.IsValid())
+	{
+		Timeline.ResponseCode = Response->GetResponseCode();
+		Timeline.BytesReceived = FMath::Max<int64>(Timeline.BytesReceived, Response->GetContent().Num());
+		if (Timeline.FirstByteCycles == 0 && Timeline.BytesReceived > 0)
+		{
+			Timeline.FirstByteCycles = Timeline.CompletedCycles;
+		}
+	}
+	Timeline.bSucceeded = bSucceeded && Timeline.ResponseCode >= 200 && Timeline.ResponseCode < 300;
+
+	// Only streamed replies have a first token apart from the whole reply
+	if (Timeline.bSucceeded && Timeline.StreamedTokens > 0)
+	{
+		const int32 EndpointIndex = static_cast<int32>(Timeline.Endpoint);
+		FScopeLock Lock(&TimelinesMutex);
+		TArray<double>& Samples = FirstTokenSamples[EndpointIndex];
+		if (Samples.Num() < MaxFirstTokenSamples)
+		{
+			Samples.Add(Timeline.GetTimeToFirstToken());
+		}
+		else
+		{
+			Samples[NextFirstTokenSample[EndpointIndex]] = Timeline.GetTimeToFirstToken();
+		}
+		NextFirstTokenSample[EndpointIndex] = (NextFirstTokenSample[EndpointIndex] + 1) % MaxFirstTokenSamples;
+	}
+
+	// A response that was not streamed reaches the game all at once
+	if (Timeline.bSucceeded && Timeline.FirstTokenCycles == 0)
+	{
+		Timeline.FirstTokenCycles = Timeline.CompletedCycles;
+		Timeline.LastTokenCycles = Timeline.CompletedCycles;
+	}
+
+	const bool bWasSent = Timeline.SentCycles != 0;
+	if (bWasSent)
+	{
+		DEC_DWORD_STAT(STAT_PlayKitRequestsInFlight);
+	}
+	else
+	{
+		DEC_DWORD_STAT(STAT_PlayKitRequestsQueued);
+	}
+
+	INC_DWORD_STAT(Timeline.bSucceeded ? STAT_PlayKitRequestsSucceeded : STAT_PlayKitRequestsFailed);
+	if (Timeline.bTimedOut)
+	{
+		INC_DWORD_STAT(STAT_PlayKitRequestsTimedOut);
+	}
+	INC_DWORD_STAT_BY(STAT_PlayKitBytesReceived, Timeline.BytesReceived);
+	INC_DWORD_STAT_BY(STAT_PlayKitPromptTokens, Timeline.PromptTokens);
+	INC_DWORD_STAT_BY(STAT_PlayKitCompletionTokens, Timeline.CompletionTokens);
+
+	const float QueueMs = ToMilliseconds(Timeline.GetQueueSeconds());
+	const float TimeToFirstByteMs = ToMilliseconds(Timeline.GetTimeToFirstByte());
+	const float TimeToFirstTokenMs = ToMilliseconds(Timeline.GetTimeToFirstToken());
+	const float TotalMs = ToMilliseconds(Timeline.GetTotalSeconds());
+	const float TokensPerSecond = static_cast<float>(Timeline.GetTokensPerSecond());
+
+	SET_FLOAT_STAT(STAT_PlayKitQueueMs, QueueMs);
+	SET_FLOAT_STAT(STAT_PlayKitTotalMs, TotalMs);
+	if (Timeline.bSucceeded)
+	{
+		SET_FLOAT_STAT(STAT_PlayKitTimeToFirstByteMs, TimeToFirstByteMs);
+		SET_FLOAT_STAT(STAT_PlayKitTimeToFirstTokenMs, TimeToFirstTokenMs);
+		SET_FLOAT_STAT(STAT_PlayKitTokensPerSecond, TokensPerSecond);
+
+		CSV_CUSTOM_STAT(PlayKit, TimeToFirstByteMs, TimeToFirstByteMs, ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(PlayKit, TimeToFirstTokenMs, TimeToFirstTokenMs, ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(PlayKit, TokensPerSecond, TokensPerSecond, ECsvCustomStatOp::Set);
+	}
+	else
+	{
+		CSV_CUSTOM_STAT(PlayKit, RequestsFailed, 1, ECsvCustomStatOp::Accumulate);
+		CSV_EVENT(PlayKit, TEXT("%s request %u failed (%d)"), GetEndpointName(Timeline.Endpoint), Timeline.Id, Timeline.ResponseCode);
+	}
+	CSV_CUSTOM_STAT(PlayKit, QueueMs, QueueMs, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(PlayKit, TotalMs, TotalMs, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(PlayKit, BytesReceived, static_cast<int32>(Timeline.BytesReceived), ECsvCustomStatOp::Accumulate);
+	CSV_CUSTOM_STAT(PlayKit, CompletionTokens, Timeline.CompletionTokens, ECsvCustomStatOp::Accumulate);
+
+	if (UE_TRACE_CHANNELEXPR_IS_ENABLED(PlayKitChannel))
+	{
+		UE_TRACE_LOG(PlayKit, RequestTimeline, PlayKitChannel)
+			<< RequestTimeline.RequestId(Timeline.Id)
+			<< RequestTimeline.Endpoint(static_cast<uint8>(Timeline.Endpoint))
+			<< RequestTimeline.QueuedCycle(Timeline.QueuedCycles)
+			<< RequestTimeline.SentCycle(Timeline.SentCycles)
+			<< RequestTimeline.FirstByteCycle(Timeline.FirstByteCycles)
+			<< RequestTimeline.FirstTokenCycle(Timeline.FirstTokenCycles)
+			<< RequestTimeline.LastTokenCycle(Timeline.LastTokenCycles)
+			<< RequestTimeline.CompletedCycle(Timeline.CompletedCycles)
+			<< RequestTimeline.BytesSent(Timeline.BytesSent)
+			<< RequestTimeline.BytesReceived(Timeline.BytesReceived)
+			<< RequestTimeline.PromptTokens(Timeline.PromptTokens)
+			<< RequestTimeline.CompletionTokens(Timeline.CompletionTokens)
+			<< RequestTimeline.ResponseCode(Timeline.ResponseCode)
+			<< RequestTimeline.Succeeded(Timeline.bSucceeded);
+
+		if (bWasSent)
+		{
+			TRACE_END_REGION(*GetRegionName(Timeline));
+		}
+	}
+
+	UE_LOG(LogTemp, Verbose, TEXT("[PlayKit] %s request %u %s (HTTP %d): queue %.1f ms, first byte %.1f ms, first token %.1f ms, total %.1f ms, %lld B out, %lld B in, %d+%d tokens, %.1f tokens/s"),
+		GetEndpointName(Timeline.Endpoint), Timeline.Id, Timeline.bSucceeded ? TEXT("succeeded") : TEXT("failed"), Timeline.ResponseCode,
+		QueueMs, TimeToFirstByteMs, TimeToFirstTokenMs, TotalMs, Timeline.BytesSent, Timeline.BytesReceived,
+		Timeline.PromptTokens, Timeline.CompletionTokens, TokensPerSecond);
+}
+
+const TCHAR* FPlayKitRequestTrace::GetEndpointName(EPlayKitEndpoint Endpoint)
+{
+	switch (Endpoint)
+	{
+	case EPlayKitEndpoint::Chat:			return TEXT("Chat");
+	case EPlayKitEndpoint::Image:			return TEXT("Image");
+	case EPlayKitEndpoint::Transcription:	return TEXT("Transcription");
+	case EPlayKitEndpoint::Model3D:			return TEXT("3D");
+	default:								return TEXT("Unknown");
+	}
+}
@@ -0,0 +1,116 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "PlayKitRequestScheduler.h"
+
+DECLARE_STATS_GROUP(TEXT("PlayKit"), STATGROUP_PlayKit, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Stream Decode"), STAT_PlayKitStreamDecode, STATGROUP_PlayKit, PLAYKITSDK_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Response Parse"), STAT_PlayKitResponseParse, STATGROUP_PlayKit, PLAYKITSDK_API);
+
+CSV_DECLARE_CATEGORY_EXTERN(PlayKit);
+
+/** Insights channel of the PlayKit request events and regions: -trace=default,PlayKit */
+UE_TRACE_CHANNEL_EXTERN(PlayKitChannel, PLAYKITSDK_API)
+
+/**
+ * Timeline of one PlayKit request.
+ * Times are FPlatformTime::Cycles64() values, 0 for milestones the request never reached.
+ */
+struct PLAYKITSDK_API FPlayKitRequestTimeline
+{
+	uint32 Id = 0;
+	EPlayKitEndpoint Endpoint = EPlayKitEndpoint::Chat;
+
+	uint64 QueuedCycles = 0;
+	uint64 SentCycles = 0;
+	uint64 FirstByteCycles = 0;
+	uint64 FirstTokenCycles = 0;
+	uint64 LastTokenCycles = 0;
+	uint64 CompletedCycles = 0;
+
+	int64 BytesSent = 0;
+	int64 BytesReceived = 0;
+
+	/** Text deltas decoded from a stream */
+	int32 StreamedTokens = 0;
+
+	/** Token counts reported in the response "usage" */
+	int32 PromptTokens = 0;
+	int32 CompletionTokens = 0;
+
+	int32 ResponseCode = 0;
+	bool bSucceeded = false;
+
+	/** The scheduler cancelled the request because it ran past a deadline */
+	bool bTimedOut = false;
+
+	/** Seconds from From to To, or 0 if either was not reached */
+	static double Span(uint64 From, uint64 To);
+
+	double GetQueueSeconds() const { return Span(QueuedCycles, SentCycles); }
+	double GetTimeToFirstByte() const { return Span(SentCycles, FirstByteCycles); }
+	double GetTimeToFirstToken() const { return Span(SentCycles, FirstTokenCycles); }
+	double GetTotalSeconds() const { return Span(QueuedCycles, CompletedCycles); }
+
+	/** Generation rate: usage tokens (or streamed deltas) over the time tokens were arriving */
+	double GetTokensPerSecond() const;
+};
+
+/**
+ * Per-request latency instrumentation.
+ *
+ * The request scheduler records when a request is queued, sent, receives its first
+ * byte and completes; clients add the first and last streamed token and the usage
+ * token counts. On completion the timeline is published as:
+ *   - stats (stat PlayKit): in-flight and completed counts, bytes, tokens and the
+ *     latencies of the last completed request
+ *   - CSV profiler category "PlayKit"
+ *   - an Insights event PlayKit.RequestTimeline and a timing region per request on
+ *     PlayKitChannel, to line AI latency up with frame hitches in a capture
+ *
+ * Requests are keyed by their IHttpRequest. Unknown requests are ignored, so clients
+ * can mark tokens on requests that were coalesced or never sent.
+ * Thread-safe: requests that decode off the game thread are marked from the HTTP thread.
+ */
+class PLAYKITSDK_API FPlayKitRequestTrace
+{
+public:
+	/** The request was submitted and waits for a slot */
+	static void Begin(const IHttpRequest* Request, EPlayKitEndpoint Endpoint);
+
+	/** The request was handed to the HTTP module */
+	static void MarkSent(const IHttpRequest* Request);
+
+	/** Progress callback; the first call with received bytes is the time to first byte */
+	static void MarkReceived(const IHttpRequest* Request, uint64 BytesReceived);
+
+	/** A text delta was decoded from the response stream */
+	static void MarkToken(const IHttpRequest* Request);
+
+	/** Token counts parsed from the response */
+	static void SetUsage(const IHttpRequest* Request, int32 PromptTokens, int32 CompletionTokens);
+
+	/** The scheduler is cancelling the request because it ran past a deadline */
+	static void MarkTimedOut(const IHttpRequest* Request);
+
+	/** The request was cancelled by MarkTimedOut's caller; valid until End() */
+	static bool HasTimedOut(const IHttpRequest* Request);
+
+	/** The request finished, failed or was cancelled; publishes and forgets its timeline */
+	static void End(const IHttpRequest* Request, const FHttpResponsePtr& Response, bool bSucceeded);
+
+	/**
+	 * Time to first token of recent successful streamed requests of an endpoint, at a percentile (0..1).
+	 * @return 0 while fewer than MinSamples requests have been seen
+	 */
+	static double GetRecentTimeToFirstToken(EPlayKitEndpoint Endpoint, double Percentile, int32 MinSamples = 20);
+
+	static const TCHAR* GetEndpointName(EPlayKitEndpoint Endpoint);
+};
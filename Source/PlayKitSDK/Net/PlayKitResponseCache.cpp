@@ -0,0 +1,389 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitResponseCache.h"
+#include "PlayKitMemory.h"
+#include "PlayKitSettings.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Policies/CondensedJsonPrintPolicy.h"
+
+namespace
+{
+	/** Compact JSON with object keys sorted, so equivalent schemas produce the same text */
+	void WriteCanonicalJson(const TSharedPtr<FJsonValue>& Value, FString& Out)
+	{
+		if (!Value.IsValid())
+		{
+			Out += TEXT("null");
+			return;
+		}
+
+		switch (Value->Type)
+		{
+		case EJson::String:
+			Out += TEXT("\"") + Value->AsString().ReplaceCharWithEscapedChar() + TEXT("\"");
+			break;
+		case EJson::Number:
+			Out += FString::SanitizeFloat(Value->AsNumber());
+			break;
+		case EJson::Boolean:
+			Out += Value->AsBool() ? TEXT("true") : TEXT("false");
+			break;
+		case EJson::Array:
+			{
+				Out += TEXT("[");
+				const TArray<TSharedPtr<FJsonValue>>& Items = Value->AsArray();
+				for (int32 Index = 0; Index < Items.Num(); ++Index)
+				{
+					Out += Index > 0 ? TEXT(",") : TEXT("");
+					WriteCanonicalJson(Items[Index], Out);
+				}
+				Out += TEXT("]");
+			}
+			break;
+		case EJson::Object:
+			{
+				const TSharedPtr<FJsonObject>& Object = Value->AsObject();
+				TArray<FString> Keys;
+				Object->Values.GenerateKeyArray(Keys);
+				Keys.Sort();
+
+				Out += TEXT("{");
+				for (int32 Index = 0; Index < Keys.Num(); ++Index)
+				{
+					Out += Index > 0 ? TEXT(",\"") : TEXT("\"");
+					Out += Keys[Index].ReplaceCharWithEscapedChar() + TEXT("\":");
+					WriteCanonicalJson(Object->Values[Keys[Index]], Out);
+				}
+				Out += TEXT("}");
+			}
+			break;
+		default:
+			Out += TEXT("null");
+			break;
+		}
+	}
+}
+
+void UPlayKitResponseCache::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	const UPlayKitSettings* Settings = UPlayKitSettings::Get();
+	Memory.Empty(Settings ? FMath::Max(1, Settings->ResponseCacheMemoryEntries) : 256);
+
+	// Expired entries are otherwise only deleted when read, and never-expiring ones not at all
+	if (IsDiskEnabled())
+	{
+		const int32 TTL = Settings->ResponseCacheTTLSeconds;
+		const int64 MaxBytes = static_cast<int64>(FMath::Max(0, Settings->ResponseCacheDiskBudgetMB)) * 1024 * 1024;
+		Async(EAsyncExecution::ThreadPool, [TTL, MaxBytes]()
+		{
+			PruneDisk(TTL, MaxBytes);
+		});
+	}
+}
+
+UPlayKitResponseCache* UPlayKitResponseCache::Get(const UObject* WorldContextObject)
+{
+	if (!WorldContextObject || !GEngine)
+	{
+		return nullptr;
+	}
+
+	UWorld* World = GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull);
+	UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UPlayKitResponseCache>() : nullptr;
+}
+
+FString UPlayKitResponseCache::MakeKey(FStringView Kind, const FString& Model, const TArray<FPlayKitChatMessage>& Messages,
+	float Temperature, int32 MaxTokens, const FString& Schema)
+{
+	FSHA1 Sha;
+	auto AddField = [&Sha](FStringView Value)
+	{
+		FTCHARToUTF8 Utf8(Value.GetData(), Value.Len());
+		Sha.Update(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+
+		// Separator, so ("ab","c") and ("a","bc") hash differently
+		const uint8 Separator = 0;
+		Sha.Update(&Separator, 1);
+	};
+
+	// Responses of one game and backend are never served to another
+	const UPlayKitSettings* Settings = UPlayKitSettings::Get();
+	AddField(TEXT("v2"));
+	AddField(Settings ? Settings->GameId : FString());
+	AddField(Settings ? Settings->GetBaseUrl() : FString());
+	AddField(Kind);
+	AddField(Model);
+	AddField(FString::SanitizeFloat(Temperature));
+	AddField(FString::FromInt(MaxTokens));
+
+	AddField(FString::FromInt(Messages.Num()));
+	for (const FPlayKitChatMessage& Message : Messages)
+	{
+		AddField(Message.Role);
+		AddField(Message.Content);
+		AddField(Message.ToolCallId);
+	}
+
+	// Canonicalize the schema so formatting and key order differences map to the same entry
+	FString CanonicalSchema = Schema;
+	TSharedPtr<FJsonValue> SchemaValue;
+	if (!Schema.IsEmpty() && FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Schema), SchemaValue) && SchemaValue.IsValid())
+	{
+		CanonicalSchema.Reset();
+		WriteCanonicalJson(SchemaValue, CanonicalSchema);
+	}
+	AddField(CanonicalSchema);
+
+	Sha.Final();
+	FSHAHash Hash;
+	Sha.GetHash(Hash.Hash);
+	return Hash.ToString();
+}
+
+void UPlayKitResponseCache::Lookup(const FString& Key, FOnLookupComplete OnComplete)
+{
+	LLM_SCOPE_BYTAG(PlayKit_Transport);
+	const int64 Now = FDateTime::UtcNow().ToUnixTimestamp();
+
+	if (const FCachedResponse* Found = Memory.FindAndTouch(Key))
+	{
+		if (Found->ExpiresAt == 0 || Found->ExpiresAt > Now)
+		{
+			++Stats.MemoryHits;
+			AsyncTask(ENamedThreads::GameThread, [Value = Found->Value, OnComplete = MoveTemp(OnComplete)]()
+			{
+				OnComplete(&Value);
+			});
+			return;
+		}
+
+		++Stats.Expirations;
+		Memory.Remove(Key);
+	}
+
+	if (!IsDiskEnabled())
+	{
+		++Stats.Misses;
+		AsyncTask(ENamedThreads::GameThread, [OnComplete = MoveTemp(OnComplete)]()
+		{
+			OnComplete(nullptr);
+		});
+		return;
+	}
+
+	// Disk tier: read and parse off the game thread
+	Async(EAsyncExecution::ThreadPool,
+		[WeakThis = TWeakObjectPtr<UPlayKitResponseCache>(this), Key, Path = GetEntryPath(Key), Now, OnComplete = MoveTemp(OnComplete)]() mutable
+		{
+			// Scopes do not follow the work onto other threads
+			LLM_SCOPE_BYTAG(PlayKit_Transport);
+			FCachedResponse Entry;
+			bool bExpired = false;
+			const bool bFound = LoadEntry(Path, Now, Entry, bExpired);
+			if (bExpired)
+			{
+				IFileManager::Get().Delete(*Path, false, false, true);
+			}
+
+			AsyncTask(ENamedThreads::GameThread,
+				[WeakThis, Key = MoveTemp(Key), bFound, bExpired, Entry = MoveTemp(Entry), OnComplete = MoveTemp(OnComplete)]()
+				{
+					LLM_SCOPE_BYTAG(PlayKit_Transport);
+					if (UPlayKitResponseCache* Cache = WeakThis.Get())
+					{
+						if (bFound)
+						{
+							++Cache->Stats.DiskHits;
+							Cache->AddToMemory(Key, Entry);
+						}
+						else
+						{
+							++Cache->Stats.Misses;
+							Cache->Stats.Expirations += bExpired ? 1 : 0;
+						}
+					}
+
+					OnComplete(bFound ? &Entry.Value : nullptr);
+				});
+		});
+}
+
+void UPlayKitResponseCache::Store(const FString& Key, const FString& Value)
+{
+	LLM_SCOPE_BYTAG(PlayKit_Transport);
+	const UPlayKitSettings* Settings = UPlayKitSettings::Get();
+	const int32 TTL = Settings ? Settings->ResponseCacheTTLSeconds : 0;
+
+	FCachedResponse Entry;
+	Entry.Value = Value;
+	Entry.ExpiresAt = TTL > 0 ? FDateTime::UtcNow().ToUnixTimestamp() + TTL : 0;
+
+	AddToMemory(Key, Entry);
+	++Stats.Stores;
+
+	if (!IsDiskEnabled())
+	{
+		return;
+	}
+
+	TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+	Json->SetNumberField(TEXT("expiresAt"), static_cast<double>(Entry.ExpiresAt));
+	Json->SetStringField(TEXT("value"), Entry.Value);
+
+	FString Serialized;
+	TSharedRef<TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>> Writer =
+		TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Serialized);
+	FJsonSerializer::Serialize(Json, Writer);
+
+	Async(EAsyncExecution::ThreadPool, [Path = GetEntryPath(Key), Serialized = MoveTemp(Serialized)]()
+	{
+		FFileHelper::SaveStringToFile(Serialized, *Path, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+	});
+}
+
+void UPlayKitResponseCache::Invalidate(const FString& Key)
+{
+	Memory.Remove(Key);
+	if (IsDiskEnabled())
+	{
+		IFileManager::Get().Delete(*GetEntryPath(Key), false, false, true);
+	}
+}
+
+void UPlayKitResponseCache::ClearCache()
+{
+	Memory.Empty(Memory.Max());
+	IFileManager::Get().DeleteDirectory(*GetCacheDirectory(), false, true);
+	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Response cache cleared"));
+}
+
+FPlayKitResponseCacheStats UPlayKitResponseCache::GetStats() const
+{
+	FPlayKitResponseCacheStats Result = Stats;
+	Result.MemoryEntries = Memory.Num();
+	return Result;
+}
+
+FString UPlayKitResponseCache::GetCacheDirectory()
+{
+	return FPaths::ProjectSavedDir() / TEXT("PlayKit/ResponseCache");
+}
+
+FString UPlayKitResponseCache::GetEntryPath(const FString& Key)
+{
+	return GetCacheDirectory() / Key + TEXT(".json");
+}
+
+bool UPlayKitResponseCache::LoadEntry(const FString& Path, int64 Now, FCachedResponse& OutEntry, bool& bOutExpired)
+{
+	bOutExpired = false;
+
+	FString Contents;
+	if (!FFileHelper::LoadFileToString(Contents, *Path))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> Json;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Contents), Json) || !Json.IsValid())
+	{
+		return false;
+	}
+
+	double ExpiresAt = 0.0;
+	Json->TryGetNumberField(TEXT("expiresAt"), ExpiresAt);
+	OutEntry.ExpiresAt = static_cast<int64>(ExpiresAt);
+	if (OutEntry.ExpiresAt != 0 && OutEntry.ExpiresAt <= Now)
+	{
+		bOutExpired = true;
+		return false;
+	}
+
+	return Json->TryGetStringField(TEXT("value"), OutEntry.Value);
+}
+
+void UPlayKitResponseCache::PruneDisk(int32 TTLSeconds, int64 MaxBytes)
+{
+	LLM_SCOPE_BYTAG(PlayKit_Transport);
+	struct FEntryFile
+	{
+		FString Path;
+		FDateTime Modified;
+		int64 Size = 0;
+	};
+
+	// Files are written once per store, so their age is the entry's age
+	const FString Directory = GetCacheDirectory();
+	const FDateTime ExpiredBefore = TTLSeconds > 0 ? FDateTime::UtcNow() - FTimespan::FromSeconds(TTLSeconds) : FDateTime::MinValue();
+	TArray<FEntryFile> Files;
+	int64 TotalBytes = 0;
+	int32 Deleted = 0;
+	IFileManager::Get().IterateDirectoryStat(*Directory, [&](const TCHAR* Path, const FFileStatData& StatData)
+	{
+		if (StatData.bIsDirectory)
+		{
+			return true;
+		}
+
+		if (StatData.ModificationTime < ExpiredBefore)
+		{
+			Deleted += IFileManager::Get().Delete(Path, false, false, true) ? 1 : 0;
+			return true;
+		}
+
+		Files.Add({ Path, StatData.ModificationTime, StatData.FileSize });
+		TotalBytes += StatData.FileSize;
+		return true;
+	});
+
+	if (MaxBytes > 0 && TotalBytes > MaxBytes)
+	{
+		Files.Sort([](const FEntryFile& A, const FEntryFile& B) { return A.Modified < B.Modified; });
+		for (const FEntryFile& File : Files)
+		{
+			if (TotalBytes <= MaxBytes)
+			{
+				break;
+			}
+			if (IFileManager::Get().Delete(*File.Path, false, false, true))
+			{
+				TotalBytes -= File.Size;
+				++Deleted;
+			}
+		}
+	}
+
+	if (Deleted > 0)
+	{
+		UE_LOG(LogTemp, Log, TEXT("[PlayKit] Response cache pruned %d files, %lld bytes remain on disk"), Deleted, TotalBytes);
+	}
+}
+
+bool UPlayKitResponseCache::IsDiskEnabled() const
+{
+	const UPlayKitSettings* Settings = UPlayKitSettings::Get();
+	return Settings && Settings->bEnableResponseDiskCache;
+}
+
+void UPlayKitResponseCache::AddToMemory(const FString& Key, const FCachedResponse& Entry)
+{
+	// TLruCache drops the least recently used entry when full
+	if (!Memory.Contains(Key) && Memory.Num() >= Memory.Max())
+	{
+		++Stats.Evictions;
+	}
+	Memory.Add(Key, Entry);
+}
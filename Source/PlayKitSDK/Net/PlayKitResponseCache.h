@@ -0,0 +1,120 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "Containers/LruCache.h"
+#include "PlayKitTypes.h"
+#include "PlayKitResponseCache.generated.h"
+
+/**
+ * Response cache counters
+ */
+USTRUCT(BlueprintType)
+struct PLAYKITSDK_API FPlayKitResponseCacheStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Cache")
+	int32 MemoryHits = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Cache")
+	int32 DiskHits = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Cache")
+	int32 Misses = 0;
+
+	/** Entries dropped from memory to make room (they stay on disk) */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Cache")
+	int32 Evictions = 0;
+
+	/** Entries dropped because their TTL elapsed */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Cache")
+	int32 Expirations = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Cache")
+	int32 Stores = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit|Cache")
+	int32 MemoryEntries = 0;
+};
+
+/**
+ * PlayKit Response Cache
+ * Two-tier cache for deterministic AI outputs (temperature-0 chat, structured output).
+ *
+ * Entries are keyed by a content hash of the request (see MakeKey) and hold the
+ * final assistant text or structured JSON. The first tier is a bounded in-memory
+ * LRU; the second is one file per entry under Saved/PlayKit/ResponseCache, so
+ * results survive restarts. Both tiers honour the TTL from UPlayKitSettings, and the
+ * disk tier is pruned to its budget when the subsystem starts.
+ *
+ * Lookups never complete synchronously: the callback always runs on the game
+ * thread on a later tick, so callers can hand out request ids first.
+ */
+UCLASS()
+class PLAYKITSDK_API UPlayKitResponseCache : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Receives the cached value, or nullptr on a miss */
+	using FOnLookupComplete = TFunction<void(const FString* CachedValue)>;
+
+	//~ Begin USubsystem Interface
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	//~ End USubsystem Interface
+
+	/** Get the cache of the game instance that owns WorldContextObject */
+	static UPlayKitResponseCache* Get(const UObject* WorldContextObject);
+
+	/**
+	 * Build a cache key from everything that determines the model output, including the
+	 * game and backend it comes from.
+	 * @param Kind Output kind ("text", "structured"), so different outputs for the same prompt never collide
+	 * @param Schema Optional JSON schema; whitespace, formatting and key order do not affect the key
+	 */
+	static FString MakeKey(FStringView Kind, const FString& Model, const TArray<FPlayKitChatMessage>& Messages,
+		float Temperature, int32 MaxTokens, const FString& Schema = FString());
+
+	/** Look up a key in memory, then on disk. OnComplete runs on the game thread on a later tick. */
+	void Lookup(const FString& Key, FOnLookupComplete OnComplete);
+
+	/** Store a value in both tiers */
+	void Store(const FString& Key, const FString& Value);
+
+	/** Remove one entry from both tiers */
+	void Invalidate(const FString& Key);
+
+	/** Remove all entries from both tiers */
+	UFUNCTION(BlueprintCallable, Category="PlayKit|Cache")
+	void ClearCache();
+
+	/** Hit/miss/evict counters */
+	UFUNCTION(BlueprintPure, Category="PlayKit|Cache")
+	FPlayKitResponseCacheStats GetStats() const;
+
+private:
+	struct FCachedResponse
+	{
+		FString Value;
+
+		/** Unix time after which the entry is stale, 0 = never */
+		int64 ExpiresAt = 0;
+	};
+
+	static FString GetCacheDirectory();
+	static FString GetEntryPath(const FString& Key);
+	static bool LoadEntry(const FString& Path, int64 Now, FCachedResponse& OutEntry, bool& bOutExpired);
+
+	/** Delete expired entry files, then the oldest ones until the rest fit in MaxBytes (0 = no limit). Any thread. */
+	static void PruneDisk(int32 TTLSeconds, int64 MaxBytes);
+
+	bool IsDiskEnabled() const;
+	void AddToMemory(const FString& Key, const FCachedResponse& Entry);
+
+private:
+	TLruCache<FString, FCachedResponse> Memory;
+	FPlayKitResponseCacheStats Stats;
+};
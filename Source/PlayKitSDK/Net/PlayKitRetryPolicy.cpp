@@ -0,0 +1,317 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitRetryPolicy.h"
+#include "PlayKitRequestTrace.h"
+#include "PlayKitSettings.h"
+#include "Math/RandomStream.h"
+#include "Misc/ScopeLock.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Retries"), STAT_PlayKitRetries, STATGROUP_PlayKit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Retries Over Budget"), STAT_PlayKitRetriesDenied, STATGROUP_PlayKit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Requests Failed Fast"), STAT_PlayKitFailedFast, STATGROUP_PlayKit);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Open Circuits"), STAT_PlayKitOpenCircuits, STATGROUP_PlayKit);
+
+namespace
+{
+	struct FEndpointState
+	{
+		EPlayKitCircuitState Circuit = EPlayKitCircuitState::Closed;
+		int32 ConsecutiveFailures = 0;
+		double OpenUntil = 0.0;
+
+		/** Half open: the probe request has been let through and has not finished */
+		bool bProbeInFlight = false;
+		double ProbeStartTime = 0.0;
+
+		double Budget = 0.0;
+		int32 Retries = 0;
+		int32 RetriesDenied = 0;
+		int32 FailedFast = 0;
+	};
+
+	constexpr int32 NumEndpoints = static_cast<int32>(EPlayKitEndpoint::MAX);
+
+	FCriticalSection StateMutex;
+	FPlayKitRetryConfig Config;
+	FEndpointState Endpoints[NumEndpoints];
+	FRandomStream Jitter(static_cast<int32>(FPlatformTime::Cycles()));
+	bool bBudgetsFilled = false;
+
+	/** Call with StateMutex held */
+	FEndpointState& GetState(EPlayKitEndpoint Endpoint)
+	{
+		if (!bBudgetsFilled)
+		{
+			for (FEndpointState& State : Endpoints)
+			{
+				State.Budget = Config.BudgetReserve;
+			}
+			bBudgetsFilled = true;
+		}
+		return Endpoints[FMath::Clamp(static_cast<int32>(Endpoint), 0, NumEndpoints - 1)];
+	}
+
+	const TCHAR* GetEndpointName(EPlayKitEndpoint Endpoint)
+	{
+		return FPlayKitRequestTrace::GetEndpointName(Endpoint);
+	}
+
+	/** Call with StateMutex held */
+	void OpenCircuit(EPlayKitEndpoint Endpoint, FEndpointState& State)
+	{
+		if (State.Circuit == EPlayKitCircuitState::Closed)
+		{
+			INC_DWORD_STAT(STAT_PlayKitOpenCircuits);
+		}
+
+		State.Circuit = EPlayKitCircuitState::Open;
+		State.OpenUntil = FPlatformTime::Seconds() + Config.BreakerCooldown;
+		State.bProbeInFlight = false;
+
+		UE_LOG(LogTemp, Warning, TEXT("[PlayKit] %s circuit open after %d failed attempts; failing requests for %.0fs"),
+			GetEndpointName(Endpoint), State.ConsecutiveFailures, Config.BreakerCooldown);
+	}
+
+	/** Call with StateMutex held */
+	void CloseCircuit(EPlayKitEndpoint Endpoint, FEndpointState& State)
+	{
+		if (State.Circuit != EPlayKitCircuitState::Closed)
+		{
+			DEC_DWORD_STAT(STAT_PlayKitOpenCircuits);
+			UE_LOG(LogTemp, Log, TEXT("[PlayKit] %s circuit closed, backend is responding again"), GetEndpointName(Endpoint));
+		}
+
+		State.Circuit = EPlayKitCircuitState::Closed;
+		State.bProbeInFlight = false;
+	}
+
+	/** Call with StateMutex held */
+	void RecordOutcome(EPlayKitEndpoint Endpoint, FEndpointState& State, FPlayKitRetryPolicy::EOutcome Outcome)
+	{
+		switch (Outcome)
+		{
+		case FPlayKitRetryPolicy::EOutcome::Succeeded:
+		case FPlayKitRetryPolicy::EOutcome::Throttled:
+			State.ConsecutiveFailures = 0;
+			CloseCircuit(Endpoint, State);
+			break;
+
+		case FPlayKitRetryPolicy::EOutcome::Failed:
+		case FPlayKitRetryPolicy::EOutcome::TimedOut:
+			++State.ConsecutiveFailures;
+			if (State.Circuit == EPlayKitCircuitState::HalfOpen
+				|| (State.Circuit == EPlayKitCircuitState::Closed && State.ConsecutiveFailures >= Config.BreakerThreshold))
+			{
+				OpenCircuit(Endpoint, State);
+			}
+			break;
+
+		case FPlayKitRetryPolicy::EOutcome::Cancelled:
+			// A cancelled probe says nothing about the backend; let the next request probe
+			State.bProbeInFlight = false;
+			break;
+		}
+	}
+}
+
+FPlayKitRetryConfig FPlayKitRetryConfig::FromSettings()
+{
+	FPlayKitRetryConfig Result;
+	if (const UPlayKitSettings* Settings = UPlayKitSettings::Get())
+	{
+		Result.MaxRetries = Settings->bEnableRetries ? FMath::Max(0, Settings->MaxRetries) : 0;
+		Result.BaseDelay = FMath::Max(0.0f, Settings->RetryBaseDelay);
+		Result.MaxDelay = FMath::Max(Result.BaseDelay, static_cast<double>(Settings->RetryMaxDelay));
+		Result.BudgetRatio = FMath::Max(0.0f, Settings->RetryBudgetRatio);
+		Result.BreakerThreshold = Settings->CircuitBreakerThreshold;
+		Result.BreakerCooldown = FMath::Max(0.0f, Settings->CircuitBreakerCooldown);
+	}
+	return Result;
+}
+
+void FPlayKitRetryPolicy::Configure(const FPlayKitRetryConfig& InConfig)
+{
+	FScopeLock Lock(&StateMutex);
+	Config = InConfig;
+	for (FEndpointState& State : Endpoints)
+	{
+		State.Budget = FMath::Min(State.Budget, Config.BudgetReserve);
+	}
+}
+
+FPlayKitRetryConfig FPlayKitRetryPolicy::GetConfig()
+{
+	FScopeLock Lock(&StateMutex);
+	return Config;
+}
+
+bool FPlayKitRetryPolicy::AllowRequest(EPlayKitEndpoint Endpoint)
+{
+	FScopeLock Lock(&StateMutex);
+	FEndpointState& State = GetState(Endpoint);
+
+	// A breaker threshold of 0 turns the breaker off
+	if (State.Circuit == EPlayKitCircuitState::Closed || Config.BreakerThreshold <= 0)
+	{
+		State.Budget = FMath::Min(State.Budget + Config.BudgetRatio, Config.BudgetReserve);
+		return true;
+	}
+
+	if (State.Circuit == EPlayKitCircuitState::Open && FPlatformTime::Seconds() >= State.OpenUntil)
+	{
+		State.Circuit = EPlayKitCircuitState::HalfOpen;
+		UE_LOG(LogTemp, Log, TEXT("[PlayKit] %s circuit half open, sending a probe request"), GetEndpointName(Endpoint));
+	}
+
+	// A probe that never reports back (cancelled while queued) is replaced after another cooldown
+	const double Now = FPlatformTime::Seconds();
+	if (State.Circuit == EPlayKitCircuitState::HalfOpen
+		&& (!State.bProbeInFlight || Now - State.ProbeStartTime >= Config.BreakerCooldown))
+	{
+		State.bProbeInFlight = true;
+		State.ProbeStartTime = Now;
+		return true;
+	}
+
+	++State.FailedFast;
+	INC_DWORD_STAT(STAT_PlayKitFailedFast);
+	return false;
+}
+
+bool FPlayKitRetryPolicy::OnAttemptFinished(EPlayKitEndpoint Endpoint, const FHttpRequestPtr& Request, const FHttpResponsePtr& Response,
+	bool bWasSuccessful, int32 Retries, bool bCanResend, double& OutDelay)
+{
+	const EOutcome Outcome = Classify(Request, Response, bWasSuccessful);
+
+	FScopeLock Lock(&StateMutex);
+	FEndpointState& State = GetState(Endpoint);
+	if (Config.BreakerThreshold > 0)
+	{
+		RecordOutcome(Endpoint, State, Outcome);
+	}
+
+	if ((Outcome != EOutcome::Failed && Outcome != EOutcome::Throttled)
+		|| !bCanResend
+		|| Retries >= Config.MaxRetries
+		|| State.Circuit == EPlayKitCircuitState::Open)
+	{
+		return false;
+	}
+
+	// Full jitter: anywhere between now and the exponential cap
+	const double Cap = FMath::Min(Config.MaxDelay, Config.BaseDelay * FMath::Pow(2.0, static_cast<double>(FMath::Min(Retries, 30))));
+	OutDelay = Jitter.GetFraction() * Cap;
+
+	const double RetryAfter = GetRetryAfter(Response);
+	if (RetryAfter > Config.MaxRetryAfter)
+	{
+		return false;
+	}
+	OutDelay = FMath::Max(OutDelay, RetryAfter);
+
+	if (State.Budget < 1.0)
+	{
+		++State.RetriesDenied;
+		INC_DWORD_STAT(STAT_PlayKitRetriesDenied);
+		return false;
+	}
+
+	State.Budget -= 1.0;
+	++State.Retries;
+	INC_DWORD_STAT(STAT_PlayKitRetries);
+	return true;
+}
+
+bool FPlayKitRetryPolicy::IsRetryableStatus(int32 StatusCode)
+{
+	switch (StatusCode)
+	{
+	case 408:
+	case 429:
+	case 500:
+	case 502:
+	case 503:
+	case 504:
+		return true;
+	default:
+		return false;
+	}
+}
+
+FPlayKitRetryPolicy::EOutcome FPlayKitRetryPolicy::Classify(const FHttpRequestPtr& Request, const FHttpResponsePtr& Response, bool bWasSuccessful)
+{
+	if (bWasSuccessful && Response.IsValid())
+	{
+		const int32 StatusCode = Response->GetResponseCode();
+		if (StatusCode == 429)
+		{
+			return EOutcome::Throttled;
+		}
+		return IsRetryableStatus(StatusCode) ? EOutcome::Failed : EOutcome::Succeeded;
+	}
+
+	// The scheduler cancels a request that runs past its deadline
+	if (Request.IsValid() && FPlayKitRequestTrace::HasTimedOut(Request.Get()))
+	{
+		return EOutcome::TimedOut;
+	}
+
+	switch (Request.IsValid() ? Request->GetFailureReason() : EHttpFailureReason::ConnectionError)
+	{
+	case EHttpFailureReason::Cancelled:	return EOutcome::Cancelled;
+	case EHttpFailureReason::TimedOut:	return EOutcome::TimedOut;
+	default:							return EOutcome::Failed;
+	}
+}
+
+double FPlayKitRetryPolicy::GetRetryAfter(const FHttpResponsePtr& Response)
+{
+	if (!Response.IsValid())
+	{
+		return 0.0;
+	}
+
+	const FString Value = Response->GetHeader(TEXT("Retry-After")).TrimStartAndEnd();
+	if (Value.IsEmpty())
+	{
+		return 0.0;
+	}
+
+	if (Value.IsNumeric())
+	{
+		return FMath::Max(0.0, FCString::Atod(*Value));
+	}
+
+	FDateTime Date;
+	if (FDateTime::ParseHttpDate(Value, Date))
+	{
+		return FMath::Max(0.0, (Date - FDateTime::UtcNow()).GetTotalSeconds());
+	}
+	return 0.0;
+}
+
+FPlayKitRetryEndpointStats FPlayKitRetryPolicy::GetStats(EPlayKitEndpoint Endpoint)
+{
+	FScopeLock Lock(&StateMutex);
+	const FEndpointState& State = GetState(Endpoint);
+
+	FPlayKitRetryEndpointStats Result;
+	Result.Circuit = State.Circuit;
+	Result.ConsecutiveFailures = State.ConsecutiveFailures;
+	Result.Retries = State.Retries;
+	Result.RetriesDenied = State.RetriesDenied;
+	Result.FailedFast = State.FailedFast;
+	return Result;
+}
+
+void FPlayKitRetryPolicy::Reset()
+{
+	FScopeLock Lock(&StateMutex);
+	for (int32 Index = 0; Index < NumEndpoints; ++Index)
+	{
+		CloseCircuit(static_cast<EPlayKitEndpoint>(Index), Endpoints[Index]);
+		Endpoints[Index] = FEndpointState();
+		Endpoints[Index].Budget = Config.BudgetReserve;
+	}
+	bBudgetsFilled = true;
+}
@@ -0,0 +1,129 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Interfaces/IHttpResponse.h"
+#include "PlayKitRequestScheduler.h"
+
+/**
+ * Tuning of FPlayKitRetryPolicy
+ */
+struct PLAYKITSDK_API FPlayKitRetryConfig
+{
+	/** Retries of one request after its first attempt; 0 disables retrying */
+	int32 MaxRetries = 3;
+
+	/** Backoff cap of the first retry; doubles per retry up to MaxDelay */
+	double BaseDelay = 0.5;
+	double MaxDelay = 20.0;
+
+	/** A Retry-After longer than this is not waited for; the request fails instead */
+	double MaxRetryAfter = 60.0;
+
+	/** Retries earned per request sent, and the retries an endpoint can bank */
+	double BudgetRatio = 0.2;
+	double BudgetReserve = 10.0;
+
+	/** Failed attempts in a row that open an endpoint's circuit, and how long it stays open */
+	int32 BreakerThreshold = 5;
+	double BreakerCooldown = 15.0;
+
+	/** Values of UPlayKitSettings. Game thread. */
+	static FPlayKitRetryConfig FromSettings();
+};
+
+/**
+ * Retry and circuit breaker state of one endpoint
+ */
+struct PLAYKITSDK_API FPlayKitRetryEndpointStats
+{
+	EPlayKitCircuitState Circuit = EPlayKitCircuitState::Closed;
+	int32 ConsecutiveFailures = 0;
+	int32 Retries = 0;
+
+	/** Retries refused because the endpoint's budget was spent */
+	int32 RetriesDenied = 0;
+
+	/** Requests failed without being sent because the circuit was open */
+	int32 FailedFast = 0;
+};
+
+/**
+ * Retry policy of the request scheduler, shared by every endpoint group.
+ *
+ * Attempts that fail with a connection error, 408, 429 or 500/502/503/504 are sent again
+ * after a full-jitter exponential backoff (a random delay up to BaseDelay * 2^retry), or
+ * after the server's Retry-After if that is longer. Randomizing the whole delay spreads
+ * the clients that failed together over the backoff window, so a backend blip is not
+ * followed by synchronized waves of retries. Only attempts whose response the owner has
+ * not seen any of are resent, so a stream cut mid-reply still fails.
+ *
+ * Retries are paid for from a per-endpoint budget: each request sent earns BudgetRatio
+ * retries and each retry costs one, with BudgetReserve banked for short bursts. During
+ * a long outage the endpoint therefore sends at most about 20% extra traffic.
+ *
+ * BreakerThreshold failed attempts in a row open the endpoint's circuit. While it is open
+ * the scheduler fails new requests right away instead of sending them; after
+ * BreakerCooldown one probe request is let through (half open), and its outcome closes
+ * or reopens the circuit. Throttled (429) and rejected (4xx) replies show the backend is
+ * up and reset the count.
+ *
+ * State and counters are published as stats (stat PlayKit) and in
+ * UPlayKitRequestScheduler::GetStats(). Thread-safe: requests that decode off the game
+ * thread report their outcome from the HTTP thread.
+ */
+class PLAYKITSDK_API FPlayKitRetryPolicy
+{
+public:
+	/** How an attempt ended */
+	enum class EOutcome : uint8
+	{
+		/** A reply the backend meant, including non-retryable errors */
+		Succeeded,
+		/** 429: the backend is up but asks to slow down */
+		Throttled,
+		/** Connection error, 408 or a retryable 5xx */
+		Failed,
+		/** The request ran past a deadline; counts against the circuit but is not retried */
+		TimedOut,
+		Cancelled
+	};
+
+	/** Replace the tuning. Called by the scheduler when it starts. */
+	static void Configure(const FPlayKitRetryConfig& InConfig);
+	static FPlayKitRetryConfig GetConfig();
+
+	/**
+	 * Admit a new request to an endpoint.
+	 * @return false while the endpoint's circuit is open; the request should fail without being sent
+	 */
+	static bool AllowRequest(EPlayKitEndpoint Endpoint);
+
+	/**
+	 * Record a finished attempt and decide whether to send the request again.
+	 * @param Retries Retries already made for the request
+	 * @param bCanResend The owner has not seen any of the response and still wants it
+	 * @param OutDelay Seconds to wait before the retry
+	 * @return true if the request should be retried; a retry has been taken from the budget
+	 */
+	static bool OnAttemptFinished(EPlayKitEndpoint Endpoint, const FHttpRequestPtr& Request, const FHttpResponsePtr& Response,
+		bool bWasSuccessful, int32 Retries, bool bCanResend, double& OutDelay);
+
+	/** Status codes worth repeating a request for */
+	static bool IsRetryableStatus(int32 StatusCode);
+
+	static EOutcome Classify(const FHttpRequestPtr& Request, const FHttpResponsePtr& Response, bool bWasSuccessful);
+
+	/**
+	 * Seconds a Retry-After header asks to wait: delta-seconds or an HTTP date.
+	 * @return 0 if the header is missing or cannot be parsed
+	 */
+	static double GetRetryAfter(const FHttpResponsePtr& Response);
+
+	static FPlayKitRetryEndpointStats GetStats(EPlayKitEndpoint Endpoint);
+
+	/** Close every circuit, refill the budgets and clear the counters */
+	static void Reset();
+};
@@ -0,0 +1,308 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitSSEDecoder.h"
+#include "PlayKitMemory.h"
+#include "PlayKitJsonReader.h"
+#include "Misc/ScopeLock.h"
+
+namespace PlayKitSSE
+{
+	// Typical SSE lines from the chat endpoint are well under this size
+	constexpr int32 InitialLineCapacity = 512;
+
+	static bool FieldEquals(const uint8* Field, int32 Num, const char* Name)
+	{
+		const int32 NameLen = FCStringAnsi::Strlen(Name);
+		return Num == NameLen && FMemory::Memcmp(Field, Name, NameLen) == 0;
+	}
+}
+
+FPlayKitSSEDecoder::FPlayKitSSEDecoder()
+{
+	PendingLine.Reserve(PlayKitSSE::InitialLineCapacity);
+	EventData.Reserve(PlayKitSSE::InitialLineCapacity);
+}
+
+void FPlayKitSSEDecoder::ConsumeResponse(const FHttpResponsePtr& Response, FOnEvent OnEvent)
+{
+	if (!Response.IsValid())
+	{
+		return;
+	}
+
+	const TArray<uint8>& Content = Response->GetContent();
+	if (Content.Num() <= BytesConsumed)
+	{
+		return;
+	}
+
+	Feed(Content.GetData() + BytesConsumed, Content.Num() - static_cast<int32>(BytesConsumed), OnEvent);
+}
+
+void FPlayKitSSEDecoder::Feed(const uint8* Bytes, int32 Num, FOnEvent OnEvent)
+{
+	if (!Bytes || Num <= 0)
+	{
+		return;
+	}
+
+	BytesConsumed += Num;
+
+	int32 Index = 0;
+	if (bSkipNextLineFeed)
+	{
+		bSkipNextLineFeed = false;
+		if (Bytes[0] == '\n')
+		{
+			Index = 1;
+		}
+	}
+
+	int32 LineStart = Index;
+	for (; Index < Num; ++Index)
+	{
+		const uint8 Byte = Bytes[Index];
+		if (Byte != '\n' && Byte != '\r')
+		{
+			continue;
+		}
+
+		if (PendingLine.Num() > 0)
+		{
+			// Complete the line carried over from the previous read
+			PendingLine.Append(Bytes + LineStart, Index - LineStart);
+			ProcessLine(PendingLine.GetData(), PendingLine.Num(), OnEvent);
+			PendingLine.Reset();
+		}
+		else
+		{
+			// Fast path: the whole line is inside this block, no copy needed
+			ProcessLine(Bytes + LineStart, Index - LineStart, OnEvent);
+		}
+
+		// CRLF counts as a single terminator, even when split across reads
+		if (Byte == '\r')
+		{
+			if (Index + 1 < Num)
+			{
+				if (Bytes[Index + 1] == '\n')
+				{
+					++Index;
+				}
+			}
+			else
+			{
+				bSkipNextLineFeed = true;
+			}
+		}
+
+		LineStart = Index + 1;
+	}
+
+	if (LineStart < Num)
+	{
+		PendingLine.Append(Bytes + LineStart, Num - LineStart);
+	}
+}
+
+void FPlayKitSSEDecoder::Flush(FOnEvent OnEvent)
+{
+	if (PendingLine.Num() > 0)
+	{
+		ProcessLine(PendingLine.GetData(), PendingLine.Num(), OnEvent);
+		PendingLine.Reset();
+	}
+	DispatchEvent(OnEvent);
+}
+
+void FPlayKitSSEDecoder::Reset()
+{
+	PendingLine.Reset();
+	EventData.Reset();
+	BytesConsumed = 0;
+	bSkipNextLineFeed = false;
+}
+
+void FPlayKitSSEDecoder::ProcessLine(const uint8* Line, int32 Num, FOnEvent OnEvent)
+{
+	// Blank line terminates the current event
+	if (Num == 0)
+	{
+		DispatchEvent(OnEvent);
+		return;
+	}
+
+	// Comment / keep-alive
+	if (Line[0] == ':')
+	{
+		return;
+	}
+
+	int32 Colon = 0;
+	while (Colon < Num && Line[Colon] != ':')
+	{
+		++Colon;
+	}
+
+	// Only the data field carries payload; event/id/retry are not used by PlayKit
+	if (!PlayKitSSE::FieldEquals(Line, Colon, "data"))
+	{
+		return;
+	}
+
+	int32 ValueStart = FMath::Min(Colon + 1, Num);
+	if (ValueStart < Num && Line[ValueStart] == ' ')
+	{
+		++ValueStart;
+	}
+
+	EventData.Append(Line + ValueStart, Num - ValueStart);
+	EventData.Add('\n');
+}
+
+void FPlayKitSSEDecoder::DispatchEvent(FOnEvent OnEvent)
+{
+	if (EventData.Num() == 0)
+	{
+		return;
+	}
+
+	// Drop the trailing '\n' appended after the last data line
+	const int32 Len = EventData.Num() - 1;
+	OnEvent(FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(EventData.GetData()), Len));
+	EventData.Reset();
+}
+
+FString FPlayKitSSEDecoder::ToString(FUtf8StringView Data)
+{
+	if (Data.Len() == 0)
+	{
+		return FString();
+	}
+
+	const auto Converted = StringCast<TCHAR>(Data.GetData(), Data.Len());
+	return FString(Converted.Length(), Converted.Get());
+}
+
+bool FPlayKitSSEDecoder::TryGetTextDelta(FUtf8StringView Data, FString& OutDelta)
+{
+	OutDelta.Reset();
+
+	Data = Data.TrimStartAndEnd();
+	if (Data.IsEmpty() || Data == UTF8TEXTVIEW("[DONE]"))
+	{
+		return false;
+	}
+
+	FPlayKitJsonReader Reader(Data);
+	if (Reader.PeekType() != EPlayKitJsonType::Object)
+	{
+		return false;
+	}
+
+	bool bHasType = false;
+	bool bIsTextDelta = false;
+	bool bHasChoiceDelta = false;
+
+	FUtf8StringView Key;
+	Reader.BeginObject();
+	while (Reader.NextMember(Key))
+	{
+		if (Key == UTF8TEXTVIEW("type"))
+		{
+			// UI Message Stream format (type, delta)
+			FUtf8StringView Type;
+			bHasType = Reader.ReadRawString(Type);
+			bIsTextDelta = Type == UTF8TEXTVIEW("text-delta");
+		}
+		else if (Key == UTF8TEXTVIEW("delta") && Reader.PeekType() == EPlayKitJsonType::String)
+		{
+			Reader.ReadString(OutDelta);
+		}
+		else if (Key == UTF8TEXTVIEW("choices") && Reader.PeekType() == EPlayKitJsonType::Array)
+		{
+			// Legacy OpenAI format (choices[0].delta.content)
+			Reader.BeginArray();
+			bool bFirst = true;
+			while (Reader.NextElement())
+			{
+				if (!bFirst || Reader.PeekType() != EPlayKitJsonType::Object)
+				{
+					Reader.SkipValue();
+					continue;
+				}
+				bFirst = false;
+
+				Reader.BeginObject();
+				while (Reader.NextMember(Key))
+				{
+					if (Key != UTF8TEXTVIEW("delta") || Reader.PeekType() != EPlayKitJsonType::Object)
+					{
+						Reader.SkipValue();
+						continue;
+					}
+
+					Reader.BeginObject();
+					while (Reader.NextMember(Key))
+					{
+						if (Key == UTF8TEXTVIEW("content"))
+						{
+							bHasChoiceDelta = Reader.ReadString(OutDelta);
+						}
+						else
+						{
+							Reader.SkipValue();
+						}
+					}
+				}
+			}
+		}
+		else
+		{
+			Reader.SkipValue();
+		}
+	}
+
+	if (Reader.HasError())
+	{
+		return false;
+	}
+
+	// Other types like "start", "finish" carry no text
+	const bool bHasText = bHasType ? bIsTextDelta : bHasChoiceDelta;
+	return bHasText && !OutDelta.IsEmpty();
+}
+
+FPlayKitStreamBodySink::FPlayKitStreamBodySink()
+{
+	SetIsSaving(true);
+	SetIsPersistent(false);
+	PendingBytes.Reserve(PlayKitSSE::InitialLineCapacity);
+}
+
+void FPlayKitStreamBodySink::Serialize(void* Data, int64 Num)
+{
+	LLM_SCOPE_BYTAG(PlayKit_Transport);
+	if (!Data || Num <= 0)
+	{
+		return;
+	}
+
+	FScopeLock Lock(&Mutex);
+	PendingBytes.Append(static_cast<const uint8*>(Data), static_cast<int32>(Num));
+	TotalBytes += Num;
+}
+
+void FPlayKitStreamBodySink::Drain(TArray<uint8>& OutBytes)
+{
+	OutBytes.Reset();
+
+	FScopeLock Lock(&Mutex);
+	Swap(OutBytes, PendingBytes);
+}
+
+SIZE_T FPlayKitStreamBodySink::GetAllocatedSize() const
+{
+	FScopeLock Lock(&Mutex);
+	return PendingBytes.GetAllocatedSize();
+}
@@ -0,0 +1,107 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpResponse.h"
+#include "HAL/CriticalSection.h"
+
+/**
+ * Incremental Server-Sent Events decoder.
+ *
+ * Consumes raw response bytes as they arrive and emits the payload of every
+ * complete event exactly once. Bytes of an unterminated line are carried over
+ * in a small reusable buffer, so a "data:" line (or a UTF-8 sequence) split
+ * across network reads is decoded correctly and each byte is scanned only once.
+ *
+ * Usage (from an OnRequestProgress64 handler):
+ *   Decoder.ConsumeResponse(Request->GetResponse(), [&](FUtf8StringView Data) { ... });
+ */
+class PLAYKITSDK_API FPlayKitSSEDecoder
+{
+public:
+	/** Receives the UTF-8 payload of one event (data lines joined with '\n') */
+	using FOnEvent = TFunctionRef<void(FUtf8StringView Data)>;
+
+	FPlayKitSSEDecoder();
+
+	/** Decode the bytes of Response that were not consumed by a previous call */
+	void ConsumeResponse(const FHttpResponsePtr& Response, FOnEvent OnEvent);
+
+	/** Decode a block of newly received bytes */
+	void Feed(const uint8* Bytes, int32 Num, FOnEvent OnEvent);
+
+	/** Dispatch a trailing event that was not terminated by a blank line */
+	void Flush(FOnEvent OnEvent);
+
+	/** Forget all state so the decoder can be reused for another response */
+	void Reset();
+
+	/** Number of response bytes consumed so far */
+	int64 GetBytesConsumed() const { return BytesConsumed; }
+
+	/** Heap memory held by the line and event buffers */
+	SIZE_T GetAllocatedSize() const { return PendingLine.GetAllocatedSize() + EventData.GetAllocatedSize(); }
+
+	/**
+	 * Extract the assistant text delta from one event payload.
+	 * Understands both the UI message stream format ({"type":"text-delta","delta":...})
+	 * and the OpenAI chunk format ({"choices":[{"delta":{"content":...}}]}).
+	 * @return false for "[DONE]", control events and payloads without text
+	 */
+	static bool TryGetTextDelta(FUtf8StringView Data, FString& OutDelta);
+
+	/** Convert a UTF-8 view to an FString */
+	static FString ToString(FUtf8StringView Data);
+
+private:
+	void ProcessLine(const uint8* Line, int32 Num, FOnEvent OnEvent);
+	void DispatchEvent(FOnEvent OnEvent);
+
+private:
+	/** Bytes of the current, not yet terminated line */
+	TArray<uint8> PendingLine;
+
+	/** Accumulated data field of the current event */
+	TArray<uint8> EventData;
+
+	int64 BytesConsumed = 0;
+
+	/** The previous chunk ended with '\r'; a leading '\n' belongs to that terminator */
+	bool bSkipNextLineFeed = false;
+};
+
+/**
+ * Receive stream for a streaming HTTP request.
+ *
+ * Installed with IHttpRequest::SetResponseBodyReceiveStream so the response body
+ * is not accumulated inside the HTTP response. The HTTP thread appends received
+ * bytes here; the game thread moves them out with Drain(), decodes them and
+ * drops them, so the raw SSE framing never outlives a tick.
+ */
+class PLAYKITSDK_API FPlayKitStreamBodySink : public FArchive
+{
+public:
+	FPlayKitStreamBodySink();
+
+	//~ Begin FArchive Interface
+	virtual void Serialize(void* Data, int64 Num) override;
+	virtual int64 Tell() override { return TotalBytes; }
+	virtual int64 TotalSize() override { return TotalBytes; }
+	virtual FString GetArchiveName() const override { return TEXT("FPlayKitStreamBodySink"); }
+	//~ End FArchive Interface
+
+	/**
+	 * Move all bytes received since the last call into OutBytes.
+	 * OutBytes and the internal buffer swap storage, so both keep their capacity.
+	 */
+	void Drain(TArray<uint8>& OutBytes);
+
+	/** Heap memory held by bytes not yet drained */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	mutable FCriticalSection Mutex;
+	TArray<uint8> PendingBytes;
+	int64 TotalBytes = 0;
+};
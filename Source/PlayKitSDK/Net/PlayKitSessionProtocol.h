@@ -0,0 +1,122 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Wire format of the session transport (FPlayKitSessionTransport).
+ *
+ * One WebSocket carries many requests. Every message is one binary frame:
+ *
+ *   uint8  Op
+ *   uint32 Stream   request id chosen by the client, unique within the session
+ *   uint32 Arg      meaning depends on Op
+ *   ...    Payload
+ *
+ * Integers are little-endian. Client to server:
+ *   Attach   Payload: session id to resume, empty for a new session. First frame on every connection.
+ *   Request  Arg: length of the head. Payload: head ("POST /path\r\nName: Value\r\n..."), then the body.
+ *   Cancel   Stop a request; the server forgets it.
+ *   Resume   Arg: body bytes already received. Sent after a reconnect for every unfinished request.
+ *
+ * Server to client:
+ *   Hello    Payload: session id. A different id than the one attached means the old session is gone.
+ *   Head     Arg: status code. Payload: response headers ("Name: Value\r\n...").
+ *   Data     Arg: offset of the payload in the response body.
+ *   End      The response body is complete.
+ *   Gone     The server does not know the stream (e.g. after a resume); the request failed.
+ *
+ * The server keeps a detached session's replies for a while, so after a dropped
+ * connection the client reattaches, resumes each stream at the offset it got to, and
+ * the delta stream continues without duplicates or gaps.
+ */
+namespace PlayKitSession
+{
+	/** WebSocket subprotocol */
+	inline const TCHAR* Protocol = TEXT("playkit-session.v1");
+
+	enum class EOp : uint8
+	{
+		Attach = 1,
+		Request = 2,
+		Cancel = 3,
+		Resume = 4,
+
+		Hello = 16,
+		Head = 17,
+		Data = 18,
+		End = 19,
+		Gone = 20,
+	};
+
+	constexpr int32 FrameHeaderSize = 9;
+
+	struct FFrame
+	{
+		EOp Op = EOp::Attach;
+		uint32 Stream = 0;
+		uint32 Arg = 0;
+		const uint8* Payload = nullptr;
+		int32 PayloadSize = 0;
+	};
+
+	inline void WriteUInt32(TArray<uint8>& Out, uint32 Value)
+	{
+		const uint8 Bytes[4] = { uint8(Value), uint8(Value >> 8), uint8(Value >> 16), uint8(Value >> 24) };
+		Out.Append(Bytes, 4);
+	}
+
+	inline uint32 ReadUInt32(const uint8* Data)
+	{
+		return uint32(Data[0]) | (uint32(Data[1]) << 8) | (uint32(Data[2]) << 16) | (uint32(Data[3]) << 24);
+	}
+
+	/** Append a frame header; the payload follows */
+	inline void WriteFrameHeader(TArray<uint8>& Out, EOp Op, uint32 Stream, uint32 Arg)
+	{
+		Out.Add(static_cast<uint8>(Op));
+		WriteUInt32(Out, Stream);
+		WriteUInt32(Out, Arg);
+	}
+
+	inline void WriteFrame(TArray<uint8>& Out, EOp Op, uint32 Stream, uint32 Arg, const uint8* Payload = nullptr, int32 PayloadSize = 0)
+	{
+		Out.Reserve(Out.Num() + FrameHeaderSize + PayloadSize);
+		WriteFrameHeader(Out, Op, Stream, Arg);
+		if (PayloadSize > 0)
+		{
+			Out.Append(Payload, PayloadSize);
+		}
+	}
+
+	/** @return false if the message is too short to be a frame */
+	inline bool ReadFrame(const uint8* Data, int32 Num, FFrame& OutFrame)
+	{
+		if (Num < FrameHeaderSize)
+		{
+			return false;
+		}
+		OutFrame.Op = static_cast<EOp>(Data[0]);
+		OutFrame.Stream = ReadUInt32(Data + 1);
+		OutFrame.Arg = ReadUInt32(Data + 5);
+		OutFrame.Payload = Data + FrameHeaderSize;
+		OutFrame.PayloadSize = Num - FrameHeaderSize;
+		return true;
+	}
+
+	/** Parse "Name: Value\r\n" lines */
+	inline void ParseHeaderLines(const FString& Text, TMap<FString, FString>& OutHeaders)
+	{
+		TArray<FString> Lines;
+		Text.ParseIntoArray(Lines, TEXT("\r\n"), true);
+		for (const FString& Line : Lines)
+		{
+			FString Name, Value;
+			if (Line.Split(TEXT(":"), &Name, &Value))
+			{
+				OutHeaders.Add(Name.TrimStartAndEnd(), Value.TrimStartAndEnd());
+			}
+		}
+	}
+}
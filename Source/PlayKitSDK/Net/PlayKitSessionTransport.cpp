@@ -0,0 +1,452 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitSessionTransport.h"
+#include "PlayKitSessionProtocol.h"
+#include "PlayKitTransportRequest.h"
+#include "PlayKitMemory.h"
+#include "PlayKitSettings.h"
+#include "HttpModule.h"
+#include "IWebSocket.h"
+#include "WebSocketsModule.h"
+
+/** A request carried as one stream of the session */
+class FPlayKitSessionRequest : public FPlayKitTransportRequest
+{
+public:
+	explicit FPlayKitSessionRequest(const TSharedRef<FPlayKitSessionTransport, ESPMode::ThreadSafe>& InTransport)
+		: Transport(InTransport)
+	{
+	}
+
+protected:
+	//~ Begin FPlayKitTransportRequest Interface
+	virtual bool StartRequest() override
+	{
+		Transport->StartStream(StaticCastSharedRef<FPlayKitSessionRequest>(AsShared()));
+		return true;
+	}
+	virtual void StopRequest() override { Transport->StopStream(*this); }
+	//~ End FPlayKitTransportRequest Interface
+
+private:
+	friend class FPlayKitSessionTransport;
+
+	TSharedRef<FPlayKitSessionTransport, ESPMode::ThreadSafe> Transport;
+
+	uint32 StreamId = 0;
+
+	/** Body bytes received; the offset a resumed stream continues from */
+	uint32 BytesReceived = 0;
+
+	/** The Request frame went out within the current session */
+	bool bSent = false;
+};
+
+namespace PlayKitSessionTransport
+{
+	/** "/ai/game/v2/chat?x=1" from "https://host:port/ai/game/v2/chat?x=1" */
+	FString GetPathAndQuery(const FString& Url)
+	{
+		const int32 SchemeEnd = Url.Find(TEXT("://"));
+		const int32 HostStart = SchemeEnd == INDEX_NONE ? 0 : SchemeEnd + 3;
+		const int32 PathStart = Url.Find(TEXT("/"), ESearchCase::CaseSensitive, ESearchDir::FromStart, HostStart);
+		return PathStart == INDEX_NONE ? FString(TEXT("/")) : Url.Mid(PathStart);
+	}
+
+	void AppendUtf8(TArray<uint8>& Out, const FString& Text)
+	{
+		const FTCHARToUTF8 Utf8(*Text, Text.Len());
+		Out.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+
+	FString FromUtf8(const uint8* Data, int32 Num)
+	{
+		const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Data), Num);
+		return FString(Converted.Length(), Converted.Get());
+	}
+}
+
+FPlayKitSessionTransport::FPlayKitSessionTransport(const FPlayKitSessionConfig& InConfig)
+	: Config(InConfig)
+{
+}
+
+FPlayKitSessionTransport::~FPlayKitSessionTransport()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(ReconnectHandle);
+	if (Socket.IsValid())
+	{
+		Socket->OnConnected().RemoveAll(this);
+		Socket->OnConnectionError().RemoveAll(this);
+		Socket->OnClosed().RemoveAll(this);
+		Socket->OnRawMessage().RemoveAll(this);
+		Socket->Close();
+	}
+}
+
+TSharedRef<IHttpRequest, ESPMode::ThreadSafe> FPlayKitSessionTransport::CreateRequest(const FString& Url)
+{
+	if (!IsSessionRoute(Url))
+	{
+		return FHttpModule::Get().CreateRequest();
+	}
+	return MakeShared<FPlayKitSessionRequest, ESPMode::ThreadSafe>(AsShared());
+}
+
+bool FPlayKitSessionTransport::IsSessionRoute(const FString& Url) const
+{
+	FString Path = PlayKitSessionTransport::GetPathAndQuery(Url);
+	int32 QueryStart = INDEX_NONE;
+	if (Path.FindChar(TEXT('?'), QueryStart))
+	{
+		Path.LeftInline(QueryStart);
+	}
+
+	for (const FString& Route : Config.Routes)
+	{
+		if (Path.EndsWith(Route))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+FString FPlayKitSessionTransport::GetSessionUrl() const
+{
+	if (!Config.Url.IsEmpty())
+	{
+		return Config.Url;
+	}
+
+	const UPlayKitSettings* Settings = UPlayKitSettings::Get();
+	FString BaseUrl = Settings ? Settings->GetBaseUrl() : FString(TEXT("https://api.playkit.ai"));
+	BaseUrl.RemoveFromEnd(TEXT("/"));
+	if (BaseUrl.StartsWith(TEXT("https://")))
+	{
+		BaseUrl = TEXT("wss://") + BaseUrl.Mid(8);
+	}
+	else if (BaseUrl.StartsWith(TEXT("http://")))
+	{
+		BaseUrl = TEXT("ws://") + BaseUrl.Mid(7);
+	}
+	return BaseUrl + TEXT("/session/v1");
+}
+
+void FPlayKitSessionTransport::StartStream(const TSharedRef<FPlayKitSessionRequest, ESPMode::ThreadSafe>& Request)
+{
+	check(IsInGameThread());
+	Request->StreamId = NextStreamId++;
+	Request->BytesReceived = 0;
+	Request->bSent = false;
+	Streams.Add(Request->StreamId, Request);
+
+	if (State == EState::Ready)
+	{
+		SendRequestFrame(*Request);
+	}
+	else if (State == EState::Disconnected && !ReconnectHandle.IsValid())
+	{
+		Connect();
+	}
+	// Otherwise the request goes out once the session is attached
+}
+
+void FPlayKitSessionTransport::StopStream(FPlayKitSessionRequest& Request)
+{
+	if (Streams.Remove(Request.StreamId) > 0 && Request.bSent && State == EState::Ready)
+	{
+		TArray<uint8> Frame;
+		PlayKitSession::WriteFrame(Frame, PlayKitSession::EOp::Cancel, Request.StreamId, 0);
+		SendFrame(Frame);
+	}
+}
+
+void FPlayKitSessionTransport::Connect()
+{
+	ReconnectHandle.Reset();
+	Incoming.Reset();
+
+	// Authorized once per connection; requests only carry a token when theirs differs
+	TMap<FString, FString> Headers;
+	const FString Token = FPlayKitTransport::GetAuthToken();
+	if (!Token.IsEmpty())
+	{
+		Headers.Add(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *Token));
+	}
+	ConnectionAuthorization = Headers.FindRef(TEXT("Authorization"));
+
+	const FString Url = GetSessionUrl();
+	Socket = FWebSocketsModule::Get().CreateWebSocket(Url, PlayKitSession::Protocol, Headers);
+
+	IWebSocket* Source = Socket.Get();
+	Socket->OnConnected().AddSP(this, &FPlayKitSessionTransport::HandleConnected, Source);
+	Socket->OnConnectionError().AddSP(this, &FPlayKitSessionTransport::HandleConnectionError, Source);
+	Socket->OnClosed().AddSP(this, &FPlayKitSessionTransport::HandleClosed, Source);
+	Socket->OnRawMessage().AddSP(this, &FPlayKitSessionTransport::HandleRawMessage, Source);
+
+	State = EState::Connecting;
+	if (bConnectedOnce)
+	{
+		++ReconnectCount;
+	}
+	UE_LOG(LogTemp, Log, TEXT("[PlayKitSession] Connecting to %s (%d requests pending)"), *Url, Streams.Num());
+	Socket->Connect();
+}
+
+void FPlayKitSessionTransport::SendRequestFrame(FPlayKitSessionRequest& Request)
+{
+	LLM_SCOPE_BYTAG(PlayKit_Transport);
+
+	TArray<uint8> Head;
+	PlayKitSessionTransport::AppendUtf8(Head, FString::Printf(TEXT("%s %s\r\n"), *Request.Verb, *PlayKitSessionTransport::GetPathAndQuery(Request.Url)));
+	for (const TPair<FString, FString>& Header : Request.Headers)
+	{
+		if (Header.Key == TEXT("Authorization") && Header.Value == ConnectionAuthorization)
+		{
+			continue;
+		}
+		PlayKitSessionTransport::AppendUtf8(Head, FString::Printf(TEXT("%s: %s\r\n"), *Header.Key, *Header.Value));
+	}
+
+	TArray<uint8> Frame;
+	Frame.Reserve(PlayKitSession::FrameHeaderSize + Head.Num() + Request.Content.Num());
+	PlayKitSession::WriteFrameHeader(Frame, PlayKitSession::EOp::Request, Request.StreamId, static_cast<uint32>(Head.Num()));
+	Frame.Append(Head);
+	Frame.Append(Request.Content);
+	SendFrame(Frame);
+	Request.bSent = true;
+}
+
+void FPlayKitSessionTransport::SendFrame(const TArray<uint8>& Frame)
+{
+	if (Socket.IsValid())
+	{
+		Socket->Send(Frame.GetData(), Frame.Num(), true);
+	}
+}
+
+void FPlayKitSessionTransport::HandleConnected(IWebSocket* Source)
+{
+	if (Source != Socket.Get())
+	{
+		return;
+	}
+
+	State = EState::Attaching;
+	bConnectedOnce = true;
+
+	TArray<uint8> Payload;
+	PlayKitSessionTransport::AppendUtf8(Payload, SessionId);
+	TArray<uint8> Frame;
+	PlayKitSession::WriteFrame(Frame, PlayKitSession::EOp::Attach, 0, 0, Payload.GetData(), Payload.Num());
+	SendFrame(Frame);
+}
+
+void FPlayKitSessionTransport::HandleConnectionError(const FString& Error, IWebSocket* Source)
+{
+	if (Source == Socket.Get())
+	{
+		OnDisconnected(Error);
+	}
+}
+
+void FPlayKitSessionTransport::HandleClosed(int32 StatusCode, const FString& Reason, bool bWasClean, IWebSocket* Source)
+{
+	if (Source == Socket.Get())
+	{
+		OnDisconnected(FString::Printf(TEXT("closed (%d) %s"), StatusCode, *Reason));
+	}
+}
+
+void FPlayKitSessionTransport::HandleRawMessage(const void* Data, SIZE_T Size, SIZE_T BytesRemaining, IWebSocket* Source)
+{
+	if (Source != Socket.Get())
+	{
+		return;
+	}
+
+	LLM_SCOPE_BYTAG(PlayKit_Transport);
+
+	// Messages may arrive in fragments; a frame is handled once complete
+	if (Incoming.Num() == 0 && BytesRemaining == 0)
+	{
+		HandleFrame(static_cast<const uint8*>(Data), static_cast<int32>(Size));
+		return;
+	}
+
+	Incoming.Append(static_cast<const uint8*>(Data), static_cast<int32>(Size));
+	if (BytesRemaining == 0)
+	{
+		const TArray<uint8> Message = MoveTemp(Incoming);
+		Incoming.Reset();
+		HandleFrame(Message.GetData(), Message.Num());
+	}
+}
+
+void FPlayKitSessionTransport::HandleFrame(const uint8* Data, int32 Num)
+{
+	PlayKitSession::FFrame Frame;
+	if (!PlayKitSession::ReadFrame(Data, Num, Frame))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[PlayKitSession] Ignoring a %d byte message"), Num);
+		return;
+	}
+
+	if (Frame.Op == PlayKitSession::EOp::Hello)
+	{
+		HandleHello(PlayKitSessionTransport::FromUtf8(Frame.Payload, Frame.PayloadSize));
+		return;
+	}
+
+	const TSharedRef<FPlayKitSessionRequest, ESPMode::ThreadSafe>* Found = Streams.Find(Frame.Stream);
+	if (!Found)
+	{
+		// Cancelled, or already failed
+		return;
+	}
+	TSharedRef<FPlayKitSessionRequest, ESPMode::ThreadSafe> Request = *Found;
+
+	switch (Frame.Op)
+	{
+	case PlayKitSession::EOp::Head:
+	{
+		// Repeated after a resume; the base request ignores a second head
+		TMap<FString, FString> Headers;
+		PlayKitSession::ParseHeaderLines(PlayKitSessionTransport::FromUtf8(Frame.Payload, Frame.PayloadSize), Headers);
+		Request->ReceiveHead(static_cast<int32>(Frame.Arg), Headers);
+		break;
+	}
+	case PlayKitSession::EOp::Data:
+	{
+		if (Frame.Arg > Request->BytesReceived)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[PlayKitSession] Stream %u skipped from byte %u to %u"), Frame.Stream, Request->BytesReceived, Frame.Arg);
+			TArray<uint8> Cancel;
+			PlayKitSession::WriteFrame(Cancel, PlayKitSession::EOp::Cancel, Frame.Stream, 0);
+			SendFrame(Cancel);
+			FinishStream(Frame.Stream, false);
+			break;
+		}
+
+		// A resumed stream may repeat bytes we already have
+		const uint32 Skip = Request->BytesReceived - Frame.Arg;
+		if (Skip < static_cast<uint32>(Frame.PayloadSize))
+		{
+			const int32 NumNew = Frame.PayloadSize - static_cast<int32>(Skip);
+			Request->BytesReceived += NumNew;
+			Request->ReceiveBody(Frame.Payload + Skip, NumNew);
+		}
+		break;
+	}
+	case PlayKitSession::EOp::End:
+		FinishStream(Frame.Stream, Request->HasResponded());
+		break;
+	case PlayKitSession::EOp::Gone:
+		UE_LOG(LogTemp, Warning, TEXT("[PlayKitSession] Server lost stream %u"), Frame.Stream);
+		FinishStream(Frame.Stream, false);
+		break;
+	default:
+		break;
+	}
+}
+
+void FPlayKitSessionTransport::HandleHello(const FString& NewSessionId)
+{
+	if (!SessionId.IsEmpty() && NewSessionId != SessionId)
+	{
+		// Replies of the old session are gone; requests it never saw can still go out
+		UE_LOG(LogTemp, Warning, TEXT("[PlayKitSession] Session %s expired, continuing as %s"), *SessionId, *NewSessionId);
+		FailStreams([](const FPlayKitSessionRequest& Request) { return Request.bSent; });
+	}
+
+	SessionId = NewSessionId;
+	State = EState::Ready;
+	ReconnectAttempts = 0;
+
+	TArray<TSharedRef<FPlayKitSessionRequest, ESPMode::ThreadSafe>> Pending;
+	Streams.GenerateValueArray(Pending);
+	for (const TSharedRef<FPlayKitSessionRequest, ESPMode::ThreadSafe>& Request : Pending)
+	{
+		if (Request->bSent)
+		{
+			TArray<uint8> Frame;
+			PlayKitSession::WriteFrame(Frame, PlayKitSession::EOp::Resume, Request->StreamId, Request->BytesReceived);
+			SendFrame(Frame);
+		}
+		else
+		{
+			SendRequestFrame(*Request);
+		}
+	}
+}
+
+void FPlayKitSessionTransport::OnDisconnected(const FString& Reason)
+{
+	UE_LOG(LogTemp, Log, TEXT("[PlayKitSession] Connection lost: %s"), *Reason);
+
+	// Not released inside its own callback
+	TSharedPtr<IWebSocket> Closed = MoveTemp(Socket);
+	Socket.Reset();
+	FTSTicker::GetCoreTicker().AddTicker(TEXT("PlayKitSessionReleaseSocket"), 0.0f, [Closed](float) { return false; });
+
+	State = EState::Disconnected;
+	Incoming.Reset();
+
+	// Idle sessions reconnect with the next request
+	if (Streams.Num() > 0)
+	{
+		ScheduleReconnect();
+	}
+}
+
+void FPlayKitSessionTransport::ScheduleReconnect()
+{
+	if (++ReconnectAttempts > Config.MaxReconnectAttempts)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[PlayKitSession] Giving up after %d reconnect attempts; failing %d requests"),
+			Config.MaxReconnectAttempts, Streams.Num());
+		ReconnectAttempts = 0;
+		FailStreams([](const FPlayKitSessionRequest&) { return true; });
+		return;
+	}
+
+	const float Delay = FMath::Min(Config.ReconnectDelay * FMath::Pow(2.0f, float(ReconnectAttempts - 1)), Config.MaxReconnectDelay);
+	TWeakPtr<FPlayKitSessionTransport, ESPMode::ThreadSafe> WeakThis = AsShared();
+	ReconnectHandle = FTSTicker::GetCoreTicker().AddTicker(TEXT("PlayKitSessionReconnect"), Delay, [WeakThis](float)
+	{
+		if (TSharedPtr<FPlayKitSessionTransport, ESPMode::ThreadSafe> This = WeakThis.Pin())
+		{
+			This->Connect();
+		}
+		return false;
+	});
+}
+
+void FPlayKitSessionTransport::FinishStream(uint32 StreamId, bool bSucceeded)
+{
+	const TSharedRef<FPlayKitSessionRequest, ESPMode::ThreadSafe>* Found = Streams.Find(StreamId);
+	if (Found)
+	{
+		const TSharedRef<FPlayKitSessionRequest, ESPMode::ThreadSafe> Request = *Found;
+		Streams.Remove(StreamId);
+		Request->Finish(bSucceeded, bSucceeded ? EHttpFailureReason::None : EHttpFailureReason::ConnectionError);
+	}
+}
+
+void FPlayKitSessionTransport::FailStreams(TFunctionRef<bool(const FPlayKitSessionRequest&)> Predicate)
+{
+	// Collected first: completion delegates may start or cancel requests
+	TArray<uint32> Failed;
+	for (const TPair<uint32, TSharedRef<FPlayKitSessionRequest, ESPMode::ThreadSafe>>& Stream : Streams)
+	{
+		if (Predicate(*Stream.Value))
+		{
+			Failed.Add(Stream.Key);
+		}
+	}
+	for (uint32 StreamId : Failed)
+	{
+		FinishStream(StreamId, false);
+	}
+}
@@ -0,0 +1,135 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PlayKitTransport.h"
+#include "Containers/Ticker.h"
+
+class IWebSocket;
+class FPlayKitSessionRequest;
+
+/**
+ * Options of FPlayKitSessionTransport
+ */
+struct PLAYKITSDK_API FPlayKitSessionConfig
+{
+	/**
+	 * ws:// or wss:// endpoint. Empty derives it from UPlayKitSettings::GetBaseUrl() when
+	 * connecting ("https://host" becomes "wss://host/session/v1"), so a changed base URL
+	 * is picked up on the next connection.
+	 */
+	FString Url;
+
+	/** URL path endings carried over the session; other requests go to FHttpModule */
+	TArray<FString> Routes = { TEXT("/v2/chat") };
+
+	/** Delay before the first reconnect; doubles per failed attempt up to MaxReconnectDelay */
+	float ReconnectDelay = 0.25f;
+	float MaxReconnectDelay = 8.0f;
+
+	/** Failed reconnects in a row before the unfinished requests fail with a connection error */
+	int32 MaxReconnectAttempts = 6;
+};
+
+/**
+ * Transport that multiplexes requests over one long-lived WebSocket (WebSockets module).
+ *
+ * Every chat turn otherwise is a fresh HTTPS request with full headers and often a new
+ * TLS handshake. Here the connection is opened once, authorized once, and then carries
+ * the requests of all NPCs side by side: each request is a stream of the session, and its
+ * reply (status, headers, streamed deltas) comes back as frames tagged with the stream.
+ * See PlayKitSessionProtocol.h for the wire format.
+ *
+ * The connection opens lazily with the first request. When it drops, unfinished
+ * requests stay pending; the transport reconnects with backoff, reattaches the session
+ * and resumes every stream at the byte it got to, so a stream cut mid-reply continues
+ * instead of failing. If the server has lost the session, the affected requests fail
+ * with a connection error and the clients' usual error handling takes over.
+ *
+ * The session endpoint needs server support; the test server (FPlayKitMockServer) has one.
+ * Enable it with UPlayKitSettings::bUseSessionTransport, or install it directly:
+ *   FPlayKitTransport::Set(MakeShared<FPlayKitSessionTransport, ESPMode::ThreadSafe>(FPlayKitSessionConfig()));
+ */
+class PLAYKITSDK_API FPlayKitSessionTransport : public IPlayKitTransport, public TSharedFromThis<FPlayKitSessionTransport, ESPMode::ThreadSafe>
+{
+public:
+	explicit FPlayKitSessionTransport(const FPlayKitSessionConfig& InConfig);
+	virtual ~FPlayKitSessionTransport() override;
+
+	//~ Begin IPlayKitTransport Interface
+	virtual const TCHAR* GetName() const override { return TEXT("Session"); }
+	virtual TSharedRef<IHttpRequest, ESPMode::ThreadSafe> CreateRequest(const FString& Url) override;
+	//~ End IPlayKitTransport Interface
+
+	/** The session is attached and requests go out right away */
+	bool IsConnected() const { return State == EState::Ready; }
+
+	/** Id the server gave the session; empty before the first connection */
+	const FString& GetSessionId() const { return SessionId; }
+
+	/** Reconnect attempts so far */
+	int32 GetReconnectCount() const { return ReconnectCount; }
+
+	/** Requests in flight over the session */
+	int32 GetNumStreams() const { return Streams.Num(); }
+
+private:
+	friend class FPlayKitSessionRequest;
+
+	enum class EState : uint8
+	{
+		Disconnected,
+		Connecting,
+		Attaching,
+		Ready
+	};
+
+	bool IsSessionRoute(const FString& Url) const;
+	FString GetSessionUrl() const;
+
+	// Called by the requests
+	void StartStream(const TSharedRef<FPlayKitSessionRequest, ESPMode::ThreadSafe>& Request);
+	void StopStream(FPlayKitSessionRequest& Request);
+
+	void Connect();
+	void SendRequestFrame(FPlayKitSessionRequest& Request);
+	void SendFrame(const TArray<uint8>& Frame);
+
+	void HandleConnected(IWebSocket* Source);
+	void HandleConnectionError(const FString& Error, IWebSocket* Source);
+	void HandleClosed(int32 StatusCode, const FString& Reason, bool bWasClean, IWebSocket* Source);
+	void HandleRawMessage(const void* Data, SIZE_T Size, SIZE_T BytesRemaining, IWebSocket* Source);
+	void HandleFrame(const uint8* Data, int32 Num);
+	void HandleHello(const FString& NewSessionId);
+
+	void OnDisconnected(const FString& Reason);
+	void ScheduleReconnect();
+
+	/** Remove a stream and complete its request */
+	void FinishStream(uint32 StreamId, bool bSucceeded);
+
+	/** Fail every stream for which Predicate returns true */
+	void FailStreams(TFunctionRef<bool(const FPlayKitSessionRequest&)> Predicate);
+
+	FPlayKitSessionConfig Config;
+
+	TSharedPtr<IWebSocket> Socket;
+	EState State = EState::Disconnected;
+	FString SessionId;
+
+	/** Authorization header the connection was opened with */
+	FString ConnectionAuthorization;
+
+	/** Requests in flight by stream id. They also keep the transport alive until they finish. */
+	TMap<uint32, TSharedRef<FPlayKitSessionRequest, ESPMode::ThreadSafe>> Streams;
+	uint32 NextStreamId = 1;
+
+	/** Fragments of the binary message being received */
+	TArray<uint8> Incoming;
+
+	int32 ReconnectAttempts = 0;
+	int32 ReconnectCount = 0;
+	bool bConnectedOnce = false;
+	FTSTicker::FDelegateHandle ReconnectHandle;
+};
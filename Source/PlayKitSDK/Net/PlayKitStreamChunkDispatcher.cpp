@@ -0,0 +1,128 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitStreamChunkDispatcher.h"
+#include "PlayKitRequestTrace.h"
+#include "PlayKitSettings.h"
+#include "Containers/Ticker.h"
+
+DECLARE_CYCLE_STAT(TEXT("Stream Chunk Dispatch"), STAT_PlayKitStreamChunkDispatch, STATGROUP_PlayKit);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Stream Chunk Broadcasts"), STAT_PlayKitStreamChunkBroadcasts, STATGROUP_PlayKit);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Components Carried Over"), STAT_PlayKitChunkSourcesCarriedOver, STATGROUP_PlayKit);
+
+namespace PlayKitStreamChunkDispatcher
+{
+	struct FScheduled
+	{
+		FObjectKey Key;
+		TWeakObjectPtr<UObject> Owner;
+		IPlayKitStreamChunkSource* Source = nullptr;
+	};
+
+	/** Components in service order */
+	TArray<FScheduled> Queue;
+
+	/** Owners in Queue, so scheduling once per delta stays cheap */
+	TSet<FObjectKey> Queued;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+}
+
+void FPlayKitStreamChunkDispatcher::Schedule(UObject* Owner, IPlayKitStreamChunkSource* Source)
+{
+	using namespace PlayKitStreamChunkDispatcher;
+	check(IsInGameThread());
+
+	const FObjectKey Key(Owner);
+	bool bAlreadyQueued = false;
+	Queued.Add(Key, &bAlreadyQueued);
+	if (!bAlreadyQueued)
+	{
+		Queue.Add({ Key, Owner, Source });
+	}
+}
+
+void FPlayKitStreamChunkDispatcher::Dispatch()
+{
+	using namespace PlayKitStreamChunkDispatcher;
+	if (Queue.Num() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_PlayKitStreamChunkDispatch);
+
+	const UPlayKitSettings* Settings = UPlayKitSettings::Get();
+	const double BudgetSeconds = (Settings ? Settings->StreamChunkBudgetMs : 0.5f) / 1000.0;
+	int32 BroadcastsLeft = FMath::Max(1, Settings ? Settings->MaxStreamChunkBroadcastsPerFrame : 16);
+
+	// Always serve at least one component, so a tight budget only slows streams down
+	const double Deadline = FPlatformTime::Seconds() + BudgetSeconds;
+	int32 NumServed = 0;
+	int32 NumBroadcasts = 0;
+	TArray<FScheduled> CutOff;
+
+	// Listeners may schedule more components while the loop runs; those are appended and served if time allows
+	while (NumServed < Queue.Num())
+	{
+		const FScheduled Entry = Queue[NumServed++];
+		if (!Entry.Owner.IsValid())
+		{
+			Queued.Remove(Entry.Key);
+			continue;
+		}
+
+		const int32 Broadcasts = Entry.Source->BroadcastPendingChunks(BroadcastsLeft);
+		BroadcastsLeft -= Broadcasts;
+		NumBroadcasts += Broadcasts;
+
+		if (Entry.Source->HasPendingChunks())
+		{
+			CutOff.Add(Entry);
+		}
+		else
+		{
+			Queued.Remove(Entry.Key);
+		}
+
+		if (BroadcastsLeft <= 0 || FPlatformTime::Seconds() >= Deadline)
+		{
+			break;
+		}
+	}
+
+	// Components not reached keep their place; components cut off by the cap go behind them
+	Queue.RemoveAt(0, NumServed, EAllowShrinking::No);
+	Queue.Append(MoveTemp(CutOff));
+
+	INC_DWORD_STAT_BY(STAT_PlayKitStreamChunkBroadcasts, NumBroadcasts);
+	INC_DWORD_STAT_BY(STAT_PlayKitChunkSourcesCarriedOver, Queue.Num());
+	CSV_CUSTOM_STAT(PlayKit, StreamChunkBroadcasts, NumBroadcasts, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(PlayKit, ChunkSourcesCarriedOver, Queue.Num(), ECsvCustomStatOp::Set);
+}
+
+void FPlayKitStreamChunkDispatcher::Startup()
+{
+	using namespace PlayKitStreamChunkDispatcher;
+	if (!TickerHandle.IsValid())
+	{
+		TickerHandle = FTSTicker::GetCoreTicker().AddTicker(
+			TEXT("PlayKitStreamChunkDispatcher"), 0.0f, [](float)
+			{
+				Dispatch();
+				return true;
+			});
+	}
+}
+
+void FPlayKitStreamChunkDispatcher::Shutdown()
+{
+	using namespace PlayKitStreamChunkDispatcher;
+	if (TickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+		TickerHandle.Reset();
+	}
+
+	Queue.Empty();
+	Queued.Empty();
+}
@@ -0,0 +1,54 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+/**
+ * A component that buffers stream chunks for FPlayKitStreamChunkDispatcher
+ */
+class IPlayKitStreamChunkSource
+{
+public:
+	/**
+	 * Broadcast merged pending chunks, one broadcast per stream.
+	 * @param MaxBroadcasts Broadcasts left this frame; streams over it stay pending
+	 * @return Broadcasts made
+	 */
+	virtual int32 BroadcastPendingChunks(int32 MaxBroadcasts) = 0;
+
+	/** Whether chunks are still waiting for a broadcast */
+	virtual bool HasPendingChunks() const = 0;
+
+protected:
+	~IPlayKitStreamChunkSource() = default;
+};
+
+/**
+ * Delivers buffered stream chunks to Blueprint once per frame, within a budget.
+ *
+ * Components using EPlayKitChunkDelivery::PerFrame merge text deltas per stream and
+ * schedule themselves here. Every frame the core ticker lets scheduled components
+ * broadcast, in the order they were scheduled, until the settings' time budget or
+ * broadcast cap is used up. Components not reached, or cut off by the cap, are served
+ * first on the next frame, so with many NPCs streaming the cost per frame stays flat
+ * and every stream still makes progress.
+ *
+ * Game thread only.
+ */
+class PLAYKITSDK_API FPlayKitStreamChunkDispatcher
+{
+public:
+	/** Queue a component with pending chunks; no-op when it is queued already */
+	static void Schedule(UObject* Owner, IPlayKitStreamChunkSource* Source);
+
+	/** Broadcast pending chunks within this frame's budget. Called by the core ticker every frame. */
+	static void Dispatch();
+
+	/** Register the per-frame dispatch with the core ticker. Called at module startup. */
+	static void Startup();
+
+	/** Unregister the dispatch and forget queued components */
+	static void Shutdown();
+};
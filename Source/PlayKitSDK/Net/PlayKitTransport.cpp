@@ -0,0 +1,79 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitTransport.h"
+#include "PlayKitSessionTransport.h"
+#include "PlayKitSettings.h"
+#include "Auth/PlayKitCredentials.h"
+#include "HttpModule.h"
+
+namespace PlayKitTransport
+{
+	TSharedPtr<IPlayKitTransport, ESPMode::ThreadSafe>& GetInstalled()
+	{
+		static TSharedPtr<IPlayKitTransport, ESPMode::ThreadSafe> Installed;
+		return Installed;
+	}
+}
+
+TSharedRef<IHttpRequest, ESPMode::ThreadSafe> FPlayKitHttpModuleTransport::CreateRequest(const FString& Url)
+{
+	return FHttpModule::Get().CreateRequest();
+}
+
+IPlayKitTransport& FPlayKitTransport::Get()
+{
+	TSharedPtr<IPlayKitTransport, ESPMode::ThreadSafe>& Installed = PlayKitTransport::GetInstalled();
+	if (!Installed.IsValid())
+	{
+		const UPlayKitSettings* Settings = UPlayKitSettings::Get();
+		if (Settings && Settings->bUseSessionTransport)
+		{
+			FPlayKitSessionConfig SessionConfig;
+			SessionConfig.Url = Settings->SessionUrl;
+			Installed = MakeShared<FPlayKitSessionTransport, ESPMode::ThreadSafe>(SessionConfig);
+		}
+		else
+		{
+			Installed = MakeShared<FPlayKitHttpModuleTransport, ESPMode::ThreadSafe>();
+		}
+	}
+	return *Installed;
+}
+
+void FPlayKitTransport::Set(TSharedPtr<IPlayKitTransport, ESPMode::ThreadSafe> InTransport)
+{
+	check(IsInGameThread());
+	PlayKitTransport::GetInstalled() = MoveTemp(InTransport);
+	UE_LOG(LogTemp, Log, TEXT("[PlayKit] Transport: %s"), Get().GetName());
+}
+
+void FPlayKitTransport::Shutdown()
+{
+	PlayKitTransport::GetInstalled().Reset();
+}
+
+FString FPlayKitTransport::GetAuthToken()
+{
+	return FPlayKitCredentials::GetAuthToken();
+}
+
+FPlayKitTransport::FHttpRequestRef FPlayKitTransport::CreateRequest(const FString& Url, const FString& Verb, const FString& ContentType, const FString& Token)
+{
+	FHttpRequestRef Request = Get().CreateRequest(Url);
+	Request->SetURL(Url);
+	Request->SetVerb(Verb);
+	if (!ContentType.IsEmpty())
+	{
+		Request->SetHeader(TEXT("Content-Type"), ContentType);
+	}
+	if (!Token.IsEmpty())
+	{
+		Request->SetHeader(TEXT("Authorization"), FString::Printf(TEXT("Bearer %s"), *Token));
+	}
+	return Request;
+}
+
+FPlayKitTransport::FHttpRequestRef FPlayKitTransport::CreateAuthenticatedRequest(const FString& Url, const FString& Verb)
+{
+	return CreateRequest(Url, Verb, TEXT("application/json"), GetAuthToken());
+}
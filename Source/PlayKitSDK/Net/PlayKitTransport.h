@@ -0,0 +1,79 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpRequest.h"
+
+/**
+ * Source of the HTTP requests the SDK sends.
+ *
+ * Clients never create requests themselves; they go through FPlayKitTransport, which
+ * asks the installed transport for an unconfigured IHttpRequest and applies the shared
+ * URL, verb, content type and auth headers. A transport only decides how the request is
+ * carried: FHttpModule (the default), an in-process loopback (FPlayKitLoopbackTransport),
+ * or a multiplexed session connection (FPlayKitSessionTransport). Requests get the URL
+ * they are created for, so a transport can carry some routes itself and hand the rest
+ * to FHttpModule.
+ *
+ * Requests must behave like FHttpModule requests: delegates, receive streams, progress
+ * and cancellation included, since the scheduler and the clients rely on all of them.
+ */
+class PLAYKITSDK_API IPlayKitTransport
+{
+public:
+	virtual ~IPlayKitTransport() = default;
+
+	/** Name for logs and benchmark output */
+	virtual const TCHAR* GetName() const = 0;
+
+	/** Create an unconfigured request for Url; the caller still sets the URL. Game thread. */
+	virtual TSharedRef<IHttpRequest, ESPMode::ThreadSafe> CreateRequest(const FString& Url) = 0;
+};
+
+/**
+ * The default transport: requests from FHttpModule (libcurl or the platform HTTP stack)
+ */
+class PLAYKITSDK_API FPlayKitHttpModuleTransport : public IPlayKitTransport
+{
+public:
+	//~ Begin IPlayKitTransport Interface
+	virtual const TCHAR* GetName() const override { return TEXT("HttpModule"); }
+	virtual TSharedRef<IHttpRequest, ESPMode::ThreadSafe> CreateRequest(const FString& Url) override;
+	//~ End IPlayKitTransport Interface
+};
+
+/**
+ * Installed transport, and the one request/auth path shared by all clients. Game thread only.
+ */
+class PLAYKITSDK_API FPlayKitTransport
+{
+public:
+	using FHttpRequestRef = TSharedRef<IHttpRequest, ESPMode::ThreadSafe>;
+
+	/** Transport new requests are created with */
+	static IPlayKitTransport& Get();
+
+	/**
+	 * Install a transport; nullptr restores the default: FPlayKitSessionTransport if
+	 * UPlayKitSettings::bUseSessionTransport is set, else FPlayKitHttpModuleTransport.
+	 * Requests already created keep running on the transport that created them.
+	 */
+	static void Set(TSharedPtr<IPlayKitTransport, ESPMode::ThreadSafe> InTransport);
+
+	/** Release the installed transport at module shutdown; unlike Set(nullptr) no default is created */
+	static void Shutdown();
+
+	/** Token sent by the clients: the developer token unless it is ignored, else the player token */
+	static FString GetAuthToken();
+
+	/**
+	 * Create a request on the installed transport.
+	 * @param ContentType Content-Type header; not set if empty (e.g. multipart bodies set their own)
+	 * @param Token Bearer token; no Authorization header if empty
+	 */
+	static FHttpRequestRef CreateRequest(const FString& Url, const FString& Verb, const FString& ContentType, const FString& Token);
+
+	/** A JSON request authorized with GetAuthToken() */
+	static FHttpRequestRef CreateAuthenticatedRequest(const FString& Url, const FString& Verb = TEXT("POST"));
+};
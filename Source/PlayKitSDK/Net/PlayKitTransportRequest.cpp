@@ -0,0 +1,229 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitTransportRequest.h"
+#include "Interfaces/IHttpResponse.h"
+#include "GenericPlatform/GenericPlatformHttp.h"
+#include "Containers/Ticker.h"
+
+/** Response of a transport request; filled in on the game thread while the reply arrives */
+class FPlayKitTransportResponse : public IHttpResponse
+{
+public:
+	FString Url;
+	int32 StatusCode = 0;
+	TMap<FString, FString> Headers;
+	TArray<uint8> Content;
+	EHttpRequestStatus::Type Status = EHttpRequestStatus::Processing;
+	EHttpFailureReason FailureReason = EHttpFailureReason::None;
+
+	//~ Begin IHttpBase Interface
+	virtual const FString& GetURL() const override { return Url; }
+	virtual FString GetURLParameter(const FString& ParameterName) const override { return FString(); }
+	virtual FString GetHeader(const FString& HeaderName) const override { return Headers.FindRef(HeaderName); }
+	virtual TArray<FString> GetAllHeaders() const override
+	{
+		TArray<FString> Result;
+		for (const TPair<FString, FString>& Header : Headers)
+		{
+			Result.Add(FString::Printf(TEXT("%s: %s"), *Header.Key, *Header.Value));
+		}
+		return Result;
+	}
+	virtual FString GetContentType() const override { return GetHeader(TEXT("Content-Type")); }
+	virtual uint64 GetContentLength() const override { return Content.Num(); }
+	virtual const TArray<uint8>& GetContent() const override { return Content; }
+	virtual EHttpRequestStatus::Type GetStatus() const override { return Status; }
+	virtual EHttpFailureReason GetFailureReason() const override { return FailureReason; }
+	virtual const FString& GetEffectiveURL() const override { return Url; }
+	//~ End IHttpBase Interface
+
+	//~ Begin IHttpResponse Interface
+	virtual int32 GetResponseCode() const override { return StatusCode; }
+	virtual FString GetContentAsString() const override
+	{
+		const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Content.GetData()), Content.Num());
+		return FString(Converted.Length(), Converted.Get());
+	}
+	//~ End IHttpResponse Interface
+};
+
+FString FPlayKitTransportRequest::GetURLParameter(const FString& ParameterName) const
+{
+	FString Query;
+	if (Url.Split(TEXT("?"), nullptr, &Query))
+	{
+		TArray<FString> Pairs;
+		Query.ParseIntoArray(Pairs, TEXT("&"));
+		for (const FString& Pair : Pairs)
+		{
+			FString Name, Value;
+			if (Pair.Split(TEXT("="), &Name, &Value) && Name == ParameterName)
+			{
+				return FGenericPlatformHttp::UrlDecode(Value);
+			}
+		}
+	}
+	return FString();
+}
+
+TArray<FString> FPlayKitTransportRequest::GetAllHeaders() const
+{
+	TArray<FString> Result;
+	for (const TPair<FString, FString>& Header : Headers)
+	{
+		Result.Add(FString::Printf(TEXT("%s: %s"), *Header.Key, *Header.Value));
+	}
+	return Result;
+}
+
+void FPlayKitTransportRequest::SetContentAsString(const FString& ContentString)
+{
+	const FTCHARToUTF8 Utf8(*ContentString, ContentString.Len());
+	Content.Reset(Utf8.Length());
+	Content.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+}
+
+void FPlayKitTransportRequest::AppendToHeader(const FString& HeaderName, const FString& AdditionalHeaderValue)
+{
+	FString& Value = Headers.FindOrAdd(HeaderName);
+	Value = Value.IsEmpty() ? AdditionalHeaderValue : Value + TEXT(", ") + AdditionalHeaderValue;
+}
+
+const FHttpResponsePtr FPlayKitTransportRequest::GetResponse() const
+{
+	return bResponded ? Response : nullptr;
+}
+
+bool FPlayKitTransportRequest::ProcessRequest()
+{
+	check(IsInGameThread());
+	if (Status == EHttpRequestStatus::Processing)
+	{
+		return false;
+	}
+
+	Status = EHttpRequestStatus::Processing;
+	FailureReason = EHttpFailureReason::None;
+	StartTime = FPlatformTime::Seconds();
+	BytesReceived = 0;
+	bResponded = false;
+	bStopping = false;
+
+	Response = MakeShared<FPlayKitTransportResponse, ESPMode::ThreadSafe>();
+	Response->Url = Url;
+
+	if (!StartRequest())
+	{
+		FinishDeferred(EHttpFailureReason::ConnectionError);
+		return true;
+	}
+
+	if (Timeout.IsSet() && Timeout.GetValue() > 0.0f)
+	{
+		TWeakPtr<IHttpRequest, ESPMode::ThreadSafe> WeakThis = AsShared();
+		const double RequestStartTime = StartTime;
+		FTSTicker::GetCoreTicker().AddTicker(TEXT("PlayKitTransportRequestTimeout"), Timeout.GetValue(), [WeakThis, RequestStartTime](float)
+		{
+			if (TSharedPtr<IHttpRequest, ESPMode::ThreadSafe> Pinned = WeakThis.Pin())
+			{
+				FPlayKitTransportRequest* This = static_cast<FPlayKitTransportRequest*>(Pinned.Get());
+				if (This->IsProcessing() && !This->bStopping && This->StartTime == RequestStartTime)
+				{
+					This->bStopping = true;
+					This->StopRequest();
+					This->Finish(false, EHttpFailureReason::TimedOut);
+				}
+			}
+			return false;
+		});
+	}
+	return true;
+}
+
+void FPlayKitTransportRequest::ProcessRequestUntilComplete()
+{
+	if (ProcessRequest())
+	{
+		while (IsProcessing())
+		{
+			FTSTicker::GetCoreTicker().Tick(0.0f);
+			FPlatformProcess::SleepNoStats(0.0f);
+		}
+	}
+}
+
+void FPlayKitTransportRequest::CancelRequest()
+{
+	check(IsInGameThread());
+	if (IsProcessing() && !bStopping)
+	{
+		bStopping = true;
+		StopRequest();
+		FinishDeferred(EHttpFailureReason::Cancelled);
+	}
+}
+
+void FPlayKitTransportRequest::ReceiveHead(int32 StatusCode, const TMap<FString, FString>& ResponseHeaders)
+{
+	if (!IsProcessing() || bStopping || bResponded)
+	{
+		return;
+	}
+
+	bResponded = true;
+	Response->StatusCode = StatusCode;
+	Response->Headers = ResponseHeaders;
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> This = AsShared();
+	StatusCodeReceivedDelegate.ExecuteIfBound(This, StatusCode);
+	for (const TPair<FString, FString>& Header : ResponseHeaders)
+	{
+		HeaderReceivedDelegate.ExecuteIfBound(This, Header.Key, Header.Value);
+	}
+}
+
+void FPlayKitTransportRequest::ReceiveBody(const uint8* Data, int32 Num)
+{
+	if (!IsProcessing() || bStopping || Num <= 0)
+	{
+		return;
+	}
+
+	BytesReceived += Num;
+	if (ReceiveStream.IsValid())
+	{
+		ReceiveStream->Serialize(const_cast<uint8*>(Data), Num);
+	}
+	else
+	{
+		Response->Content.Append(Data, Num);
+	}
+
+	ProgressDelegate64.ExecuteIfBound(AsShared(), 0, BytesReceived);
+}
+
+void FPlayKitTransportRequest::Finish(bool bSucceeded, EHttpFailureReason Reason)
+{
+	if (!IsProcessing())
+	{
+		return;
+	}
+
+	Status = bSucceeded ? EHttpRequestStatus::Succeeded : EHttpRequestStatus::Failed;
+	FailureReason = Reason;
+	Response->Status = Status;
+	Response->FailureReason = Reason;
+
+	CompleteDelegate.ExecuteIfBound(AsShared(), bSucceeded ? FHttpResponsePtr(Response) : nullptr, bSucceeded);
+}
+
+void FPlayKitTransportRequest::FinishDeferred(EHttpFailureReason Reason)
+{
+	// The ticker holds the request until it has completed
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> This = AsShared();
+	FTSTicker::GetCoreTicker().AddTicker(TEXT("PlayKitTransportRequestFinish"), 0.0f, [This, Reason](float)
+	{
+		static_cast<FPlayKitTransportRequest&>(*This).Finish(false, Reason);
+		return false;
+	});
+}
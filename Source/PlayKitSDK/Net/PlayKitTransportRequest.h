@@ -0,0 +1,122 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Interfaces/IHttpRequest.h"
+
+class FPlayKitTransportResponse;
+
+/**
+ * Base of requests carried by a transport other than FHttpModule.
+ *
+ * Implements the IHttpRequest surface the SDK relies on: configuration, delegates,
+ * receive streams, progress, cancellation and timeouts. A derived transport starts the
+ * exchange in StartRequest() and feeds the reply back with ReceiveHead(), ReceiveBody()
+ * and Finish(). Everything runs on the game thread, whatever the delegate thread policy.
+ */
+class PLAYKITSDK_API FPlayKitTransportRequest : public IHttpRequest
+{
+public:
+	//~ Begin IHttpBase Interface
+	virtual const FString& GetURL() const override { return Url; }
+	virtual FString GetURLParameter(const FString& ParameterName) const override;
+	virtual FString GetHeader(const FString& HeaderName) const override { return Headers.FindRef(HeaderName); }
+	virtual TArray<FString> GetAllHeaders() const override;
+	virtual FString GetContentType() const override { return GetHeader(TEXT("Content-Type")); }
+	virtual uint64 GetContentLength() const override { return Content.Num(); }
+	virtual const TArray<uint8>& GetContent() const override { return Content; }
+	virtual EHttpRequestStatus::Type GetStatus() const override { return Status; }
+	virtual EHttpFailureReason GetFailureReason() const override { return FailureReason; }
+	virtual const FString& GetEffectiveURL() const override { return Url; }
+	//~ End IHttpBase Interface
+
+	//~ Begin IHttpRequest Interface
+	virtual FString GetVerb() const override { return Verb; }
+	virtual void SetVerb(const FString& InVerb) override { Verb = InVerb.ToUpper(); }
+	virtual void SetURL(const FString& InUrl) override { Url = InUrl; }
+	virtual void SetOption(const FName Option, const FString& OptionValue) override { Options.Add(Option, OptionValue); }
+	virtual FString GetOption(const FName Option) const override { return Options.FindRef(Option); }
+	virtual void SetContent(const TArray<uint8>& ContentPayload) override { Content = ContentPayload; }
+	virtual void SetContent(TArray<uint8>&& ContentPayload) override { Content = MoveTemp(ContentPayload); }
+	virtual void SetContentAsString(const FString& ContentString) override;
+	virtual bool SetContentAsStreamedFile(const FString& Filename) override { return false; }
+	virtual bool SetContentFromStream(TSharedRef<FArchive, ESPMode::ThreadSafe> Stream) override { return false; }
+	virtual bool SetResponseBodyReceiveStream(TSharedRef<FArchive> Stream) override
+	{
+		ReceiveStream = Stream;
+		return true;
+	}
+	virtual void SetHeader(const FString& HeaderName, const FString& HeaderValue) override { Headers.Add(HeaderName, HeaderValue); }
+	virtual void AppendToHeader(const FString& HeaderName, const FString& AdditionalHeaderValue) override;
+	virtual void SetTimeout(float InTimeoutSecs) override { Timeout = InTimeoutSecs; }
+	virtual void ClearTimeout() override { Timeout.Reset(); }
+	virtual void ResetTimeoutStatus() override {}
+	virtual TOptional<float> GetTimeout() const override { return Timeout; }
+	virtual void SetActivityTimeout(float InTimeoutSecs) override {}
+	virtual void ProcessRequestUntilComplete() override;
+	virtual bool ProcessRequest() override;
+	virtual FHttpRequestCompleteDelegate& OnProcessRequestComplete() override { return CompleteDelegate; }
+PRAGMA_DISABLE_DEPRECATION_WARNINGS
+	virtual FHttpRequestProgressDelegate& OnRequestProgress() override { return ProgressDelegate; }
+PRAGMA_ENABLE_DEPRECATION_WARNINGS
+	virtual FHttpRequestProgressDelegate64& OnRequestProgress64() override { return ProgressDelegate64; }
+	virtual FHttpRequestWillRetryDelegate& OnRequestWillRetry() override { return WillRetryDelegate; }
+	virtual FHttpRequestHeaderReceivedDelegate& OnHeaderReceived() override { return HeaderReceivedDelegate; }
+	virtual FHttpRequestStatusCodeReceivedDelegate& OnStatusCodeReceived() override { return StatusCodeReceivedDelegate; }
+	virtual void CancelRequest() override;
+	virtual const FHttpResponsePtr GetResponse() const override;
+	virtual void Tick(float DeltaSeconds) override {}
+	virtual float GetElapsedTime() const override { return StartTime > 0.0 ? float(FPlatformTime::Seconds() - StartTime) : 0.0f; }
+	virtual void SetDelegateThreadPolicy(EHttpRequestDelegateThreadPolicy InThreadPolicy) override { ThreadPolicy = InThreadPolicy; }
+	virtual EHttpRequestDelegateThreadPolicy GetDelegateThreadPolicy() const override { return ThreadPolicy; }
+	//~ End IHttpRequest Interface
+
+protected:
+	/** Start the exchange; the request is already Processing. @return false to fail it right away */
+	virtual bool StartRequest() = 0;
+
+	/** Stop the exchange after a cancel or timeout; Finish() follows on the next tick */
+	virtual void StopRequest() {}
+
+	/** Status and headers arrived; body pieces may follow */
+	void ReceiveHead(int32 StatusCode, const TMap<FString, FString>& ResponseHeaders);
+
+	/** A body piece arrived: written to the receive stream or the response content, then reported as progress */
+	void ReceiveBody(const uint8* Data, int32 Num);
+
+	/** Complete the request and call the complete delegate. Ignored once the request is finished. */
+	void Finish(bool bSucceeded, EHttpFailureReason Reason);
+
+	bool IsProcessing() const { return Status == EHttpRequestStatus::Processing; }
+	bool HasResponded() const { return bResponded; }
+
+	FString Verb = TEXT("GET");
+	FString Url;
+	TMap<FString, FString> Headers;
+	TArray<uint8> Content;
+
+private:
+	/** Finish on the next tick, like a cancelled or timed out FHttpModule request */
+	void FinishDeferred(EHttpFailureReason Reason);
+
+	TMap<FName, FString> Options;
+	TOptional<float> Timeout;
+	TSharedPtr<FArchive> ReceiveStream;
+	EHttpRequestDelegateThreadPolicy ThreadPolicy = EHttpRequestDelegateThreadPolicy::CompleteOnGameThread;
+
+	FHttpRequestCompleteDelegate CompleteDelegate;
+	FHttpRequestProgressDelegate ProgressDelegate;
+	FHttpRequestProgressDelegate64 ProgressDelegate64;
+	FHttpRequestWillRetryDelegate WillRetryDelegate;
+	FHttpRequestHeaderReceivedDelegate HeaderReceivedDelegate;
+	FHttpRequestStatusCodeReceivedDelegate StatusCodeReceivedDelegate;
+
+	EHttpRequestStatus::Type Status = EHttpRequestStatus::NotStarted;
+	EHttpFailureReason FailureReason = EHttpFailureReason::None;
+	TSharedPtr<FPlayKitTransportResponse, ESPMode::ThreadSafe> Response;
+	uint64 BytesReceived = 0;
+	double StartTime = 0.0;
+	bool bResponded = false;
+	bool bStopping = false;
+};
@@ -0,0 +1,27 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+/**
+ * Low Level Memory Tracker tags of the SDK.
+ * Run with -llm and use "stat LLM" / "stat LLMFULL" or memreport -full to see them.
+ *
+ * Entry points and HTTP callbacks open a scope with LLM_SCOPE_BYTAG(PlayKit_NPC) etc.,
+ * so everything allocated below them is charged to that area:
+ *   PlayKit/NPC        NPC clients and the AI context manager: history, memories, prompt caches
+ *   PlayKit/Chat       chat client requests and replies
+ *   PlayKit/Image      image requests, Base64 payloads and decoded textures
+ *   PlayKit/Audio      speech-to-text uploads and recordings
+ *   PlayKit/Model3D    3D generation tasks
+ *   PlayKit/Transport  scheduler, response cache, stream buffers filled on the HTTP thread
+ */
+LLM_DECLARE_TAG_API(PlayKit, PLAYKITSDK_API);
+LLM_DECLARE_TAG_API(PlayKit_NPC, PLAYKITSDK_API);
+LLM_DECLARE_TAG_API(PlayKit_Chat, PLAYKITSDK_API);
+LLM_DECLARE_TAG_API(PlayKit_Image, PLAYKITSDK_API);
+LLM_DECLARE_TAG_API(PlayKit_Audio, PLAYKITSDK_API);
+LLM_DECLARE_TAG_API(PlayKit_Model3D, PLAYKITSDK_API);
+LLM_DECLARE_TAG_API(PlayKit_Transport, PLAYKITSDK_API);
@@ -44,6 +44,8 @@ public class PlayKitSDK : ModuleRules
 			{
 				"Slate",
 				"SlateCore",
+				"ImageCore",
+				"WebSockets",
 			}
 			);
 
@@ -1,18 +1,49 @@
 // Copyright PlayKit. All Rights Reserved.
 
 #include "PlayKitSDK.h"
+#include "PlayKitMemory.h"
+#include "Auth/PlayKitCredentials.h"
+#include "Net/PlayKitGameThreadQueue.h"
+#include "Net/PlayKitStreamChunkDispatcher.h"
+#include "Net/PlayKitTransport.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#if WITH_DEV_AUTOMATION_TESTS
+#include "Tests/PlayKitBenchmark.h"
+#endif
 
 #define LOCTEXT_NAMESPACE "FPlayKitSDKModule"
 
+LLM_DEFINE_TAG(PlayKit);
+LLM_DEFINE_TAG(PlayKit_NPC);
+LLM_DEFINE_TAG(PlayKit_Chat);
+LLM_DEFINE_TAG(PlayKit_Image);
+LLM_DEFINE_TAG(PlayKit_Audio);
+LLM_DEFINE_TAG(PlayKit_Model3D);
+LLM_DEFINE_TAG(PlayKit_Transport);
+
 void FPlayKitSDKModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
+#if WITH_DEV_AUTOMATION_TESTS
+	if (FParse::Param(FCommandLine::Get(), TEXT("PlayKitBenchmarkAllocs")))
+	{
+		PlayKitBenchmark::InstallAllocationCounter();
+	}
+#endif
+	FPlayKitGameThreadQueue::Startup();
+	FPlayKitStreamChunkDispatcher::Startup();
+	FPlayKitCredentials::Startup();
 }
 
 void FPlayKitSDKModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module. For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	FPlayKitCredentials::Shutdown();
+	FPlayKitTransport::Shutdown();
+	FPlayKitStreamChunkDispatcher::Shutdown();
+	FPlayKitGameThreadQueue::Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -1,6 +1,7 @@
 // Copyright PlayKit. All Rights Reserved.
 
 #include "PlayKitSettings.h"
+#include "Auth/PlayKitCredentials.h"
 #include "Misc/ConfigCacheIni.h"
 
 #if WITH_EDITOR
@@ -50,13 +51,7 @@ bool UPlayKitSettings::HasDeveloperToken() const
 
 FString UPlayKitSettings::GetDeveloperToken() const
 {
-#if WITH_EDITOR
-	FString Token;
-	GConfig->GetString(TEXT("PlayKit"), *DeveloperTokenKey, Token, GEditorPerProjectIni);
-	return Token;
-#else
-	return FString();
-#endif
+	return FPlayKitCredentials::GetDeveloperToken();
 }
 
 void UPlayKitSettings::SetDeveloperToken(const FString& Token)
@@ -64,6 +59,7 @@ void UPlayKitSettings::SetDeveloperToken(const FString& Token)
 #if WITH_EDITOR
 	GConfig->SetString(TEXT("PlayKit"), *DeveloperTokenKey, *Token, GEditorPerProjectIni);
 	GConfig->Flush(false, GEditorPerProjectIni);
+	FPlayKitCredentials::SetDeveloperToken(Token);
 
 	DeveloperTokenStatus = Token.IsEmpty() ? TEXT("Not logged in") : TEXT("Logged in");
 
@@ -79,15 +75,14 @@ void UPlayKitSettings::ClearDeveloperToken()
 
 FString UPlayKitSettings::GetPlayerToken() const
 {
-	FString Token;
-	GConfig->GetString(TEXT("PlayKit"), *PlayerTokenKey, Token, GGameUserSettingsIni);
-	return Token;
+	return FPlayKitCredentials::GetPlayerToken();
 }
 
 void UPlayKitSettings::SetPlayerToken(const FString& Token)
 {
 	GConfig->SetString(TEXT("PlayKit"), *PlayerTokenKey, *Token, GGameUserSettingsIni);
 	GConfig->Flush(false, GGameUserSettingsIni);
+	FPlayKitCredentials::SetPlayerToken(Token);
 
 	UE_LOG(LogTemp, Log, TEXT("[PlayKitSettings] Player token updated"));
 }
@@ -97,6 +92,16 @@ void UPlayKitSettings::ClearPlayerToken()
 	SetPlayerToken(FString());
 }
 
+void UPlayKitSettings::ReadStoredTokens(FString& OutDeveloperToken, FString& OutPlayerToken) const
+{
+	OutDeveloperToken.Empty();
+#if WITH_EDITOR
+	GConfig->GetString(TEXT("PlayKit"), *DeveloperTokenKey, OutDeveloperToken, GEditorPerProjectIni);
+#endif
+	OutPlayerToken.Empty();
+	GConfig->GetString(TEXT("PlayKit"), *PlayerTokenKey, OutPlayerToken, GGameUserSettingsIni);
+}
+
 void UPlayKitSettings::SaveSettings()
 {
 	TryUpdateDefaultConfigFile();
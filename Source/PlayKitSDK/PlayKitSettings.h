@@ -67,6 +67,132 @@ public:
 	UPROPERTY(config, EditAnywhere, Category="Context Management", meta=(DisplayName="Auto Compact Min Messages", ClampMin="5", ClampMax="100"))
 	int32 AutoCompactMinMessages = 10;
 
+	//========== Networking ==========//
+
+	/** Maximum chat/NPC requests in flight per game instance */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Max Concurrent Chat Requests", ClampMin="1", ClampMax="64"))
+	int32 MaxConcurrentChatRequests = 8;
+
+	/** Chat slots that only player dialogue may use, so ambient traffic cannot block the player */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Reserved Dialogue Chat Slots", ClampMin="0", ClampMax="16"))
+	int32 ReservedDialogueChatSlots = 2;
+
+	/** Maximum image generation requests in flight per game instance */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Max Concurrent Image Requests", ClampMin="1", ClampMax="16"))
+	int32 MaxConcurrentImageRequests = 2;
+
+	/** Maximum transcription requests in flight per game instance */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Max Concurrent Transcription Requests", ClampMin="1", ClampMax="16"))
+	int32 MaxConcurrentTranscriptionRequests = 2;
+
+	/** Maximum 3D generation requests (create and poll) in flight per game instance */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Max Concurrent 3D Requests", ClampMin="1", ClampMax="16"))
+	int32 MaxConcurrent3DRequests = 2;
+
+	/** Chat/NPC requests sent per minute, across all game instances (0 = no local limit until the server reports one) */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Chat Requests Per Minute", ClampMin="0"))
+	int32 ChatRequestsPerMinute = 0;
+
+	/** Image generation requests sent per minute (0 = no local limit until the server reports one) */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Image Requests Per Minute", ClampMin="0"))
+	int32 ImageRequestsPerMinute = 0;
+
+	/** Transcription requests sent per minute (0 = no local limit until the server reports one) */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Transcription Requests Per Minute", ClampMin="0"))
+	int32 TranscriptionRequestsPerMinute = 0;
+
+	/** 3D generation requests (create and poll) sent per minute (0 = no local limit until the server reports one) */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="3D Requests Per Minute", ClampMin="0"))
+	int32 Model3DRequestsPerMinute = 0;
+
+	/** Requests of one endpoint that may be sent back to back before the per-minute rate applies */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Rate Limit Burst", ClampMin="1", ClampMax="64"))
+	int32 RateLimitBurst = 4;
+
+	/** Follow the server's rate limit: slow down on 429 replies and pace requests by its RateLimit-Remaining/Reset headers */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Adapt Rate Limits"))
+	bool bAdaptRateLimits = true;
+
+	/** Carry chat requests over one persistent WebSocket session instead of a request each (needs server support) */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Use Session Transport (Experimental)"))
+	bool bUseSessionTransport = false;
+
+	/** ws:// or wss:// session endpoint (leave empty to derive it from the base URL) */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Session URL", EditCondition="bUseSessionTransport"))
+	FString SessionUrl;
+
+	/** Send requests that failed with a connection error, 408, 429 or 5xx again, with jittered backoff */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Enable Retries"))
+	bool bEnableRetries = true;
+
+	/** Retries of one request after its first attempt */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Max Retries", ClampMin="0", ClampMax="10", EditCondition="bEnableRetries"))
+	int32 MaxRetries = 3;
+
+	/** Longest wait in seconds before the first retry; doubles per retry up to Retry Max Delay */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Retry Base Delay", ClampMin="0.0", EditCondition="bEnableRetries"))
+	float RetryBaseDelay = 0.5f;
+
+	/** Longest wait in seconds before any retry */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Retry Max Delay", ClampMin="0.0", EditCondition="bEnableRetries"))
+	float RetryMaxDelay = 20.0f;
+
+	/** Retries an endpoint earns per request sent; bounds the extra load retries add during an outage */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Retry Budget Ratio", ClampMin="0.0", ClampMax="1.0", EditCondition="bEnableRetries"))
+	float RetryBudgetRatio = 0.2f;
+
+	/** Failed attempts in a row after which an endpoint fails requests without sending them (0 disables the breaker) */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Circuit Breaker Threshold", ClampMin="0", ClampMax="100"))
+	int32 CircuitBreakerThreshold = 5;
+
+	/** Seconds a tripped endpoint fails fast before it probes the backend again */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Circuit Breaker Cooldown", ClampMin="1.0"))
+	float CircuitBreakerCooldown = 15.0f;
+
+	/** Seconds a chat request may wait for the first byte of its reply (0 = no limit) */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Chat First Byte Timeout", ClampMin="0.0"))
+	float ChatFirstByteTimeout = 30.0f;
+
+	/** Seconds a chat reply may go without new bytes once it has started; catches streams that stall mid-sentence (0 = no limit) */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Chat Stream Idle Timeout", ClampMin="0.0"))
+	float ChatStreamIdleTimeout = 15.0f;
+
+	/** Seconds a chat request may take in total, retries included (0 = no limit) */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Chat Total Timeout", ClampMin="0.0"))
+	float ChatTotalTimeout = 120.0f;
+
+	/** Seconds an image, transcription or 3D request may take in total, retries included (0 = no limit) */
+	UPROPERTY(config, EditAnywhere, Category="Networking", meta=(DisplayName="Media Total Timeout", ClampMin="0.0"))
+	float MediaTotalTimeout = 300.0f;
+
+	//========== Streaming ==========//
+
+	/** Game thread time per frame for broadcasting merged stream chunks (components using Per Frame delivery). Chunks over budget wait for the next frame. */
+	UPROPERTY(config, EditAnywhere, Category="Streaming", meta=(DisplayName="Chunk Delivery Budget (ms)", ClampMin="0.05", ClampMax="16.0"))
+	float StreamChunkBudgetMs = 0.5f;
+
+	/** Most merged stream chunks broadcast per frame, across all PlayKit components */
+	UPROPERTY(config, EditAnywhere, Category="Streaming", meta=(DisplayName="Max Chunk Broadcasts Per Frame", ClampMin="1", ClampMax="1024"))
+	int32 MaxStreamChunkBroadcastsPerFrame = 16;
+
+	//========== Response Cache ==========//
+
+	/** Number of cached responses kept in memory */
+	UPROPERTY(config, EditAnywhere, Category="Response Cache", meta=(DisplayName="Memory Entries", ClampMin="1", ClampMax="65536"))
+	int32 ResponseCacheMemoryEntries = 256;
+
+	/** Also keep cached responses on disk (Saved/PlayKit/ResponseCache) */
+	UPROPERTY(config, EditAnywhere, Category="Response Cache", meta=(DisplayName="Enable Disk Cache"))
+	bool bEnableResponseDiskCache = true;
+
+	/** Seconds a cached response stays valid (0 = never expires) */
+	UPROPERTY(config, EditAnywhere, Category="Response Cache", meta=(DisplayName="Time To Live", ClampMin="0"))
+	int32 ResponseCacheTTLSeconds = 86400;
+
+	/** Disk space the cache may use; expired and then the oldest entries are deleted at startup to stay below it (0 = no limit) */
+	UPROPERTY(config, EditAnywhere, Category="Response Cache", meta=(DisplayName="Disk Budget (MB)", ClampMin="0"))
+	int32 ResponseCacheDiskBudgetMB = 64;
+
 	//========== Advanced ==========//
 
 	/** Override the default API base URL (leave empty to use default: https://api.playkit.ai) */
@@ -95,7 +221,7 @@ public:
 	UFUNCTION(BlueprintPure, Category="PlayKit")
 	bool HasDeveloperToken() const;
 
-	/** Get the stored developer token */
+	/** Get the stored developer token (served from memory by FPlayKitCredentials) */
 	FString GetDeveloperToken() const;
 
 	/** Set the developer token (stored locally) */
@@ -104,7 +230,7 @@ public:
 	/** Clear the developer token */
 	void ClearDeveloperToken();
 
-	/** Get the stored player token */
+	/** Get the stored player token (served from memory by FPlayKitCredentials) */
 	FString GetPlayerToken() const;
 
 	/** Set the player token (stored locally) */
@@ -113,6 +239,9 @@ public:
 	/** Clear the player token */
 	void ClearPlayerToken();
 
+	/** Read both tokens from their ini files; done once at startup by FPlayKitCredentials */
+	void ReadStoredTokens(FString& OutDeveloperToken, FString& OutPlayerToken) const;
+
 	/** Save Config */
 	UFUNCTION(CallInEditor)
 	void SaveSettings();
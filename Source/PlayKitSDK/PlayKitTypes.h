@@ -7,6 +7,18 @@
 
 //========== Chat Types ==========//
 
+/**
+ * How stream chunks reach OnStreamChunk
+ */
+UENUM(BlueprintType)
+enum class EPlayKitChunkDelivery : uint8
+{
+	/** One broadcast per text delta, as soon as it is decoded */
+	Immediate UMETA(DisplayName = "Immediate"),
+	/** Deltas are merged and broadcast at most once per frame per stream, within the SDK's per-frame streaming budget */
+	PerFrame UMETA(DisplayName = "Per Frame")
+};
+
 /**
  * Chat message for conversations
  */
@@ -84,6 +96,10 @@ struct PLAYKITSDK_API FPlayKitChatResponse
 
 	UPROPERTY(BlueprintReadOnly, Category="PlayKit")
 	int32 TotalTokens = 0;
+
+	/** Handle of the request that produced this response (-1 if the request was never started) */
+	UPROPERTY(BlueprintReadOnly, Category="PlayKit")
+	int32 RequestId = INDEX_NONE;
 };
 
 /**
@@ -272,6 +288,12 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnChatStreamChunk, const FString&,
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnChatStreamComplete, const FString&, FullContent);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnChatError, const FString&, ErrorCode, const FString&, ErrorMessage);
 
+// Per-request chat delegates (carry the handle returned by the Generate* calls)
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnChatRequestResponse, int32, RequestId, FPlayKitChatResponse, Response);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnChatRequestStreamChunk, int32, RequestId, const FString&, Chunk);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnChatRequestStreamComplete, int32, RequestId, const FString&, FullContent);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnChatRequestError, int32, RequestId, const FString&, ErrorCode, const FString&, ErrorMessage);
+
 // Image delegates
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnImageGenerated, FPlayKitGeneratedImage, Image);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnImagesGenerated, const TArray<FPlayKitGeneratedImage>&, Images);
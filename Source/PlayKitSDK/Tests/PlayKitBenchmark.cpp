@@ -0,0 +1,195 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitBenchmark.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Net/PlayKitJsonWriter.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformProperties.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace PlayKitBenchmark
+{
+	/** Counts of the current thread; only threads inside Measure() count */
+	struct FThreadAllocations
+	{
+		bool bCounting = false;
+		int64 Allocations = 0;
+		int64 Bytes = 0;
+	};
+
+	static thread_local FThreadAllocations ThreadAllocations;
+
+	/** Forwards to the allocator it wraps and counts calls on threads that asked for it */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInner)
+			: Inner(InInner)
+		{
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			Track(Count);
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			Track(Count);
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("PlayKitCountingMalloc"); }
+
+	private:
+		static void Track(SIZE_T Count)
+		{
+			FThreadAllocations& Counts = ThreadAllocations;
+			if (Counts.bCounting)
+			{
+				++Counts.Allocations;
+				Counts.Bytes += Count;
+			}
+		}
+
+		FMalloc* Inner;
+	};
+
+	static bool bAllocationCounterInstalled = false;
+
+	void InstallAllocationCounter()
+	{
+		if (!bAllocationCounterInstalled && GMalloc)
+		{
+			// Never removed or destroyed: blocks allocated through it are freed through it until exit
+			GMalloc = new FCountingMalloc(GMalloc);
+			bAllocationCounterInstalled = true;
+			UE_LOG(LogTemp, Log, TEXT("[PlayKit] Benchmark allocation counter installed"));
+		}
+	}
+
+	bool IsCountingAllocations()
+	{
+		return bAllocationCounterInstalled;
+	}
+
+	FResult Measure(const FString& Name, int32 Iterations, TFunctionRef<void()> Body)
+	{
+		check(Iterations > 0);
+
+		// Warm up so one-time growth of static buffers is not counted
+		Body();
+
+		FThreadAllocations& Counts = ThreadAllocations;
+		Counts.Allocations = 0;
+		Counts.Bytes = 0;
+		Counts.bCounting = bAllocationCounterInstalled;
+
+		const double Start = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < Iterations; ++Index)
+		{
+			Body();
+		}
+		const double Elapsed = FPlatformTime::Seconds() - Start;
+		Counts.bCounting = false;
+
+		FResult Result;
+		Result.Name = Name;
+		Result.Iterations = Iterations;
+		Result.NanosecondsPerOp = Elapsed * 1.0e9 / Iterations;
+		Result.bCountedAllocations = bAllocationCounterInstalled;
+		Result.AllocationsPerOp = double(Counts.Allocations) / Iterations;
+		Result.BytesPerOp = double(Counts.Bytes) / Iterations;
+		return Result;
+	}
+
+	FReport::FReport(FAutomationTestBase& InTest, const FString& InSuite)
+		: Test(InTest)
+		, Suite(InSuite)
+	{
+	}
+
+	const FResult& FReport::Run(const FString& Name, int32 Iterations, TFunctionRef<void()> Body)
+	{
+		const FResult& Result = Results.Add_GetRef(Measure(Name, Iterations, Body));
+		if (Result.bCountedAllocations)
+		{
+			Test.AddInfo(FString::Printf(TEXT("%-40s %12.0f ns/op %10.1f allocs/op %12.0f bytes/op"),
+				*Result.Name, Result.NanosecondsPerOp, Result.AllocationsPerOp, Result.BytesPerOp));
+		}
+		else
+		{
+			Test.AddInfo(FString::Printf(TEXT("%-40s %12.0f ns/op (allocations not counted, run with -PlayKitBenchmarkAllocs)"),
+				*Result.Name, Result.NanosecondsPerOp));
+		}
+		return Result;
+	}
+
+	FString FReport::GetFilePath() const
+	{
+		FString Directory;
+		if (!FParse::Value(FCommandLine::Get(), TEXT("PlayKitBenchmarkDir="), Directory))
+		{
+			Directory = FPaths::ProjectSavedDir() / TEXT("PlayKit/Benchmarks");
+		}
+		return Directory / (Suite + TEXT(".json"));
+	}
+
+	bool FReport::Save() const
+	{
+		TArray<uint8> Json;
+		FPlayKitJsonWriter Writer(Json);
+		Writer.BeginObject();
+		Writer.WriteString("suite", Suite);
+		Writer.WriteString("engine", FEngineVersion::Current().ToString());
+		Writer.WriteString("platform", ANSI_TO_TCHAR(FPlatformProperties::IniPlatformName()));
+		Writer.WriteString("configuration", LexToString(FApp::GetBuildConfiguration()));
+		Writer.WriteString("timestamp", FDateTime::UtcNow().ToIso8601());
+		Writer.BeginArray("results");
+		for (const FResult& Result : Results)
+		{
+			Writer.BeginObject();
+			Writer.WriteString("name", Result.Name);
+			Writer.WriteNumber("iterations", Result.Iterations);
+			Writer.WriteNumber("ns_per_op", Result.NanosecondsPerOp);
+			if (Result.bCountedAllocations)
+			{
+				Writer.WriteNumber("allocs_per_op", Result.AllocationsPerOp);
+				Writer.WriteNumber("bytes_per_op", Result.BytesPerOp);
+			}
+			Writer.EndObject();
+		}
+		Writer.EndArray();
+		Writer.EndObject();
+
+		const FString FilePath = GetFilePath();
+		if (!FFileHelper::SaveArrayToFile(Json, *FilePath))
+		{
+			Test.AddWarning(FString::Printf(TEXT("Could not write benchmark results to %s"), *FilePath));
+			return false;
+		}
+
+		Test.AddInfo(FString::Printf(TEXT("Benchmark results written to %s"), *FilePath));
+		return true;
+	}
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,66 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace PlayKitBenchmark
+{
+	struct FResult
+	{
+		FString Name;
+		int32 Iterations = 0;
+		double NanosecondsPerOp = 0.0;
+
+		/** Set when the allocation counter is installed; the per-op counts are 0 otherwise */
+		bool bCountedAllocations = false;
+		double AllocationsPerOp = 0.0;
+		double BytesPerOp = 0.0;
+	};
+
+	/**
+	 * Wrap GMalloc in a proxy that counts the allocations of threads inside Measure().
+	 * Called once at module startup when the command line has -PlayKitBenchmarkAllocs;
+	 * the proxy stays installed until exit, so it is never swapped under a running thread.
+	 */
+	void InstallAllocationCounter();
+
+	bool IsCountingAllocations();
+
+	/**
+	 * Run Body once to warm up, then Iterations times, and measure time per call. With the
+	 * allocation counter installed, also the allocations and bytes of the calling thread.
+	 */
+	FResult Measure(const FString& Name, int32 Iterations, TFunctionRef<void()> Body);
+
+	/**
+	 * Results of one benchmark suite.
+	 *
+	 * Every measurement is logged on the running test. Save() writes the suite as JSON to
+	 * Saved/PlayKit/Benchmarks/<Suite>.json (or the directory given with -PlayKitBenchmarkDir=)
+	 * so runs can be diffed across SDK updates.
+	 */
+	class FReport
+	{
+	public:
+		FReport(FAutomationTestBase& InTest, const FString& InSuite);
+
+		/** Measure and record one case */
+		const FResult& Run(const FString& Name, int32 Iterations, TFunctionRef<void()> Body);
+
+		/** Write all recorded results. @return false if the file could not be written */
+		bool Save() const;
+
+		FString GetFilePath() const;
+
+	private:
+		FAutomationTestBase& Test;
+		FString Suite;
+		TArray<FResult> Results;
+	};
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
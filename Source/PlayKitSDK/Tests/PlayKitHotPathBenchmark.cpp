@@ -0,0 +1,348 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "PlayKitBenchmark.h"
+#include "Auth/PlayKitAuthSubsystem.h"
+#include "Auth/PlayKitCredentials.h"
+#include "Client/PlayKit3DClient.h"
+#include "Client/PlayKitChatClient.h"
+#include "Client/PlayKitImageClient.h"
+#include "Client/PlayKitSTTClient.h"
+#include "NPC/PlayKitNPCActionsModule.h"
+#include "NPC/PlayKitNPCClient.h"
+#include "Net/PlayKitSSEDecoder.h"
+#include "Engine/Texture2D.h"
+#include "ImageUtils.h"
+#include "HAL/FileManager.h"
+#include "Misc/Base64.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+/**
+ * Fixed-corpus benchmarks of the SDK's hot paths. Every suite writes
+ * Saved/PlayKit/Benchmarks/<Suite>.json; the corpora and iteration counts must
+ * stay unchanged so results remain comparable between SDK versions.
+ */
+namespace PlayKitHotPathBenchmark
+{
+	/** 2000 events in the UI message stream format, as one response body */
+	TArray<uint8> MakeStreamCorpus()
+	{
+		FString Stream;
+		Stream += TEXT("data: {\"type\":\"start\",\"messageId\":\"msg_1\"}\n\n");
+		for (int32 Index = 0; Index < 2000; ++Index)
+		{
+			Stream += FString::Printf(TEXT("data: {\"type\":\"text-delta\",\"id\":\"0\",\"delta\":\"word%d \\\"q\\\" caf\u00E9 \"}\n\n"), Index);
+		}
+		Stream += TEXT("data: {\"type\":\"finish\"}\n\ndata: [DONE]\n\n");
+
+		FTCHARToUTF8 Converter(*Stream, Stream.Len());
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+	}
+
+	FString MakeCompletionCorpus()
+	{
+		FString Content;
+		for (int32 Index = 0; Index < 40; ++Index)
+		{
+			Content += FString::Printf(TEXT("Line %d of the answer, with \\\"quotes\\\" and caf\\u00e9.\\n"), Index);
+		}
+		return FString::Printf(TEXT("{\"id\":\"chatcmpl-1\",\"object\":\"chat.completion\",\"created\":1700000000,\"model\":\"default-chat\",")
+			TEXT("\"choices\":[{\"index\":0,\"message\":{\"role\":\"assistant\",\"content\":\"%s\",\"tool_calls\":[")
+			TEXT("{\"id\":\"call_1\",\"type\":\"function\",\"function\":{\"name\":\"open_door\",\"arguments\":\"{\\\"door\\\":\\\"north\\\",\\\"force\\\":2}\"}},")
+			TEXT("{\"id\":\"call_2\",\"type\":\"function\",\"function\":{\"name\":\"give_item\",\"arguments\":\"{\\\"item\\\":\\\"sword\\\",\\\"count\\\":1}\"}}]},")
+			TEXT("\"finish_reason\":\"tool_calls\"}],\"usage\":{\"prompt_tokens\":812,\"completion_tokens\":344,\"total_tokens\":1156}}"), *Content);
+	}
+
+	TArray<FNPCMessage> MakeHistory(int32 NumMessages)
+	{
+		TArray<FNPCMessage> History;
+		for (int32 Index = 0; Index < NumMessages; ++Index)
+		{
+			const bool bUser = (Index % 2) == 0;
+			History.Emplace(bUser ? TEXT("user") : TEXT("assistant"), FString::Printf(
+				TEXT("Message %d: \"Can you fix this sword?\"\nThe blade is chipped \u2014 caf\u00E9 quality steel, nothing special."), Index));
+		}
+		return History;
+	}
+
+	/** A 256x256 gradient PNG, Base64 encoded like the image endpoint returns it */
+	FString MakeImageCorpus()
+	{
+		constexpr int32 Size = 256;
+		TArray<FColor> Pixels;
+		Pixels.SetNumUninitialized(Size * Size);
+		for (int32 Y = 0; Y < Size; ++Y)
+		{
+			for (int32 X = 0; X < Size; ++X)
+			{
+				Pixels[Y * Size + X] = FColor(uint8(X), uint8(Y), uint8((X * Y) >> 8), 255);
+			}
+		}
+
+		TArray64<uint8> Png;
+		FImageUtils::PNGCompressImageArray(Size, Size, Pixels, Png);
+		return FBase64::Encode(Png.GetData(), static_cast<uint32>(Png.Num()));
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitSSEBenchmark, "PlayKit.Benchmark.SSEDecode",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPlayKitSSEBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace PlayKitHotPathBenchmark;
+
+	PlayKitBenchmark::FReport Report(*this, TEXT("SSEDecode"));
+	const TArray<uint8> Stream = MakeStreamCorpus();
+
+	// Whole stream in network-sized reads, text deltas accumulated like the chat client does
+	FPlayKitSSEDecoder Decoder;
+	FString Accumulated;
+	int32 NumDeltas = 0;
+	Report.Run(TEXT("SSE.Stream.2000Events.1KBReads"), 50, [&]()
+	{
+		Decoder.Reset();
+		Accumulated.Reset();
+		NumDeltas = 0;
+		for (int32 Offset = 0; Offset < Stream.Num(); Offset += 1024)
+		{
+			Decoder.Feed(Stream.GetData() + Offset, FMath::Min(1024, Stream.Num() - Offset), [&](FUtf8StringView Data)
+			{
+				FString Delta;
+				if (FPlayKitSSEDecoder::TryGetTextDelta(Data, Delta))
+				{
+					Accumulated += Delta;
+					++NumDeltas;
+				}
+			});
+		}
+		Decoder.Flush([](FUtf8StringView) {});
+	});
+	TestEqual(TEXT("Every text delta decoded"), NumDeltas, 2000);
+
+	FString Delta;
+	Report.Run(TEXT("SSE.TryGetTextDelta.OpenAIChunk"), 100000, [&]()
+	{
+		FPlayKitSSEDecoder::TryGetTextDelta(UTF8TEXTVIEW("{\"id\":\"c1\",\"choices\":[{\"index\":0,\"delta\":{\"role\":\"assistant\",\"content\":\"Hello there\"},\"finish_reason\":null}]}"), Delta);
+	});
+
+	Report.Save();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitRequestBuilderBenchmark, "PlayKit.Benchmark.RequestBuilders",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPlayKitRequestBuilderBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace PlayKitHotPathBenchmark;
+
+	PlayKitBenchmark::FReport Report(*this, TEXT("RequestBuilders"));
+	const TArray<FNPCMessage> History = MakeHistory(100);
+
+	FPlayKitChatConfig ChatConfig;
+	ChatConfig.Temperature = 0.7f;
+	ChatConfig.MaxTokens = 512;
+	ChatConfig.Messages.Add(FPlayKitChatMessage(TEXT("system"), TEXT("You are a gruff blacksmith in a frontier town. Keep answers short.")));
+	for (const FNPCMessage& Message : History)
+	{
+		ChatConfig.Messages.Add(FPlayKitChatMessage(Message.Role, Message.Content));
+	}
+
+	// A fresh buffer per request, like the clients (the buffer is moved into the HTTP request)
+	Report.Run(TEXT("Chat.100Messages"), 2000, [&]()
+	{
+		TArray<uint8> Body;
+		UPlayKitChatClient::BuildChatRequestBody(TEXT("default-chat"), ChatConfig, true, Body);
+	});
+
+	Report.Run(TEXT("Structured.Schema"), 10000, [&]()
+	{
+		TArray<uint8> Body;
+		UPlayKitChatClient::BuildStructuredRequestBody(TEXT("default-chat"), TEXT("Extract the quest."), TEXT("The blacksmith asks you to find 3 iron ores in the northern mine."),
+			TEXT("{\"type\":\"object\",\"properties\":{\"title\":{\"type\":\"string\"},\"count\":{\"type\":\"integer\"}},\"required\":[\"title\",\"count\"]}"), 0.2f, Body);
+	});
+
+	Report.Run(TEXT("NPC.100Messages"), 2000, [&]()
+	{
+		TArray<uint8> Body;
+		UPlayKitNPCClient::BuildChatRequestBody(TEXT("default-chat"), TEXT("You are a guard at the north gate."), History, TEXT("Open the gate"), 0.7f, true, Body);
+	});
+
+	FPlayKitImageOptions ImageOptions;
+	ImageOptions.Size = TEXT("1024x1024");
+	ImageOptions.Count = 2;
+	ImageOptions.Seed = 42;
+	Report.Run(TEXT("Image.Generate"), 20000, [&]()
+	{
+		TArray<uint8> Body;
+		UPlayKitImageClient::BuildRequestBody(TEXT("default-image"), TEXT("A rusty sword on an anvil, soft forge light, painterly"), ImageOptions, Body);
+	});
+
+	FPlayKit3DConfig ModelConfig;
+	ModelConfig.Prompt = TEXT("A rusty sword with a leather-wrapped grip");
+	ModelConfig.NegativePrompt = TEXT("blurry, low poly");
+	ModelConfig.TextureSeed = 7;
+	ModelConfig.FaceLimit = 20000;
+	Report.Run(TEXT("3D.CreateTask"), 20000, [&]()
+	{
+		TArray<uint8> Body;
+		UPlayKit3DClient::BuildCreateTaskBody(TEXT("default-3d"), ModelConfig, Body);
+	});
+
+	Report.Save();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitResponseParserBenchmark, "PlayKit.Benchmark.ResponseParsing",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPlayKitResponseParserBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace PlayKitHotPathBenchmark;
+
+	PlayKitBenchmark::FReport Report(*this, TEXT("ResponseParsing"));
+
+	const FString Completion = MakeCompletionCorpus();
+	FTCHARToUTF8 CompletionUtf8(*Completion, Completion.Len());
+	const FUtf8StringView CompletionView(reinterpret_cast<const UTF8CHAR*>(CompletionUtf8.Get()), CompletionUtf8.Length());
+
+	FPlayKitChatResponse Response;
+	Report.Run(TEXT("Chat.ParseChatResponse"), 10000, [&]() { Response = UPlayKitChatClient::ParseChatResponse(CompletionView); });
+	TestEqual(TEXT("Tool calls parsed"), Response.ToolCalls.Num(), 2);
+
+	const FString PredictionsJson = TEXT("Here are some options:\n```json\n[\"Can you fix my sword?\", \"How much for a new blade?\", \"Where do you get your \\\"iron\\\"?\", \"Goodbye.\"]\n```");
+	TArray<FString> Predictions;
+	Report.Run(TEXT("NPC.ParsePredictionsFromJson"), 50000, [&]() { Predictions = UPlayKitNPCClient::ParsePredictionsFromJson(PredictionsJson); });
+	TestEqual(TEXT("JSON predictions"), Predictions.Num(), 4);
+
+	const FString PredictionsText = TEXT("1. Can you fix my sword?\n2. How much for a new blade?\n- \"Where do you get your iron?\",\n3. Goodbye.\n");
+	Report.Run(TEXT("NPC.ExtractPredictionsFromText"), 50000, [&]() { Predictions = UPlayKitNPCClient::ExtractPredictionsFromText(PredictionsText, 4); });
+	TestEqual(TEXT("Text predictions"), Predictions.Num(), 4);
+
+	Report.Save();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitActionsSchemaBenchmark, "PlayKit.Benchmark.ActionsSchema",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPlayKitActionsSchemaBenchmark::RunTest(const FString& Parameters)
+{
+	PlayKitBenchmark::FReport Report(*this, TEXT("ActionsSchema"));
+
+	UPlayKitNPCActionsModule* Actions = NewObject<UPlayKitNPCActionsModule>(GetTransientPackage());
+	for (int32 Index = 0; Index < 8; ++Index)
+	{
+		FNPCAction Action;
+		Action.SetName(FString::Printf(TEXT("action_%d"), Index))
+			.SetDescription(TEXT("Perform a scripted interaction with an object or character nearby."))
+			.AddStringParam(TEXT("target"), TEXT("Name of the target"))
+			.AddNumberParam(TEXT("amount"), TEXT("How much to use"), false)
+			.AddBoolParam(TEXT("quietly"), TEXT("Avoid drawing attention"), false)
+			.AddEnumParam(TEXT("mood"), TEXT("Delivery"), { TEXT("calm"), TEXT("angry"), TEXT("afraid") });
+		Actions->RegisterAction(Action, FOnActionExecute());
+	}
+
+	FString Schema;
+	Report.Run(TEXT("Actions.GetActionsAsJsonSchema.8Actions"), 5000, [&]() { Schema = Actions->GetActionsAsJsonSchema(); });
+	TestTrue(TEXT("Schema lists the actions"), Schema.Contains(TEXT("action_7")));
+
+	Report.Save();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitImageDecodeBenchmark, "PlayKit.Benchmark.Base64ToTexture2D",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPlayKitImageDecodeBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace PlayKitHotPathBenchmark;
+
+	PlayKitBenchmark::FReport Report(*this, TEXT("Base64ToTexture2D"));
+
+	const FString Base64 = MakeImageCorpus();
+	UTexture2D* Texture = nullptr;
+	Report.Run(TEXT("Image.Base64ToTexture2D.256x256Png"), 50, [&]() { Texture = UPlayKitImageClient::Base64ToTexture2D(Base64); });
+	if (TestNotNull(TEXT("Texture created"), Texture))
+	{
+		TestEqual(TEXT("Texture width"), Texture->GetSizeX(), 256);
+	}
+
+	Report.Save();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitMultipartBenchmark, "PlayKit.Benchmark.STTMultipart",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPlayKitMultipartBenchmark::RunTest(const FString& Parameters)
+{
+	PlayKitBenchmark::FReport Report(*this, TEXT("STTMultipart"));
+
+	// One second of 16 kHz, 16-bit mono audio
+	TArray<uint8> Audio;
+	Audio.SetNumUninitialized(32000);
+	for (int32 Index = 0; Index < Audio.Num(); ++Index)
+	{
+		Audio[Index] = static_cast<uint8>(Index * 31);
+	}
+
+	const FString Boundary = TEXT("----PlayKitBoundary123456");
+	const FString FileName = TEXT("r\u00E9plique.wav");
+	TArray<uint8> Body;
+	Report.Run(TEXT("STT.BuildMultipartBody.1sWav"), 5000, [&]()
+	{
+		UPlayKitSTTClient::BuildMultipartBody(Boundary, TEXT("default-transcription-model"), TEXT("fr"), Audio, FileName, Body);
+	});
+
+	// Non-ASCII field values are longer in UTF-8 than in TCHARs; the closing boundary must still be complete
+	const FString Closing = FString::Printf(TEXT("--%s--\r\n"), *Boundary);
+	const bool bClosed = Body.Num() >= Closing.Len()
+		&& FMemory::Memcmp(Body.GetData() + Body.Num() - Closing.Len(), TCHAR_TO_UTF8(*Closing), Closing.Len()) == 0;
+	TestTrue(TEXT("Body ends with the closing boundary"), bClosed);
+
+	Report.Save();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitTokenFileBenchmark, "PlayKit.Benchmark.GetToken",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPlayKitTokenFileBenchmark::RunTest(const FString& Parameters)
+{
+	PlayKitBenchmark::FReport Report(*this, TEXT("GetToken"));
+
+	// GetToken serves the token from memory; the file read it replaced, now done once at startup, is measured directly
+	FPlayerTokenInfo Token;
+	Token.UserId = TEXT("user_0123456789");
+	Token.PlayerToken = TEXT("pk_player_0123456789abcdef0123456789abcdef0123456789abcdef0123456789abcdef");
+	Token.ExpiresAt = (FDateTime::UtcNow() + FTimespan::FromDays(30)).ToIso8601();
+
+	const FString FilePath = FPaths::AutomationTransientDir() / TEXT("PlayKitBenchmarkToken.dat");
+	if (!TestTrue(TEXT("Token saved"), UPlayKitAuthSubsystem::SaveTokenToFile(Token, FilePath)))
+	{
+		return false;
+	}
+
+	FPlayerTokenInfo Loaded;
+	bool bLoaded = false;
+	Report.Run(TEXT("Auth.LoadTokenFromFile"), 1000, [&]() { bLoaded = UPlayKitAuthSubsystem::LoadTokenFromFile(FilePath, Loaded); });
+	TestTrue(TEXT("Token loaded"), bLoaded);
+	TestEqual(TEXT("Token round-trips"), Loaded.PlayerToken, Token.PlayerToken);
+
+	IFileManager::Get().Delete(*FilePath);
+
+	// What every request pays for its token now: a snapshot read, no ini or file access
+	FString AuthToken;
+	Report.Run(TEXT("Auth.GetAuthToken"), 100000, [&]() { AuthToken = FPlayKitCredentials::GetAuthToken(); });
+
+	Report.Save();
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,82 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Net/PlayKitJsonReader.h"
+#include "Net/PlayKitSSEDecoder.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitJsonReaderTest, "PlayKit.ResponseParser.ChatCompletion",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPlayKitJsonReaderTest::RunTest(const FString& Parameters)
+{
+	// Unknown subtrees (with brackets and quotes inside strings) before and after the fields that are read
+	const FUtf8StringView Completion = UTF8TEXTVIEW(R"json(
+	{
+		"id": "chatcmpl-1",
+		"meta": { "nested": [1, 2, {"a": "]}\"["}], "flag": true, "none": null },
+		"choices": [
+			{
+				"index": 0,
+				"message": {
+					"role": "assistant",
+					"content": "Line one\nCaf\u00e9 \"quoted\" \ud83d\udde1 done",
+					"tool_calls": [
+						{ "id": "call_1", "type": "function", "function": { "name": "open_door", "arguments": "{\"door\":\"north\",\"force\":2,\"loud\":false}" } }
+					]
+				},
+				"finish_reason": "tool_calls"
+			},
+			{ "index": 1, "message": { "content": "ignored" } }
+		],
+		"usage": { "prompt_tokens": 12, "completion_tokens": 34, "total_tokens": 46 }
+	})json");
+
+	FPlayKitChatResponse Response;
+	TestTrue(TEXT("Parses"), FPlayKitJsonReader::ParseChatCompletion(Completion, Response));
+	TestEqual(TEXT("content"), Response.Content, FString(TEXT("Line one\nCaf\u00E9 \"quoted\" \U0001F5E1 done")));
+	TestEqual(TEXT("finish_reason"), Response.FinishReason, FString(TEXT("tool_calls")));
+	TestEqual(TEXT("prompt_tokens"), Response.PromptTokens, 12);
+	TestEqual(TEXT("completion_tokens"), Response.CompletionTokens, 34);
+	TestEqual(TEXT("total_tokens"), Response.TotalTokens, 46);
+
+	if (TestEqual(TEXT("tool call count"), Response.ToolCalls.Num(), 1))
+	{
+		TestEqual(TEXT("tool call id"), Response.ToolCalls[0].Id, FString(TEXT("call_1")));
+		TestEqual(TEXT("function name"), Response.ToolCalls[0].FunctionName, FString(TEXT("open_door")));
+		TestEqual(TEXT("arguments"), Response.ToolCalls[0].FunctionArguments, FString(TEXT("{\"door\":\"north\",\"force\":2,\"loud\":false}")));
+	}
+
+	FPlayKitChatResponse Truncated;
+	TestFalse(TEXT("Truncated body fails"), FPlayKitJsonReader::ParseChatCompletion(UTF8TEXTVIEW("{\"choices\":[{\"message\":{\"content\":\"abc"), Truncated));
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitSSEDeltaTest, "PlayKit.ResponseParser.StreamDelta",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPlayKitSSEDeltaTest::RunTest(const FString& Parameters)
+{
+	FString Delta;
+
+	TestTrue(TEXT("UI text-delta"), FPlayKitSSEDecoder::TryGetTextDelta(UTF8TEXTVIEW("{\"type\":\"text-delta\",\"id\":\"0\",\"delta\":\"Hi\\n\"}"), Delta));
+	TestEqual(TEXT("UI delta"), Delta, FString(TEXT("Hi\n")));
+
+	TestTrue(TEXT("Delta before type"), FPlayKitSSEDecoder::TryGetTextDelta(UTF8TEXTVIEW("{\"delta\":\"there\",\"type\":\"text-delta\"}"), Delta));
+	TestEqual(TEXT("Reordered delta"), Delta, FString(TEXT("there")));
+
+	TestFalse(TEXT("Control event"), FPlayKitSSEDecoder::TryGetTextDelta(UTF8TEXTVIEW("{\"type\":\"finish\",\"delta\":\"x\"}"), Delta));
+	TestFalse(TEXT("Done marker"), FPlayKitSSEDecoder::TryGetTextDelta(UTF8TEXTVIEW(" [DONE] "), Delta));
+
+	TestTrue(TEXT("OpenAI chunk"), FPlayKitSSEDecoder::TryGetTextDelta(UTF8TEXTVIEW("{\"choices\":[{\"delta\":{\"role\":\"assistant\",\"content\":\"Yo\"},\"index\":0}]}"), Delta));
+	TestEqual(TEXT("OpenAI delta"), Delta, FString(TEXT("Yo")));
+
+	TestFalse(TEXT("OpenAI chunk without content"), FPlayKitSSEDecoder::TryGetTextDelta(UTF8TEXTVIEW("{\"choices\":[{\"delta\":{},\"finish_reason\":\"stop\"}]}"), Delta));
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
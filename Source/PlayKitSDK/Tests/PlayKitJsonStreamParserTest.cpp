@@ -0,0 +1,60 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Net/PlayKitJsonStreamParser.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitJsonStreamParserTest, "PlayKit.ResponseParser.JsonStream",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPlayKitJsonStreamParserTest::RunTest(const FString& Parameters)
+{
+	const FString Object = TEXT("{\"title\": \"Iron \\\"Ore\\\" }\", \"count\": 3, \"objectives\": [{\"id\": 1, \"tags\": [\"a\", \"b\"]}, 2, \"x,y\"], \"done\": true, \"meta\": {\"k\": [1, 2]}}");
+	const FString Text = TEXT("```json\n") + Object + TEXT("\n```");
+
+	const TCHAR* ExpectedPaths[] = { TEXT("title"), TEXT("count"), TEXT("objectives[0]"), TEXT("objectives[1]"), TEXT("objectives[2]"),
+		TEXT("objectives"), TEXT("done"), TEXT("meta") };
+	const TCHAR* ExpectedJson[] = { TEXT("\"Iron \\\"Ore\\\" }\""), TEXT("3"), TEXT("{\"id\":1,\"tags\":[\"a\",\"b\"]}"), TEXT("2"), TEXT("\"x,y\""),
+		TEXT("[{\"id\":1,\"tags\":[\"a\",\"b\"]},2,\"x,y\"]"), TEXT("true"), TEXT("{\"k\":[1,2]}") };
+
+	// Deltas split anywhere, down to single characters, give the same values
+	for (int32 ChunkSize = 1; ChunkSize <= Text.Len(); ChunkSize += ChunkSize < 8 ? 1 : 16)
+	{
+		FPlayKitJsonStreamParser Parser;
+		TArray<FPlayKitJsonStreamValue> Values;
+		for (int32 Start = 0; Start < Text.Len(); Start += ChunkSize)
+		{
+			Parser.Feed(FStringView(Text).Mid(Start, ChunkSize), Values);
+		}
+
+		const FString Context = FString::Printf(TEXT("Chunk size %d"), ChunkSize);
+		TestTrue(Context + TEXT(": object complete"), Parser.IsComplete() && !Parser.HasError());
+		if (!TestEqual(Context + TEXT(": value count"), Values.Num(), static_cast<int32>(UE_ARRAY_COUNT(ExpectedPaths))))
+		{
+			continue;
+		}
+		for (int32 Index = 0; Index < Values.Num(); ++Index)
+		{
+			TestEqual(Context + TEXT(": path"), Values[Index].Path, FString(ExpectedPaths[Index]));
+			TestEqual(Context + TEXT(": value"), Values[Index].Json, FString(ExpectedJson[Index]));
+		}
+		TestEqual(Context + TEXT(": root range skips the fence"),
+			Text.Mid(static_cast<int32>(Parser.GetRootStart()), static_cast<int32>(Parser.GetRootEnd() - Parser.GetRootStart())), Object);
+	}
+
+	// A truncated stream never completes; mismatched brackets are an error
+	FPlayKitJsonStreamParser Truncated;
+	TArray<FPlayKitJsonStreamValue> Values;
+	Truncated.Feed(TEXT("{\"title\": \"Iron\", \"objectives\": [1, 2"), Values);
+	TestFalse(TEXT("Truncated object is incomplete"), Truncated.IsComplete());
+	TestEqual(TEXT("Completed values of a truncated object are reported"), Values.Num(), 2);
+
+	FPlayKitJsonStreamParser Malformed;
+	TestFalse(TEXT("Mismatched bracket is an error"), Malformed.Feed(TEXT("{\"a\": [1}"), Values));
+
+	return true;
+}
+
+#endif
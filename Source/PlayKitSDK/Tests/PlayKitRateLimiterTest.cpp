@@ -0,0 +1,58 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Net/PlayKitRateLimiter.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitRateLimiterTest, "PlayKit.Scheduler.RateLimiter",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPlayKitRateLimiterTest::RunTest(const FString& Parameters)
+{
+	const EPlayKitEndpoint Endpoint = EPlayKitEndpoint::Image;
+
+	// One request a minute after a burst of two: slow enough that no token refills during the test
+	FPlayKitRateLimit Limit;
+	Limit.RequestsPerSecond = 1.0 / 60.0;
+	Limit.Burst = 2.0;
+	FPlayKitRateLimiter::Configure(Endpoint, Limit);
+	FPlayKitRateLimiter::Reset();
+
+	TestEqual(TEXT("First burst request is sent"), FPlayKitRateLimiter::TryAcquire(Endpoint), 0.0);
+	TestEqual(TEXT("Second burst request is sent"), FPlayKitRateLimiter::TryAcquire(Endpoint), 0.0);
+	const double Wait = FPlayKitRateLimiter::TryAcquire(Endpoint);
+	TestTrue(TEXT("Third request waits for the next token"), Wait > 50.0 && Wait <= 60.0);
+	TestEqual(TEXT("Held back send is counted"), FPlayKitRateLimiter::GetStats(Endpoint).Delayed, 1);
+	TestEqual(TEXT("Other endpoints are unaffected"), FPlayKitRateLimiter::TryAcquire(EPlayKitEndpoint::Chat), 0.0);
+
+	// The server reports a larger quota: pace to spend it by the reset
+	FPlayKitRateLimiter::OnQuota(Endpoint, 30, 10.0);
+	TestEqual(TEXT("Rate follows the reported quota"), FPlayKitRateLimiter::GetStats(Endpoint).RequestsPerSecond, 3.0, 1.0e-6);
+
+	// A spent quota pauses the endpoint until the reset
+	FPlayKitRateLimiter::OnQuota(Endpoint, 0, 30.0);
+	TestTrue(TEXT("Spent quota waits for the reset"), FPlayKitRateLimiter::TryAcquire(Endpoint) > 25.0);
+
+	// Once a short window resets, requests go out again straight away rather than at the backed off rate
+	FPlayKitRateLimiter::Reset();
+	FPlayKitRateLimiter::OnQuota(Endpoint, 0, 0.05);
+	TestTrue(TEXT("Spent quota pauses the endpoint"), FPlayKitRateLimiter::TryAcquire(Endpoint) > 0.0);
+	FPlatformProcess::Sleep(0.1f);
+	TestEqual(TEXT("Reset quota sends immediately"), FPlayKitRateLimiter::TryAcquire(Endpoint), 0.0);
+
+	// A 429 without headers halves the rate
+	Limit.RequestsPerSecond = 2.0;
+	FPlayKitRateLimiter::Configure(Endpoint, Limit);
+	FPlayKitRateLimiter::Reset();
+	FPlayKitRateLimiter::OnThrottled(Endpoint, 0.0);
+	TestEqual(TEXT("Throttling halves the rate"), FPlayKitRateLimiter::GetStats(Endpoint).RequestsPerSecond, 1.0, 1.0e-6);
+	TestEqual(TEXT("Throttled reply is counted"), FPlayKitRateLimiter::GetStats(Endpoint).Throttled, 1);
+
+	FPlayKitRateLimiter::Configure(Endpoint, FPlayKitRateLimit::FromSettings(Endpoint));
+	FPlayKitRateLimiter::Reset();
+	return true;
+}
+
+#endif
@@ -0,0 +1,227 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "PlayKitBenchmark.h"
+#include "Client/PlayKitChatClient.h"
+#include "NPC/PlayKitNPCClient.h"
+#include "UObject/Package.h"
+#include "Dom/JsonObject.h"
+#include "Dom/JsonValue.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace PlayKitRequestBodyBenchmark
+{
+	FPlayKitChatConfig MakeConfig(int32 NumMessages)
+	{
+		FPlayKitChatConfig Config;
+		Config.Temperature = 0.7f;
+		Config.MaxTokens = 512;
+		Config.Messages.Add(FPlayKitChatMessage(TEXT("system"), TEXT("You are a gruff blacksmith in a frontier town. Keep answers short.")));
+		for (int32 Index = 1; Index < NumMessages; ++Index)
+		{
+			const bool bUser = (Index % 2) == 1;
+			Config.Messages.Add(FPlayKitChatMessage(bUser ? TEXT("user") : TEXT("assistant"), FString::Printf(
+				TEXT("Message %d: \"Can you fix this sword?\"\nThe blade is chipped \u2014 caf\u00E9 quality steel \U0001F5E1, nothing special."), Index)));
+		}
+		return Config;
+	}
+
+	/** The FJsonObject path the chat client used before FPlayKitJsonWriter */
+	void BuildLegacyBody(const FString& Model, const FPlayKitChatConfig& Config, bool bStream, TArray<uint8>& OutBody)
+	{
+		TSharedPtr<FJsonObject> RequestBody = MakeShared<FJsonObject>();
+		RequestBody->SetStringField(TEXT("model"), Model);
+		RequestBody->SetNumberField(TEXT("temperature"), Config.Temperature);
+		RequestBody->SetBoolField(TEXT("stream"), bStream);
+		if (Config.MaxTokens > 0)
+		{
+			RequestBody->SetNumberField(TEXT("max_tokens"), Config.MaxTokens);
+		}
+
+		TArray<TSharedPtr<FJsonValue>> MessagesArray;
+		for (const FPlayKitChatMessage& Message : Config.Messages)
+		{
+			TSharedPtr<FJsonObject> MessageObj = MakeShared<FJsonObject>();
+			MessageObj->SetStringField(TEXT("role"), Message.Role);
+			MessageObj->SetStringField(TEXT("content"), Message.Content);
+			MessagesArray.Add(MakeShared<FJsonValueObject>(MessageObj));
+		}
+		RequestBody->SetArrayField(TEXT("messages"), MessagesArray);
+
+		FString RequestBodyStr;
+		TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&RequestBodyStr);
+		FJsonSerializer::Serialize(RequestBody.ToSharedRef(), Writer);
+
+		// What SetContentAsString does with the string
+		FTCHARToUTF8 Converter(*RequestBodyStr, RequestBodyStr.Len());
+		OutBody.Reset();
+		OutBody.Append(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+	}
+
+	TSharedPtr<FJsonObject> Parse(const TArray<uint8>& Body)
+	{
+		FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Body.GetData()), Body.Num());
+		TSharedPtr<FJsonObject> Object;
+		FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(FString(Converter.Length(), Converter.Get())), Object);
+		return Object;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitRequestBodyTest, "PlayKit.RequestBody.Roundtrip",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPlayKitRequestBodyTest::RunTest(const FString& Parameters)
+{
+	using namespace PlayKitRequestBodyBenchmark;
+
+	FPlayKitChatConfig Config = MakeConfig(4);
+	FString Awkward = TEXT("ctrl \x01 tab\t back\\slash lone ");
+	Awkward.AppendChar(static_cast<TCHAR>(0xD800));
+	Awkward += TEXT(" end");
+	Config.Messages.Add(FPlayKitChatMessage(TEXT("user"), Awkward));
+
+	TArray<uint8> Body;
+	UPlayKitChatClient::BuildChatRequestBody(TEXT("default-chat"), Config, true, Body);
+
+	TSharedPtr<FJsonObject> Parsed = Parse(Body);
+	if (!TestTrue(TEXT("Body is valid JSON"), Parsed.IsValid()))
+	{
+		return false;
+	}
+
+	TestEqual(TEXT("model"), Parsed->GetStringField(TEXT("model")), FString(TEXT("default-chat")));
+	TestEqual(TEXT("temperature"), Parsed->GetNumberField(TEXT("temperature")), 0.7);
+	TestTrue(TEXT("stream"), Parsed->GetBoolField(TEXT("stream")));
+	TestEqual(TEXT("max_tokens"), static_cast<int32>(Parsed->GetNumberField(TEXT("max_tokens"))), 512);
+
+	const TArray<TSharedPtr<FJsonValue>>& Messages = Parsed->GetArrayField(TEXT("messages"));
+	if (TestEqual(TEXT("message count"), Messages.Num(), Config.Messages.Num()))
+	{
+		for (int32 Index = 0; Index < Messages.Num() - 1; ++Index)
+		{
+			TestEqual(TEXT("content"), Messages[Index]->AsObject()->GetStringField(TEXT("content")), Config.Messages[Index].Content);
+		}
+
+		// The unpaired surrogate is replaced, everything else survives
+		const FString Last = Messages.Last()->AsObject()->GetStringField(TEXT("content"));
+		TestEqual(TEXT("escaped content"), Last, FString(TEXT("ctrl \x01 tab\t back\\slash lone \uFFFD end")));
+	}
+
+	TArray<FNPCMessage> History;
+	History.Emplace(TEXT("user"), TEXT("Hello"));
+	History.Emplace(TEXT("assistant"), TEXT("Well met."));
+	UPlayKitNPCClient::BuildChatRequestBody(TEXT("default-chat"), TEXT("You are a guard."), History, TEXT("Open the gate"), 0.5f, false, Body);
+
+	Parsed = Parse(Body);
+	if (TestTrue(TEXT("NPC body is valid JSON"), Parsed.IsValid()))
+	{
+		TestEqual(TEXT("NPC message count"), Parsed->GetArrayField(TEXT("messages")).Num(), 4);
+		TestFalse(TEXT("NPC stream"), Parsed->GetBoolField(TEXT("stream")));
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitRequestBodyBenchmark, "PlayKit.Benchmark.RequestBody",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+
+bool FPlayKitRequestBodyBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace PlayKitRequestBodyBenchmark;
+
+	PlayKitBenchmark::FReport Report(*this, TEXT("RequestBody"));
+	const FString Model = TEXT("default-chat");
+
+	// Allocations are what the writer rewrite is about; without the counter only time is reported
+	if (!PlayKitBenchmark::IsCountingAllocations())
+	{
+		AddWarning(TEXT("Run with -PlayKitBenchmarkAllocs to measure allocations and bytes per request body"));
+	}
+
+	for (const int32 NumMessages : { 10, 100, 1000 })
+	{
+		const FPlayKitChatConfig Config = MakeConfig(NumMessages);
+		const int32 Iterations = FMath::Max(10, 20000 / NumMessages);
+
+		TArray<uint8> Body;
+		const PlayKitBenchmark::FResult Legacy = Report.Run(FString::Printf(TEXT("Chat.FJsonObject.%dMessages"), NumMessages), Iterations,
+			[&]() { BuildLegacyBody(Model, Config, true, Body); });
+
+		// A fresh buffer per request, like the clients (the buffer is moved into the HTTP request)
+		const PlayKitBenchmark::FResult Writer = Report.Run(FString::Printf(TEXT("Chat.JsonWriter.%dMessages"), NumMessages), Iterations, [&]()
+		{
+			TArray<uint8> RequestBody;
+			UPlayKitChatClient::BuildChatRequestBody(Model, Config, true, RequestBody);
+			Body = MoveTemp(RequestBody);
+		});
+
+		if (Writer.bCountedAllocations)
+		{
+			AddInfo(FString::Printf(TEXT("%d messages: writer %.1f allocs / %.0f bytes, FJsonObject %.1f allocs / %.0f bytes per request body"),
+				NumMessages, Writer.AllocationsPerOp, Writer.BytesPerOp, Legacy.AllocationsPerOp, Legacy.BytesPerOp));
+			TestTrue(TEXT("Writer allocates less than the DOM path"), Writer.AllocationsPerOp < Legacy.AllocationsPerOp);
+		}
+	}
+
+	Report.Save();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitNPCHistoryCacheTest, "PlayKit.RequestBody.NPCHistoryCache",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPlayKitNPCHistoryCacheTest::RunTest(const FString& Parameters)
+{
+	using namespace PlayKitRequestBodyBenchmark;
+
+	UPlayKitNPCClient* NPC = NewObject<UPlayKitNPCClient>(GetTransientPackage());
+	NPC->SetModel(TEXT("default-chat"));
+	NPC->SetCharacterDesign(TEXT("You are a guard."));
+
+	// 300 turns
+	for (int32 Turn = 0; Turn < 300; ++Turn)
+	{
+		NPC->AppendChatMessage(TEXT("user"), FString::Printf(TEXT("Question %d about the \"gate\"?"), Turn));
+		NPC->AppendChatMessage(TEXT("assistant"), FString::Printf(TEXT("Answer %d: the gate stays shut \u2014 orders."), Turn));
+	}
+
+	TArray<uint8> Body;
+	const PlayKitBenchmark::FResult Turn = PlayKitBenchmark::Measure(TEXT("NPC.Turn.300Turns"), 1000, [&]() { NPC->BuildTurnRequestBody(TEXT("Open the gate"), true, Body); });
+	AddInfo(FString::Printf(TEXT("300-turn NPC, %d bytes: %.0f ns, %.1f allocs, %.0f bytes allocated per request body"),
+		Body.Num(), Turn.NanosecondsPerOp, Turn.AllocationsPerOp, Turn.BytesPerOp));
+
+	TArray<uint8> Expected;
+	UPlayKitNPCClient::BuildChatRequestBody(TEXT("default-chat"), TEXT("You are a guard."), NPC->GetHistory(), TEXT("Open the gate"), NPC->Temperature, true, Expected);
+	TestTrue(TEXT("Cached body matches a full rebuild"), Body == Expected);
+
+	// Reverts and edits must invalidate exactly what changed
+	NPC->RevertHistory();
+	NPC->AppendChatMessage(TEXT("user"), TEXT("Replacement question"));
+	NPC->SetMemory(TEXT("mood"), TEXT("wary"));
+	NPC->BuildTurnRequestBody(TEXT("Open the gate"), false, Body);
+
+	TSharedPtr<FJsonObject> Parsed = Parse(Body);
+	if (TestTrue(TEXT("Body is valid JSON"), Parsed.IsValid()))
+	{
+		const TArray<TSharedPtr<FJsonValue>>& Messages = Parsed->GetArrayField(TEXT("messages"));
+		TestEqual(TEXT("message count"), Messages.Num(), 1 + 599 + 1);
+		TestTrue(TEXT("system prompt has the memory"), Messages[0]->AsObject()->GetStringField(TEXT("content")).Contains(TEXT("mood: wary")));
+		TestEqual(TEXT("replaced message"), Messages[599]->AsObject()->GetStringField(TEXT("content")), FString(TEXT("Replacement question")));
+	}
+
+	NPC->ClearHistory();
+	NPC->BuildTurnRequestBody(TEXT("Hello"), false, Body);
+	Parsed = Parse(Body);
+	if (TestTrue(TEXT("Body is valid JSON after clear"), Parsed.IsValid()))
+	{
+		TestEqual(TEXT("message count after clear"), Parsed->GetArrayField(TEXT("messages")).Num(), 2);
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,97 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Net/PlayKitRequestScheduler.h"
+#include "Net/PlayKitRequestTrace.h"
+#include "Net/PlayKitRateLimiter.h"
+#include "Net/PlayKitRetryPolicy.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HttpModule.h"
+#include "Interfaces/IHttpRequest.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitRequestDeadlineTest, "PlayKit.Scheduler.Deadlines",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPlayKitRequestDeadlineTest::RunTest(const FString& Parameters)
+{
+	const EPlayKitEndpoint Endpoint = EPlayKitEndpoint::Image;
+
+	// Rooted so a garbage collection while the latent command waits keeps the scheduler alive
+	UGameInstance* GameInstance = NewObject<UGameInstance>(GEngine);
+	GameInstance->AddToRoot();
+	GameInstance->InitializeStandalone();
+	UPlayKitRequestScheduler* Scheduler = GameInstance->GetSubsystem<UPlayKitRequestScheduler>();
+	if (!TestNotNull(TEXT("Scheduler"), Scheduler))
+	{
+		return false;
+	}
+
+	// A spent quota holds the endpoint for a minute: nothing gets a send slot during the test
+	FPlayKitRetryPolicy::Reset();
+	FPlayKitRateLimit Limit;
+	Limit.bAdaptive = true;
+	FPlayKitRateLimiter::Configure(Endpoint, Limit);
+	FPlayKitRateLimiter::Reset();
+	FPlayKitRateLimiter::OnQuota(Endpoint, 0, 60.0);
+
+	struct FResult
+	{
+		bool bCompleted = false;
+		bool bTimedOut = false;
+		bool bHadResponse = false;
+	};
+	TSharedRef<FResult> Result = MakeShared<FResult>();
+
+	TSharedRef<IHttpRequest, ESPMode::ThreadSafe> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(TEXT("http://127.0.0.1:9/playkit-deadline-test"));
+	Request->SetVerb(TEXT("POST"));
+	Request->OnProcessRequestComplete().BindLambda([Result](FHttpRequestPtr InRequest, FHttpResponsePtr InResponse, bool bWasSuccessful)
+	{
+		Result->bCompleted = true;
+		Result->bTimedOut = FPlayKitRequestTrace::HasTimedOut(InRequest.Get());
+		Result->bHadResponse = InResponse.IsValid();
+	});
+
+	FPlayKitRequestDeadlines Deadlines;
+	Deadlines.TotalSeconds = 0.2f;
+	Scheduler->Submit(Request, Endpoint, EPlayKitRequestPriority::AssetGeneration, GameInstance, false,
+		EPlayKitDecodeThread::GameThread, Deadlines);
+	TestEqual(TEXT("Request waits for the rate limiter"), Scheduler->GetActiveCount(Endpoint), 0);
+
+	const double GiveUpTime = FPlatformTime::Seconds() + 5.0;
+	ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([this, Result, Request, Scheduler, GameInstance, Endpoint, GiveUpTime]()
+	{
+		if (!Result->bCompleted && FPlatformTime::Seconds() < GiveUpTime)
+		{
+			return false;
+		}
+
+		TestTrue(TEXT("Queued request fails once its total deadline passes"), Result->bCompleted);
+		TestTrue(TEXT("Failure is reported as a timeout"), Result->bTimedOut);
+		TestFalse(TEXT("No response was received"), Result->bHadResponse);
+		TestEqual(TEXT("Request was never sent"), Request->GetStatus(), EHttpRequestStatus::NotStarted);
+		TestEqual(TEXT("Expired request is counted"), Scheduler->GetStats().TotalTimedOut, 1);
+
+		FPlayKitRateLimiter::Configure(Endpoint, FPlayKitRateLimit::FromSettings(Endpoint));
+		FPlayKitRateLimiter::Reset();
+
+		UWorld* World = GameInstance->GetWorld();
+		GameInstance->Shutdown();
+		if (World)
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+		GameInstance->RemoveFromRoot();
+		return true;
+	}));
+
+	return true;
+}
+
+#endif
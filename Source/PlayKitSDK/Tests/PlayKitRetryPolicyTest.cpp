@@ -0,0 +1,66 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Net/PlayKitRetryPolicy.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FPlayKitRetryPolicyTest, "PlayKit.Scheduler.RetryPolicy",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FPlayKitRetryPolicyTest::RunTest(const FString& Parameters)
+{
+	const FPlayKitRetryConfig SavedConfig = FPlayKitRetryPolicy::GetConfig();
+
+	TestTrue(TEXT("503 is retryable"), FPlayKitRetryPolicy::IsRetryableStatus(503));
+	TestTrue(TEXT("429 is retryable"), FPlayKitRetryPolicy::IsRetryableStatus(429));
+	TestFalse(TEXT("400 is not retryable"), FPlayKitRetryPolicy::IsRetryableStatus(400));
+	TestFalse(TEXT("501 is not retryable"), FPlayKitRetryPolicy::IsRetryableStatus(501));
+	TestTrue(TEXT("No reply is a connection failure"),
+		FPlayKitRetryPolicy::Classify(nullptr, nullptr, false) == FPlayKitRetryPolicy::EOutcome::Failed);
+
+	// Budget: one banked retry, none earned
+	FPlayKitRetryConfig Config;
+	Config.MaxRetries = 3;
+	Config.BaseDelay = 1.0;
+	Config.MaxDelay = 4.0;
+	Config.BudgetRatio = 0.0;
+	Config.BudgetReserve = 1.0;
+	Config.BreakerThreshold = 0;
+	FPlayKitRetryPolicy::Configure(Config);
+	FPlayKitRetryPolicy::Reset();
+
+	double Delay = -1.0;
+	TestTrue(TEXT("First retry is paid from the reserve"),
+		FPlayKitRetryPolicy::OnAttemptFinished(EPlayKitEndpoint::Image, nullptr, nullptr, false, 0, true, Delay));
+	TestTrue(TEXT("Delay is within the first backoff window"), Delay >= 0.0 && Delay <= Config.BaseDelay);
+	TestFalse(TEXT("Second retry is over budget"),
+		FPlayKitRetryPolicy::OnAttemptFinished(EPlayKitEndpoint::Image, nullptr, nullptr, false, 1, true, Delay));
+	TestFalse(TEXT("A delivered reply is not resent"),
+		FPlayKitRetryPolicy::OnAttemptFinished(EPlayKitEndpoint::Image, nullptr, nullptr, false, 0, false, Delay));
+	TestEqual(TEXT("Denied retries are counted"), FPlayKitRetryPolicy::GetStats(EPlayKitEndpoint::Image).RetriesDenied, 1);
+
+	// Breaker: two failures open the circuit for longer than the test runs
+	Config.BudgetReserve = 10.0;
+	Config.BreakerThreshold = 2;
+	Config.BreakerCooldown = 3600.0;
+	FPlayKitRetryPolicy::Configure(Config);
+	FPlayKitRetryPolicy::Reset();
+
+	TestTrue(TEXT("Closed circuit admits"), FPlayKitRetryPolicy::AllowRequest(EPlayKitEndpoint::Transcription));
+	FPlayKitRetryPolicy::OnAttemptFinished(EPlayKitEndpoint::Transcription, nullptr, nullptr, false, 0, true, Delay);
+	TestFalse(TEXT("Attempt that opens the circuit is not retried"),
+		FPlayKitRetryPolicy::OnAttemptFinished(EPlayKitEndpoint::Transcription, nullptr, nullptr, false, 0, true, Delay));
+	TestTrue(TEXT("Circuit is open"),
+		FPlayKitRetryPolicy::GetStats(EPlayKitEndpoint::Transcription).Circuit == EPlayKitCircuitState::Open);
+	TestFalse(TEXT("Open circuit fails fast"), FPlayKitRetryPolicy::AllowRequest(EPlayKitEndpoint::Transcription));
+	TestEqual(TEXT("Failed fast is counted"), FPlayKitRetryPolicy::GetStats(EPlayKitEndpoint::Transcription).FailedFast, 1);
+	TestTrue(TEXT("Other endpoints are unaffected"), FPlayKitRetryPolicy::AllowRequest(EPlayKitEndpoint::Image));
+
+	FPlayKitRetryPolicy::Configure(SavedConfig);
+	FPlayKitRetryPolicy::Reset();
+	return true;
+}
+
+#endif
@@ -0,0 +1,368 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitLoadTestCommandlet.h"
+
+#include "PlayKitMockServer.h"
+#include "PlayKitSettings.h"
+#include "Net/PlayKitJsonWriter.h"
+#include "Net/PlayKitTransport.h"
+#include "Net/PlayKitSessionTransport.h"
+#include "Containers/Ticker.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/Package.h"
+
+namespace PlayKitLoadTest
+{
+	/** Nearest-rank percentile of Values (sorted in place); 0 when empty */
+	double Percentile(TArray<double>& Values, double P)
+	{
+		if (Values.Num() == 0)
+		{
+			return 0.0;
+		}
+		Values.Sort();
+		const int32 Rank = FMath::Clamp(FMath::CeilToInt(P * Values.Num()) - 1, 0, Values.Num() - 1);
+		return Values[Rank];
+	}
+
+	const TCHAR* Lines[] = {
+		TEXT("Good morning. Is the forge open?"),
+		TEXT("I need this blade sharpened before nightfall."),
+		TEXT("What would you charge for a new hilt?"),
+		TEXT("Have you heard anything about the mine to the north?"),
+		TEXT("Thanks. I'll be back tomorrow."),
+	};
+}
+
+//========== Agent ==========//
+
+void UPlayKitLoadTestAgent::Initialize(int32 InAgentIndex, int32 InTurns, bool bInStream, double InStartTime, FPlayKitLoadTestStats* InStats)
+{
+	AgentIndex = InAgentIndex;
+	TurnsLeft = InTurns;
+	bStream = bInStream;
+	NextTurnTime = InStartTime;
+	Stats = InStats;
+
+	NPC = NewObject<UPlayKitNPCClient>(this);
+	NPC->SetCharacterDesign(FString::Printf(TEXT("You are blacksmith #%d of a frontier town. Keep answers short."), AgentIndex));
+	NPC->SetPlayerToken(TEXT("mock-player-token"));
+	NPC->OnStreamChunk.AddDynamic(this, &UPlayKitLoadTestAgent::HandleStreamChunk);
+	NPC->OnResponse.AddDynamic(this, &UPlayKitLoadTestAgent::HandleResponse);
+	NPC->OnError.AddDynamic(this, &UPlayKitLoadTestAgent::HandleError);
+}
+
+void UPlayKitLoadTestAgent::Tick(double Now)
+{
+	if (bWaiting || TurnsLeft == 0 || Now < NextTurnTime)
+	{
+		return;
+	}
+
+	--TurnsLeft;
+	bWaiting = true;
+	bGotFirstToken = false;
+	TurnStartTime = Now;
+
+	const FString Line = PlayKitLoadTest::Lines[(AgentIndex + TurnsLeft) % UE_ARRAY_COUNT(PlayKitLoadTest::Lines)];
+	if (bStream)
+	{
+		NPC->TalkStream(Line);
+	}
+	else
+	{
+		NPC->Talk(Line);
+	}
+}
+
+void UPlayKitLoadTestAgent::Shutdown()
+{
+	NPC->OnStreamChunk.RemoveAll(this);
+	NPC->OnResponse.RemoveAll(this);
+	NPC->OnError.RemoveAll(this);
+	Stats = nullptr;
+}
+
+void UPlayKitLoadTestAgent::HandleStreamChunk(FString Chunk)
+{
+	if (bWaiting && !bGotFirstToken)
+	{
+		bGotFirstToken = true;
+		Stats->FirstTokenSeconds.Add(FPlatformTime::Seconds() - TurnStartTime);
+	}
+}
+
+void UPlayKitLoadTestAgent::HandleResponse(FNPCResponse Response)
+{
+	FinishTurn(Response.bSuccess);
+}
+
+void UPlayKitLoadTestAgent::HandleError(FString ErrorCode, FString ErrorMessage)
+{
+	if (bWaiting)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[PlayKitLoadTest] NPC %d: %s - %s"), AgentIndex, *ErrorCode, *ErrorMessage);
+		FinishTurn(false);
+	}
+}
+
+void UPlayKitLoadTestAgent::FinishTurn(bool bSuccess)
+{
+	if (!bWaiting)
+	{
+		return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	bWaiting = false;
+	NextTurnTime = Now;
+
+	if (!bSuccess)
+	{
+		++Stats->Failed;
+		return;
+	}
+
+	++Stats->Completed;
+	Stats->TurnSeconds.Add(Now - TurnStartTime);
+	if (!bGotFirstToken)
+	{
+		// Talk: the whole reply is the first token
+		Stats->FirstTokenSeconds.Add(Now - TurnStartTime);
+	}
+}
+
+//========== Commandlet ==========//
+
+UPlayKitLoadTestCommandlet::UPlayKitLoadTestCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UPlayKitLoadTestCommandlet::Main(const FString& Params)
+{
+	const TCHAR* CmdLine = *Params;
+
+	int32 NumNPCs = 100;
+	int32 Turns = 5;
+	bool bStream = true;
+	bool bOffThread = false;
+	bool bPerFrameChunks = false;
+	bool bLoopback = false;
+	bool bSession = false;
+	bool bHistorySync = false;
+	double RampSeconds = 2.0;
+	double FrameRate = 60.0;
+	double TimeoutSeconds = 600.0;
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("PlayKit/Benchmarks/LoadTest.json");
+
+	FPlayKitMockServerConfig ServerConfig;
+	FParse::Value(CmdLine, TEXT("NPCs="), NumNPCs);
+	FParse::Value(CmdLine, TEXT("Turns="), Turns);
+	FParse::Bool(CmdLine, TEXT("Stream="), bStream);
+	FParse::Bool(CmdLine, TEXT("OffThread="), bOffThread);
+	FParse::Bool(CmdLine, TEXT("PerFrameChunks="), bPerFrameChunks);
+	FParse::Bool(CmdLine, TEXT("Loopback="), bLoopback);
+	FParse::Bool(CmdLine, TEXT("Session="), bSession);
+	FParse::Bool(CmdLine, TEXT("HistorySync="), bHistorySync);
+	FParse::Value(CmdLine, TEXT("RampSeconds="), RampSeconds);
+	FParse::Value(CmdLine, TEXT("FrameRate="), FrameRate);
+	FParse::Value(CmdLine, TEXT("TimeoutSeconds="), TimeoutSeconds);
+	FParse::Value(CmdLine, TEXT("Output="), OutputPath);
+	ServerConfig.ParseFrom(CmdLine);
+
+	NumNPCs = FMath::Max(1, NumNPCs);
+	bSession = bSession && !bLoopback;
+	Turns = FMath::Max(1, Turns);
+	FrameRate = FMath::Max(1.0, FrameRate);
+
+	FPlayKitMockServer Server(ServerConfig);
+	if (bLoopback)
+	{
+		FPlayKitTransport::Set(MakeShared<FPlayKitLoopbackTransport, ESPMode::ThreadSafe>(FPlayKitMockServer::MakeLoopbackHandler(ServerConfig)));
+	}
+	else if (!Server.Start())
+	{
+		return 1;
+	}
+
+	TSharedPtr<FPlayKitSessionTransport, ESPMode::ThreadSafe> SessionTransport;
+	if (bSession)
+	{
+		FPlayKitSessionConfig SessionConfig;
+		SessionConfig.Url = Server.GetSessionUrl();
+		SessionTransport = MakeShared<FPlayKitSessionTransport, ESPMode::ThreadSafe>(SessionConfig);
+		FPlayKitTransport::Set(SessionTransport);
+	}
+
+	// Point the SDK at the mock server for the duration of the run
+	UPlayKitSettings* Settings = UPlayKitSettings::Get();
+	const FString SavedBaseUrl = Settings->CustomBaseUrl;
+	const FString SavedGameId = Settings->GameId;
+	Settings->CustomBaseUrl = bLoopback ? TEXT("http://loopback") : Server.GetBaseUrl();
+	Settings->GameId = TEXT("loadtest");
+
+	const uint64 BaselineMemory = FPlatformMemory::GetStats().UsedPhysical;
+	uint64 PeakMemory = BaselineMemory;
+
+	FPlayKitLoadTestStats Stats;
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumNPCs; ++Index)
+	{
+		UPlayKitLoadTestAgent* Agent = NewObject<UPlayKitLoadTestAgent>(GetTransientPackage());
+		Agent->Initialize(Index, Turns, bStream, StartTime + RampSeconds * Index / NumNPCs, &Stats);
+		if (bOffThread)
+		{
+			Agent->NPC->DecodeThread = EPlayKitDecodeThread::HttpThread;
+		}
+		if (bPerFrameChunks)
+		{
+			Agent->NPC->ChunkDelivery = EPlayKitChunkDelivery::PerFrame;
+		}
+		Agent->NPC->bUseHistorySync = bHistorySync;
+		Agents.Add(Agent);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("[PlayKitLoadTest] %d NPCs x %d turns (%s) against %s"),
+		NumNPCs, Turns, bStream ? TEXT("TalkStream") : TEXT("Talk"),
+		bLoopback ? TEXT("the loopback transport") : bSession ? *Server.GetSessionUrl() : *Server.GetBaseUrl());
+
+	// Game loop: everything PlayKit does on the game thread happens inside the timed section
+	TArray<double> FrameWorkMs;
+	const double FrameInterval = 1.0 / FrameRate;
+	double LastFrameTime = StartTime;
+	bool bTimedOut = false;
+	for (;;)
+	{
+		const double FrameStart = FPlatformTime::Seconds();
+
+		for (UPlayKitLoadTestAgent* Agent : Agents)
+		{
+			Agent->Tick(FrameStart);
+		}
+		FTSTicker::GetCoreTicker().Tick(static_cast<float>(FrameStart - LastFrameTime));
+		LastFrameTime = FrameStart;
+
+		const double FrameEnd = FPlatformTime::Seconds();
+		FrameWorkMs.Add((FrameEnd - FrameStart) * 1000.0);
+		PeakMemory = FMath::Max(PeakMemory, FPlatformMemory::GetStats().UsedPhysical);
+
+		if (Agents.FindByPredicate([](const UPlayKitLoadTestAgent* Agent) { return !Agent->IsDone(); }) == nullptr)
+		{
+			break;
+		}
+		if (FrameEnd - StartTime > TimeoutSeconds)
+		{
+			bTimedOut = true;
+			break;
+		}
+
+		const double Remaining = FrameInterval - (FrameEnd - FrameStart);
+		if (Remaining > 0.0)
+		{
+			FPlatformProcess::SleepNoStats(static_cast<float>(Remaining));
+		}
+	}
+
+	const double Elapsed = FPlatformTime::Seconds() - StartTime;
+	const int64 InjectedFaults = Server.GetInjectedFaultCount();
+	const int32 SessionReconnects = bSession ? SessionTransport->GetReconnectCount() : 0;
+	const int64 ChatRequestBytes = Server.GetChatRequestBytes();
+	const int64 HistoryMismatches = Server.GetHistoryMismatchCount();
+
+	// After a timeout some replies are still in flight; they must not reach Stats
+	for (UPlayKitLoadTestAgent* Agent : Agents)
+	{
+		Agent->Shutdown();
+	}
+	Agents.Reset();
+
+	Settings->CustomBaseUrl = SavedBaseUrl;
+	Settings->GameId = SavedGameId;
+	if (bLoopback || bSession)
+	{
+		FPlayKitTransport::Set(nullptr);
+	}
+	SessionTransport.Reset();
+	Server.Stop();
+
+	// Report
+	const double RequestsPerSecond = Elapsed > 0.0 ? Stats.Completed / Elapsed : 0.0;
+	const double TtftP50 = PlayKitLoadTest::Percentile(Stats.FirstTokenSeconds, 0.50) * 1000.0;
+	const double TtftP95 = PlayKitLoadTest::Percentile(Stats.FirstTokenSeconds, 0.95) * 1000.0;
+	const double TtftP99 = PlayKitLoadTest::Percentile(Stats.FirstTokenSeconds, 0.99) * 1000.0;
+	const double TurnP50 = PlayKitLoadTest::Percentile(Stats.TurnSeconds, 0.50) * 1000.0;
+	const double FrameP50 = PlayKitLoadTest::Percentile(FrameWorkMs, 0.50);
+	const double FrameP95 = PlayKitLoadTest::Percentile(FrameWorkMs, 0.95);
+	const double FrameMax = FrameWorkMs.Num() > 0 ? FMath::Max(FrameWorkMs) : 0.0;
+	const double PeakMemoryMB = PeakMemory / (1024.0 * 1024.0);
+	const double PeakMemoryDeltaMB = (PeakMemory - BaselineMemory) / (1024.0 * 1024.0);
+
+	UE_LOG(LogTemp, Display, TEXT("[PlayKitLoadTest] %d completed, %d failed (%lld injected faults) in %.1f s: %.1f requests/s"),
+		Stats.Completed, Stats.Failed, InjectedFaults, Elapsed, RequestsPerSecond);
+	UE_LOG(LogTemp, Display, TEXT("[PlayKitLoadTest] Time to first token: p50 %.1f ms, p95 %.1f ms, p99 %.1f ms (turn p50 %.1f ms)"),
+		TtftP50, TtftP95, TtftP99, TurnP50);
+	UE_LOG(LogTemp, Display, TEXT("[PlayKitLoadTest] Game thread per frame: p50 %.3f ms, p95 %.3f ms, max %.3f ms over %d frames"),
+		FrameP50, FrameP95, FrameMax, FrameWorkMs.Num());
+	if (bSession)
+	{
+		UE_LOG(LogTemp, Display, TEXT("[PlayKitLoadTest] Session reconnects: %d"), SessionReconnects);
+	}
+	if (!bLoopback)
+	{
+		UE_LOG(LogTemp, Display, TEXT("[PlayKitLoadTest] Chat uploads: %.1f KB (%lld history mismatches)"), ChatRequestBytes / 1024.0, HistoryMismatches);
+	}
+	UE_LOG(LogTemp, Display, TEXT("[PlayKitLoadTest] Peak memory: %.1f MB (+%.1f MB over baseline)"), PeakMemoryMB, PeakMemoryDeltaMB);
+
+	TArray<uint8> Json;
+	FPlayKitJsonWriter Writer(Json);
+	Writer.BeginObject();
+	Writer.WriteNumber("npcs", NumNPCs);
+	Writer.WriteNumber("turns", Turns);
+	Writer.WriteBool("stream", bStream);
+	Writer.WriteBool("off_thread", bOffThread);
+	Writer.WriteBool("per_frame_chunks", bPerFrameChunks);
+	Writer.WriteBool("loopback", bLoopback);
+	Writer.WriteBool("session", bSession);
+	Writer.WriteNumber("session_reconnects", SessionReconnects);
+	Writer.WriteBool("history_sync", bHistorySync);
+	Writer.WriteNumber("chat_request_bytes", ChatRequestBytes);
+	Writer.WriteNumber("history_mismatches", HistoryMismatches);
+	Writer.WriteNumber("latency_ms", ServerConfig.LatencyMs);
+	Writer.WriteNumber("tokens_per_second", ServerConfig.TokensPerSecond);
+	Writer.WriteNumber("tokens_per_response", ServerConfig.TokensPerResponse);
+	Writer.WriteNumber("completed", Stats.Completed);
+	Writer.WriteNumber("failed", Stats.Failed);
+	Writer.WriteNumber("injected_faults", InjectedFaults);
+	Writer.WriteBool("timed_out", bTimedOut);
+	Writer.WriteNumber("elapsed_s", Elapsed);
+	Writer.WriteNumber("requests_per_s", RequestsPerSecond);
+	Writer.WriteNumber("ttft_p50_ms", TtftP50);
+	Writer.WriteNumber("ttft_p95_ms", TtftP95);
+	Writer.WriteNumber("ttft_p99_ms", TtftP99);
+	Writer.WriteNumber("turn_p50_ms", TurnP50);
+	Writer.WriteNumber("frame_p50_ms", FrameP50);
+	Writer.WriteNumber("frame_p95_ms", FrameP95);
+	Writer.WriteNumber("frame_max_ms", FrameMax);
+	Writer.WriteNumber("peak_memory_mb", PeakMemoryMB);
+	Writer.WriteNumber("peak_memory_delta_mb", PeakMemoryDeltaMB);
+	Writer.EndObject();
+
+	if (FFileHelper::SaveArrayToFile(Json, *OutputPath))
+	{
+		UE_LOG(LogTemp, Display, TEXT("[PlayKitLoadTest] Results written to %s"), *OutputPath);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("[PlayKitLoadTest] Could not write results to %s"), *OutputPath);
+	}
+
+	// Failures are expected when faults are injected; only a timeout fails such a run
+	const bool bFailed = bTimedOut || (Stats.Failed > 0 && InjectedFaults == 0);
+	return bFailed ? 1 : 0;
+}
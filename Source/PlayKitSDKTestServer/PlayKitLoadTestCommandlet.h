@@ -0,0 +1,106 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "NPC/PlayKitNPCClient.h"
+#include "PlayKitLoadTestCommandlet.generated.h"
+
+/**
+ * Measurements shared by all agents of a load test run
+ */
+struct FPlayKitLoadTestStats
+{
+	/** Seconds from Talk/TalkStream to the first chunk (stream) or the response (Talk) */
+	TArray<double> FirstTokenSeconds;
+
+	/** Seconds from Talk/TalkStream to the end of the reply */
+	TArray<double> TurnSeconds;
+
+	int32 Completed = 0;
+	int32 Failed = 0;
+};
+
+/**
+ * One scripted conversation: an NPC client that says the next line as soon as the previous reply is complete
+ */
+UCLASS()
+class UPlayKitLoadTestAgent : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	void Initialize(int32 InAgentIndex, int32 InTurns, bool bInStream, double InStartTime, FPlayKitLoadTestStats* InStats);
+
+	/** Start the next turn if it is due */
+	void Tick(double Now);
+
+	bool IsDone() const { return TurnsLeft == 0 && !bWaiting; }
+
+	/** Stop listening to the NPC; replies still in flight after the run are ignored */
+	void Shutdown();
+
+	UPROPERTY()
+	TObjectPtr<UPlayKitNPCClient> NPC;
+
+private:
+	UFUNCTION()
+	void HandleStreamChunk(FString Chunk);
+
+	UFUNCTION()
+	void HandleResponse(FNPCResponse Response);
+
+	/** Errors raised before a request is sent; failed requests also end with OnResponse */
+	UFUNCTION()
+	void HandleError(FString ErrorCode, FString ErrorMessage);
+
+	void FinishTurn(bool bSuccess);
+
+	FPlayKitLoadTestStats* Stats = nullptr;
+	int32 AgentIndex = 0;
+	int32 TurnsLeft = 0;
+	bool bStream = true;
+	bool bWaiting = false;
+	bool bGotFirstToken = false;
+	double NextTurnTime = 0.0;
+	double TurnStartTime = 0.0;
+};
+
+/**
+ * Headless load test: N NPCs hold scripted conversations against a local FPlayKitMockServer.
+ *
+ * Reports requests/s, time-to-first-token p50/p95/p99, game-thread time per frame spent
+ * ticking HTTP and PlayKit callbacks, and peak memory. Results are logged and written
+ * as JSON to Saved/PlayKit/Benchmarks/LoadTest.json (or -Output=<path>).
+ *
+ * Usage:
+ *   UnrealEditor-Cmd <Project>.uproject -run=PlayKitLoadTest -NPCs=200 -Turns=5 [-Stream=true] [-OffThread=false] [-PerFrameChunks=false]
+ *     [-Loopback=false] [-Session=false] [-HistorySync=false] [-RampSeconds=2] [-FrameRate=60] [-TimeoutSeconds=600] [mock server options, see FPlayKitMockServerConfig::ParseFrom]
+ *
+ * -OffThread=true decodes replies on the HTTP thread (UPlayKitNPCClient::DecodeThread), to compare
+ * the game-thread cost of both modes. -PerFrameChunks=true switches the NPCs to EPlayKitChunkDelivery::PerFrame.
+ * -Loopback=true serves the replies in process through FPlayKitLoopbackTransport instead of the mock server,
+ * so the run measures the SDK alone: no sockets, latency or injected faults. -Session=true carries the
+ * turns over one FPlayKitSessionTransport WebSocket to the mock server's session endpoint; combine it
+ * with SessionDropSeconds to measure reconnect and resume. -HistorySync=true turns on
+ * UPlayKitNPCClient::bUseHistorySync; compare the reported chat upload bytes with a run without it.
+ *
+ * Returns non-zero if the run timed out, or if a turn failed while no faults were injected.
+ */
+UCLASS()
+class UPlayKitLoadTestCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UPlayKitLoadTestCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+
+private:
+	UPROPERTY()
+	TArray<TObjectPtr<UPlayKitLoadTestAgent>> Agents;
+};
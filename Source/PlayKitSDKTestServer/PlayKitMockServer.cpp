@@ -0,0 +1,1423 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitMockServer.h"
+
+#include "Common/TcpSocketBuilder.h"
+#include "HAL/RunnableThread.h"
+#include "ImageUtils.h"
+#include "Misc/Base64.h"
+#include "Misc/SecureHash.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Net/PlayKitJsonReader.h"
+#include "Net/PlayKitJsonWriter.h"
+#include "Net/PlayKitHistorySync.h"
+#include "Net/PlayKitSessionProtocol.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+
+namespace PlayKitMockServer
+{
+	/** Largest request accepted; audio uploads are the biggest requests the SDK sends */
+	constexpr int32 MaxRequestBytes = 64 * 1024 * 1024;
+
+	const TCHAR* ReasonPhrase(int32 StatusCode)
+	{
+		switch (StatusCode)
+		{
+		case 200: return TEXT("OK");
+		case 400: return TEXT("Bad Request");
+		case 404: return TEXT("Not Found");
+		case 409: return TEXT("Conflict");
+		case 429: return TEXT("Too Many Requests");
+		case 500: return TEXT("Internal Server Error");
+		case 503: return TEXT("Service Unavailable");
+		default:  return TEXT("Status");
+		}
+	}
+
+	void AppendUtf8(TArray<uint8>& Out, const FString& Text)
+	{
+		FTCHARToUTF8 Converter(*Text, Text.Len());
+		Out.Append(reinterpret_cast<const uint8*>(Converter.Get()), Converter.Length());
+	}
+
+	/** Find "\r\n\r\n" in the first Num bytes. @return index just past it, or INDEX_NONE */
+	int32 FindHeaderEnd(const uint8* Data, int32 Num)
+	{
+		for (int32 Index = 3; Index < Num; ++Index)
+		{
+			if (Data[Index] == '\n' && Data[Index - 1] == '\r' && Data[Index - 2] == '\n' && Data[Index - 3] == '\r')
+			{
+				return Index + 1;
+			}
+		}
+		return INDEX_NONE;
+	}
+
+	/** Read "stream" from a chat request body. @return false if the body is not valid JSON */
+	bool ReadChatStreamFlag(const TArray<uint8>& Body, bool& bOutStream)
+	{
+		bOutStream = false;
+		FPlayKitJsonReader Reader(FPlayKitJsonReader::ToView(Body));
+		FUtf8StringView Key;
+		if (Reader.BeginObject())
+		{
+			while (Reader.NextMember(Key))
+			{
+				if (Key == UTF8TEXTVIEW("stream"))
+				{
+					Reader.ReadBool(bOutStream);
+				}
+				else
+				{
+					Reader.SkipValue();
+				}
+			}
+		}
+		return !Reader.HasError();
+	}
+
+	/** What the server reads from a chat request body */
+	struct FChatRequest
+	{
+		bool bStream = false;
+
+		/** Role and content of each message */
+		TArray<TPair<FString, FString>> Messages;
+
+		/** Present when the client syncs its history (PlayKitHistorySync.h) */
+		bool bHistory = false;
+		PlayKitHistorySync::FHeader History;
+	};
+
+	/** @return false if the body is not valid JSON */
+	bool ReadChatRequest(const TArray<uint8>& Body, FChatRequest& Out)
+	{
+		FPlayKitJsonReader Reader(FPlayKitJsonReader::ToView(Body));
+		FUtf8StringView Key;
+		if (Reader.BeginObject())
+		{
+			while (Reader.NextMember(Key))
+			{
+				if (Key == UTF8TEXTVIEW("stream"))
+				{
+					Reader.ReadBool(Out.bStream);
+				}
+				else if (Key == UTF8TEXTVIEW("messages") && Reader.BeginArray())
+				{
+					while (Reader.NextElement() && Reader.BeginObject())
+					{
+						TPair<FString, FString>& Message = Out.Messages.AddDefaulted_GetRef();
+						FUtf8StringView MessageKey;
+						while (Reader.NextMember(MessageKey))
+						{
+							if (MessageKey == UTF8TEXTVIEW("role"))
+							{
+								Reader.ReadString(Message.Key);
+							}
+							else if (MessageKey == UTF8TEXTVIEW("content"))
+							{
+								Reader.ReadString(Message.Value);
+							}
+							else
+							{
+								Reader.SkipValue();
+							}
+						}
+					}
+				}
+				else if (Key == UTF8TEXTVIEW("history") && Reader.BeginObject())
+				{
+					Out.bHistory = true;
+					FUtf8StringView HistoryKey;
+					while (Reader.NextMember(HistoryKey))
+					{
+						FString Hash;
+						if (HistoryKey == UTF8TEXTVIEW("id"))
+						{
+							Reader.ReadString(Out.History.Id);
+						}
+						else if (HistoryKey == UTF8TEXTVIEW("base"))
+						{
+							Reader.ReadInt(Out.History.Base);
+						}
+						else if (HistoryKey == UTF8TEXTVIEW("hash") && Reader.ReadString(Hash))
+						{
+							Out.History.Hash = FParse::HexNumber64(*Hash);
+						}
+						else
+						{
+							Reader.SkipValue();
+						}
+					}
+				}
+				else
+				{
+					Reader.SkipValue();
+				}
+			}
+		}
+		return !Reader.HasError();
+	}
+
+	/** Non-streamed chat completion */
+	void WriteChatCompletion(TArray<uint8>& Body, const FString& Content, int32 PromptTokens, int32 CompletionTokens)
+	{
+		FPlayKitJsonWriter Writer(Body);
+		Writer.BeginObject();
+		Writer.WriteString("id", TEXT("chatcmpl-mock"));
+		Writer.WriteString("object", TEXT("chat.completion"));
+		Writer.BeginArray("choices");
+		Writer.BeginObject();
+		Writer.WriteNumber("index", 0);
+		Writer.BeginObject("message");
+		Writer.WriteString("role", TEXT("assistant"));
+		Writer.WriteString("content", Content);
+		Writer.EndObject();
+		Writer.WriteString("finish_reason", TEXT("stop"));
+		Writer.EndObject();
+		Writer.EndArray();
+		Writer.BeginObject("usage");
+		Writer.WriteNumber("prompt_tokens", PromptTokens);
+		Writer.WriteNumber("completion_tokens", CompletionTokens);
+		Writer.WriteNumber("total_tokens", PromptTokens + CompletionTokens);
+		Writer.EndObject();
+		Writer.EndObject();
+	}
+
+	/** One text-delta stream event */
+	void WriteDeltaEvent(TArray<uint8>& Event, const FString& Delta)
+	{
+		Event.Reset();
+		AppendUtf8(Event, TEXT("data: {\"type\":\"text-delta\",\"id\":\"0\",\"delta\":"));
+		FPlayKitJsonWriter::AppendEscapedString(Event, Delta);
+		AppendUtf8(Event, TEXT("}\n\n"));
+	}
+
+	const FUtf8StringView StreamStartEvent = UTF8TEXTVIEW("data: {\"type\":\"start\",\"messageId\":\"msg-mock\"}\n\n");
+	const FUtf8StringView StreamFinishEvent = UTF8TEXTVIEW("data: {\"type\":\"finish\"}\n\ndata: [DONE]\n\n");
+
+	TArray<uint8> ToBytes(FUtf8StringView Text)
+	{
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Text.GetData()), Text.Len());
+	}
+
+	FString FromUtf8(const uint8* Data, int32 Num)
+	{
+		const FUTF8ToTCHAR Converted(reinterpret_cast<const ANSICHAR*>(Data), Num);
+		return FString(Converted.Length(), Converted.Get());
+	}
+
+	/** Appended to Sec-WebSocket-Key before hashing (RFC 6455) */
+	const TCHAR* WebSocketGuid = TEXT("258EAFA5-E914-47DA-95CA-C5AB0DC11B11");
+
+	// WebSocket opcodes
+	constexpr uint8 OpContinuation = 0x0;
+	constexpr uint8 OpText = 0x1;
+	constexpr uint8 OpBinary = 0x2;
+	constexpr uint8 OpClose = 0x8;
+	constexpr uint8 OpPing = 0x9;
+	constexpr uint8 OpPong = 0xA;
+}
+
+FPlayKitMockServer::FPlayKitMockServer(const FPlayKitMockServerConfig& InConfig)
+	: Config(InConfig)
+{
+}
+
+FPlayKitMockServer::~FPlayKitMockServer()
+{
+	Stop();
+}
+
+bool FPlayKitMockServer::Start()
+{
+	check(!Thread);
+
+	const FIPv4Endpoint Endpoint(FIPv4Address(127, 0, 0, 1), static_cast<uint16>(Config.Port));
+	ListenSocket = FTcpSocketBuilder(TEXT("PlayKitMockServer"))
+		.AsNonBlocking()
+		.AsReusable()
+		.BoundToEndpoint(Endpoint)
+		.Listening(256);
+
+	if (!ListenSocket)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[PlayKitMockServer] Could not listen on 127.0.0.1:%d"), Config.Port);
+		return false;
+	}
+
+	BoundPort = ListenSocket->GetPortNo();
+	FaultRandom.Initialize(Config.Seed);
+
+	// Noise does not compress, so the PNG is about as large as the image endpoint's real output
+	const int32 ImageSize = FMath::Max(1, Config.ImageSize);
+	TArray<FColor> Pixels;
+	Pixels.SetNumUninitialized(ImageSize * ImageSize);
+	FRandomStream PixelRandom(Config.Seed);
+	for (FColor& Pixel : Pixels)
+	{
+		Pixel = FColor(static_cast<uint32>(PixelRandom.GetUnsignedInt()) | 0xFF000000u);
+	}
+	TArray64<uint8> Png;
+	FImageUtils::PNGCompressImageArray(ImageSize, ImageSize, Pixels, Png);
+	ImageBase64 = FBase64::Encode(Png.GetData(), static_cast<uint32>(Png.Num()));
+
+	bStopping = false;
+	Thread = FRunnableThread::Create(this, TEXT("PlayKitMockServer"));
+
+	UE_LOG(LogTemp, Log, TEXT("[PlayKitMockServer] Listening on %s"), *GetBaseUrl());
+	return true;
+}
+
+void FPlayKitMockServer::Stop()
+{
+	if (Thread)
+	{
+		bStopping = true;
+		Thread->WaitForCompletion();
+		delete Thread;
+		Thread = nullptr;
+	}
+
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	for (const TUniquePtr<FConnection>& Connection : Connections)
+	{
+		Connection->Socket->Close();
+		SocketSubsystem->DestroySocket(Connection->Socket);
+	}
+	Connections.Reset();
+	Sessions.Reset();
+
+	if (ListenSocket)
+	{
+		ListenSocket->Close();
+		SocketSubsystem->DestroySocket(ListenSocket);
+		ListenSocket = nullptr;
+	}
+}
+
+FString FPlayKitMockServer::GetBaseUrl() const
+{
+	return FString::Printf(TEXT("http://127.0.0.1:%d"), BoundPort);
+}
+
+FString FPlayKitMockServer::GetSessionUrl() const
+{
+	return FString::Printf(TEXT("ws://127.0.0.1:%d/session/v1"), BoundPort);
+}
+
+uint32 FPlayKitMockServer::Run()
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+
+	while (!bStopping)
+	{
+		AcceptConnections();
+
+		const double Now = FPlatformTime::Seconds();
+		for (int32 Index = Connections.Num() - 1; Index >= 0; --Index)
+		{
+			if (!ServiceConnection(*Connections[Index], Now))
+			{
+				DetachSession(*Connections[Index], Now);
+				Connections[Index]->Socket->Close();
+				SocketSubsystem->DestroySocket(Connections[Index]->Socket);
+				Connections.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			}
+		}
+		ExpireSessions(Now);
+
+		// Token pacing needs about millisecond resolution; the loop itself costs nothing when idle
+		FPlatformProcess::SleepNoStats(0.001f);
+	}
+
+	return 0;
+}
+
+void FPlayKitMockServer::AcceptConnections()
+{
+	bool bHasPending = false;
+	while (ListenSocket->HasPendingConnection(bHasPending) && bHasPending)
+	{
+		FSocket* Socket = ListenSocket->Accept(TEXT("PlayKitMockConnection"));
+		if (!Socket)
+		{
+			break;
+		}
+
+		Socket->SetNonBlocking(true);
+		Socket->SetNoDelay(true);
+
+		TUniquePtr<FConnection> Connection = MakeUnique<FConnection>();
+		Connection->Socket = Socket;
+		Connections.Add(MoveTemp(Connection));
+	}
+}
+
+bool FPlayKitMockServer::ServiceConnection(FConnection& Connection, double Now)
+{
+	// Receive. Recv fails once the peer has closed; zero bytes means nothing is pending.
+	uint8 Buffer[16 * 1024];
+	for (;;)
+	{
+		int32 BytesRead = 0;
+		if (!Connection.Socket->Recv(Buffer, sizeof(Buffer), BytesRead))
+		{
+			return false;
+		}
+		if (BytesRead <= 0)
+		{
+			break;
+		}
+		Connection.Input.Append(Buffer, BytesRead);
+		if (Connection.Input.Num() > PlayKitMockServer::MaxRequestBytes)
+		{
+			return false;
+		}
+	}
+
+	// Answer one request at a time; pipelined requests wait in Input
+	if (Connection.bWebSocket)
+	{
+		if (!ServiceWebSocket(Connection, Now))
+		{
+			return false;
+		}
+	}
+	else if (!Connection.bResponding)
+	{
+		FRequest Request;
+		if (TryParseRequest(Connection.Input, Request))
+		{
+			++RequestCount;
+			Connection.bResponding = true;
+			Connection.bCloseWhenSent = !Request.bKeepAlive;
+			Respond(Connection, Request, Now);
+		}
+	}
+
+	// Move due writes to the output buffer
+	int32 NumDue = 0;
+	while (NumDue < Connection.Schedule.Num() && Connection.Schedule[NumDue].DueTime <= Now)
+	{
+		Connection.Output.Append(Connection.Schedule[NumDue].Bytes);
+		++NumDue;
+	}
+	if (NumDue > 0)
+	{
+		Connection.Schedule.RemoveAt(0, NumDue, EAllowShrinking::No);
+	}
+
+	// Send
+	while (Connection.OutputOffset < Connection.Output.Num())
+	{
+		// With MaxWriteBytes, one slice per loop iteration so the client sees separate reads
+		const int32 Pending = Connection.Output.Num() - Connection.OutputOffset;
+		const int32 SliceSize = Config.MaxWriteBytes > 0 ? FMath::Min(Pending, Config.MaxWriteBytes) : Pending;
+
+		int32 BytesSent = 0;
+		if (!Connection.Socket->Send(Connection.Output.GetData() + Connection.OutputOffset, SliceSize, BytesSent))
+		{
+			const ESocketErrors Error = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->GetLastErrorCode();
+			return Error == SE_EWOULDBLOCK;
+		}
+		if (BytesSent <= 0)
+		{
+			break;
+		}
+		Connection.OutputOffset += BytesSent;
+		if (Config.MaxWriteBytes > 0)
+		{
+			break;
+		}
+	}
+	if (Connection.OutputOffset >= Connection.Output.Num())
+	{
+		Connection.Output.Reset();
+		Connection.OutputOffset = 0;
+	}
+
+	// A closing WebSocket goes once its close frame is out
+	if (Connection.bWebSocket && Connection.bCloseWhenSent && Connection.Output.Num() == 0)
+	{
+		return false;
+	}
+
+	// Response complete
+	if (Connection.bResponding && Connection.Schedule.Num() == 0 && Connection.Output.Num() == 0)
+	{
+		Connection.bResponding = false;
+		if (Connection.bCloseWhenSent)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FPlayKitMockServer::TryParseRequest(TArray<uint8>& Input, FRequest& OutRequest)
+{
+	const int32 HeaderEnd = PlayKitMockServer::FindHeaderEnd(Input.GetData(), Input.Num());
+	if (HeaderEnd == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FString Head(FUTF8ToTCHAR(reinterpret_cast<const ANSICHAR*>(Input.GetData()), HeaderEnd));
+	TArray<FString> Lines;
+	Head.ParseIntoArray(Lines, TEXT("\r\n"), true);
+	if (Lines.Num() == 0)
+	{
+		return false;
+	}
+
+	TArray<FString> RequestLine;
+	Lines[0].ParseIntoArrayWS(RequestLine);
+	if (RequestLine.Num() < 2)
+	{
+		return false;
+	}
+
+	int32 ContentLength = 0;
+	bool bKeepAlive = RequestLine.Num() < 3 || RequestLine[2] != TEXT("HTTP/1.0");
+	for (int32 Index = 1; Index < Lines.Num(); ++Index)
+	{
+		FString Name;
+		FString Value;
+		if (!Lines[Index].Split(TEXT(":"), &Name, &Value))
+		{
+			continue;
+		}
+		Value.TrimStartAndEndInline();
+		if (Name.Equals(TEXT("Content-Length"), ESearchCase::IgnoreCase))
+		{
+			ContentLength = FCString::Atoi(*Value);
+		}
+		else if (Name.Equals(TEXT("Connection"), ESearchCase::IgnoreCase))
+		{
+			// "keep-alive, Upgrade" on a WebSocket handshake
+			bKeepAlive = !Value.Equals(TEXT("close"), ESearchCase::IgnoreCase);
+		}
+		else if (Name.Equals(TEXT("Sec-WebSocket-Key"), ESearchCase::IgnoreCase))
+		{
+			OutRequest.WebSocketKey = Value;
+		}
+		else if (Name.Equals(TEXT("Sec-WebSocket-Protocol"), ESearchCase::IgnoreCase))
+		{
+			OutRequest.WebSocketProtocol = Value;
+		}
+	}
+
+	if (Input.Num() < HeaderEnd + ContentLength)
+	{
+		return false;
+	}
+
+	OutRequest.Method = RequestLine[0];
+	OutRequest.Path = RequestLine[1];
+	OutRequest.bKeepAlive = bKeepAlive;
+	OutRequest.Body = TArray<uint8>(Input.GetData() + HeaderEnd, ContentLength);
+	Input.RemoveAt(0, HeaderEnd + ContentLength, EAllowShrinking::No);
+	return true;
+}
+
+void FPlayKitMockServer::Respond(FConnection& Connection, const FRequest& Request, double Now)
+{
+	// Query strings are not used by any route
+	FString Path = Request.Path;
+	int32 QueryStart = INDEX_NONE;
+	if (Path.FindChar(TEXT('?'), QueryStart))
+	{
+		Path.LeftInline(QueryStart);
+	}
+
+	TArray<FString> Segments;
+	Path.ParseIntoArray(Segments, TEXT("/"), true);
+
+	// /session/v1
+	if (Path == TEXT("/session/v1"))
+	{
+		if (Request.Method == TEXT("GET") && !Request.WebSocketKey.IsEmpty())
+		{
+			AcceptWebSocket(Connection, Request, Now);
+		}
+		else
+		{
+			ScheduleError(Connection, Now, 400, TEXT("INVALID_REQUEST"), TEXT("Expected a WebSocket upgrade"));
+		}
+		return;
+	}
+
+	// /mock/assets/{name}
+	if (Segments.Num() == 3 && Segments[0] == TEXT("mock") && Segments[1] == TEXT("assets") && Request.Method == TEXT("GET"))
+	{
+		RespondAsset(Connection, Now);
+		return;
+	}
+
+	// /ai/{game}/v2/{route...}
+	if (Segments.Num() < 4 || Segments[0] != TEXT("ai") || Segments[2] != TEXT("v2"))
+	{
+		ScheduleError(Connection, Now, 404, TEXT("NOT_FOUND"), FString::Printf(TEXT("No mock route for %s %s"), *Request.Method, *Path));
+		return;
+	}
+
+	const EFault Fault = RollFault();
+	FReply FaultReply;
+	if (MakeFaultReply(Fault, Now, FaultReply))
+	{
+		ScheduleReply(Connection, FaultReply);
+		return;
+	}
+
+	const bool bStall = Fault == EFault::Stall;
+	const double ReplyTime = Now + Config.LatencyMs / 1000.0 + (bStall ? Config.StallSeconds : 0.0);
+	const FString& Route = Segments[3];
+
+	if (Request.Method == TEXT("POST") && Segments.Num() == 4 && Route == TEXT("chat"))
+	{
+		RespondChat(Connection, Request, Now, bStall);
+	}
+	else if (Request.Method == TEXT("POST") && Segments.Num() == 4 && Route == TEXT("image"))
+	{
+		RespondImage(Connection, Request, ReplyTime);
+	}
+	else if (Request.Method == TEXT("POST") && Segments.Num() == 5 && Route == TEXT("audio") && Segments[4] == TEXT("transcriptions"))
+	{
+		RespondTranscription(Connection, ReplyTime);
+	}
+	else if (Request.Method == TEXT("POST") && Segments.Num() == 4 && Route == TEXT("3d"))
+	{
+		RespondCreateTask(Connection, Now, ReplyTime);
+	}
+	else if (Request.Method == TEXT("GET") && Segments.Num() == 5 && Route == TEXT("3d"))
+	{
+		RespondPollTask(Connection, Segments[4], Now, ReplyTime);
+	}
+	else
+	{
+		ScheduleError(Connection, Now, 404, TEXT("NOT_FOUND"), FString::Printf(TEXT("No mock route for %s %s"), *Request.Method, *Path));
+	}
+}
+
+FPlayKitMockServer::EFault FPlayKitMockServer::RollFault()
+{
+	const double Roll = FaultRandom.FRand();
+	EFault Fault = EFault::None;
+	if (Roll < Config.RateLimitRate)
+	{
+		Fault = EFault::RateLimit;
+	}
+	else if (Roll < Config.RateLimitRate + Config.ServerErrorRate)
+	{
+		Fault = EFault::ServerError;
+	}
+	else if (Roll < Config.RateLimitRate + Config.ServerErrorRate + Config.StallRate)
+	{
+		Fault = EFault::Stall;
+	}
+
+	if (Fault != EFault::None)
+	{
+		++InjectedFaultCount;
+	}
+	return Fault;
+}
+
+bool FPlayKitMockServer::MakeFaultReply(EFault Fault, double Now, FReply& OutReply) const
+{
+	if (Fault == EFault::RateLimit)
+	{
+		MakeErrorReply(OutReply, Now + Config.LatencyMs / 1000.0, 429, TEXT("RATE_LIMITED"), TEXT("Injected rate limit"),
+			FString::Printf(TEXT("Retry-After: %d\r\n"), Config.RetryAfterSeconds));
+		return true;
+	}
+	if (Fault == EFault::ServerError)
+	{
+		// Alternate between the two status codes gateways actually return
+		const bool bUnavailable = (InjectedFaultCount.load() % 2) == 0;
+		MakeErrorReply(OutReply, Now + Config.LatencyMs / 1000.0, bUnavailable ? 503 : 500,
+			bUnavailable ? TEXT("SERVICE_UNAVAILABLE") : TEXT("INTERNAL_ERROR"), TEXT("Injected server error"));
+		return true;
+	}
+	return false;
+}
+
+void FPlayKitMockServer::RespondChat(FConnection& Connection, const FRequest& Request, double Now, bool bStall)
+{
+	FReply Reply;
+	MakeChatReply(Request.Body, Now, bStall, Reply);
+	ScheduleReply(Connection, Reply);
+}
+
+void FPlayKitMockServer::MakeChatReply(const TArray<uint8>& RequestBody, double Now, bool bStall, FReply& OutReply)
+{
+	ChatRequestBytes += RequestBody.Num();
+
+	// The reply does not depend on the conversation; a synced history is only verified
+	PlayKitMockServer::FChatRequest Chat;
+	if (!PlayKitMockServer::ReadChatRequest(RequestBody, Chat))
+	{
+		MakeErrorReply(OutReply, Now, 400, TEXT("INVALID_REQUEST"), TEXT("Request body is not valid JSON"));
+		return;
+	}
+	const bool bStream = Chat.bStream;
+
+	const double FirstTokenTime = Now + Config.LatencyMs / 1000.0;
+	if (Chat.bHistory && !ApplyHistory(Chat.History, Chat.Messages))
+	{
+		++HistoryMismatchCount;
+		MakeErrorReply(OutReply, FirstTokenTime, 409, PlayKitHistorySync::MismatchCode,
+			FString::Printf(TEXT("History %s does not hold %d messages with hash %s"), *Chat.History.Id, Chat.History.Base,
+				*PlayKitHistorySync::ToString(Chat.History.Hash)));
+		return;
+	}
+	const int32 NumTokens = FMath::Max(1, Config.TokensPerResponse);
+
+	if (!bStream)
+	{
+		OutReply.ContentType = TEXT("application/json");
+		OutReply.HeadTime = FirstTokenTime + (bStall ? Config.StallSeconds : 0.0);
+		FScheduledWrite& Piece = OutReply.Pieces.AddDefaulted_GetRef();
+		Piece.DueTime = OutReply.HeadTime;
+		PlayKitMockServer::WriteChatCompletion(Piece.Bytes, MakeReplyText(NumTokens), RequestBody.Num() / 4, NumTokens);
+		return;
+	}
+
+	// Headers right away, then paced events
+	OutReply.ContentType = TEXT("text/event-stream");
+	OutReply.HeadTime = Now;
+	OutReply.bStream = true;
+	OutReply.Pieces.Add({ FirstTokenTime, PlayKitMockServer::ToBytes(PlayKitMockServer::StreamStartEvent) });
+
+	const double TokenInterval = Config.TokensPerSecond > 0.0 ? 1.0 / Config.TokensPerSecond : 0.0;
+	const int32 TokensPerEvent = FMath::Max(1, Config.TokensPerEvent);
+	double EventTime = FirstTokenTime;
+	for (int32 First = 0; First < NumTokens; First += TokensPerEvent)
+	{
+		const int32 Count = FMath::Min(TokensPerEvent, NumTokens - First);
+		FString Delta;
+		for (int32 Index = First; Index < First + Count; ++Index)
+		{
+			Delta += MakeReplyToken(Index);
+		}
+
+		// An event is sent once its last token has been "generated"
+		EventTime = FirstTokenTime + (First + Count - 1) * TokenInterval;
+		if (bStall && First >= NumTokens / 2)
+		{
+			EventTime += Config.StallSeconds;
+		}
+
+		FScheduledWrite& Piece = OutReply.Pieces.AddDefaulted_GetRef();
+		Piece.DueTime = EventTime;
+		PlayKitMockServer::WriteDeltaEvent(Piece.Bytes, Delta);
+	}
+
+	OutReply.Pieces.Add({ EventTime, PlayKitMockServer::ToBytes(PlayKitMockServer::StreamFinishEvent) });
+}
+
+bool FPlayKitMockServer::ApplyHistory(const PlayKitHistorySync::FHeader& History, TConstArrayView<TPair<FString, FString>> Messages)
+{
+	// Ids are never retired by the client; forgetting them all only costs each a full upload
+	if (Histories.Num() >= MaxHistories && !Histories.Contains(History.Id))
+	{
+		Histories.Reset();
+	}
+
+	TArray<uint64>& Hashes = Histories.FindOrAdd(History.Id);
+	int32 First = 0;
+	if (History.Base <= 0)
+	{
+		// A full upload; the system message is not part of the history
+		Hashes.Reset();
+		if (Messages.Num() > 0 && Messages[0].Key == TEXT("system"))
+		{
+			First = 1;
+		}
+	}
+	else if (History.Base > Hashes.Num() || Hashes[History.Base - 1] != History.Hash)
+	{
+		return false;
+	}
+	else
+	{
+		Hashes.SetNum(History.Base);
+	}
+
+	for (int32 Index = First; Index < Messages.Num(); ++Index)
+	{
+		const uint64 Previous = Hashes.Num() > 0 ? Hashes.Last() : PlayKitHistorySync::EmptyHash;
+		Hashes.Add(PlayKitHistorySync::Chain(Previous, Messages[Index].Key, Messages[Index].Value));
+	}
+	return true;
+}
+
+FPlayKitLoopbackTransport::FHandler FPlayKitMockServer::MakeLoopbackHandler(const FPlayKitMockServerConfig& Config)
+{
+	const int32 NumTokens = FMath::Max(1, Config.TokensPerResponse);
+	const int32 TokensPerEvent = FMath::Max(1, Config.TokensPerEvent);
+
+	return [NumTokens, TokensPerEvent](const IHttpRequest& Request, FPlayKitLoopbackReply& Reply)
+	{
+		bool bStream = false;
+		if (Request.GetVerb() != TEXT("POST") || !Request.GetURL().EndsWith(TEXT("/v2/chat")))
+		{
+			Reply.StatusCode = 404;
+			Reply.AddChunk(FString::Printf(TEXT("{\"code\":\"NOT_FOUND\",\"message\":\"No loopback route for %s\"}"), *Request.GetURL()));
+			return;
+		}
+		if (!PlayKitMockServer::ReadChatStreamFlag(Request.GetContent(), bStream))
+		{
+			Reply.StatusCode = 400;
+			Reply.AddChunk(TEXTVIEW("{\"code\":\"INVALID_REQUEST\",\"message\":\"Request body is not valid JSON\"}"));
+			return;
+		}
+
+		if (!bStream)
+		{
+			TArray<uint8> Body;
+			FString Content;
+			for (int32 Index = 0; Index < NumTokens; ++Index)
+			{
+				Content += MakeReplyToken(Index);
+			}
+			PlayKitMockServer::WriteChatCompletion(Body, Content, Request.GetContent().Num() / 4, NumTokens);
+			Reply.AddChunk(MoveTemp(Body));
+			return;
+		}
+
+		Reply.ContentType = TEXT("text/event-stream");
+		Reply.AddChunk(PlayKitMockServer::StreamStartEvent);
+		for (int32 First = 0; First < NumTokens; First += TokensPerEvent)
+		{
+			FString Delta;
+			for (int32 Index = First; Index < FMath::Min(First + TokensPerEvent, NumTokens); ++Index)
+			{
+				Delta += MakeReplyToken(Index);
+			}
+
+			TArray<uint8> Event;
+			PlayKitMockServer::WriteDeltaEvent(Event, Delta);
+			Reply.AddChunk(MoveTemp(Event));
+		}
+		Reply.AddChunk(PlayKitMockServer::StreamFinishEvent);
+	};
+}
+
+void FPlayKitMockServer::RespondImage(FConnection& Connection, const FRequest& Request, double ReplyTime)
+{
+	int32 Count = 1;
+	FPlayKitJsonReader Reader(FPlayKitJsonReader::ToView(Request.Body));
+	FUtf8StringView Key;
+	if (Reader.BeginObject())
+	{
+		while (Reader.NextMember(Key))
+		{
+			if (Key == UTF8TEXTVIEW("n"))
+			{
+				Reader.ReadInt(Count);
+			}
+			else
+			{
+				Reader.SkipValue();
+			}
+		}
+	}
+
+	TArray<uint8> Body;
+	FPlayKitJsonWriter Writer(Body);
+	Writer.BeginObject();
+	Writer.WriteNumber("created", FDateTime::UtcNow().ToUnixTimestamp());
+	Writer.BeginArray("data");
+	for (int32 Index = 0; Index < FMath::Clamp(Count, 1, 10); ++Index)
+	{
+		Writer.BeginObject();
+		Writer.WriteString("b64_json", ImageBase64);
+		Writer.WriteString("revised_prompt", TEXT("A mock image"));
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+	Writer.EndObject();
+
+	ScheduleResponse(Connection, ReplyTime, 200, TEXT("application/json"), Body);
+}
+
+void FPlayKitMockServer::RespondTranscription(FConnection& Connection, double ReplyTime)
+{
+	const int32 NumTokens = FMath::Max(1, Config.TokensPerResponse);
+	const double Duration = NumTokens * 0.4;
+
+	TArray<uint8> Body;
+	FPlayKitJsonWriter Writer(Body);
+	Writer.BeginObject();
+	Writer.WriteString("text", MakeReplyText(NumTokens));
+	Writer.WriteString("language", TEXT("en"));
+	Writer.WriteNumber("duration", Duration);
+	Writer.BeginArray("segments");
+	constexpr int32 TokensPerSegment = 10;
+	for (int32 First = 0; First < NumTokens; First += TokensPerSegment)
+	{
+		FString Text;
+		for (int32 Index = First; Index < FMath::Min(First + TokensPerSegment, NumTokens); ++Index)
+		{
+			Text += MakeReplyToken(Index);
+		}
+		Writer.BeginObject();
+		Writer.WriteNumber("start", First * 0.4);
+		Writer.WriteNumber("end", FMath::Min(First + TokensPerSegment, NumTokens) * 0.4);
+		Writer.WriteString("text", Text.TrimEnd());
+		Writer.EndObject();
+	}
+	Writer.EndArray();
+	Writer.EndObject();
+
+	ScheduleResponse(Connection, ReplyTime, 200, TEXT("application/json"), Body);
+}
+
+void FPlayKitMockServer::RespondCreateTask(FConnection& Connection, double Now, double ReplyTime)
+{
+	const FString TaskId = FString::Printf(TEXT("mock-task-%d"), NextTaskId++);
+	TaskCreateTimes.Add(TaskId, Now);
+
+	TArray<uint8> Body;
+	FPlayKitJsonWriter Writer(Body);
+	Writer.BeginObject();
+	Writer.WriteString("task_id", TaskId);
+	Writer.WriteString("status", TEXT("queued"));
+	Writer.WriteNumber("progress", 0);
+	Writer.WriteNumber("poll_interval", 1);
+	Writer.EndObject();
+
+	ScheduleResponse(Connection, ReplyTime, 200, TEXT("application/json"), Body);
+}
+
+void FPlayKitMockServer::RespondPollTask(FConnection& Connection, const FString& TaskId, double Now, double ReplyTime)
+{
+	const double* CreateTime = TaskCreateTimes.Find(TaskId);
+	if (!CreateTime)
+	{
+		ScheduleError(Connection, ReplyTime, 404, TEXT("TASK_NOT_FOUND"), FString::Printf(TEXT("Unknown task %s"), *TaskId));
+		return;
+	}
+
+	const double Fraction = Config.TaskSeconds > 0.0 ? (Now - *CreateTime) / Config.TaskSeconds : 1.0;
+	const int32 Progress = FMath::Clamp(FMath::FloorToInt(Fraction * 100.0), 0, 100);
+	const TCHAR* Status = Progress >= 100 ? TEXT("success") : (Progress < 10 ? TEXT("queued") : TEXT("running"));
+
+	TArray<uint8> Body;
+	FPlayKitJsonWriter Writer(Body);
+	Writer.BeginObject();
+	Writer.WriteString("task_id", TaskId);
+	Writer.WriteString("status", Status);
+	Writer.WriteNumber("progress", Progress);
+	Writer.WriteNumber("poll_interval", 1);
+	if (Progress >= 100)
+	{
+		const FString AssetUrl = GetBaseUrl() / TEXT("mock/assets") / TaskId;
+		const int64 CreatedAt = FDateTime::UtcNow().ToUnixTimestamp() - static_cast<int64>(Now - *CreateTime);
+		Writer.WriteNumber("created_at", CreatedAt);
+		Writer.WriteNumber("completed_at", CreatedAt + static_cast<int64>(Config.TaskSeconds));
+		Writer.BeginObject("output");
+		Writer.WriteString("model", AssetUrl + TEXT(".glb"));
+		Writer.WriteString("pbr_model", AssetUrl + TEXT("_pbr.glb"));
+		Writer.WriteString("rendered_image", AssetUrl + TEXT(".png"));
+		Writer.EndObject();
+	}
+	Writer.EndObject();
+
+	ScheduleResponse(Connection, ReplyTime, 200, TEXT("application/json"), Body);
+}
+
+void FPlayKitMockServer::RespondAsset(FConnection& Connection, double Now)
+{
+	TArray<uint8> Body;
+	Body.SetNumUninitialized(FMath::Max(0, Config.ModelBytes));
+	for (int32 Index = 0; Index < Body.Num(); ++Index)
+	{
+		Body[Index] = static_cast<uint8>(Index * 131);
+	}
+	ScheduleResponse(Connection, Now + Config.LatencyMs / 1000.0, 200, TEXT("application/octet-stream"), Body);
+}
+
+void FPlayKitMockServer::AcceptWebSocket(FConnection& Connection, const FRequest& Request, double Now)
+{
+	const FTCHARToUTF8 Key(*(Request.WebSocketKey + PlayKitMockServer::WebSocketGuid));
+	uint8 Hash[FSHA1::DigestSize];
+	FSHA1::HashBuffer(Key.Get(), Key.Length(), Hash);
+
+	const FString ProtocolHeader = Request.WebSocketProtocol.Contains(PlayKitSession::Protocol)
+		? FString::Printf(TEXT("Sec-WebSocket-Protocol: %s\r\n"), PlayKitSession::Protocol)
+		: FString();
+
+	TArray<uint8> Head;
+	PlayKitMockServer::AppendUtf8(Head, FString::Printf(TEXT("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Accept: %s\r\n%s\r\n"),
+		*FBase64::Encode(Hash, FSHA1::DigestSize), *ProtocolHeader));
+	Connection.Schedule.Add({ Now, MoveTemp(Head) });
+
+	// Frames from here on; the session starts with the client's Attach
+	Connection.bWebSocket = true;
+	Connection.UpgradeTime = Now;
+	Connection.bResponding = false;
+	Connection.bCloseWhenSent = false;
+}
+
+bool FPlayKitMockServer::ServiceWebSocket(FConnection& Connection, double Now)
+{
+	if (Config.SessionDropSeconds > 0.0 && Now - Connection.UpgradeTime >= Config.SessionDropSeconds)
+	{
+		// Abrupt, like a network change: no close frame
+		return false;
+	}
+
+	// Client frames; RFC 6455 requires them to be masked
+	int32 Offset = 0;
+	while (!Connection.bCloseWhenSent)
+	{
+		const uint8* Data = Connection.Input.GetData() + Offset;
+		const int32 Available = Connection.Input.Num() - Offset;
+		if (Available < 2)
+		{
+			break;
+		}
+
+		const bool bFinal = (Data[0] & 0x80) != 0;
+		const uint8 Opcode = Data[0] & 0x0F;
+		const bool bMasked = (Data[1] & 0x80) != 0;
+		uint64 Length = Data[1] & 0x7F;
+		int32 HeaderSize = 2;
+		if (Length == 126)
+		{
+			if (Available < 4)
+			{
+				break;
+			}
+			Length = (uint64(Data[2]) << 8) | uint64(Data[3]);
+			HeaderSize = 4;
+		}
+		else if (Length == 127)
+		{
+			if (Available < 10)
+			{
+				break;
+			}
+			Length = 0;
+			for (int32 Index = 2; Index < 10; ++Index)
+			{
+				Length = (Length << 8) | uint64(Data[Index]);
+			}
+			HeaderSize = 10;
+		}
+		if (!bMasked || Length > uint64(PlayKitMockServer::MaxRequestBytes))
+		{
+			return false;
+		}
+
+		const int32 FrameSize = HeaderSize + 4 + static_cast<int32>(Length);
+		if (Available < FrameSize)
+		{
+			break;
+		}
+
+		const uint8* Mask = Data + HeaderSize;
+		const uint8* Masked = Mask + 4;
+		TArray<uint8> Payload;
+		Payload.SetNumUninitialized(static_cast<int32>(Length));
+		for (int32 Index = 0; Index < Payload.Num(); ++Index)
+		{
+			Payload[Index] = Masked[Index] ^ Mask[Index & 3];
+		}
+		Offset += FrameSize;
+
+		switch (Opcode)
+		{
+		case PlayKitMockServer::OpContinuation:
+		case PlayKitMockServer::OpText:
+		case PlayKitMockServer::OpBinary:
+			Connection.Message.Append(Payload);
+			if (bFinal)
+			{
+				HandleSessionFrame(Connection, Connection.Message.GetData(), Connection.Message.Num(), Now);
+				Connection.Message.Reset();
+			}
+			break;
+		case PlayKitMockServer::OpClose:
+			// Echo the status code, then close once it is out
+			SendWebSocketFrame(Connection, PlayKitMockServer::OpClose, Payload.GetData(), FMath::Min(Payload.Num(), 2));
+			Connection.bCloseWhenSent = true;
+			break;
+		case PlayKitMockServer::OpPing:
+			SendWebSocketFrame(Connection, PlayKitMockServer::OpPong, Payload.GetData(), Payload.Num());
+			break;
+		default:
+			break;
+		}
+	}
+	if (Offset > 0)
+	{
+		Connection.Input.RemoveAt(0, Offset, EAllowShrinking::No);
+	}
+
+	FSession* Session = Sessions.Find(Connection.SessionId);
+	if (Session && Session->Connection == &Connection && !Connection.bCloseWhenSent)
+	{
+		ServiceSession(Connection, *Session, Now);
+	}
+	return true;
+}
+
+void FPlayKitMockServer::HandleSessionFrame(FConnection& Connection, const uint8* Data, int32 Num, double Now)
+{
+	using PlayKitSession::EOp;
+
+	PlayKitSession::FFrame Frame;
+	if (!PlayKitSession::ReadFrame(Data, Num, Frame))
+	{
+		return;
+	}
+
+	if (Frame.Op == EOp::Attach)
+	{
+		FString SessionId = PlayKitMockServer::FromUtf8(Frame.Payload, Frame.PayloadSize);
+		FSession* Session = SessionId.IsEmpty() ? nullptr : Sessions.Find(SessionId);
+		if (!Session)
+		{
+			SessionId = FString::Printf(TEXT("mock-session-%d"), NextSessionId++);
+			Session = &Sessions.Add(SessionId);
+		}
+		else if (Session->Connection && Session->Connection != &Connection)
+		{
+			// The client reconnected before the server noticed the old connection was gone
+			Session->Connection->SessionId.Reset();
+		}
+
+		Session->Connection = &Connection;
+		Connection.SessionId = SessionId;
+
+		// Replies continue once the client says where it got to
+		for (TPair<uint32, FSessionStream>& Stream : Session->Streams)
+		{
+			Stream.Value.bDetached = true;
+		}
+
+		TArray<uint8> Payload;
+		PlayKitMockServer::AppendUtf8(Payload, SessionId);
+		TArray<uint8> Hello;
+		PlayKitSession::WriteFrame(Hello, EOp::Hello, 0, 0, Payload.GetData(), Payload.Num());
+		SendSessionFrame(Connection, Hello);
+		return;
+	}
+
+	// Everything else needs an attached session
+	FSession* Session = Sessions.Find(Connection.SessionId);
+	if (!Session || Session->Connection != &Connection)
+	{
+		return;
+	}
+
+	switch (Frame.Op)
+	{
+	case EOp::Request:
+	{
+		++RequestCount;
+		const int32 HeadSize = FMath::Min(static_cast<int32>(Frame.Arg), Frame.PayloadSize);
+		const FString Head = PlayKitMockServer::FromUtf8(Frame.Payload, HeadSize);
+		const TArray<uint8> Body(Frame.Payload + HeadSize, Frame.PayloadSize - HeadSize);
+
+		FString RequestLine = Head;
+		Head.Split(TEXT("\r\n"), &RequestLine, nullptr);
+		TArray<FString> Parts;
+		RequestLine.ParseIntoArrayWS(Parts);
+
+		FString Path = Parts.Num() >= 2 ? Parts[1] : FString();
+		int32 QueryStart = INDEX_NONE;
+		if (Path.FindChar(TEXT('?'), QueryStart))
+		{
+			Path.LeftInline(QueryStart);
+		}
+		TArray<FString> Segments;
+		Path.ParseIntoArray(Segments, TEXT("/"), true);
+
+		FSessionStream& Stream = Session->Streams.Add(Frame.Stream);
+
+		// Only the chat route is carried; /ai/{game}/v2/chat
+		const bool bChat = Parts.Num() >= 2 && Parts[0] == TEXT("POST") && Segments.Num() == 4
+			&& Segments[0] == TEXT("ai") && Segments[2] == TEXT("v2") && Segments[3] == TEXT("chat");
+		if (!bChat)
+		{
+			MakeErrorReply(Stream.Reply, Now, 404, TEXT("NOT_FOUND"), FString::Printf(TEXT("No session route for %s"), *RequestLine));
+			break;
+		}
+
+		const EFault Fault = RollFault();
+		if (!MakeFaultReply(Fault, Now, Stream.Reply))
+		{
+			MakeChatReply(Body, Now, Fault == EFault::Stall, Stream.Reply);
+		}
+		break;
+	}
+	case EOp::Cancel:
+		Session->Streams.Remove(Frame.Stream);
+		break;
+	case EOp::Resume:
+	{
+		FSessionStream* Stream = Session->Streams.Find(Frame.Stream);
+		if (!Stream || static_cast<int64>(Frame.Arg) > Stream->Body.Num())
+		{
+			Session->Streams.Remove(Frame.Stream);
+			TArray<uint8> Gone;
+			PlayKitSession::WriteFrame(Gone, EOp::Gone, Frame.Stream, 0);
+			SendSessionFrame(Connection, Gone);
+			break;
+		}
+
+		// Head and End are sent again; the client ignores what it already has
+		Stream->bDetached = false;
+		Stream->bHeadSent = false;
+		Stream->SentOffset = static_cast<int32>(Frame.Arg);
+		Stream->EndTime = 0.0;
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+void FPlayKitMockServer::ServiceSession(FConnection& Connection, FSession& Session, double Now)
+{
+	using PlayKitSession::EOp;
+
+	for (TMap<uint32, FSessionStream>::TIterator It = Session.Streams.CreateIterator(); It; ++It)
+	{
+		const uint32 StreamId = It.Key();
+		FSessionStream& Stream = It.Value();
+
+		// Generation runs on schedule whether or not the client is attached
+		TArray<FScheduledWrite>& Pieces = Stream.Reply.Pieces;
+		int32 NumDue = 0;
+		while (NumDue < Pieces.Num() && Pieces[NumDue].DueTime <= Now)
+		{
+			Stream.Body.Append(Pieces[NumDue].Bytes);
+			++NumDue;
+		}
+		if (NumDue > 0)
+		{
+			Pieces.RemoveAt(0, NumDue, EAllowShrinking::No);
+		}
+
+		if (Stream.EndTime > 0.0)
+		{
+			if (Now - Stream.EndTime > Config.SessionTimeoutSeconds)
+			{
+				It.RemoveCurrent();
+			}
+			continue;
+		}
+		if (Stream.bDetached || Now < Stream.Reply.HeadTime)
+		{
+			continue;
+		}
+
+		TArray<uint8> Frame;
+		if (!Stream.bHeadSent)
+		{
+			TArray<uint8> Headers;
+			PlayKitMockServer::AppendUtf8(Headers, FString::Printf(TEXT("Content-Type: %s\r\n%s"), *Stream.Reply.ContentType, *Stream.Reply.ExtraHeaders));
+			PlayKitSession::WriteFrame(Frame, EOp::Head, StreamId, static_cast<uint32>(Stream.Reply.StatusCode), Headers.GetData(), Headers.Num());
+			SendSessionFrame(Connection, Frame);
+			Stream.bHeadSent = true;
+		}
+
+		if (Stream.SentOffset < Stream.Body.Num())
+		{
+			Frame.Reset();
+			PlayKitSession::WriteFrame(Frame, EOp::Data, StreamId, static_cast<uint32>(Stream.SentOffset),
+				Stream.Body.GetData() + Stream.SentOffset, Stream.Body.Num() - Stream.SentOffset);
+			SendSessionFrame(Connection, Frame);
+			Stream.SentOffset = Stream.Body.Num();
+		}
+
+		if (Pieces.Num() == 0)
+		{
+			Frame.Reset();
+			PlayKitSession::WriteFrame(Frame, EOp::End, StreamId, 0);
+			SendSessionFrame(Connection, Frame);
+			Stream.EndTime = Now;
+		}
+	}
+}
+
+void FPlayKitMockServer::DetachSession(FConnection& Connection, double Now)
+{
+	FSession* Session = Connection.SessionId.IsEmpty() ? nullptr : Sessions.Find(Connection.SessionId);
+	if (Session && Session->Connection == &Connection)
+	{
+		Session->Connection = nullptr;
+		Session->DetachedTime = Now;
+	}
+}
+
+void FPlayKitMockServer::ExpireSessions(double Now)
+{
+	for (TMap<FString, FSession>::TIterator It = Sessions.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().Connection && Now - It.Value().DetachedTime > Config.SessionTimeoutSeconds)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FPlayKitMockServer::SendWebSocketFrame(FConnection& Connection, uint8 Opcode, const uint8* Data, int32 Num)
+{
+	// Server frames are unmasked and never fragmented
+	TArray<uint8>& Out = Connection.Output;
+	Out.Add(0x80 | Opcode);
+	if (Num < 126)
+	{
+		Out.Add(static_cast<uint8>(Num));
+	}
+	else if (Num <= 0xFFFF)
+	{
+		Out.Add(126);
+		Out.Add(static_cast<uint8>(Num >> 8));
+		Out.Add(static_cast<uint8>(Num));
+	}
+	else
+	{
+		Out.Add(127);
+		for (int32 Shift = 56; Shift >= 0; Shift -= 8)
+		{
+			Out.Add(static_cast<uint8>(static_cast<uint64>(Num) >> Shift));
+		}
+	}
+	Out.Append(Data, Num);
+}
+
+void FPlayKitMockServer::SendSessionFrame(FConnection& Connection, const TArray<uint8>& Frame)
+{
+	SendWebSocketFrame(Connection, PlayKitMockServer::OpBinary, Frame.GetData(), Frame.Num());
+}
+
+void FPlayKitMockServer::ScheduleResponse(FConnection& Connection, double DueTime, int32 StatusCode, const TCHAR* ContentType,
+	const TArray<uint8>& Body, const FString& ExtraHeaders)
+{
+	FScheduledWrite& Write = Connection.Schedule.AddDefaulted_GetRef();
+	Write.DueTime = DueTime;
+	PlayKitMockServer::AppendUtf8(Write.Bytes, FString::Printf(TEXT("HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %d\r\n%s%s\r\n"),
+		StatusCode, PlayKitMockServer::ReasonPhrase(StatusCode), ContentType, Body.Num(), *ExtraHeaders,
+		Connection.bCloseWhenSent ? TEXT("Connection: close\r\n") : TEXT("")));
+	Write.Bytes.Append(Body);
+}
+
+void FPlayKitMockServer::ScheduleError(FConnection& Connection, double DueTime, int32 StatusCode, const TCHAR* Code, const FString& Message,
+	const FString& ExtraHeaders)
+{
+	FReply Reply;
+	MakeErrorReply(Reply, DueTime, StatusCode, Code, Message, ExtraHeaders);
+	ScheduleReply(Connection, Reply);
+}
+
+void FPlayKitMockServer::MakeErrorReply(FReply& OutReply, double DueTime, int32 StatusCode, const TCHAR* Code, const FString& Message,
+	const FString& ExtraHeaders)
+{
+	OutReply = FReply();
+	OutReply.StatusCode = StatusCode;
+	OutReply.ContentType = TEXT("application/json");
+	OutReply.ExtraHeaders = ExtraHeaders;
+	OutReply.HeadTime = DueTime;
+
+	FScheduledWrite& Piece = OutReply.Pieces.AddDefaulted_GetRef();
+	Piece.DueTime = DueTime;
+	FPlayKitJsonWriter Writer(Piece.Bytes);
+	Writer.BeginObject();
+	Writer.BeginObject("error");
+	Writer.WriteString("code", Code);
+	Writer.WriteString("message", Message);
+	Writer.EndObject();
+	Writer.EndObject();
+}
+
+void FPlayKitMockServer::ScheduleChunk(FConnection& Connection, double DueTime, FUtf8StringView Data)
+{
+	FScheduledWrite& Write = Connection.Schedule.AddDefaulted_GetRef();
+	Write.DueTime = DueTime;
+	PlayKitMockServer::AppendUtf8(Write.Bytes, FString::Printf(TEXT("%x\r\n"), Data.Len()));
+	Write.Bytes.Append(reinterpret_cast<const uint8*>(Data.GetData()), Data.Len());
+	Write.Bytes.Append(reinterpret_cast<const uint8*>("\r\n"), 2);
+}
+
+void FPlayKitMockServer::ScheduleReply(FConnection& Connection, const FReply& Reply)
+{
+	if (!Reply.bStream)
+	{
+		TArray<uint8> Body;
+		for (const FScheduledWrite& Piece : Reply.Pieces)
+		{
+			Body.Append(Piece.Bytes);
+		}
+		ScheduleResponse(Connection, Reply.HeadTime, Reply.StatusCode, *Reply.ContentType, Body, Reply.ExtraHeaders);
+		return;
+	}
+
+	TArray<uint8> Head;
+	PlayKitMockServer::AppendUtf8(Head, FString::Printf(TEXT("HTTP/1.1 %d %s\r\nContent-Type: %s\r\nCache-Control: no-cache\r\nTransfer-Encoding: chunked\r\n%s\r\n"),
+		Reply.StatusCode, PlayKitMockServer::ReasonPhrase(Reply.StatusCode), *Reply.ContentType, *Reply.ExtraHeaders));
+	Connection.Schedule.Add({ Reply.HeadTime, MoveTemp(Head) });
+
+	double LastTime = Reply.HeadTime;
+	for (const FScheduledWrite& Piece : Reply.Pieces)
+	{
+		ScheduleChunk(Connection, Piece.DueTime, FUtf8StringView(reinterpret_cast<const UTF8CHAR*>(Piece.Bytes.GetData()), Piece.Bytes.Num()));
+		LastTime = Piece.DueTime;
+	}
+
+	// Terminating chunk
+	TArray<uint8> Tail;
+	PlayKitMockServer::AppendUtf8(Tail, TEXT("0\r\n\r\n"));
+	Connection.Schedule.Add({ LastTime, MoveTemp(Tail) });
+}
+
+FString FPlayKitMockServer::MakeReplyText(int32 NumTokens) const
+{
+	FString Text;
+	for (int32 Index = 0; Index < NumTokens; ++Index)
+	{
+		Text += MakeReplyToken(Index);
+	}
+	return Text;
+}
+
+FString FPlayKitMockServer::MakeReplyToken(int32 Index)
+{
+	// Includes non-ASCII words so multi-byte sequences cross write boundaries when MaxWriteBytes is small
+	static const TCHAR* Words[] = {
+		TEXT("Aye"), TEXT("the"), TEXT("forge"), TEXT("runs"), TEXT("hot"), TEXT("today,"), TEXT("traveler."),
+		TEXT("Bring"), TEXT("me"), TEXT("iron"), TEXT("and"), TEXT("I'll"), TEXT("make"), TEXT("it"), TEXT("sing"),
+		TEXT("\u2014"), TEXT("caf\u00E9"), TEXT("\u9435\u5320.")
+	};
+	return FString::Printf(TEXT("%s "), Words[Index % UE_ARRAY_COUNT(Words)]);
+}
+
+void FPlayKitMockServerConfig::ParseFrom(const TCHAR* Params)
+{
+	FParse::Value(Params, TEXT("Port="), Port);
+	FParse::Value(Params, TEXT("LatencyMs="), LatencyMs);
+	FParse::Value(Params, TEXT("TokensPerSecond="), TokensPerSecond);
+	FParse::Value(Params, TEXT("TaskSeconds="), TaskSeconds);
+	FParse::Value(Params, TEXT("Tokens="), TokensPerResponse);
+	FParse::Value(Params, TEXT("TokensPerEvent="), TokensPerEvent);
+	FParse::Value(Params, TEXT("MaxWriteBytes="), MaxWriteBytes);
+	FParse::Value(Params, TEXT("ImageSize="), ImageSize);
+	FParse::Value(Params, TEXT("ModelBytes="), ModelBytes);
+	FParse::Value(Params, TEXT("RateLimitRate="), RateLimitRate);
+	FParse::Value(Params, TEXT("RetryAfterSeconds="), RetryAfterSeconds);
+	FParse::Value(Params, TEXT("ServerErrorRate="), ServerErrorRate);
+	FParse::Value(Params, TEXT("StallRate="), StallRate);
+	FParse::Value(Params, TEXT("StallSeconds="), StallSeconds);
+	FParse::Value(Params, TEXT("Seed="), Seed);
+	FParse::Value(Params, TEXT("SessionDropSeconds="), SessionDropSeconds);
+	FParse::Value(Params, TEXT("SessionTimeoutSeconds="), SessionTimeoutSeconds);
+}
@@ -0,0 +1,340 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Math/RandomStream.h"
+#include "Net/PlayKitLoopbackTransport.h"
+#include <atomic>
+
+class FSocket;
+namespace PlayKitHistorySync { struct FHeader; }
+class FRunnableThread;
+
+/**
+ * Behaviour of the mock server
+ */
+struct PLAYKITSDKTESTSERVER_API FPlayKitMockServerConfig
+{
+	/** Port to listen on (loopback only). 0 picks a free port. */
+	int32 Port = 0;
+
+	//========== Timing ==========//
+
+	/** Delay before the first byte of a JSON response, or the first token of a stream */
+	double LatencyMs = 200.0;
+
+	/** Rate at which a stream emits tokens */
+	double TokensPerSecond = 50.0;
+
+	/** Seconds a 3D task takes from creation to success */
+	double TaskSeconds = 5.0;
+
+	//========== Payloads ==========//
+
+	/** Tokens (words) in every chat reply and transcription */
+	int32 TokensPerResponse = 40;
+
+	/** Tokens per stream event; more than one batches deltas like a busy upstream does */
+	int32 TokensPerEvent = 1;
+
+	/** Cap on bytes per socket write, 0 for none. Small values split events and UTF-8 sequences across reads. */
+	int32 MaxWriteBytes = 0;
+
+	/** Width and height of generated images. Pixels are noise, so the PNG is close to its uncompressed size. */
+	int32 ImageSize = 256;
+
+	/** Size of the model files behind 3D task output URLs */
+	int32 ModelBytes = 1024 * 1024;
+
+	//========== Error injection ==========//
+
+	/** Fraction of API requests answered with 429 and a Retry-After header */
+	double RateLimitRate = 0.0;
+
+	/** Seconds sent in Retry-After */
+	int32 RetryAfterSeconds = 1;
+
+	/** Fraction of API requests answered with 500 or 503 */
+	double ServerErrorRate = 0.0;
+
+	/** Fraction of API requests that stall: JSON replies are held back, streams pause halfway */
+	double StallRate = 0.0;
+
+	/** Length of a stall */
+	double StallSeconds = 30.0;
+
+	/** Seed of the error injection, so a failing run can be reproduced */
+	int32 Seed = 0;
+
+	//========== Sessions ==========//
+
+	/** Drop every session connection after this many seconds, 0 for never. Exercises reconnect and resume. */
+	double SessionDropSeconds = 0.0;
+
+	/** Seconds a detached session, and a finished stream, are kept for resuming */
+	double SessionTimeoutSeconds = 30.0;
+
+	/**
+	 * Read overrides from a command line or console arguments, e.g.
+	 * "Port=8123 LatencyMs=50 TokensPerSecond=80 RateLimitRate=0.05 StallRate=0.01".
+	 */
+	void ParseFrom(const TCHAR* Params);
+};
+
+/**
+ * Local stand-in for the PlayKit API, for load tests and profiling without a network.
+ *
+ * Routes (game id is ignored):
+ *   POST /ai/{game}/v2/chat                  JSON completion, or a text-delta event stream for "stream": true
+ *   POST /ai/{game}/v2/image                 "n" noise PNGs as b64_json
+ *   POST /ai/{game}/v2/audio/transcriptions  verbose_json transcription
+ *   POST /ai/{game}/v2/3d                    create a task that succeeds after TaskSeconds
+ *   GET  /ai/{game}/v2/3d/{task}             poll a task
+ *   GET  /mock/assets/{name}                 ModelBytes of data, the target of 3D output URLs
+ *   GET  /session/v1                         WebSocket session (FPlayKitSessionTransport), carrying the chat route
+ *
+ * Chat requests with a "history" member are checked against the history the server
+ * holds for that id (PlayKitHistorySync.h) and answered with 409 HISTORY_MISMATCH when
+ * they do not continue it. Only the hashes are kept; replies never depend on the messages.
+ *
+ * Streams are paced: the first token after LatencyMs, then one event per
+ * TokensPerEvent tokens at TokensPerSecond, so time-to-first-token and per-token
+ * overhead can be measured on the client. Rate limits, server errors and stalls are
+ * injected at configurable rates on every /ai/ route.
+ *
+ * Session streams keep their reply after the connection drops: it keeps being
+ * "generated" on schedule, and a client that reattaches within SessionTimeoutSeconds
+ * resumes each stream from the byte it got to (see PlayKitSessionProtocol.h).
+ *
+ * A single worker thread multiplexes all connections over non-blocking sockets, so
+ * hundreds of concurrent streams cost one thread. Keep-alive is supported. UE's
+ * HTTPServer module is not used because it can only send a response as a whole.
+ *
+ * Usage:
+ *   FPlayKitMockServer Server(Config);
+ *   if (Server.Start()) { Settings->CustomBaseUrl = Server.GetBaseUrl(); ... }
+ *
+ * In a running game or editor: PlayKit.MockServer.Start [Key=Value ...] / PlayKit.MockServer.Stop
+ */
+class PLAYKITSDKTESTSERVER_API FPlayKitMockServer : public FRunnable
+{
+public:
+	explicit FPlayKitMockServer(const FPlayKitMockServerConfig& InConfig);
+	virtual ~FPlayKitMockServer() override;
+
+	/** Bind the listen socket and start the worker thread. @return false if the port could not be bound */
+	bool Start();
+
+	/** Close all connections and join the worker thread */
+	void Stop();
+
+	/** Bound port; valid after Start() */
+	int32 GetPort() const { return BoundPort; }
+
+	/** http://127.0.0.1:<port>, suitable for UPlayKitSettings::CustomBaseUrl */
+	FString GetBaseUrl() const;
+
+	/** ws://127.0.0.1:<port>/session/v1, suitable for FPlayKitSessionConfig::Url */
+	FString GetSessionUrl() const;
+
+	/** Requests answered so far */
+	int64 GetRequestCount() const { return RequestCount.load(); }
+
+	/** Requests answered with an injected error or stall so far */
+	int64 GetInjectedFaultCount() const { return InjectedFaultCount.load(); }
+
+	/** Bytes of chat request bodies received so far */
+	int64 GetChatRequestBytes() const { return ChatRequestBytes.load(); }
+
+	/** Chat requests answered with HISTORY_MISMATCH so far */
+	int64 GetHistoryMismatchCount() const { return HistoryMismatchCount.load(); }
+
+	/**
+	 * Handler for FPlayKitLoopbackTransport that answers the chat route with the same replies
+	 * as the server, in process. Only payload options apply: there is no latency, pacing or
+	 * fault injection, and each stream event is one loopback chunk (delivered one per tick).
+	 */
+	static FPlayKitLoopbackTransport::FHandler MakeLoopbackHandler(const FPlayKitMockServerConfig& Config);
+
+	//~ Begin FRunnable Interface
+	virtual uint32 Run() override;
+	//~ End FRunnable Interface
+
+private:
+	/** Bytes to send once DueTime is reached */
+	struct FScheduledWrite
+	{
+		double DueTime = 0.0;
+		TArray<uint8> Bytes;
+	};
+
+	struct FConnection
+	{
+		FSocket* Socket = nullptr;
+
+		/** Received bytes not yet parsed into a request */
+		TArray<uint8> Input;
+
+		/** Response of the current request, in send order */
+		TArray<FScheduledWrite> Schedule;
+
+		/** Bytes due for sending; OutputOffset of them went out already */
+		TArray<uint8> Output;
+		int32 OutputOffset = 0;
+
+		bool bResponding = false;
+		bool bCloseWhenSent = false;
+
+		/** Upgraded to a session WebSocket */
+		bool bWebSocket = false;
+		double UpgradeTime = 0.0;
+		FString SessionId;
+
+		/** Fragments of the WebSocket message being received */
+		TArray<uint8> Message;
+	};
+
+	struct FRequest
+	{
+		FString Method;
+		FString Path;
+		bool bKeepAlive = true;
+		TArray<uint8> Body;
+
+		/** Sec-WebSocket-Key and -Protocol of an upgrade request */
+		FString WebSocketKey;
+		FString WebSocketProtocol;
+	};
+
+	/** A reply independent of how it is carried: an HTTP response, or a session stream */
+	struct FReply
+	{
+		int32 StatusCode = 200;
+		FString ContentType;
+
+		/** "Name: Value\r\n" lines */
+		FString ExtraHeaders;
+
+		/** Status and headers go out at HeadTime */
+		double HeadTime = 0.0;
+
+		/** Body pieces in send order; a stream sends each when due, else the body goes out whole at HeadTime */
+		TArray<FScheduledWrite> Pieces;
+		bool bStream = false;
+	};
+
+	/** A request of a session; its reply outlives the connection it came in on */
+	struct FSessionStream
+	{
+		FReply Reply;
+
+		/** Body generated so far (pieces that came due), kept for resuming */
+		TArray<uint8> Body;
+
+		/** Body bytes sent on the current connection */
+		int32 SentOffset = 0;
+
+		bool bHeadSent = false;
+
+		/** Waiting for the client to resume after a reconnect */
+		bool bDetached = false;
+
+		/** When End was sent; finished streams are kept a while in case End was lost */
+		double EndTime = 0.0;
+	};
+
+	struct FSession
+	{
+		TMap<uint32, FSessionStream> Streams;
+		FConnection* Connection = nullptr;
+		double DetachedTime = 0.0;
+	};
+
+	enum class EFault : uint8
+	{
+		None,
+		RateLimit,
+		ServerError,
+		Stall
+	};
+
+	void AcceptConnections();
+
+	/** Receive, answer and send on one connection. @return false once the connection is finished */
+	bool ServiceConnection(FConnection& Connection, double Now);
+
+	/** Parse one complete request from the front of Input. @return false if more bytes are needed */
+	static bool TryParseRequest(TArray<uint8>& Input, FRequest& OutRequest);
+
+	void Respond(FConnection& Connection, const FRequest& Request, double Now);
+	EFault RollFault();
+
+	/** Error reply for an injected rate limit or server error. @return false for other faults */
+	bool MakeFaultReply(EFault Fault, double Now, FReply& OutReply) const;
+	void MakeChatReply(const TArray<uint8>& Body, double Now, bool bStall, FReply& OutReply);
+
+	/** Verify a synced history and extend it by Messages. @return false if History.Base does not continue what is held */
+	bool ApplyHistory(const PlayKitHistorySync::FHeader& History, TConstArrayView<TPair<FString, FString>> Messages);
+	static void MakeErrorReply(FReply& OutReply, double DueTime, int32 StatusCode, const TCHAR* Code, const FString& Message,
+		const FString& ExtraHeaders = FString());
+
+	// Sessions
+	void AcceptWebSocket(FConnection& Connection, const FRequest& Request, double Now);
+
+	/** Read client frames and send due stream data. @return false to close the connection */
+	bool ServiceWebSocket(FConnection& Connection, double Now);
+	void HandleSessionFrame(FConnection& Connection, const uint8* Data, int32 Num, double Now);
+	void ServiceSession(FConnection& Connection, FSession& Session, double Now);
+	void DetachSession(FConnection& Connection, double Now);
+	void ExpireSessions(double Now);
+	static void SendWebSocketFrame(FConnection& Connection, uint8 Opcode, const uint8* Data, int32 Num);
+	static void SendSessionFrame(FConnection& Connection, const TArray<uint8>& Frame);
+
+	// Routes. ReplyTime already includes latency and an injected stall where one applies.
+	void RespondChat(FConnection& Connection, const FRequest& Request, double Now, bool bStall);
+	void RespondImage(FConnection& Connection, const FRequest& Request, double ReplyTime);
+	void RespondTranscription(FConnection& Connection, double ReplyTime);
+	void RespondCreateTask(FConnection& Connection, double Now, double ReplyTime);
+	void RespondPollTask(FConnection& Connection, const FString& TaskId, double Now, double ReplyTime);
+	void RespondAsset(FConnection& Connection, double Now);
+
+	static void ScheduleResponse(FConnection& Connection, double DueTime, int32 StatusCode, const TCHAR* ContentType,
+		const TArray<uint8>& Body, const FString& ExtraHeaders = FString());
+	static void ScheduleError(FConnection& Connection, double DueTime, int32 StatusCode, const TCHAR* Code, const FString& Message,
+		const FString& ExtraHeaders = FString());
+	static void ScheduleChunk(FConnection& Connection, double DueTime, FUtf8StringView Data);
+	static void ScheduleReply(FConnection& Connection, const FReply& Reply);
+
+	FString MakeReplyText(int32 NumTokens) const;
+	static FString MakeReplyToken(int32 Index);
+
+private:
+	FPlayKitMockServerConfig Config;
+
+	FSocket* ListenSocket = nullptr;
+	int32 BoundPort = 0;
+
+	FRunnableThread* Thread = nullptr;
+	std::atomic<bool> bStopping { false };
+	std::atomic<int64> RequestCount { 0 };
+	std::atomic<int64> InjectedFaultCount { 0 };
+	std::atomic<int64> ChatRequestBytes { 0 };
+	std::atomic<int64> HistoryMismatchCount { 0 };
+
+	/** Noise PNG served by the image route, Base64 encoded once in Start() */
+	FString ImageBase64;
+
+	// Only touched by the worker thread
+	TArray<TUniquePtr<FConnection>> Connections;
+	TMap<FString, double> TaskCreateTimes;
+	int32 NextTaskId = 1;
+	TMap<FString, FSession> Sessions;
+	int32 NextSessionId = 1;
+
+	/** Synced chat histories: the hash of every message prefix, by history id */
+	TMap<FString, TArray<uint64>> Histories;
+	static constexpr int32 MaxHistories = 100000;
+	FRandomStream FaultRandom;
+};
@@ -0,0 +1,30 @@
+// Copyright PlayKit. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class PlayKitSDKTestServer : ModuleRules
+{
+	public PlayKitSDKTestServer(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Core",
+				"CoreUObject",
+				"Engine",
+				"PlayKitSDK",
+			}
+			);
+
+		PrivateDependencyModuleNames.AddRange(
+			new string[]
+			{
+				"Sockets",
+				"Networking",
+				"HTTP",
+			}
+			);
+	}
+}
@@ -0,0 +1,83 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#include "PlayKitSDKTestServer.h"
+
+#include "PlayKitMockServer.h"
+#include "PlayKitSettings.h"
+#include "HAL/IConsoleManager.h"
+
+#define LOCTEXT_NAMESPACE "FPlayKitSDKTestServerModule"
+
+void FPlayKitSDKTestServerModule::StartupModule()
+{
+	StartCommand = IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("PlayKit.MockServer.Start"),
+		TEXT("Serve the PlayKit API from a local mock server and point the SDK at it. ")
+		TEXT("Options: Port= LatencyMs= TokensPerSecond= Tokens= TokensPerEvent= MaxWriteBytes= ImageSize= ModelBytes= TaskSeconds= ")
+		TEXT("RateLimitRate= RetryAfterSeconds= ServerErrorRate= StallRate= StallSeconds= Seed="),
+		FConsoleCommandWithArgsDelegate::CreateRaw(this, &FPlayKitSDKTestServerModule::StartMockServer));
+
+	StopCommand = IConsoleManager::Get().RegisterConsoleCommand(
+		TEXT("PlayKit.MockServer.Stop"),
+		TEXT("Stop the local mock server and restore the PlayKit base URL."),
+		FConsoleCommandDelegate::CreateRaw(this, &FPlayKitSDKTestServerModule::StopMockServer));
+}
+
+void FPlayKitSDKTestServerModule::ShutdownModule()
+{
+	StopMockServer();
+
+	if (StartCommand)
+	{
+		IConsoleManager::Get().UnregisterConsoleObject(StartCommand);
+		StartCommand = nullptr;
+	}
+	if (StopCommand)
+	{
+		IConsoleManager::Get().UnregisterConsoleObject(StopCommand);
+		StopCommand = nullptr;
+	}
+}
+
+void FPlayKitSDKTestServerModule::StartMockServer(const TArray<FString>& Args)
+{
+	StopMockServer();
+
+	FPlayKitMockServerConfig Config;
+	Config.ParseFrom(*FString::Join(Args, TEXT(" ")));
+
+	TUniquePtr<FPlayKitMockServer> Server = MakeUnique<FPlayKitMockServer>(Config);
+	if (!Server->Start())
+	{
+		return;
+	}
+
+	UPlayKitSettings* Settings = UPlayKitSettings::Get();
+	SavedBaseUrl = Settings->CustomBaseUrl;
+	Settings->CustomBaseUrl = Server->GetBaseUrl();
+	MockServer = MoveTemp(Server);
+
+	UE_LOG(LogTemp, Display, TEXT("[PlayKitMockServer] PlayKit requests now go to %s"), *Settings->CustomBaseUrl);
+}
+
+void FPlayKitSDKTestServerModule::StopMockServer()
+{
+	if (!MockServer)
+	{
+		return;
+	}
+
+	MockServer->Stop();
+	UE_LOG(LogTemp, Display, TEXT("[PlayKitMockServer] Stopped after %lld requests (%lld injected faults)"),
+		MockServer->GetRequestCount(), MockServer->GetInjectedFaultCount());
+	MockServer.Reset();
+
+	if (UPlayKitSettings* Settings = UPlayKitSettings::Get())
+	{
+		Settings->CustomBaseUrl = SavedBaseUrl;
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
+
+IMPLEMENT_MODULE(FPlayKitSDKTestServerModule, PlayKitSDKTestServer)
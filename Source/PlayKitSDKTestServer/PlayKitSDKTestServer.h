@@ -0,0 +1,31 @@
+// Copyright PlayKit. All Rights Reserved.
+
+#pragma once
+
+#include "Modules/ModuleManager.h"
+
+class FPlayKitMockServer;
+class IConsoleObject;
+
+class FPlayKitSDKTestServerModule : public IModuleInterface
+{
+public:
+
+	/** IModuleInterface implementation */
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+
+private:
+	/** PlayKit.MockServer.Start [Key=Value ...]: serve the API locally and point the SDK settings at it */
+	void StartMockServer(const TArray<FString>& Args);
+
+	/** PlayKit.MockServer.Stop: stop the server and restore the SDK settings */
+	void StopMockServer();
+
+private:
+	TUniquePtr<FPlayKitMockServer> MockServer;
+	FString SavedBaseUrl;
+
+	IConsoleObject* StartCommand = nullptr;
+	IConsoleObject* StopCommand = nullptr;
+};